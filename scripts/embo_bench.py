@@ -0,0 +1,100 @@
+import serial
+import sys
+import time
+import argparse
+
+
+# command latency and SCOPE readout throughput of EMBO, real device or host simulator (src/firmware/board/HOST)
+
+class EmboBench(object):
+    TIMEOUT_CMD = 1.0
+    TIMEOUT_READ = 5.0
+    READY_STR = "Ready"
+
+    def __init__(self, port, baud):
+        self.ser = serial.Serial(port, baud, timeout=0,
+            parity=serial.PARITY_NONE,
+            stopbits=serial.STOPBITS_ONE,
+            bytesize=serial.EIGHTBITS)
+        self.ser.reset_input_buffer()
+
+    def send_cmd(self, cmd, timeout):
+        self.ser.write((cmd + "\r\n").encode())
+        return self.receive_line(timeout)
+
+    def receive_line(self, timeout):
+        rx = b""
+        t = time.perf_counter()
+        while time.perf_counter() - t < timeout:
+            rx += self.ser.read(self.ser.in_waiting or 1)
+            if rx.endswith(b"\r\n"):
+                return rx.decode(errors="replace").strip()
+        return ""
+
+    def receive_block(self, timeout):
+        rx = b""
+        t = time.perf_counter()
+        need = -1
+        while time.perf_counter() - t < timeout:
+            rx += self.ser.read(self.ser.in_waiting or 1)
+            if need < 0 and len(rx) >= 2:
+                if rx[0:1] != b"#":
+                    if rx.endswith(b"\r\n"):
+                        return None # not ready or error
+                    continue
+                digits = int(rx[1:2])
+                if len(rx) >= 2 + digits:
+                    need = 2 + digits + int(rx[2:2 + digits]) + 2
+            if need > 0 and len(rx) >= need:
+                return rx[:need]
+        raise TimeoutError("block not received")
+
+    def latency(self, n):
+        self.send_cmd("*IDN?", self.TIMEOUT_CMD)
+        res = []
+        for i in range(n):
+            t = time.perf_counter()
+            if self.send_cmd("*IDN?", self.TIMEOUT_CMD) == "":
+                raise TimeoutError("*IDN? not answered")
+            res.append((time.perf_counter() - t) * 1000.0)
+        res.sort()
+        print("latency *IDN? [ms]: min %.3f avg %.3f p99 %.3f max %.3f" %
+              (res[0], sum(res) / len(res), res[min(len(res) - 1, int(len(res) * 0.99))], res[-1]))
+
+    def throughput(self, n, settings):
+        print(self.send_cmd("SYS:MODE SCOPE", self.TIMEOUT_CMD))
+        print(self.send_cmd("SCOP:SET " + settings, self.TIMEOUT_CMD))
+        time.sleep(0.2)
+        self.ser.reset_input_buffer()
+
+        total = 0
+        frames = 0
+        t = time.perf_counter()
+        while frames < n:
+            self.ser.write(b"SCOP:READ?\r\n")
+            blk = self.receive_block(self.TIMEOUT_READ)
+            if blk is not None:
+                total += len(blk)
+                frames += 1
+            while self.READY_STR not in self.receive_line(self.TIMEOUT_READ): # device announces next frame
+                pass
+        dt = time.perf_counter() - t
+
+        print("SCOPE readout: %d frames, %d B in %.3f s => %.1f kB/s, %.1f fps" %
+              (frames, total, dt, total / dt / 1000.0, frames / dt))
+        print("device TPUT: " + self.send_cmd("SYS:TPUT?", self.TIMEOUT_CMD))
+
+
+if __name__ == '__main__':
+    ap = argparse.ArgumentParser(description="EMBO latency and throughput benchmark")
+    ap.add_argument("port", nargs="?", default="/tmp/embo-sim", help="serial port or simulator pty link")
+    ap.add_argument("-b", "--baud", type=int, default=115200)
+    ap.add_argument("-n", type=int, default=100, help="iterations")
+    ap.add_argument("-s", "--scope", default="12,1000,100000,1100,1,50,R,A,50",
+                    help="SCOP:SET settings (bits,mem,fs,chans,trig ch,level,edge,mode,pretrig)")
+    args = ap.parse_args()
+
+    b = EmboBench(args.port, args.baud)
+    print(b.send_cmd("*IDN?", b.TIMEOUT_CMD))
+    b.latency(args.n)
+    b.throughput(args.n, args.scope)
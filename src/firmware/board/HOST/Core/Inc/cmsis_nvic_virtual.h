@@ -0,0 +1,38 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_CMSIS_NVIC_VIRTUAL_H_
+#define INC_CMSIS_NVIC_VIRTUAL_H_
+
+/* NVIC registers are write 1 to set / clear, plain host memory can not do that, simulator keeps the state */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+void host_nvic_enable(int irqn);
+void host_nvic_disable(int irqn);
+uint32_t host_nvic_get_enable(int irqn);
+void host_nvic_set_pending(int irqn);
+void host_nvic_clear_pending(int irqn);
+uint32_t host_nvic_get_pending(int irqn);
+void host_nvic_set_priority(int irqn, uint32_t priority);
+uint32_t host_nvic_get_priority(int irqn);
+void host_nvic_set_grouping(uint32_t group);
+uint32_t host_nvic_get_grouping(void);
+
+#define NVIC_SetPriorityGrouping(g)     host_nvic_set_grouping(g)
+#define NVIC_GetPriorityGrouping()      host_nvic_get_grouping()
+#define NVIC_EnableIRQ(n)               host_nvic_enable(n)
+#define NVIC_GetEnableIRQ(n)            host_nvic_get_enable(n)
+#define NVIC_DisableIRQ(n)              host_nvic_disable(n)
+#define NVIC_GetPendingIRQ(n)           host_nvic_get_pending(n)
+#define NVIC_SetPendingIRQ(n)           host_nvic_set_pending(n)
+#define NVIC_ClearPendingIRQ(n)         host_nvic_clear_pending(n)
+#define NVIC_GetActive(n)               (0U)
+#define NVIC_SetPriority(n,p)           host_nvic_set_priority(n, p)
+#define NVIC_GetPriority(n)             host_nvic_get_priority(n)
+#define NVIC_SystemReset()              abort()
+
+#endif /* INC_CMSIS_NVIC_VIRTUAL_H_ */
@@ -0,0 +1,52 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_HOST_H_
+#define INC_HOST_H_
+
+/* CMSIS PRIMASK functions are ARM assembly, keep them out of the way and mask "IRQs" by host lock instead */
+#define __enable_irq    __cm3_enable_irq
+#define __disable_irq   __cm3_disable_irq
+
+#include "stm32f1xx.h"
+
+#undef __enable_irq
+#undef __disable_irq
+
+#include <stdint.h>
+
+#define __enable_irq()  host_irq_unlock()
+#define __disable_irq() host_irq_lock()
+
+#define HOST_SIM_STEP_US        100         // simulator step, DMA and ADC advance in bursts of this length
+#define HOST_SIM_DAQ_MAX        1000000     // max DAQ timer ticks per step, protects against absurd timer setup
+#define HOST_SIG_FREQ           1000        // default base frequency of generated signals [Hz]
+#define HOST_LINK               "/tmp/embo-sim" // default symlink to pty slave, PC app lists it on scan
+
+/* simulator options */
+typedef struct
+{
+    double sig_freq;        // base frequency of generated signals
+    uint8_t fast;           // ignore baud rate, pty as fast as it goes
+    uint8_t verbose;        // print UART traffic to stderr
+}host_opt_t;
+
+extern host_opt_t host_opt;
+
+/* peripheral memory */
+int host_mem_map(void);
+
+/* interrupts */
+void host_irq_lock(void);
+void host_irq_unlock(void);
+void host_irq_raise(int irqn);      // NVIC functions: cmsis_nvic_virtual.h
+
+/* simulator */
+int host_sim_start(int pty_fd);
+
+/* OS */
+uint32_t host_os_tick(void);
+
+#endif /* INC_HOST_H_ */
@@ -0,0 +1,77 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+/* host port, replaces portable/M3/portmacro.h, kernel API is provided by host_os.c over pthreads */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define portCHAR          char
+#define portFLOAT         float
+#define portDOUBLE        double
+#define portLONG          long
+#define portSHORT         short
+#define portSTACK_TYPE    uint32_t
+#define portBASE_TYPE     long
+
+typedef portSTACK_TYPE   StackType_t;
+typedef long             BaseType_t;
+typedef unsigned long    UBaseType_t;
+
+typedef uint32_t         TickType_t;
+#define portMAX_DELAY              ( TickType_t ) 0xffffffffUL
+#define portTICK_TYPE_IS_ATOMIC    1
+
+#define portSTACK_GROWTH      ( -1 )
+#define portTICK_PERIOD_MS    ( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT    8
+#define portDONT_DISCARD      __attribute__( ( used ) )
+
+/* every task is its own thread, nothing to switch */
+#define portYIELD()
+#define portEND_SWITCHING_ISR( xSwitchRequired )    ( void )( xSwitchRequired )
+#define portYIELD_FROM_ISR( x )                     portEND_SWITCHING_ISR( x )
+
+/* critical section = simulator IRQ lock (recursive) */
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+extern uint32_t ulPortRaiseBASEPRI( void );
+extern void vPortSetBASEPRI( uint32_t ulNewMaskValue );
+
+#define portSET_INTERRUPT_MASK_FROM_ISR()         ulPortRaiseBASEPRI()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )    vPortSetBASEPRI( x )
+#define portDISABLE_INTERRUPTS()                  vPortEnterCritical()
+#define portENABLE_INTERRUPTS()                   vPortExitCritical()
+#define portENTER_CRITICAL()                      vPortEnterCritical()
+#define portEXIT_CRITICAL()                       vPortExitCritical()
+
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters )    void vFunction( void * pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters )          void vFunction( void * pvParameters )
+
+#define portRECORD_READY_PRIORITY( uxPriority, uxReadyPriorities )    ( uxReadyPriorities ) |= ( 1UL << ( uxPriority ) )
+#define portRESET_READY_PRIORITY( uxPriority, uxReadyPriorities )     ( uxReadyPriorities ) &= ~( 1UL << ( uxPriority ) )
+#define portGET_HIGHEST_PRIORITY( uxTopPriority, uxReadyPriorities )  uxTopPriority = ( 31UL - ( uint32_t ) __builtin_clz( ( uxReadyPriorities ) ) )
+
+#define portNOP()
+#define portINLINE              __inline
+#define portFORCE_INLINE        inline __attribute__( ( always_inline ) )
+#define portMEMORY_BARRIER()    __sync_synchronize()
+
+/* called from irq.c, SysTick drives the tick, SVC and PendSV have no meaning here */
+void xPortSysTickHandler( void );
+void vPortSVCHandler( void );
+void xPortPendSVHandler( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,446 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* FreeRTOS API subset used by app, every task is a pthread, IRQ masking is one recursive lock shared with simulator */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+
+#define HOST_OS_MAX_TASKS   8
+#define HOST_OS_STACK       (256 * 1024)
+
+
+struct QueueDefinition
+{
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+struct StreamBufferDef_t
+{
+    pthread_mutex_t mtx;
+    uint8_t* data;
+    size_t size;
+    size_t head;            // write pos
+    size_t tail;            // read pos
+};
+
+typedef struct
+{
+    pthread_t thread;
+    TaskFunction_t code;
+    void* param;
+    char name[16];
+    uint32_t depth;
+}host_task_t;
+
+static pthread_mutex_t irq_mtx;
+static pthread_once_t irq_once = PTHREAD_ONCE_INIT;
+
+static pthread_mutex_t sched_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sched_cond = PTHREAD_COND_INITIALIZER;
+static volatile BaseType_t sched_state = taskSCHEDULER_NOT_STARTED;
+
+static host_task_t tasks[HOST_OS_MAX_TASKS];
+static int tasks_cnt = 0;
+static __thread host_task_t* task_self = NULL;
+
+static volatile TickType_t tick = 0;
+
+
+/******************************* irq lock *********************************/
+
+static void irq_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&irq_mtx, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void host_irq_lock(void)
+{
+    pthread_once(&irq_once, irq_init);
+    pthread_mutex_lock(&irq_mtx);
+}
+
+void host_irq_unlock(void)
+{
+    pthread_once(&irq_once, irq_init);
+    pthread_mutex_unlock(&irq_mtx);
+}
+
+void vPortEnterCritical(void)
+{
+    host_irq_lock();
+}
+
+void vPortExitCritical(void)
+{
+    host_irq_unlock();
+}
+
+uint32_t ulPortRaiseBASEPRI(void)
+{
+    host_irq_lock();
+    return 0;
+}
+
+void vPortSetBASEPRI(uint32_t ulNewMaskValue)
+{
+    (void)ulNewMaskValue;
+    host_irq_unlock();
+}
+
+/******************************** helpers *********************************/
+
+static struct timespec deadline(TickType_t ticks)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    ts.tv_sec += ticks / 1000;
+    ts.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return ts;
+}
+
+/* handle lives in first word of static buffer, re-create reuses it */
+static void* static_obj(void* buff, size_t size)
+{
+    void** slot = (void**)buff;
+    if (*slot == NULL)
+    {
+        *slot = calloc(1, size);
+        if (*slot == NULL)
+            abort();
+    }
+    return *slot;
+}
+
+/******************************* semaphores *******************************/
+
+static QueueHandle_t sem_create(StaticQueue_t* buff, UBaseType_t max, UBaseType_t init)
+{
+    _Static_assert(sizeof(StaticQueue_t) >= sizeof(void*), "static queue too small");
+
+    QueueHandle_t q = static_obj(buff, sizeof(struct QueueDefinition));
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&q->mtx, NULL);
+    pthread_cond_init(&q->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    q->count = init;
+    q->max = max;
+    return q;
+}
+
+QueueHandle_t xQueueGenericCreateStatic(const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize,
+                                        uint8_t* pucQueueStorage, StaticQueue_t* pxStaticQueue, const uint8_t ucQueueType)
+{
+    (void)pucQueueStorage;
+    (void)ucQueueType;
+
+    if (uxItemSize != 0) // only semaphores are used by app
+        return NULL;
+    return sem_create(pxStaticQueue, uxQueueLength, 0);
+}
+
+QueueHandle_t xQueueCreateMutexStatic(const uint8_t ucQueueType, StaticQueue_t* pxStaticQueue)
+{
+    (void)ucQueueType;
+    return sem_create(pxStaticQueue, 1, 1);
+}
+
+QueueHandle_t xQueueCreateCountingSemaphoreStatic(const UBaseType_t uxMaxCount, const UBaseType_t uxInitialCount,
+                                                  StaticQueue_t* pxStaticQueue)
+{
+    return sem_create(pxStaticQueue, uxMaxCount, uxInitialCount);
+}
+
+BaseType_t xQueueSemaphoreTake(QueueHandle_t xQueue, TickType_t xTicksToWait)
+{
+    BaseType_t ret = pdFAIL;
+    struct timespec ts = deadline(xTicksToWait);
+
+    pthread_mutex_lock(&xQueue->mtx);
+    while (xQueue->count == 0 && xTicksToWait != 0)
+    {
+        if (xTicksToWait == portMAX_DELAY)
+            pthread_cond_wait(&xQueue->cond, &xQueue->mtx);
+        else if (pthread_cond_timedwait(&xQueue->cond, &xQueue->mtx, &ts) == ETIMEDOUT)
+            break;
+    }
+    if (xQueue->count > 0)
+    {
+        xQueue->count--;
+        ret = pdPASS;
+    }
+    pthread_mutex_unlock(&xQueue->mtx);
+    return ret;
+}
+
+static BaseType_t sem_give(QueueHandle_t xQueue)
+{
+    BaseType_t ret = errQUEUE_FULL;
+
+    pthread_mutex_lock(&xQueue->mtx);
+    if (xQueue->count < xQueue->max)
+    {
+        xQueue->count++;
+        pthread_cond_signal(&xQueue->cond);
+        ret = pdPASS;
+    }
+    pthread_mutex_unlock(&xQueue->mtx);
+    return ret;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void* const pvItemToQueue, TickType_t xTicksToWait,
+                             const BaseType_t xCopyPosition)
+{
+    (void)pvItemToQueue;
+    (void)xTicksToWait;
+    (void)xCopyPosition;
+    return sem_give(xQueue);
+}
+
+BaseType_t xQueueGiveFromISR(QueueHandle_t xQueue, BaseType_t* const pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != NULL)
+        *pxHigherPriorityTaskWoken = pdFALSE;
+    return sem_give(xQueue);
+}
+
+UBaseType_t uxQueueMessagesWaiting(const QueueHandle_t xQueue)
+{
+    pthread_mutex_lock(&xQueue->mtx);
+    UBaseType_t ret = xQueue->count;
+    pthread_mutex_unlock(&xQueue->mtx);
+    return ret;
+}
+
+/****************************** stream buffer *****************************/
+
+StreamBufferHandle_t xStreamBufferGenericCreateStatic(size_t xBufferSizeBytes, size_t xTriggerLevelBytes,
+                                                      BaseType_t xIsMessageBuffer, uint8_t* const pucStreamBufferStorageArea,
+                                                      StaticStreamBuffer_t* const pxStaticStreamBuffer)
+{
+    (void)xTriggerLevelBytes;
+
+    if (xIsMessageBuffer || xBufferSizeBytes < 2)
+        return NULL;
+
+    StreamBufferHandle_t sb = static_obj(pxStaticStreamBuffer, sizeof(struct StreamBufferDef_t));
+
+    pthread_mutex_init(&sb->mtx, NULL);
+    sb->data = pucStreamBufferStorageArea;
+    sb->size = xBufferSizeBytes;
+    sb->head = 0;
+    sb->tail = 0;
+    return sb;
+}
+
+static size_t sb_used(StreamBufferHandle_t sb)
+{
+    return (sb->head >= sb->tail) ? (sb->head - sb->tail) : (sb->size - sb->tail + sb->head);
+}
+
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t xStreamBuffer)
+{
+    pthread_mutex_lock(&xStreamBuffer->mtx);
+    size_t ret = sb_used(xStreamBuffer);
+    pthread_mutex_unlock(&xStreamBuffer->mtx);
+    return ret;
+}
+
+/* one byte always free, same as FreeRTOS */
+size_t xStreamBufferSpacesAvailable(StreamBufferHandle_t xStreamBuffer)
+{
+    pthread_mutex_lock(&xStreamBuffer->mtx);
+    size_t ret = xStreamBuffer->size - 1 - sb_used(xStreamBuffer);
+    pthread_mutex_unlock(&xStreamBuffer->mtx);
+    return ret;
+}
+
+size_t xStreamBufferSendFromISR(StreamBufferHandle_t xStreamBuffer, const void* pvTxData, size_t xDataLengthBytes,
+                                BaseType_t* const pxHigherPriorityTaskWoken)
+{
+    StreamBufferHandle_t sb = xStreamBuffer;
+
+    if (pxHigherPriorityTaskWoken != NULL)
+        *pxHigherPriorityTaskWoken = pdFALSE;
+
+    pthread_mutex_lock(&sb->mtx);
+
+    size_t free = sb->size - 1 - sb_used(sb);
+    size_t len = (xDataLengthBytes < free) ? xDataLengthBytes : free;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        sb->data[sb->head] = ((const uint8_t*)pvTxData)[i];
+        sb->head = (sb->head + 1 == sb->size) ? 0 : sb->head + 1;
+    }
+
+    pthread_mutex_unlock(&sb->mtx);
+    return len;
+}
+
+size_t xStreamBufferReceive(StreamBufferHandle_t xStreamBuffer, void* pvRxData, size_t xBufferLengthBytes,
+                            TickType_t xTicksToWait)
+{
+    StreamBufferHandle_t sb = xStreamBuffer;
+    (void)xTicksToWait; // app only polls
+
+    pthread_mutex_lock(&sb->mtx);
+
+    size_t used = sb_used(sb);
+    size_t len = (xBufferLengthBytes < used) ? xBufferLengthBytes : used;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        ((uint8_t*)pvRxData)[i] = sb->data[sb->tail];
+        sb->tail = (sb->tail + 1 == sb->size) ? 0 : sb->tail + 1;
+    }
+
+    pthread_mutex_unlock(&sb->mtx);
+    return len;
+}
+
+/********************************** tasks *********************************/
+
+static void* task_run(void* p)
+{
+    host_task_t* t = (host_task_t*)p;
+    task_self = t;
+
+    pthread_mutex_lock(&sched_mtx);
+    while (sched_state != taskSCHEDULER_RUNNING)
+        pthread_cond_wait(&sched_cond, &sched_mtx);
+    pthread_mutex_unlock(&sched_mtx);
+
+    t->code(t->param);
+
+    fprintf(stderr, "task %s returned\n", t->name);
+    abort();
+    return NULL;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char* const pcName, const uint32_t ulStackDepth,
+                               void* const pvParameters, UBaseType_t uxPriority, StackType_t* const puxStackBuffer,
+                               StaticTask_t* const pxTaskBuffer)
+{
+    (void)uxPriority;       // host scheduler decides, tasks run truly parallel
+    (void)puxStackBuffer;   // thread has its own stack
+
+    if (tasks_cnt >= HOST_OS_MAX_TASKS)
+        return NULL;
+
+    host_task_t* t = &tasks[tasks_cnt];
+    t->code = pxTaskCode;
+    t->param = pvParameters;
+    t->depth = ulStackDepth;
+    snprintf(t->name, sizeof(t->name), "%s", pcName);
+
+    /* responds longer than UART_TX_COPY_MAX may be DMAed from task stack, keep it below 4 GB */
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+#ifdef MAP_32BIT
+    void* stack = mmap(NULL, HOST_OS_STACK, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT | MAP_STACK, -1, 0);
+    if (stack == MAP_FAILED)
+        return NULL;
+    pthread_attr_setstack(&attr, stack, HOST_OS_STACK);
+#endif
+
+    int ret = pthread_create(&t->thread, &attr, task_run, t);
+    pthread_attr_destroy(&attr);
+    if (ret != 0)
+        return NULL;
+    pthread_setname_np(t->thread, t->name);
+
+    tasks_cnt++;
+    return (TaskHandle_t)pxTaskBuffer;
+}
+
+void vTaskStartScheduler(void)
+{
+    pthread_mutex_lock(&sched_mtx);
+    sched_state = taskSCHEDULER_RUNNING;
+    pthread_cond_broadcast(&sched_cond);
+    pthread_mutex_unlock(&sched_mtx);
+
+    for (int i = 0; i < tasks_cnt; i++)
+        pthread_join(tasks[i].thread, NULL);
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return sched_state;
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+    struct timespec ts = deadline(xTicksToDelay);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+/* host stacks are not instrumented, report configured depth as untouched */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t xTask)
+{
+    (void)xTask;
+    return (task_self != NULL) ? task_self->depth : 0;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return tick;
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return tick;
+}
+
+uint32_t host_os_tick(void)
+{
+    return tick;
+}
+
+/********************************** port **********************************/
+
+void xPortSysTickHandler(void)
+{
+    tick++;
+}
+
+void vPortSVCHandler(void)
+{
+}
+
+void xPortPendSVHandler(void)
+{
+}
@@ -0,0 +1,652 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* peripheral model of F103C8 as used by app: TIM3 paced ADC1 scan + DMA1 ch1, LA on GPIOA + DMA1 ch6,
+ * EXTI1-4, USART1 RX IRQ + TX DMA1 ch4 on pty, SysTick. Runs in one thread holding IRQ lock per step,
+ * so IRQ handlers are called from simulator thread exactly as they would preempt tasks on MCU. */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "cfg.h"
+#include "main.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE     0x100000
+#endif
+
+#define SIM_DMA_CH              7
+#define SIM_IRQ_MAX             64
+#define SIM_BURST_MAX_NS        10000000L   // longer stall (debugger, overload) is not replayed
+#define SIM_UART_BUFF           8192
+
+
+/* F103 vector table subset, app defines the handlers it needs */
+void EXTI0_IRQHandler(void) __attribute__((weak));
+void EXTI1_IRQHandler(void) __attribute__((weak));
+void EXTI2_IRQHandler(void) __attribute__((weak));
+void EXTI3_IRQHandler(void) __attribute__((weak));
+void EXTI4_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel1_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel2_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel3_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel4_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel5_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel6_IRQHandler(void) __attribute__((weak));
+void DMA1_Channel7_IRQHandler(void) __attribute__((weak));
+void ADC1_2_IRQHandler(void) __attribute__((weak));
+void TIM1_UP_IRQHandler(void) __attribute__((weak));
+void USART1_IRQHandler(void) __attribute__((weak));
+void SysTick_Handler(void);
+
+static void (* const vectors[SIM_IRQ_MAX])(void) =
+{
+    [EXTI0_IRQn] = EXTI0_IRQHandler,
+    [EXTI1_IRQn] = EXTI1_IRQHandler,
+    [EXTI2_IRQn] = EXTI2_IRQHandler,
+    [EXTI3_IRQn] = EXTI3_IRQHandler,
+    [EXTI4_IRQn] = EXTI4_IRQHandler,
+    [DMA1_Channel1_IRQn] = DMA1_Channel1_IRQHandler,
+    [DMA1_Channel2_IRQn] = DMA1_Channel2_IRQHandler,
+    [DMA1_Channel3_IRQn] = DMA1_Channel3_IRQHandler,
+    [DMA1_Channel4_IRQn] = DMA1_Channel4_IRQHandler,
+    [DMA1_Channel5_IRQn] = DMA1_Channel5_IRQHandler,
+    [DMA1_Channel6_IRQn] = DMA1_Channel6_IRQHandler,
+    [DMA1_Channel7_IRQn] = DMA1_Channel7_IRQHandler,
+    [ADC1_2_IRQn] = ADC1_2_IRQHandler,
+    [TIM1_UP_IRQn] = TIM1_UP_IRQHandler,
+    [USART1_IRQn] = USART1_IRQHandler,
+};
+
+static DMA_Channel_TypeDef* const dma_ch[SIM_DMA_CH] =
+{
+    DMA1_Channel1, DMA1_Channel2, DMA1_Channel3, DMA1_Channel4, DMA1_Channel5, DMA1_Channel6, DMA1_Channel7
+};
+
+typedef struct
+{
+    uint32_t len;           // reload length latched on enable
+    uint32_t cnt;           // CNDTR as last written by simulator
+    uint8_t en;             // EN as seen last step
+}sim_dma_t;
+
+static struct
+{
+    int fd;                             // pty master
+    pthread_t thread;
+
+    sim_dma_t dma[SIM_DMA_CH];
+    uint8_t in_irq;
+
+    double daq_acc;                     // fractional DAQ timer ticks
+    double t;                           // signal time [s]
+    uint64_t ms;                        // SysTick periods done
+    uint32_t seed;
+
+    double rx_acc;                      // fractional UART bytes
+    double tx_acc;
+    uint8_t rx[SIM_UART_BUFF];
+    int rx_len;
+    int rx_pos;
+    uint8_t tx[SIM_UART_BUFF];
+    int tx_len;
+}sim;
+
+static volatile uint64_t nvic_en = 0;
+static volatile uint64_t nvic_pend = 0;
+static uint8_t nvic_pri[SIM_IRQ_MAX];
+static uint32_t nvic_group = 0;
+
+
+/****************************** memory map ********************************/
+
+int host_mem_map(void)
+{
+    static const struct
+    {
+        uintptr_t base;
+        size_t size;
+    }regions[] =
+    {
+        { PERIPH_BASE, 0x30000 },               // APB1, APB2, AHB (DMA, RCC, FLASH)
+        { 0xE0000000UL, 0x100000 },             // Cortex-M3 PPB (SysTick, NVIC, SCB, DWT)
+        { FLASHSIZE_BASE & ~0xFFFUL, 0x1000 },  // system memory: flash size, UID
+    };
+
+    for (int i = 0; i < sizeof(regions) / sizeof(regions[0]); i++)
+    {
+        void* p = mmap((void*)regions[i].base, regions[i].size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+        if (p != (void*)regions[i].base)
+        {
+            fprintf(stderr, "can not map 0x%08lx: %s\n", (unsigned long)regions[i].base,
+                    p == MAP_FAILED ? strerror(errno) : "address taken");
+            return -1;
+        }
+    }
+
+    *(volatile uint16_t*)FLASHSIZE_BASE = 64;
+    *(volatile uint32_t*)UID_BASE = 0x484F5354; // "HOST"
+    return 0;
+}
+
+/********************************** NVIC **********************************/
+
+void host_nvic_enable(int irqn)
+{
+    if (irqn >= 0 && irqn < SIM_IRQ_MAX)
+        __atomic_or_fetch(&nvic_en, 1ULL << irqn, __ATOMIC_SEQ_CST);
+}
+
+void host_nvic_disable(int irqn)
+{
+    if (irqn >= 0 && irqn < SIM_IRQ_MAX)
+        __atomic_and_fetch(&nvic_en, ~(1ULL << irqn), __ATOMIC_SEQ_CST);
+}
+
+uint32_t host_nvic_get_enable(int irqn)
+{
+    if (irqn < 0 || irqn >= SIM_IRQ_MAX)
+        return 1; // system exceptions always on
+    return (nvic_en >> irqn) & 1;
+}
+
+void host_nvic_set_pending(int irqn)
+{
+    if (irqn >= 0 && irqn < SIM_IRQ_MAX)
+        __atomic_or_fetch(&nvic_pend, 1ULL << irqn, __ATOMIC_SEQ_CST);
+}
+
+void host_nvic_clear_pending(int irqn)
+{
+    if (irqn >= 0 && irqn < SIM_IRQ_MAX)
+        __atomic_and_fetch(&nvic_pend, ~(1ULL << irqn), __ATOMIC_SEQ_CST);
+}
+
+uint32_t host_nvic_get_pending(int irqn)
+{
+    if (irqn < 0 || irqn >= SIM_IRQ_MAX)
+        return 0;
+    return (nvic_pend >> irqn) & 1;
+}
+
+void host_nvic_set_priority(int irqn, uint32_t priority)
+{
+    if (irqn >= 0 && irqn < SIM_IRQ_MAX)
+        nvic_pri[irqn] = priority;
+}
+
+uint32_t host_nvic_get_priority(int irqn)
+{
+    if (irqn < 0 || irqn >= SIM_IRQ_MAX)
+        return 0;
+    return nvic_pri[irqn];
+}
+
+void host_nvic_set_grouping(uint32_t group)
+{
+    nvic_group = group;
+}
+
+uint32_t host_nvic_get_grouping(void)
+{
+    return nvic_group;
+}
+
+/******************************* registers ********************************/
+
+/* write 1 to clear and rc_w0 registers are plain memory here, fix them up after app code ran */
+static void sim_reg_fixup(void)
+{
+    uint32_t ifcr = DMA1->IFCR;
+    if (ifcr != 0)
+    {
+        uint32_t clr = ifcr;
+        for (int i = 0; i < SIM_DMA_CH; i++)
+        {
+            if (ifcr & (DMA_IFCR_CGIF1 << (i * 4)))
+                clr |= (0xFUL << (i * 4));
+        }
+        DMA1->ISR &= ~clr;
+        DMA1->IFCR = 0;
+    }
+
+    ADC1->CR2 &= ~(ADC_CR2_CAL | ADC_CR2_RSTCAL); // calibration is instant
+    ADC1->SR &= ADC_SR_AWD;
+    USART1->SR = USART_SR_TXE | USART_SR_TC;
+    EXTI->PR = 0;
+    TIM1->SR = 0;
+}
+
+static void sim_irq_dispatch(void)
+{
+    if (sim.in_irq) // no nesting, raised inside handler is served right after
+        return;
+    sim.in_irq = 1;
+
+    uint64_t act;
+    while ((act = (nvic_pend & nvic_en)) != 0)
+    {
+        int irqn = __builtin_ctzll(act);
+        host_nvic_clear_pending(irqn);
+
+        if (vectors[irqn] != NULL)
+            vectors[irqn]();
+        sim_reg_fixup();
+    }
+
+    sim.in_irq = 0;
+}
+
+/* simulator thread only, handler runs immediately if enabled */
+void host_irq_raise(int irqn)
+{
+    host_nvic_set_pending(irqn);
+    sim_irq_dispatch();
+}
+
+/********************************** DMA ***********************************/
+
+static uint32_t sim_rd(uintptr_t addr, uint32_t size)
+{
+    if (size == 0)
+        return *(volatile uint8_t*)addr;
+    if (size == 1)
+        return *(volatile uint16_t*)addr;
+    return *(volatile uint32_t*)addr;
+}
+
+static void sim_wr(uintptr_t addr, uint32_t size, uint32_t val)
+{
+    if (size == 0)
+        *(volatile uint8_t*)addr = val;
+    else if (size == 1)
+        *(volatile uint16_t*)addr = val;
+    else
+        *(volatile uint32_t*)addr = val;
+}
+
+/* latch new length when app (re)armed the channel */
+static void sim_dma_sync(int i)
+{
+    DMA_Channel_TypeDef* ch = dma_ch[i];
+    sim_dma_t* d = &sim.dma[i];
+    uint8_t en = (ch->CCR & DMA_CCR_EN) != 0;
+
+    if ((en && !d->en) || (en && ch->CNDTR != d->cnt))
+    {
+        d->len = ch->CNDTR & 0xFFFF;
+        d->cnt = d->len;
+    }
+    d->en = en;
+}
+
+/* one request of peripheral, returns 0 if channel is idle */
+static int sim_dma_req(int i)
+{
+    DMA_Channel_TypeDef* ch = dma_ch[i];
+    sim_dma_t* d = &sim.dma[i];
+
+    sim_dma_sync(i);
+    if (!d->en || d->cnt == 0 || d->len == 0)
+        return 0;
+
+    uint32_t ccr = ch->CCR;
+    uint32_t idx = d->len - d->cnt;
+    uint32_t psize = (ccr & DMA_CCR_PSIZE) >> DMA_CCR_PSIZE_Pos;
+    uint32_t msize = (ccr & DMA_CCR_MSIZE) >> DMA_CCR_MSIZE_Pos;
+    uintptr_t paddr = (uintptr_t)ch->CPAR + ((ccr & DMA_CCR_PINC) ? (idx << psize) : 0);
+    uintptr_t maddr = (uintptr_t)ch->CMAR + ((ccr & DMA_CCR_MINC) ? (idx << msize) : 0);
+
+    if (ccr & DMA_CCR_DIR) // memory to peripheral
+        sim_wr(paddr, psize, sim_rd(maddr, msize));
+    else
+        sim_wr(maddr, msize, sim_rd(paddr, psize));
+
+    d->cnt--;
+
+    uint32_t flags = 0;
+    uint32_t irq = 0;
+
+    if (d->cnt == d->len / 2)
+    {
+        flags |= DMA_ISR_HTIF1 | DMA_ISR_GIF1;
+        irq |= (ccr & DMA_CCR_HTIE);
+    }
+    if (d->cnt == 0)
+    {
+        flags |= DMA_ISR_TCIF1 | DMA_ISR_GIF1;
+        irq |= (ccr & DMA_CCR_TCIE);
+
+        if (ccr & DMA_CCR_CIRC)
+            d->cnt = d->len;
+    }
+
+    ch->CNDTR = d->cnt;
+
+    if (flags)
+    {
+        DMA1->ISR |= flags << (i * 4);
+        if (irq)
+            host_irq_raise(DMA1_Channel1_IRQn + i);
+    }
+    return 1;
+}
+
+/********************************* signals ********************************/
+
+static uint32_t sim_sig(uint32_t ch, double t)
+{
+    double f = host_opt.sig_freq;
+    double ph = fmod(t * f, 1.0);
+    double v;
+
+    switch (ch)
+    {
+    case 1:  v = 2048 + 1500 * sin(2 * M_PI * ph); break;                   // sine
+    case 2:  v = ph < 0.5 ? 548 : 3548; break;                              // square
+    case 3:  v = 548 + 3000 * (ph < 0.5 ? 2 * ph : 2 - 2 * ph); break;      // triangle
+    case 4:  v = 2048 + 1000 * sin(2 * M_PI * ph) +                         // noisy sine
+                 (double)((int)(rand_r(&sim.seed) % 301) - 150); break;
+    case 16: v = 1750; break;                                               // temp sensor
+    case 17: v = EM_ADC_VREF_CAL; break;                                    // vrefint
+    default: v = 0; break;
+    }
+
+    if (v < 0)
+        v = 0;
+    if (v > 4095)
+        v = 4095;
+    return (uint32_t)v;
+}
+
+/* LA pins 1-4 are binary counter, pin 1 toggles at signal freq */
+static uint32_t sim_la(double t)
+{
+    uint32_t cnt = (uint32_t)(t * host_opt.sig_freq * 2.0);
+    return (cnt & 0xF) << EM_GPIO_LA_CH1_NUM;
+}
+
+/*********************************** ADC **********************************/
+
+static uint32_t sim_adc_rank(int r)
+{
+    if (r < 6)
+        return (ADC1->SQR3 >> (r * 5)) & 0x1F;
+    if (r < 12)
+        return (ADC1->SQR2 >> ((r - 6) * 5)) & 0x1F;
+    return (ADC1->SQR1 >> ((r - 12) * 5)) & 0x1F;
+}
+
+static void sim_adc_awd(uint32_t ch, uint32_t val)
+{
+    uint32_t cr1 = ADC1->CR1;
+
+    if (!(cr1 & ADC_CR1_AWDEN))
+        return;
+    if ((cr1 & ADC_CR1_AWDSGL) && (cr1 & ADC_CR1_AWDCH) != ch)
+        return;
+    if (val <= (ADC1->HTR & 0xFFF) && val >= (ADC1->LTR & 0xFFF))
+        return;
+
+    ADC1->SR |= ADC_SR_AWD;
+    if (cr1 & ADC_CR1_AWDIE)
+        host_irq_raise(ADC1_2_IRQn);
+}
+
+/* TIM3 TRGO starts whole regular sequence */
+static void sim_adc_trgo(double t)
+{
+    uint32_t cr2 = ADC1->CR2;
+
+    if (!(cr2 & ADC_CR2_ADON) || !(cr2 & ADC_CR2_EXTTRIG))
+        return;
+
+    int ranks = (ADC1->CR1 & ADC_CR1_SCAN) ? (int)((ADC1->SQR1 & ADC_SQR1_L) >> ADC_SQR1_L_Pos) + 1 : 1;
+
+    for (int r = 0; r < ranks; r++)
+    {
+        uint32_t ch = sim_adc_rank(r);
+        uint32_t val = sim_sig(ch, t);
+
+        ADC1->DR = val;
+        ADC1->SR |= ADC_SR_EOS;
+
+        if (ADC1->CR2 & ADC_CR2_DMA)
+            sim_dma_req(0);
+        sim_adc_awd(ch, val);
+    }
+}
+
+/********************************** GPIO **********************************/
+
+static void sim_gpio(double t)
+{
+    uint32_t old = GPIOA->IDR;
+    uint32_t mask = 0xFUL << EM_GPIO_LA_CH1_NUM;
+    uint32_t now = (old & ~mask) | sim_la(t);
+
+    GPIOA->IDR = now;
+
+    uint32_t rise = (~old & now) & EXTI->RTSR;
+    uint32_t fall = (old & ~now) & EXTI->FTSR;
+    uint32_t hit = (rise | fall) & EXTI->IMR & mask;
+
+    for (int line = EM_GPIO_LA_CH1_NUM; hit != 0 && line <= EM_GPIO_LA_CH4_NUM; line++)
+    {
+        if (hit & (1UL << line))
+        {
+            EXTI->PR |= (1UL << line);
+            host_irq_raise(EXTI0_IRQn + line);
+            EXTI->PR = 0;
+        }
+    }
+}
+
+/*********************************** DAQ **********************************/
+
+static void sim_daq(double dt)
+{
+    uint32_t n = 0;
+
+    if (TIM3->CR1 & TIM_CR1_CEN)
+    {
+        double rate = (double)EM_TIM_DAQ_FREQ / ((double)(TIM3->PSC + 1) * (double)(TIM3->ARR + 1));
+        sim.daq_acc += rate * dt;
+        n = (uint32_t)sim.daq_acc;
+        sim.daq_acc -= n;
+
+        if (n > HOST_SIM_DAQ_MAX)
+            n = HOST_SIM_DAQ_MAX;
+    }
+    else
+    {
+        sim.daq_acc = 0;
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        double t = sim.t + dt * (double)(i + 1) / (double)n;
+
+        sim_gpio(t);
+        sim_adc_trgo(t);
+
+        if (TIM3->DIER & TIM_DIER_CC1DE)
+            sim_dma_req(5);
+    }
+
+    if (n == 0)
+        sim_gpio(sim.t + dt);
+
+    sim.t += dt;
+}
+
+/********************************** UART **********************************/
+
+static uint32_t sim_uart_budget(double* acc, double dt)
+{
+    if (host_opt.fast || USART1->BRR == 0)
+        return SIM_UART_BUFF;
+
+    *acc += (double)EM_FREQ_PCLK2 / (double)USART1->BRR / 10.0 * dt; // 8N1
+    uint32_t n = (uint32_t)*acc;
+    *acc -= n;
+    if (*acc > 1.0) // idle line does not save up
+        *acc = 1.0;
+    return n;
+}
+
+static void sim_uart_rx(double dt)
+{
+    if (sim.rx_pos >= sim.rx_len)
+    {
+        sim.rx_pos = 0;
+        sim.rx_len = 0;
+
+        int ret = read(sim.fd, sim.rx, sizeof(sim.rx));
+        if (ret > 0)
+        {
+            sim.rx_len = ret;
+            if (host_opt.verbose)
+                fprintf(stderr, "rx %.*s", ret, sim.rx);
+        }
+    }
+
+    uint32_t budget = sim_uart_budget(&sim.rx_acc, dt);
+
+    while (budget > 0 && sim.rx_pos < sim.rx_len)
+    {
+        if (!(USART1->CR1 & USART_CR1_UE) || !(USART1->CR1 & USART_CR1_RXNEIE))
+            break; // held in pty until app listens
+
+        USART1->DR = sim.rx[sim.rx_pos++];
+        USART1->SR |= USART_SR_RXNE;
+        host_irq_raise(USART1_IRQn);
+        USART1->SR &= ~USART_SR_RXNE;
+        budget--;
+    }
+}
+
+static void sim_uart_tx(double dt)
+{
+    uint32_t budget = sim_uart_budget(&sim.tx_acc, dt);
+
+    while (budget > 0 && sim.tx_len < SIM_UART_BUFF &&
+           (USART1->CR1 & USART_CR1_UE) && (USART1->CR3 & USART_CR3_DMAT))
+    {
+        if (!sim_dma_req(3))
+            break;
+        sim.tx[sim.tx_len++] = (uint8_t)USART1->DR;
+        budget--;
+    }
+
+    if (sim.tx_len == 0)
+        return;
+
+    int ret = write(sim.fd, sim.tx, sim.tx_len);
+    if (ret > 0)
+    {
+        memmove(sim.tx, sim.tx + ret, sim.tx_len - ret);
+        sim.tx_len -= ret;
+        if (host_opt.verbose)
+            fprintf(stderr, "tx %d B\n", ret);
+    }
+    else if (ret < 0 && errno == EIO) // nobody has slave open, line goes to void
+    {
+        sim.tx_len = 0;
+    }
+}
+
+/********************************** step **********************************/
+
+static void sim_step(double dt, uint64_t ms)
+{
+    sim_reg_fixup();
+
+    for (int i = 0; i < SIM_DMA_CH; i++)
+        sim_dma_sync(i);
+
+    while (sim.ms < ms)
+    {
+        sim.ms++;
+        if ((SysTick->CTRL & (SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk)) ==
+            (SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk))
+        {
+            SysTick_Handler();
+            sim_reg_fixup();
+        }
+    }
+
+    sim_daq(dt);
+    sim_uart_rx(dt);
+    sim_uart_tx(dt);
+    sim_irq_dispatch(); // enabled by app while pending
+}
+
+static int64_t sim_ns(const struct timespec* ts)
+{
+    return (int64_t)ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+static void* sim_run(void* p)
+{
+    struct timespec next, now;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    int64_t start = sim_ns(&next);
+    int64_t last = start;
+    int64_t skipped = 0;
+
+    while (1)
+    {
+        next.tv_nsec += HOST_SIM_STEP_US * 1000L;
+        if (next.tv_nsec >= 1000000000L)
+        {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR);
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t ns = sim_ns(&now);
+        int64_t dt = ns - last;
+
+        if (dt > SIM_BURST_MAX_NS)
+        {
+            skipped += dt - HOST_SIM_STEP_US * 1000L;
+            dt = HOST_SIM_STEP_US * 1000L;
+            next = now;
+        }
+        last = ns;
+
+        host_irq_lock();
+        sim_step((double)dt / 1e9, (uint64_t)((ns - start - skipped) / 1000000LL));
+        host_irq_unlock();
+    }
+    return NULL;
+}
+
+int host_sim_start(int pty_fd)
+{
+    sim.fd = pty_fd;
+    sim.seed = 1;
+
+    USART1->SR = USART_SR_TXE | USART_SR_TC;
+
+    if (pthread_create(&sim.thread, NULL, sim_run, NULL) != 0)
+        return -1;
+    pthread_setname_np(sim.thread, "sim");
+    return 0;
+}
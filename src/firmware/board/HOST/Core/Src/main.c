@@ -0,0 +1,200 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* EMBO firmware on PC: peripherals are simulated (host_sim.c), USART1 is pseudo terminal linked to HOST_LINK */
+
+#define _GNU_SOURCE
+
+#include "cfg.h"
+#include "main.h"
+
+/* after device headers, termios.h defines CR1, CR2, CR3 bits */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <pty.h>
+
+
+/* system_stm32f1xx.c */
+uint32_t SystemCoreClock = 72000000;
+const uint8_t AHBPrescTable[16U] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
+const uint8_t APBPrescTable[8U] = {0, 0, 0, 0, 1, 2, 3, 4};
+
+host_opt_t host_opt =
+{
+    .sig_freq = HOST_SIG_FREQ,
+    .fast = 0,
+    .verbose = 0,
+};
+
+static const char* link_path = HOST_LINK;
+
+extern char end; // end of .bss, DMA addresses are 32-bit
+
+static void MX_DMA_Init(void);
+static void MX_ADC1_Init(void);
+static void MX_TIM3_Init(void);
+static void MX_USART1_UART_Init(void);
+static int pty_open(void);
+static void on_exit_sig(int sig);
+
+
+int main(int argc, char** argv)
+{
+    int opt;
+    while ((opt = getopt(argc, argv, "fg:vh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'f': host_opt.fast = 1; break;
+        case 'g': host_opt.sig_freq = atof(optarg); break;
+        case 'v': host_opt.verbose = 1; break;
+        default:
+            fprintf(stderr, "usage: %s [-f] [-g freq] [-v] [link]\n"
+                            "  -f       ignore UART baud rate, pty runs at full speed\n"
+                            "  -g freq  base frequency of generated signals [Hz], default %d\n"
+                            "  -v       print UART traffic\n"
+                            "  link     pty symlink, default %s\n", argv[0], HOST_SIG_FREQ, HOST_LINK);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind < argc)
+        link_path = argv[optind];
+
+    if ((uintptr_t)&end > 0xFFFFFFFFUL)
+    {
+        fprintf(stderr, "image above 4 GB, link with -no-pie\n");
+        return 1;
+    }
+
+    if (host_mem_map() != 0)
+        return 1;
+
+    int fd = pty_open();
+    if (fd < 0)
+        return 1;
+
+    signal(SIGINT, on_exit_sig);
+    signal(SIGTERM, on_exit_sig);
+
+    MX_DMA_Init();
+    MX_ADC1_Init();
+    MX_USART1_UART_Init();
+    MX_TIM3_Init();
+
+    if (host_sim_start(fd) != 0)
+    {
+        perror("simulator");
+        return 1;
+    }
+
+    app_main();
+
+    return 0;
+}
+
+/* raw pty, master non-blocking, slave closed so simulator sees EIO while nobody is connected */
+static int pty_open(void)
+{
+    int master, slave;
+    struct termios tio;
+
+    if (openpty(&master, &slave, NULL, NULL, NULL) != 0)
+    {
+        perror("openpty");
+        return -1;
+    }
+
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    const char* name = ttyname(slave);
+    unlink(link_path);
+    if (symlink(name, link_path) != 0)
+    {
+        perror(link_path);
+        return -1;
+    }
+    close(slave);
+
+    fprintf(stderr, "%s %s on %s -> %s\n", EM_DEV_NAME, EM_DEV_VER, link_path, name);
+    return master;
+}
+
+static void on_exit_sig(int sig)
+{
+    unlink(link_path);
+    _exit(128 + sig);
+}
+
+void Error_Handler(void)
+{
+    abort();
+}
+
+/* CubeMX setup of F103C8 board without clocks and pins */
+
+static void MX_DMA_Init(void)
+{
+    LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_CHANNEL_1, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+    LL_DMA_SetChannelPriorityLevel(DMA1, LL_DMA_CHANNEL_1, LL_DMA_PRIORITY_VERYHIGH);
+    LL_DMA_SetMode(DMA1, LL_DMA_CHANNEL_1, LL_DMA_MODE_CIRCULAR);
+    LL_DMA_SetPeriphIncMode(DMA1, LL_DMA_CHANNEL_1, LL_DMA_PERIPH_NOINCREMENT);
+    LL_DMA_SetMemoryIncMode(DMA1, LL_DMA_CHANNEL_1, LL_DMA_MEMORY_INCREMENT);
+    LL_DMA_SetPeriphSize(DMA1, LL_DMA_CHANNEL_1, LL_DMA_PDATAALIGN_HALFWORD);
+    LL_DMA_SetMemorySize(DMA1, LL_DMA_CHANNEL_1, LL_DMA_MDATAALIGN_HALFWORD);
+
+    LL_DMA_SetDataTransferDirection(DMA1, LL_DMA_CHANNEL_6, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+    LL_DMA_SetChannelPriorityLevel(DMA1, LL_DMA_CHANNEL_6, LL_DMA_PRIORITY_VERYHIGH);
+    LL_DMA_SetMode(DMA1, LL_DMA_CHANNEL_6, LL_DMA_MODE_CIRCULAR);
+    LL_DMA_SetPeriphIncMode(DMA1, LL_DMA_CHANNEL_6, LL_DMA_PERIPH_NOINCREMENT);
+    LL_DMA_SetMemoryIncMode(DMA1, LL_DMA_CHANNEL_6, LL_DMA_MEMORY_INCREMENT);
+    LL_DMA_SetPeriphSize(DMA1, LL_DMA_CHANNEL_6, LL_DMA_PDATAALIGN_BYTE);
+    LL_DMA_SetMemorySize(DMA1, LL_DMA_CHANNEL_6, LL_DMA_MDATAALIGN_BYTE);
+}
+
+static void MX_ADC1_Init(void)
+{
+    LL_ADC_SetDataAlignment(ADC1, LL_ADC_DATA_ALIGN_RIGHT);
+    LL_ADC_SetSequencersScanMode(ADC1, LL_ADC_SEQ_SCAN_ENABLE);
+    LL_ADC_REG_SetTriggerSource(ADC1, LL_ADC_REG_TRIG_EXT_TIM3_TRGO);
+    LL_ADC_REG_SetSequencerLength(ADC1, LL_ADC_REG_SEQ_SCAN_ENABLE_3RANKS);
+    LL_ADC_REG_SetContinuousMode(ADC1, LL_ADC_REG_CONV_SINGLE);
+    LL_ADC_REG_SetDMATransfer(ADC1, LL_ADC_REG_DMA_TRANSFER_UNLIMITED);
+
+    LL_ADC_SetAnalogWDMonitChannels(ADC1, LL_ADC_AWD_CHANNEL_1_REG);
+    LL_ADC_SetAnalogWDThresholds(ADC1, LL_ADC_AWD_THRESHOLD_HIGH, 4095);
+    LL_ADC_SetAnalogWDThresholds(ADC1, LL_ADC_AWD_THRESHOLD_LOW, 0);
+    LL_ADC_EnableIT_AWD1(ADC1);
+
+    LL_ADC_REG_SetSequencerRanks(ADC1, LL_ADC_REG_RANK_1, LL_ADC_CHANNEL_VREFINT);
+    LL_ADC_REG_SetSequencerRanks(ADC1, LL_ADC_REG_RANK_2, LL_ADC_CHANNEL_1);
+    LL_ADC_REG_SetSequencerRanks(ADC1, LL_ADC_REG_RANK_3, LL_ADC_CHANNEL_2);
+    LL_ADC_SetCommonPathInternalCh(__LL_ADC_COMMON_INSTANCE(ADC1), LL_ADC_PATH_INTERNAL_VREFINT);
+}
+
+static void MX_TIM3_Init(void)
+{
+    LL_TIM_SetPrescaler(TIM3, 1000);
+    LL_TIM_SetCounterMode(TIM3, LL_TIM_COUNTERMODE_UP);
+    LL_TIM_SetAutoReload(TIM3, 72);
+    LL_TIM_EnableARRPreload(TIM3);
+    LL_TIM_SetTriggerOutput(TIM3, LL_TIM_TRGO_UPDATE);
+}
+
+static void MX_USART1_UART_Init(void)
+{
+    LL_USART_SetTransferDirection(USART1, LL_USART_DIRECTION_TX_RX);
+    LL_USART_ConfigCharacter(USART1, LL_USART_DATAWIDTH_8B, LL_USART_PARITY_NONE, LL_USART_STOPBITS_1);
+    LL_USART_SetBaudRate(USART1, EM_FREQ_PCLK2, EM_UART_BAUD);
+    LL_USART_ConfigAsyncMode(USART1);
+    LL_USART_Enable(USART1);
+}
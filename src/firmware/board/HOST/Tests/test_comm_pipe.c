@@ -0,0 +1,175 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* pipelined requests against running simulator: several lines written at once are all queued in RX FIFO,
+ * answered in order and matched by SYS:SEQ? echo */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/wait.h>
+
+
+#define PIPE_LINES      8       // 8 x ~30 B, fits 256 B RX FIFO
+#define PIPE_ROUNDS     20
+#define RX_MAX          4096
+
+static int fails = 0;
+static pid_t sim = -1;
+static char link_path[64];
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+                                             fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); fails++; } } while (0)
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* reads until count text lines arrived, returns bytes read, lines split in place */
+static int read_lines(int fd, char* rx, int count, char** lines)
+{
+    int got = 0;
+    int found = 0;
+    int start = 0;
+    double t0 = now_ms();
+
+    while (found < count && now_ms() - t0 < 2000)
+    {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 10) <= 0)
+            continue;
+
+        int n = read(fd, rx + got, RX_MAX - 1 - got);
+        if (n <= 0)
+            continue;
+        got += n;
+
+        for (int i = start; i + 1 < got && found < count; i++)
+        {
+            if (rx[i] == '\r' && rx[i + 1] == '\n')
+            {
+                rx[i] = '\0';
+                lines[found++] = rx + start;
+                start = i + 2;
+                i++;
+            }
+        }
+        if (got >= RX_MAX - 1)
+            break;
+    }
+    return found;
+}
+
+static int sim_start(const char* exe)
+{
+    snprintf(link_path, sizeof(link_path), "/tmp/embo-test-pipe-%d", (int)getpid());
+
+    sim = fork();
+    if (sim == 0)
+    {
+        execl(exe, exe, "-f", link_path, (char*)NULL);
+        perror(exe);
+        _exit(127);
+    }
+    if (sim < 0)
+        return -1;
+
+    for (int it = 0; it < 200; it++) // wait for pty link
+    {
+        int fd = open(link_path, O_RDWR | O_NOCTTY);
+        if (fd >= 0)
+        {
+            struct termios tio;
+            tcgetattr(fd, &tio);
+            cfmakeraw(&tio);
+            tcsetattr(fd, TCSANOW, &tio);
+            return fd;
+        }
+        usleep(10000);
+    }
+    return -1;
+}
+
+static void sim_stop(void)
+{
+    if (sim > 0)
+    {
+        kill(sim, SIGTERM);
+        waitpid(sim, NULL, 0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s embo_host\n", argv[0]);
+        return 2;
+    }
+
+    int fd = sim_start(argv[1]);
+    if (fd < 0)
+    {
+        fprintf(stderr, "simulator did not start\n");
+        sim_stop();
+        return 1;
+    }
+
+    char rx[RX_MAX];
+    char* lines[PIPE_LINES];
+    unsigned seq = 1;
+
+    /* device announces pipelining */
+    CHECK(write(fd, "SYS:LIM?\r\n", 10) == 10, "write");
+    CHECK(read_lines(fd, rx, 1, lines) == 1, "no SYS:LIM? respond");
+    CHECK(strchr(lines[0], 'Q') != NULL, "feature Q missing: %s", lines[0]);
+
+    for (int round = 0; round < PIPE_ROUNDS; round++)
+    {
+        /* whole window in one write, device is still busy with first line when rest arrives */
+        char tx[PIPE_LINES * 40];
+        int len = 0;
+        unsigned first = seq;
+
+        for (int i = 0; i < PIPE_LINES; i++)
+            len += sprintf(tx + len, "SYS:SEQ? %u;SYS:UPT?%s\r\n", seq++, i % 2 ? ";*IDN?" : "");
+
+        CHECK(write(fd, tx, len) == len, "write");
+
+        int n = read_lines(fd, rx, PIPE_LINES, lines);
+        CHECK(n == PIPE_LINES, "round %d: %d of %d lines answered", round, n, PIPE_LINES);
+
+        for (int i = 0; i < n; i++)
+        {
+            CHECK(strtoul(lines[i], NULL, 10) == first + i, "round %d line %d: %s", round, i, lines[i]);
+            CHECK(strchr(lines[i], ';') != NULL, "round %d line %d not batch: %s", round, i, lines[i]);
+            CHECK((strstr(lines[i], "EMBO") != NULL) == (i % 2 == 1), "round %d line %d: %s", round, i, lines[i]);
+        }
+        if (n != PIPE_LINES)
+            break;
+    }
+
+    close(fd);
+    sim_stop();
+
+    if (fails > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", fails);
+        return 1;
+    }
+    printf("test_comm_pipe: OK\n");
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* daq_pos.c circular position arithmetic: fixed wrap-around cases and sweep over whole buffer against plain modulo */
+
+#include "daq_pos.h"
+
+#include <stdio.h>
+
+
+static int fails = 0;
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+                                             fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); fails++; } } while (0)
+
+#define CHECK_POS(p, f, t, l, po) CHECK((p).frst == (f) && (p).trig == (t) && (p).last == (l) && (p).post == (po), \
+                                        "frst %d trig %d last %d post %d, expected %d %d %d %d", \
+                                        (p).frst, (p).trig, (p).last, (p).post, (f), (t), (l), (po))
+
+static int mod(int x, int len)
+{
+    return ((x % len) + len) % len;
+}
+
+static int in_buff(const daq_pos_t* p, int len)
+{
+    return p->frst >= 0 && p->frst < len && p->trig >= 0 && p->trig < len && p->last >= 0 && p->last < len;
+}
+
+static void test_basic(void)
+{
+    CHECK(daq_pos_wrap(-1, 10) == 9, "wrap -1");
+    CHECK(daq_pos_wrap(-10, 10) == 0, "wrap -len");
+    CHECK(daq_pos_wrap(10, 10) == 0, "wrap len");
+    CHECK(daq_pos_wrap(19, 10) == 9, "wrap 2 * len - 1");
+    CHECK(daq_pos_wrap(5, 10) == 5, "wrap inside");
+
+    CHECK(daq_pos_dist(8, 2, 10) == 4, "dist across end");
+    CHECK(daq_pos_dist(2, 8, 10) == 6, "dist forward");
+    CHECK(daq_pos_dist(3, 3, 10) == 0, "dist same");
+
+    CHECK(daq_pos_post_frames(1000, 0) == 1000, "post 0 %%");
+    CHECK(daq_pos_post_frames(1000, 100) == 0, "post 100 %%");
+    CHECK(daq_pos_post_frames(1000, 50) == 500, "post 50 %%");
+    CHECK(daq_pos_post_frames(1000, 33) == 670, "post 33 %%");
+}
+
+/* hand computed, buffer of 3 ch x (10 mem + 2 reserve) */
+static void test_fixed(void)
+{
+    daq_pos_t p;
+
+    /* trigger in middle, nothing wraps */
+    daq_pos_post_scope(&p, 18, 1, 36, 3, 10, 50);
+    CHECK_POS(p, 2, 19, 34, 15);
+
+    /* post trigger runs over buffer end */
+    daq_pos_post_scope(&p, 30, 2, 36, 3, 10, 50);
+    CHECK_POS(p, 15, 32, 11, 15);
+
+    /* trigger on last item of buffer */
+    daq_pos_post_scope(&p, 33, 2, 36, 3, 10, 20);
+    CHECK_POS(p, 27, 35, 23, 24);
+
+    /* pre trigger reaches before buffer start */
+    daq_pos_post_scope(&p, 3, 0, 36, 3, 10, 80);
+    CHECK_POS(p, 13, 3, 9, 6);
+
+    /* LA, 1 byte per sample, 20 mem + 4 reserve */
+    daq_pos_post_la(&p, 2, 24, 20, 50);
+    CHECK_POS(p, 17, 2, 12, 10);
+
+    daq_pos_post_la(&p, 20, 24, 20, 25);
+    CHECK_POS(p, 16, 20, 11, 15);
+
+    /* auto trigger, last whole frame before catched */
+    daq_pos_now_scope(&p, 4, 36, 3, 10);
+    CHECK_POS(p, 9, 0, 0, 0);
+
+    daq_pos_now_scope(&p, 2, 36, 3, 10);
+    CHECK_POS(p, 6, 0, 33, 0);
+
+    daq_pos_now_la(&p, 5, 24, 20);
+    CHECK_POS(p, 10, 0, 5, 0);
+}
+
+/* every trigger position, order and pretrigger of common layouts */
+static void test_sweep(void)
+{
+    const int pretrig[] = { 0, 1, 10, 33, 50, 90, 99, 100 };
+
+    for (int chans = 1; chans <= 4; chans++)
+    {
+        for (int mem = 1; mem <= 40; mem += 13)
+        {
+            for (int reserve = 0; reserve <= 3; reserve += 3)
+            {
+                int len = chans * (mem + reserve + 1);
+
+                for (unsigned k = 0; k < sizeof(pretrig) / sizeof(pretrig[0]); k++)
+                {
+                    int post = daq_pos_post_frames(mem, pretrig[k]);
+
+                    for (int from = 0; from < len; from += chans)
+                    {
+                        for (int order = 0; order < chans; order++)
+                        {
+                            daq_pos_t p;
+                            daq_pos_post_scope(&p, from, order, len, chans, mem, pretrig[k]);
+
+                            CHECK(in_buff(&p, len), "scope out of buffer: len %d from %d order %d", len, from, order);
+                            CHECK(p.trig == mod(from + order, len), "scope trig");
+                            CHECK(p.post == post * chans, "scope post");
+                            CHECK(p.last == mod(from + order + post * chans, len), "scope last");
+                            CHECK(p.frst == mod(from + order - (mem - post + 1) * chans + 1, len), "scope frst");
+                            CHECK(daq_pos_dist(p.trig, p.last, len) == mod(p.post, len), "scope trig -> last");
+                        }
+
+                        if (chans == 1)
+                        {
+                            daq_pos_t p;
+                            daq_pos_post_la(&p, from, len, mem, pretrig[k]);
+
+                            CHECK(in_buff(&p, len), "la out of buffer: len %d from %d", len, from);
+                            CHECK(p.trig == from && p.post == post, "la trig / post");
+                            CHECK(p.last == mod(from + post, len), "la last");
+                            CHECK(daq_pos_dist(p.frst, p.last, len) == mem - 1, "la frst -> last is mem");
+                        }
+                    }
+                }
+
+                for (int catched = 0; catched < len; catched++)
+                {
+                    daq_pos_t p;
+                    daq_pos_now_scope(&p, catched, len, chans, mem);
+
+                    CHECK(in_buff(&p, len), "now scope out of buffer: len %d catched %d", len, catched);
+                    CHECK(p.last % chans == 0, "now scope last not frame aligned");
+                    CHECK(p.last == mod(catched - (catched % chans) - chans, len), "now scope last");
+                    CHECK(daq_pos_dist(p.frst, p.last, len) == chans * (mem - 1), "now scope frst -> last is mem");
+
+                    if (chans == 1)
+                    {
+                        daq_pos_now_la(&p, catched, len, mem);
+
+                        CHECK(in_buff(&p, len), "now la out of buffer: len %d catched %d", len, catched);
+                        CHECK(p.last == catched, "now la last");
+                        CHECK(daq_pos_dist(p.frst, p.last, len) == mem - 1, "now la frst -> last is mem");
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    test_basic();
+    test_fixed();
+    test_sweep();
+
+    if (fails > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", fails);
+        return 1;
+    }
+    printf("test_daq_pos: OK\n");
+    return 0;
+}
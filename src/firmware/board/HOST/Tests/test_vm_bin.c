@@ -0,0 +1,263 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* VM:READ:BIN? against running simulator: block framing, header, decode to volts and lost records after overrun */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/wait.h>
+
+
+#define VM_MEM          100     // cfg.h EM_VM_MEM
+#define VM_BIN_MAX      25      // cfg.h EM_VM_BIN_MAX
+#define VM_HDR_LEN      12
+#define VM_REC_LEN      10
+#define RX_MAX          4096
+
+typedef struct
+{
+    uint32_t vcc_k;
+    int adc_max;
+    int count;
+    int lost;
+    int chans;
+    double vcc[VM_BIN_MAX];
+    double ch[VM_BIN_MAX][4];
+}vm_bin_t;
+
+static int fails = 0;
+static pid_t sim = -1;
+static char link_path[64];
+
+#define CHECK(cond, ...) do { if (!(cond)) { fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+                                             fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); fails++; } } while (0)
+
+static uint16_t rd16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static uint32_t rd32(const uint8_t* p) { return rd16(p) | ((uint32_t)rd16(p + 2) << 16); }
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* sends command, reads one response: text line or arbitrary block #<n><len><data> followed by \r\n */
+static int query(int fd, const char* cmd, uint8_t* rx)
+{
+    char tx[64];
+    int len = snprintf(tx, sizeof(tx), "%s\r\n", cmd);
+    if (write(fd, tx, len) != len)
+        return -1;
+
+    int got = 0;
+    int need = -1;
+    double t0 = now_ms();
+
+    while (now_ms() - t0 < 2000)
+    {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, 10) <= 0)
+            continue;
+
+        int n = read(fd, rx + got, RX_MAX - got);
+        if (n <= 0)
+            continue;
+        got += n;
+
+        if (need < 0 && rx[0] == '#' && got >= 2)
+        {
+            int digits = rx[1] - '0';
+            if (got >= 2 + digits)
+            {
+                char num[10] = {0};
+                memcpy(num, rx + 2, digits);
+                need = 2 + digits + atoi(num) + 2;
+            }
+        }
+        if (need > 0 && got >= need)
+            return got;
+        if (rx[0] != '#' && got >= 2 && rx[got - 2] == '\r' && rx[got - 1] == '\n')
+            return got;
+        if (got >= RX_MAX)
+            return -1;
+    }
+    return -1;
+}
+
+/* framing and decode the same way as app (utils.cpp get_vm_from_bin) */
+static int read_bin(int fd, vm_bin_t* vm)
+{
+    uint8_t rx[RX_MAX];
+    int got = query(fd, "VM:READ:BIN?", rx);
+
+    CHECK(got > 2 && rx[0] == '#', "no block");
+    if (got <= 2 || rx[0] != '#')
+        return -1;
+
+    int digits = rx[1] - '0';
+    char num[10] = {0};
+    memcpy(num, rx + 2, digits);
+    int len = atoi(num);
+    const uint8_t* p = rx + 2 + digits;
+
+    CHECK(digits >= 1 && digits <= 4, "block digits %d", digits);
+    CHECK(got == 2 + digits + len + 2, "block length %d, got %d", len, got);
+    CHECK(p[len] == '\r' && p[len + 1] == '\n', "block not terminated");
+    CHECK(len >= VM_HDR_LEN, "block shorter than header");
+    if (len < VM_HDR_LEN)
+        return -1;
+
+    vm->vcc_k = rd32(p);
+    vm->adc_max = rd16(p + 4);
+    vm->count = rd16(p + 6);
+    vm->lost = rd16(p + 8);
+    vm->chans = rd16(p + 10);
+
+    CHECK(len == VM_HDR_LEN + vm->count * VM_REC_LEN, "len %d for %d records", len, vm->count);
+    CHECK(vm->count <= VM_BIN_MAX, "count %d", vm->count);
+    CHECK(vm->adc_max == 4095, "adc max %d", vm->adc_max);
+    CHECK(vm->chans == 2 || vm->chans == 4, "chans %d", vm->chans);
+    if (vm->count > VM_BIN_MAX)
+        return -1;
+
+    p += VM_HDR_LEN;
+
+    for (int i = 0; i < vm->count; i++, p += VM_REC_LEN)
+    {
+        uint16_t vref = rd16(p);
+        CHECK(vref > 0, "record %d vref 0", i);
+        vm->vcc[i] = vref > 0 ? vm->vcc_k / 1000.0 / vref : 0;
+
+        for (int c = 0; c < 4; c++)
+        {
+            vm->ch[i][c] = rd16(p + 2 + c * 2) * vm->vcc[i] / vm->adc_max;
+            CHECK(vm->ch[i][c] >= 0 && vm->ch[i][c] <= vm->vcc[i], "record %d ch%d %f V", i, c + 1, vm->ch[i][c]);
+        }
+        CHECK(vm->vcc[i] > 2.5 && vm->vcc[i] < 4.0, "record %d vcc %f V", i, vm->vcc[i]);
+    }
+    return vm->count;
+}
+
+/* reads until less than full block, returns records drained */
+static int drain(int fd, int* lost)
+{
+    vm_bin_t vm;
+    int total = 0;
+    *lost = 0;
+
+    for (int it = 0; it < 20; it++)
+    {
+        int n = read_bin(fd, &vm);
+        if (n < 0)
+            return -1;
+        total += n;
+        *lost += vm.lost;
+        if (n < VM_BIN_MAX)
+            break;
+    }
+    return total;
+}
+
+static int sim_start(const char* exe)
+{
+    snprintf(link_path, sizeof(link_path), "/tmp/embo-test-vm-%d", (int)getpid());
+
+    sim = fork();
+    if (sim == 0)
+    {
+        execl(exe, exe, "-f", link_path, (char*)NULL);
+        perror(exe);
+        _exit(127);
+    }
+    if (sim < 0)
+        return -1;
+
+    for (int it = 0; it < 200; it++) // wait for pty link
+    {
+        int fd = open(link_path, O_RDWR | O_NOCTTY);
+        if (fd >= 0)
+        {
+            struct termios tio;
+            tcgetattr(fd, &tio);
+            cfmakeraw(&tio);
+            tcsetattr(fd, TCSANOW, &tio);
+            return fd;
+        }
+        usleep(10000);
+    }
+    return -1;
+}
+
+static void sim_stop(void)
+{
+    if (sim > 0)
+    {
+        kill(sim, SIGTERM);
+        waitpid(sim, NULL, 0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s embo_host\n", argv[0]);
+        return 2;
+    }
+
+    int fd = sim_start(argv[1]);
+    if (fd < 0)
+    {
+        fprintf(stderr, "simulator did not start\n");
+        sim_stop();
+        return 1;
+    }
+
+    uint8_t rx[RX_MAX];
+    vm_bin_t vm;
+    int lost;
+
+    int got = query(fd, "SYS:MODE VM", rx);
+    CHECK(got > 0 && memcmp(rx, "\"OK\"", 4) == 0, "SYS:MODE VM");
+
+    /* first call starts sequence with last record only */
+    usleep(100000);
+    CHECK(read_bin(fd, &vm) == 1, "first read count %d", vm.count);
+    CHECK(vm.lost == 0, "first read lost %d", vm.lost);
+
+    /* ~30 records pending: full block, rest in next call, nothing lost */
+    usleep(300000);
+    int n = drain(fd, &lost);
+    CHECK(n > VM_BIN_MAX && n < VM_MEM, "drained %d after 300 ms", n);
+    CHECK(lost == 0, "lost %d after 300 ms", lost);
+
+    /* overrun: newest mem records survive, all of them must come out, older ones reported lost */
+    usleep(1500000);
+    n = drain(fd, &lost);
+    CHECK(n >= VM_MEM && n < VM_MEM + VM_BIN_MAX, "drained %d after overrun", n);
+    CHECK(lost > 0 && lost < 150, "lost %d after overrun", lost);
+
+    close(fd);
+    sim_stop();
+
+    if (fails > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", fails);
+        return 1;
+    }
+    printf("test_vm_bin: OK\n");
+    return 0;
+}
@@ -27,6 +27,7 @@
 #include "usbd_cdc.h"
 
 /* USER CODE BEGIN Includes */
+#include "usbd_cdc_if.h"
 
 /* USER CODE END Includes */
 
@@ -147,6 +148,11 @@ void HAL_PCD_DataInStageCallback(PCD_HandleTypeDef *hpcd, uint8_t epnum)
 #endif /* USE_HAL_PCD_REGISTER_CALLBACKS */
 {
   USBD_LL_DataInStage((USBD_HandleTypeDef*)hpcd->pData, epnum, hpcd->IN_ep[epnum].xfer_buff);
+
+  /* USER CODE BEGIN DataInStage */
+  if (epnum == (CDC_IN_EP & 0x7F) && CDC_Busy() == 0) // this CDC version has no TransmitCplt, TxState is 0 after ZLP
+    comm_usb_tx_cplt();
+  /* USER CODE END DataInStage */
 }
 
 /**
@@ -296,29 +296,21 @@ static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
   }
   while(result != USBD_OK);
 
-  if (em_comm.uart.available == EM_FALSE && em_comm.usb.available == EM_FALSE)
+  uint8_t line = EM_FALSE;
+  while (len--) // queued even while previous line is processed
   {
-      while (len--)
-      {
-         em_comm.usb.rx_buffer[em_comm.usb.rx_index++] = *Buf;
-
-         if (em_comm.usb.rx_index >= RX_BUFF_LAST)
-             em_comm.usb.rx_index = 0;
-
-         em_comm.uart.last = EM_FALSE;
-         em_comm.usb.last = EM_TRUE;
-
-         if (*Buf == '\n' && em_comm.usb.rx_index > 1 && em_comm.usb.rx_buffer[em_comm.usb.rx_index - 2] == '\r')
-         {
-             em_comm.usb.available = EM_TRUE;
-             exit = -1;
-
-             portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-             ASSERT(xSemaphoreGiveFromISR(sem1_comm, &xHigherPriorityTaskWoken) == pdPASS);
-             portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
-         }
-         Buf++;
-      }
+      if (comm_rx_put(&em_comm.usb, *Buf) == EM_TRUE)
+          line = EM_TRUE;
+      Buf++;
+  }
+
+  if (line == EM_TRUE)
+  {
+      exit = -1;
+
+      portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+      xSemaphoreGiveFromISR(sem1_comm, &xHigherPriorityTaskWoken); // may be given already, comm task takes all lines
+      portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
   }
 
   ret = USBD_OK;
@@ -374,6 +366,7 @@ static int8_t CDC_TransmitCplt_FS(uint8_t *Buf, uint32_t *Len, uint8_t epnum)
   UNUSED(Buf);
   UNUSED(Len);
   UNUSED(epnum);
+  comm_usb_tx_cplt(); // start next queued transfer
   /* USER CODE END 13 */
   return result;
 }
@@ -79,11 +79,22 @@ void app_main(void)
     sem1_comm = xSemaphoreCreateBinaryStatic(&buff_sem1_comm);
     sem2_trig = xSemaphoreCreateBinaryStatic(&buff_sem2_trig);
     sem3_cntr = xSemaphoreCreateBinaryStatic(&buff_sem3_cntr);
+    sem4_uart = xSemaphoreCreateBinaryStatic(&buff_sem4_uart);
+#ifdef EM_USB
+    sem5_usb = xSemaphoreCreateCountingStatic(USB_TX_QUEUE_LEN, USB_TX_QUEUE_LEN, &buff_sem5_usb);
+#endif
+    sem6_post = xSemaphoreCreateBinaryStatic(&buff_sem6_post);
     mtx1 = xSemaphoreCreateMutexStatic(&buff_mtx1);
 
     ASSERT(sem1_comm != NULL);
     ASSERT(sem2_trig != NULL);
     ASSERT(sem3_cntr != NULL);
+    ASSERT(sem4_uart != NULL);
+    ASSERT(xSemaphoreGive(sem4_uart) == pdPASS); // UART TX idle
+#ifdef EM_USB
+    ASSERT(sem5_usb != NULL);
+#endif
+    ASSERT(sem6_post != NULL);
     ASSERT(mtx1 != NULL);
 
     /* Tasks */
@@ -116,6 +127,15 @@ void t1_wd(void* p)
             led_blink_do(&em_led, em_daq.uwTick); // blink led optionaly
         #endif
 
+        /* new UART baud not confirmed by host, back to default */
+        if (em_comm.baud.verify_tick != 0 && em_daq.uwTick - em_comm.baud.verify_tick > UART_BAUD_VERIFY_MS &&
+            em_comm.uart.available == EM_FALSE && xSemaphoreTake(mtx1, 0) == pdPASS)
+        {
+            comm_baud_set(&em_comm, EM_UART_BAUD);
+            em_comm.baud.verify_tick = 0;
+            ASSERT(xSemaphoreGive(mtx1) == pdPASS);
+        }
+
         vTaskDelay(10);
 
         #ifdef EM_DEBUG
@@ -159,11 +179,8 @@ void t3_trig_post_count(void* p)
     while(1)
     {
         ASSERT(xSemaphoreTake(sem2_trig, portMAX_DELAY) == pdPASS);
-        ASSERT(xSemaphoreTake(mtx1, portMAX_DELAY) == pdPASS);
-
-        daq_trig_postcount(&em_daq); // count post-trigger and send Ready
 
-        ASSERT(xSemaphoreGive(mtx1) == pdPASS);
+        daq_trig_postcount(&em_daq); // count post-trigger and send Ready, takes mtx1 only to finish
 
         #ifdef EM_DEBUG
             watermark_t3 = uxTaskGetStackHighWaterMark(NULL);
@@ -226,6 +243,9 @@ void t4_comm_and_init(void* p)
 
         ASSERT(xSemaphoreGive(mtx1) == pdPASS);
 
+        if (comm_pending(&em_comm) == EM_TRUE) // pipelined host, next line already queued
+            xSemaphoreGive(sem1_comm);
+
         #ifdef EM_DEBUG
             watermark_t4 = uxTaskGetStackHighWaterMark(NULL);
         #endif
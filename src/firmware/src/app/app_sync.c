@@ -8,9 +8,15 @@
 StaticSemaphore_t buff_sem1_comm;
 StaticSemaphore_t buff_sem2_trig;
 StaticSemaphore_t buff_sem3_cntr;
+StaticSemaphore_t buff_sem4_uart;
+StaticSemaphore_t buff_sem5_usb;
+StaticSemaphore_t buff_sem6_post;
 StaticSemaphore_t buff_mtx1;
 
 SemaphoreHandle_t sem1_comm;
 SemaphoreHandle_t sem2_trig;
 SemaphoreHandle_t sem3_cntr;
+SemaphoreHandle_t sem4_uart;
+SemaphoreHandle_t sem5_usb;
+SemaphoreHandle_t sem6_post;
 SemaphoreHandle_t mtx1;
\ No newline at end of file
@@ -15,11 +15,17 @@
 extern StaticSemaphore_t buff_sem1_comm; // comm respond init
 extern StaticSemaphore_t buff_sem2_trig; // post trig count init
 extern StaticSemaphore_t buff_sem3_cntr; // counter enable
+extern StaticSemaphore_t buff_sem4_uart; // uart tx dma done
+extern StaticSemaphore_t buff_sem5_usb;  // usb tx queue slots
+extern StaticSemaphore_t buff_sem6_post; // post trig abort
 extern StaticSemaphore_t buff_mtx1;      // mutex for comm and trig
 
 extern SemaphoreHandle_t sem1_comm;      // semaphore - communication processing respond
 extern SemaphoreHandle_t sem2_trig;      // semaphore - trigger process
 extern SemaphoreHandle_t sem3_cntr;      // semaphore - counter enable/disable
+extern SemaphoreHandle_t sem4_uart;      // semaphore - UART TX DMA idle
+extern SemaphoreHandle_t sem5_usb;       // semaphore - USB TX queue free slots (counting)
+extern SemaphoreHandle_t sem6_post;      // semaphore - post trigger wait abort
 extern SemaphoreHandle_t mtx1;           // mutex - critical section for SCPI output
 
 #endif /* INC_APP_SYNC_H_ */
@@ -6,6 +6,9 @@
 #include "cfg.h"
 #include "comm.h"
 #include "comm_proto.h"
+#include "app_data.h"
+#include "app_sync.h"
+#include "periph/periph_dma.h"
 #include "util.h"
 #include "build_defs.h"
 
@@ -23,11 +26,25 @@
 
 #define SCPI_INPUT_BUFFER_LENGTH    RX_BUFF_LEN
 #define SCPI_ERROR_QUEUE_SIZE       1
+#define UART_TX_COPY_MAX            160     // responds outside DAQ buffer are copied in chunks, they may live on caller stack
+#define USB_TX_COPY_MAX             64      // same for USB, copied into pool
+#define USB_TX_CHUNK_MAX            4096    // one CDC transfer, multiple of 64 B packet
+#define USB_TX_TIMEOUT_MS           100     // host not reading, drop queue
 
 
 // respond
-static void uart_put_str(const char* data, int len);
 static void uart_put_char(const char data);
+#ifdef EM_UART_TX_DMA
+static void uart_tx_dma(const char* data, int len);
+#else
+static void uart_put_str(const char* data, int len);
+#endif
+#ifdef EM_USB
+static void usb_tx_put(const char* data, int len);
+static void usb_tx_start(void);
+static void usb_tx_flush(void);
+static void usb_tx_reset(void);
+#endif
 
 
 // scpi core
@@ -66,15 +83,30 @@ const scpi_command_t scpi_commands[] = {
     {.pattern = "SYStem:LIMits?", .callback = EM_SYS_LimitsQ,},
     {.pattern = "SYStem:INFO?", .callback = EM_SYS_InfoQ,},
     {.pattern = "SYStem:UPTime?", .callback = EM_SYS_UptimeQ,},
+    {.pattern = "SYStem:TPUT?", .callback = EM_SYS_TputQ,},
+    {.pattern = "SYStem:BAUD?", .callback = EM_SYS_BaudQ,},
+    {.pattern = "SYStem:BAUD", .callback = EM_SYS_Baud,},
+    {.pattern = "SYStem:SEQ?", .callback = EM_SYS_SeqQ,},
 
     /* EMBO - Voltmeter */
     {.pattern = "VM:READ?", .callback = EM_VM_ReadQ,},
+    {.pattern = "VM:READ:BIN?", .callback = EM_VM_ReadBinQ,},
+    {.pattern = "VM:LOG:READ?", .callback = EM_VM_LogReadQ,},
+    {.pattern = "VM:LOG?", .callback = EM_VM_LogQ,},
+    {.pattern = "VM:LOG", .callback = EM_VM_Log,},
 
     /* EMBO - Scope */
     {.pattern = "SCOPe:READ?", .callback = EM_SCOPE_ReadQ,},
     {.pattern = "SCOPe:SET?", .callback = EM_SCOPE_SetQ,},
     {.pattern = "SCOPe:SET", .callback = EM_SCOPE_Set,},
     {.pattern = "SCOPe:FORCetrig", .callback = EM_SCOPE_ForceTrig,},
+    {.pattern = "SCOPe:DBUF", .callback = EM_SCOPE_DBuf,},
+    {.pattern = "SCOPe:ROLL:READ?", .callback = EM_SCOPE_RollReadQ,},
+    {.pattern = "SCOPe:ROLL?", .callback = EM_SCOPE_RollQ,},
+    {.pattern = "SCOPe:ROLL", .callback = EM_SCOPE_Roll,},
+    {.pattern = "SCOPe:SEGment:READ?", .callback = EM_SCOPE_SegReadQ,},
+    {.pattern = "SCOPe:SEGment?", .callback = EM_SCOPE_SegQ,},
+    {.pattern = "SCOPe:SEGment", .callback = EM_SCOPE_Seg,},
 
     /* EMBO - Logic Analyzer */
     {.pattern = "LA:READ?", .callback = EM_LA_ReadQ,},
@@ -111,6 +143,26 @@ char scpi_input_buffer[SCPI_INPUT_BUFFER_LENGTH];
 scpi_error_t scpi_error_queue_data[SCPI_ERROR_QUEUE_SIZE];
 scpi_t scpi_context;
 
+#ifdef EM_UART_TX_DMA
+static char uart_tx_buff[UART_TX_COPY_MAX];
+#endif
+
+#ifdef EM_USB
+typedef struct
+{
+    const uint8_t* data;
+    uint16_t len;
+}usb_tx_item_t;
+
+/* ring of pending transfers, head is written by task, tail (in flight) is popped by USB IRQ */
+static usb_tx_item_t usb_tx_queue[USB_TX_QUEUE_LEN];
+static volatile uint8_t usb_tx_head = 0;
+static volatile uint8_t usb_tx_tail = 0;
+static volatile uint8_t usb_tx_busy = EM_FALSE;
+static uint8_t usb_tx_pool[USB_TX_POOL_LEN];
+static int usb_tx_pool_pos = 0;
+#endif
+
 
 /************************* SCPI Core *************************/
 
@@ -183,6 +235,15 @@ scpi_result_t SCPI_CoreIdnQ(scpi_t * context)
 
 /************************* Write Respond *************************/
 
+#if defined(EM_UART_TX_DMA) || defined(EM_USB)
+/* only DAQ buffer outlives the call, anything else may be on caller stack */
+static uint8_t comm_tx_in_daq(const char* data, int len)
+{
+    const uint8_t* ptr = (const uint8_t*)data;
+    return (ptr >= em_daq.buff_raw && ptr + len <= em_daq.buff_raw + sizeof(em_daq.buff_raw)) ? EM_TRUE : EM_FALSE;
+}
+#endif
+
 void uart_put_text(const char* data)
 {
     for (int i = 0; i < strlen(data); i++)
@@ -195,11 +256,209 @@ static void uart_put_char(const char data)
     LL_USART_TransmitData8(EM_UART, data);
 }
 
+#ifndef EM_UART_TX_DMA
 static void uart_put_str(const char* data, int len)
 {
     for (int i = 0; i < len; i++)
         uart_put_char(data[i]);
 }
+#endif
+
+#ifdef EM_UART_TX_DMA
+/* starts DMA transfer and returns, sem4_uart is given back by TC interrupt */
+static void uart_tx_dma(const char* data, int len)
+{
+    if (len <= 0)
+        return;
+
+    // DAQ buffers are sent zero-copy, comm_flush before they change
+    uint8_t zero_copy = comm_tx_in_daq(data, len);
+
+    while (len > 0)
+    {
+        int chunk = (zero_copy || len <= UART_TX_COPY_MAX) ? len : UART_TX_COPY_MAX;
+        const char* ptr = data;
+
+        ASSERT(xSemaphoreTake(sem4_uart, portMAX_DELAY) == pdPASS); // previous transfer done
+        comm_tput_begin(comm_ptr);
+
+        if (!zero_copy)
+        {
+            memcpy(uart_tx_buff, data, chunk);
+            ptr = uart_tx_buff;
+        }
+
+        dma_set((uint32_t)ptr, EM_DMA_UART_TX, EM_DMA_CH_UART_TX, EM_UART_TX_ADDR, chunk,
+                LL_DMA_PDATAALIGN_BYTE, LL_DMA_MDATAALIGN_BYTE, LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+
+        data += chunk;
+        len -= chunk;
+    }
+}
+#endif
+
+#ifdef EM_USB
+/* queues data and returns, transfer runs from USB IRQ, task blocks only if queue is full */
+static void usb_tx_put(const char* data, int len)
+{
+    while (len > 0)
+    {
+        uint8_t zero_copy = comm_tx_in_daq(data, len);
+        int chunk = len > USB_TX_CHUNK_MAX ? USB_TX_CHUNK_MAX : len;
+        const uint8_t* ptr = (const uint8_t*)data;
+
+        if (!zero_copy && chunk > USB_TX_COPY_MAX)
+            chunk = USB_TX_COPY_MAX;
+
+        if (!zero_copy)
+        {
+            if (usb_tx_pool_pos + chunk > USB_TX_POOL_LEN) // pool full, wait until all out and start over
+                usb_tx_flush();
+
+            ptr = usb_tx_pool + usb_tx_pool_pos;
+            memcpy((uint8_t*)ptr, data, chunk);
+            usb_tx_pool_pos += chunk;
+
+            /* append to last queued item if it is contiguous and not in flight yet */
+            uint8_t merged = EM_FALSE;
+            taskENTER_CRITICAL();
+            if (usb_tx_head != usb_tx_tail)
+            {
+                uint8_t last = (usb_tx_head + USB_TX_QUEUE_LEN - 1) % USB_TX_QUEUE_LEN;
+                usb_tx_item_t* it = &usb_tx_queue[last];
+
+                if (!(usb_tx_busy && last == usb_tx_tail) && it->data + it->len == ptr &&
+                    it->len + chunk <= USB_TX_CHUNK_MAX)
+                {
+                    it->len += chunk;
+                    merged = EM_TRUE;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            if (merged)
+            {
+                data += chunk;
+                len -= chunk;
+                continue;
+            }
+        }
+        // DAQ buffers are sent zero-copy, comm_flush before they change
+
+        if (xSemaphoreTake(sem5_usb, USB_TX_TIMEOUT_MS / portTICK_PERIOD_MS) != pdPASS)
+        {
+            usb_tx_reset(); // host stopped reading
+            return;
+        }
+
+        taskENTER_CRITICAL();
+        usb_tx_queue[usb_tx_head].data = ptr;
+        usb_tx_queue[usb_tx_head].len = chunk;
+        usb_tx_head = (usb_tx_head + 1) % USB_TX_QUEUE_LEN;
+        if (!usb_tx_busy)
+            usb_tx_start();
+        taskEXIT_CRITICAL();
+
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+/* called with USB IRQ masked, from task critical section or from the IRQ itself */
+static void usb_tx_start(void)
+{
+    if (usb_tx_head == usb_tx_tail)
+        return;
+
+    if (!usb_tx_busy)
+        comm_tput_begin(comm_ptr);
+
+    usb_tx_busy = EM_TRUE;
+
+    if (CDC_Transmit_FS((uint8_t*)usb_tx_queue[usb_tx_tail].data, usb_tx_queue[usb_tx_tail].len) != USBD_OK)
+    {
+        usb_tx_busy = EM_FALSE; // not connected, next put retries
+        comm_tput_end(comm_ptr);
+    }
+}
+
+/* USB CDC IN transfer complete (incl. ZLP), called from USB IRQ */
+void comm_usb_tx_cplt(void)
+{
+    if (!usb_tx_busy)
+        return;
+
+    usb_tx_tail = (usb_tx_tail + 1) % USB_TX_QUEUE_LEN;
+
+    portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(sem5_usb, &xHigherPriorityTaskWoken);
+
+    if (usb_tx_head == usb_tx_tail)
+    {
+        usb_tx_busy = EM_FALSE;
+        comm_tput_end(comm_ptr);
+    }
+    else
+        usb_tx_start(); // next one right away, no gap between transfers
+
+    portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+}
+
+/* waits until whole queue is out */
+static void usb_tx_flush(void)
+{
+    int i;
+
+    for (i = 0; i < USB_TX_QUEUE_LEN; i++)
+    {
+        if (xSemaphoreTake(sem5_usb, USB_TX_TIMEOUT_MS / portTICK_PERIOD_MS) != pdPASS)
+            break;
+    }
+
+    if (i < USB_TX_QUEUE_LEN)
+    {
+        usb_tx_reset();
+        return;
+    }
+
+    for (i = 0; i < USB_TX_QUEUE_LEN; i++)
+        xSemaphoreGive(sem5_usb);
+
+    usb_tx_pool_pos = 0;
+}
+
+/* drops pending data, all slots free again */
+static void usb_tx_reset(void)
+{
+    taskENTER_CRITICAL();
+    usb_tx_head = 0;
+    usb_tx_tail = 0;
+    if (usb_tx_busy)
+        comm_tput_end(comm_ptr);
+    usb_tx_busy = EM_FALSE;
+    while (uxSemaphoreGetCount(sem5_usb) < USB_TX_QUEUE_LEN)
+        xSemaphoreGive(sem5_usb);
+    taskEXIT_CRITICAL();
+
+    usb_tx_pool_pos = 0;
+}
+#endif
+
+/************************* Throughput *************************/
+
+void comm_tput_begin(comm_data_t* self)
+{
+    self->tput.start_us = daq_time_us(&em_daq);
+}
+
+void comm_tput_end(comm_data_t* self)
+{
+    if (self->tput.start_us == 0)
+        return;
+
+    self->tput.busy_us += daq_time_us(&em_daq) - self->tput.start_us;
+    self->tput.start_us = 0;
+}
 
 /************************* Write Async Msg *************************/
 
@@ -226,12 +485,14 @@ void comm_daq_ready(comm_data_t* self, const char* rdy, uint32_t pos_frst)
 
 void comm_init(comm_data_t* self)
 {
-    self->uart.last = 0;
-    self->uart.available = 0;
-    self->uart.rx_index = 0;
-    self->usb.last = 0;
-    self->usb.available = 0;
-    self->usb.rx_index = 0;
+    memset(&self->uart, 0, sizeof(comm_ch_t));
+    memset(&self->usb, 0, sizeof(comm_ch_t));
+    self->tput.bytes = 0;
+    self->tput.busy_us = 0;
+    self->tput.start_us = 0;
+    self->baud.now = EM_UART_BAUD;
+    self->baud.pending = 0;
+    self->baud.verify_tick = 0;
     comm_ptr = self;
 
     SCPI_Init(&scpi_context,
@@ -251,25 +512,93 @@ void comm_init(comm_data_t* self)
 
     LL_USART_EnableIT_RXNE(EM_UART);
 
+#ifdef EM_UART_TX_DMA
+    LL_DMA_SetDataTransferDirection(EM_DMA_UART_TX, EM_DMA_CH_UART_TX, LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+    LL_DMA_SetMode(EM_DMA_UART_TX, EM_DMA_CH_UART_TX, LL_DMA_MODE_NORMAL);
+    LL_DMA_SetPeriphIncMode(EM_DMA_UART_TX, EM_DMA_CH_UART_TX, LL_DMA_PERIPH_NOINCREMENT);
+    LL_DMA_SetMemoryIncMode(EM_DMA_UART_TX, EM_DMA_CH_UART_TX, LL_DMA_MEMORY_INCREMENT);
+    LL_DMA_SetChannelPriorityLevel(EM_DMA_UART_TX, EM_DMA_CH_UART_TX, LL_DMA_PRIORITY_LOW);
+  #ifdef EM_DMA_UART_TX_REQ
+    LL_DMA_SetPeriphRequest(EM_DMA_UART_TX, EM_DMA_CH_UART_TX, EM_DMA_UART_TX_REQ);
+  #endif
+    LL_DMA_EnableIT_TC(EM_DMA_UART_TX, EM_DMA_CH_UART_TX);
+    LL_USART_EnableDMAReq_TX(EM_UART);
+
+    NVIC_SetPriority(EM_IRQN_UART_TX, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), EM_IT_PRI_UART, 0));
+    NVIC_EnableIRQ(EM_IRQN_UART_TX);
+#endif
+
     //uart_put_text(WELCOME_STR);
 
     NVIC_SetPriority(EM_IRQN_UART, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), EM_IT_PRI_UART, 0));
     NVIC_EnableIRQ(EM_IRQN_UART);
 }
 
+/* oldest complete line from FIFO to rx_buffer, too long line is cut but still ends with newline */
+static uint8_t comm_rx_take(comm_ch_t* ch)
+{
+    if (ch->lines_in == ch->lines_out)
+        return EM_FALSE;
+
+    uint8_t tail = ch->fifo_tail;
+    int len = 0;
+    char prev = 0;
+    char c = 0;
+
+    do
+    {
+        prev = c;
+        c = ch->rx_fifo[tail++];
+
+        if (len < RX_BUFF_LEN - 3)
+            ch->rx_buffer[len++] = c;
+    }
+    while (prev != '\r' || c != '\n');
+
+    if (ch->rx_buffer[len - 1] != '\n')
+    {
+        ch->rx_buffer[len++] = '\r';
+        ch->rx_buffer[len++] = '\n';
+    }
+    ch->rx_buffer[len] = '\0';
+
+    ch->rx_index = len;
+    ch->fifo_tail = tail; // bytes free for IRQ only now
+    ch->lines_out++;
+    ch->available = EM_TRUE;
+    return EM_TRUE;
+}
+
+/* one line per call, UART first, rest stays queued - see comm_pending */
 uint8_t comm_main(comm_data_t* self)
 {
-    if (self->uart.available == EM_TRUE)
+    comm_flush(self); // last respond must be out before new command touches buffers
+
+    if (comm_rx_take(&self->uart) == EM_TRUE)
     {
+        self->uart.last = EM_TRUE;
+        self->usb.last = EM_FALSE;
+        self->baud.verify_tick = 0; // command readable, current baud confirmed
+
         SCPI_Input(&scpi_context, self->uart.rx_buffer, self->uart.rx_index);
 
         memset(self->uart.rx_buffer, '\0', RX_BUFF_LEN * sizeof(char));
         self->uart.rx_index = 0;
+
+        if (self->baud.pending != 0) // SYS:BAUD respond went out with old baud
+        {
+            comm_baud_set(self, self->baud.pending);
+            self->baud.verify_tick = self->baud.now != EM_UART_BAUD ? em_daq.uwTick : 0;
+            self->baud.pending = 0;
+        }
         return EM_TRUE;
     }
 #ifdef EM_USB
-    else if (self->usb.available == EM_TRUE)
+    else if (comm_rx_take(&self->usb) == EM_TRUE)
     {
+        self->uart.last = EM_FALSE;
+        self->usb.last = EM_TRUE;
+
         SCPI_Input(&scpi_context, self->usb.rx_buffer, self->usb.rx_index);
 
         memset(self->usb.rx_buffer, '\0', RX_BUFF_LEN * sizeof(char));
@@ -280,30 +609,66 @@ uint8_t comm_main(comm_data_t* self)
     return EM_FALSE;
 }
 
+/* complete lines still waiting in FIFO */
+uint8_t comm_pending(comm_data_t* self)
+{
+    return self->uart.lines_in != self->uart.lines_out || self->usb.lines_in != self->usb.lines_out;
+}
+
 int comm_respond(comm_data_t* self, const char* data, int len)
 {
     if (self->uart.last == EM_TRUE)
     {
+        self->tput.bytes += len;
+#ifdef EM_UART_TX_DMA
+        uart_tx_dma(data, len);
+#else
+        comm_tput_begin(self);
         uart_put_str(data, len);
+        comm_tput_end(self);
+#endif
         return len;
     }
 #ifdef EM_USB
     else if (self->usb.last == EM_TRUE)
     {
-        int cntr = 1000000;
-        uint8_t ret = USBD_BUSY;
-
-        while (ret == USBD_BUSY && cntr > 0)
-        {
-            ret = CDC_Transmit_FS((uint8_t *)data, len);
-            cntr--;
-        }
-
-        while (CDC_Busy()) // busy wait for packet sent
-            __asm("nop");
-
+        self->tput.bytes += len;
+        usb_tx_put(data, len);
         return len;
     }
 #endif
     return 0;
 }
+
+/* waits until UART is idle and changes baud, both sides must switch, see SYS:BAUD */
+void comm_baud_set(comm_data_t* self, uint32_t baud)
+{
+    comm_flush(self);
+
+    while (!LL_USART_IsActiveFlag_TC(EM_UART)) // last byte out of shift register
+        __asm("nop");
+
+    LL_USART_Disable(EM_UART); // BRR is writable only when disabled
+    EM_UART_SET_BAUD(EM_UART, baud);
+    LL_USART_Enable(EM_UART);
+
+#ifdef EM_UART_POLLINIT
+    while((!(LL_USART_IsActiveFlag_TEACK(EM_UART))) || (!(LL_USART_IsActiveFlag_REACK(EM_UART))))
+        __asm("nop");
+#endif
+
+    self->baud.now = baud;
+}
+
+void comm_flush(comm_data_t* self)
+{
+    (void) self;
+
+#ifdef EM_UART_TX_DMA
+    ASSERT(xSemaphoreTake(sem4_uart, portMAX_DELAY) == pdPASS); // wait for DMA idle
+    ASSERT(xSemaphoreGive(sem4_uart) == pdPASS);
+#endif
+#ifdef EM_USB
+    usb_tx_flush();
+#endif
+}
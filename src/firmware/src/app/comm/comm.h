@@ -12,10 +12,16 @@
 
 #define RX_BUFF_LEN    200
 #define RX_BUFF_LAST   RX_BUFF_LEN - 1
+#define RX_FIFO_LEN    256      // received lines waiting while previous one is processed, uint8_t indexes wrap at 256
 
 #define APP_RX_DATA_SIZE  RX_BUFF_LEN
 #define APP_TX_DATA_SIZE  1
 
+#define USB_TX_QUEUE_LEN   8        // max queued USB transfers
+#define USB_TX_POOL_LEN    512      // copy pool for short responds
+
+#define UART_BAUD_VERIFY_MS  500    // new baud must be confirmed by a command in time, else back to default
+
 #ifndef EMBO
 #define EM_TRUE                1
 #define EM_FALSE               0
@@ -48,17 +54,41 @@ scpi_result_t SCPI_Flush(scpi_t * context);
 
 typedef struct
 {
-    char rx_buffer[RX_BUFF_LEN];
+    char rx_buffer[RX_BUFF_LEN];    // line being processed
+    char rx_fifo[RX_FIFO_LEN];      // ring of received bytes, IRQ writes, comm task takes whole lines
 
     uint8_t last;
     uint8_t available;
     uint8_t rx_index;
+
+    volatile uint8_t fifo_head;     // IRQ only
+    volatile uint8_t fifo_tail;     // comm task only
+    volatile uint8_t lines_in;      // complete lines received, IRQ only
+    uint8_t lines_out;              // lines taken, comm task only
+    uint8_t rx_cr;                  // last received byte was '\r', IRQ only
+    uint32_t rx_lost;               // bytes dropped on full FIFO
 }comm_ch_t;
 
+typedef struct
+{
+    uint32_t bytes;         // bytes responded
+    uint32_t busy_us;       // time TX was running
+    uint32_t start_us;      // start of current TX, 0 = idle
+}comm_tput_t;
+
+typedef struct
+{
+    uint32_t now;           // current UART baud
+    uint32_t pending;       // switch after respond is out, 0 = none
+    uint32_t verify_tick;   // tick of switch, 0 = confirmed
+}comm_baud_t;
+
 typedef struct
 {
     comm_ch_t usb;
     comm_ch_t uart;
+    comm_tput_t tput;
+    comm_baud_t baud;
 }comm_data_t;
 
 
@@ -66,7 +96,16 @@ comm_data_t* comm_ptr;
 
 void comm_init(comm_data_t* self);
 uint8_t comm_main(comm_data_t* self);
+uint8_t comm_pending(comm_data_t* self);
+uint8_t comm_rx_put(comm_ch_t* ch, char rx);
 int comm_respond(comm_data_t* self, const char* data, int len);
+void comm_flush(comm_data_t* self);
 void comm_daq_ready(comm_data_t* self, const char* rdy, uint32_t pos_frst);
+void comm_baud_set(comm_data_t* self, uint32_t baud);
+void comm_tput_begin(comm_data_t* self);
+void comm_tput_end(comm_data_t* self);
+#ifdef EM_USB
+void comm_usb_tx_cplt(void);
+#endif
 
 #endif
@@ -14,6 +14,31 @@
 #include "semphr.h"
 
 
+/* received byte into channel FIFO, EM_TRUE when it completed a line, called from UART and USB IRQ */
+uint8_t comm_rx_put(comm_ch_t* ch, char rx)
+{
+    uint8_t head = ch->fifo_head;
+
+    if ((uint8_t)(head + 1) == ch->fifo_tail) // full, host sent more than window allows
+    {
+        ch->rx_lost++;
+        return EM_FALSE;
+    }
+
+    ch->rx_fifo[head] = rx;
+    ch->fifo_head = head + 1;
+
+    if (rx == '\n' && ch->rx_cr)
+    {
+        ch->rx_cr = EM_FALSE;
+        ch->lines_in++;
+        return EM_TRUE;
+    }
+
+    ch->rx_cr = (rx == '\r');
+    return EM_FALSE;
+}
+
 /* UART IRQ handler */
 void EM_UART_RX_IRQHandler(void)
 {
@@ -24,38 +49,48 @@ void EM_UART_RX_IRQHandler(void)
     {
         char rx = LL_USART_ReceiveData8(EM_UART);
 
-        if (em_comm.uart.available == EM_FALSE && em_comm.usb.available == EM_FALSE)
-        {
-            em_comm.uart.rx_buffer[em_comm.uart.rx_index++] = rx;
+        #ifdef EM_UART_CLEAR_FLAG
+            EM_UART_CLEAR_FLAG(EM_UART);
+        #endif
 
-            if (em_comm.uart.rx_index >= RX_BUFF_LAST)
-                em_comm.uart.rx_index = 0;
+        /* new message detected, queued even while previous one is processed */
+        if (comm_rx_put(&em_comm.uart, rx) == EM_TRUE)
+        {
+            exit = -1;
 
-            em_comm.uart.last = EM_TRUE;
-            em_comm.usb.last = EM_FALSE;
+            portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+            xSemaphoreGiveFromISR(sem1_comm, &xHigherPriorityTaskWoken); // may be given already, comm task takes all lines
+            portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+        }
+    }
 
-            #ifdef EM_UART_CLEAR_FLAG
-                EM_UART_CLEAR_FLAG(EM_UART);
-            #endif
+    if (exit == 0)
+        traceISR_EXIT();
+}
 
-            /* new message detected */
-            if (rx == '\n' && em_comm.uart.rx_index > 1 && em_comm.uart.rx_buffer[em_comm.uart.rx_index - 2] == '\r')
-            {
-                em_comm.uart.available = EM_TRUE;
-                exit = -1;
+#ifdef EM_UART_TX_DMA
+/* UART TX DMA transfer complete */
+void EM_UART_TX_IRQh(void)
+{
+    traceISR_ENTER();
+    int8_t exit = 0;
 
-                portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-                ASSERT(xSemaphoreGiveFromISR(sem1_comm, &xHigherPriorityTaskWoken) == pdPASS);
-                portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
-            }
-        }
-        //else
-        //    ASSERT(0);
+    if (EM_UART_TX_DMA_TC(EM_DMA_UART_TX) == 1)
+    {
+        EM_UART_TX_DMA_CLR(EM_DMA_UART_TX);
+        LL_DMA_DisableChannel(EM_DMA_UART_TX, EM_DMA_CH_UART_TX);
+        comm_tput_end(&em_comm);
+        exit = -1;
+
+        portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+        ASSERT(xSemaphoreGiveFromISR(sem4_uart, &xHigherPriorityTaskWoken) == pdPASS);
+        portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
     }
 
     if (exit == 0)
         traceISR_EXIT();
 }
+#endif
 
 /*
 static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
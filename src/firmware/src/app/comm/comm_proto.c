@@ -10,6 +10,9 @@
 #include "circ.h"
 
 #include "app_data.h"
+#include "daq/daq_roll.h"
+#include "daq/daq_log.h"
+#include "daq/daq_seg.h"
 #include "main.h"
 #include "FreeRTOS.h"
 #include "task.h"
@@ -100,7 +103,7 @@ scpi_result_t EM_SYS_ModeQ(scpi_t* context)
 
 scpi_result_t EM_SYS_LimitsQ(scpi_t* context)
 {
-    char buff[120];
+    char buff[140];
     char dual[2] = {'\0'};
     char inter[2] = {'\0'};
     uint8_t dac = 0;
@@ -154,10 +157,26 @@ scpi_result_t EM_SYS_LimitsQ(scpi_t* context)
         gpio4 = EM_GPIO_LA_CH4_NUM;
     #endif
 
-    int len = sprintf(buff, "%d,%d,%d,%d,%d,%d,%d%d%s%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d%d%d%d", EM_DAQ_MAX_B12_FS, EM_DAQ_MAX_B8_FS, EM_DAQ_MAX_MEM,
+    char feat[12] = {'\0'}; // optional features, one char each
+    int feat_len = 0;
+
+    feat[feat_len++] = 'V'; // VM:READ:BIN?
+    feat[feat_len++] = 'P'; // SCOPe:DBUF - double buffered SCOPE
+    feat[feat_len++] = 'B'; // SYStem:BAUD - UART baud negotiation
+    feat[feat_len++] = 'C'; // LA:READ? COMP - run-length encoded LA data
+    feat[feat_len++] = 'K'; // SCOPe:READ? PACK - 12 bit samples packed to 3 bytes per 2
+    feat[feat_len++] = 'D'; // SCOPe:READ? DEC - decimated readout
+    feat[feat_len++] = 'S'; // SCOPe:SEGment - segmented memory
+    feat[feat_len++] = 'Q'; // SYStem:SEQ? - lines queued while busy, pipelined requests
+#ifdef EM_DAQ_ROLL
+    feat[feat_len++] = 'R'; // SCOPe:ROLL - streamed roll mode
+    feat[feat_len++] = 'L'; // VM:LOG - gapless block averaged VM logger
+#endif
+
+    int len = sprintf(buff, "%d,%d,%d,%d,%d,%d,%d%d%s%s,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d%d%d%d,%s", EM_DAQ_MAX_B12_FS, EM_DAQ_MAX_B8_FS, EM_DAQ_MAX_MEM,
                       EM_LA_MAX_FS, EM_PWM_MAX_F, pwm2, daqch, adcs, dual, inter, bit8, dac, EM_VM_FS, EM_VM_MEM, EM_CNTR_MEAS_MS,
                       EM_SGEN_MAX_F, EM_DAC_BUFF_LEN, EM_CNTR_MAX_F, EM_MEM_RESERVE,
-                      gpio1, gpio2, gpio3, gpio4);
+                      gpio1, gpio2, gpio3, gpio4, feat);
 
     SCPI_ResultCharacters(context, buff, len);
     return SCPI_RES_OK;
@@ -165,7 +184,7 @@ scpi_result_t EM_SYS_LimitsQ(scpi_t* context)
 
 scpi_result_t EM_SYS_InfoQ(scpi_t* context)
 {
-    char buff[100];
+    char buff[150];
 
     int len = sprintf(buff, "%s,%s,%s,%d,%d,%s,%s,%s,%s,%s", tskKERNEL_VERSION_NUMBER, EM_LL_VER, EM_DEV_COMM,
                       EM_FREQ_HCLK/1000000, (int)em_daq.vcc_mv, EM_PINS_SCOPE_VM, EM_PINS_LA, EM_PINS_CNTR, EM_PINS_PWM, EM_PINS_SGEN);
@@ -194,8 +213,125 @@ scpi_result_t EM_SYS_UptimeQ(scpi_t* context)
     return SCPI_RES_OK;
 }
 
+scpi_result_t EM_SYS_TputQ(scpi_t* context)
+{
+    char buff[40];
+    comm_tput_t* tp = &((comm_data_t*)context->comm)->tput;
+
+    comm_flush((comm_data_t*)context->comm); // count last respond fully
+
+    uint32_t bytes = tp->bytes;
+    uint32_t busy_us = tp->busy_us;
+    uint32_t bps = busy_us > 0 ? (uint32_t)(((uint64_t)bytes * 1000000) / busy_us) : 0;
+
+    tp->bytes = 0;
+    tp->busy_us = 0;
+
+    int len = sprintf(buff, "%lu,%lu,%lu", (unsigned long)bytes, (unsigned long)busy_us, (unsigned long)bps);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_SYS_Baud(scpi_t* context)
+{
+    comm_data_t* comm = (comm_data_t*)context->comm;
+
+    if (comm->uart.last != EM_TRUE)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_FUNCTION_NOT_AVAILABLE);
+        return SCPI_RES_ERR;
+    }
+
+    uint32_t p1;
+
+    if (!SCPI_ParamUInt32(context, &p1, TRUE))
+        return SCPI_RES_ERR;
+
+    if (p1 < 9600 || p1 > EM_UART_BAUD_MAX)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+    comm->baud.pending = p1; // switched in comm_main after this respond is out
+
+    SCPI_ResultText(context, SCPI_OK);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_SYS_BaudQ(scpi_t* context)
+{
+    char buff[25];
+    comm_data_t* comm = (comm_data_t*)context->comm;
+
+    int len = sprintf(buff, "%lu,%lu", comm->uart.last == EM_TRUE ? (unsigned long)comm->baud.now : 0UL, // 0 = USB
+                      (unsigned long)EM_UART_BAUD_MAX);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+}
+
+/* echoes batch number, host matches pipelined responses by it */
+scpi_result_t EM_SYS_SeqQ(scpi_t* context)
+{
+    char buff[12];
+    uint32_t p1;
+
+    if (!SCPI_ParamUInt32(context, &p1, TRUE))
+        return SCPI_RES_ERR;
+
+    int len = sprintf(buff, "%lu", (unsigned long)p1);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+}
+
 /************************* [VM Actions] *************************/
 
+#if defined(EM_ADC_MODE_ADC1)
+    #ifdef EM_DAQ_4CH
+        #define EM_VM_BUFF1_SIZE    5
+    #else
+        #define EM_VM_BUFF1_SIZE    3
+    #endif
+#elif defined(EM_ADC_MODE_ADC12)
+    #define EM_VM_BUFF1_SIZE        3
+#elif defined(EM_ADC_MODE_ADC1234)
+    #define EM_VM_BUFF1_SIZE        2
+#endif
+
+typedef struct
+{
+    uint32_t vcc_k;         // vcc [V] = vcc_k / vref_raw / 1000
+    uint16_t adc_max;       // max adc value
+    uint16_t count;         // number of records, each is vref,ch1,ch2,ch3,ch4 (uint16)
+    uint16_t lost;          // records overwritten by DMA before read
+    uint16_t chans;         // valid channels in record
+}vm_bin_hdr_t;
+
+static struct
+{
+    vm_bin_hdr_t hdr;
+    uint16_t data[EM_VM_BIN_MAX * 5];
+}vm_bin;
+
+static int vm_last_idx(void)
+{
+    int last_idx = EM_DMA_LAST_IDX(em_daq.buff1.len, EM_DMA_CH_ADC1, EM_DMA_ADC1);
+
+    for (int x = 0; x < EM_VM_BUFF1_SIZE; x++) // normalize index to mem size
+    {
+        if (last_idx % EM_VM_BUFF1_SIZE == EM_VM_BUFF1_SIZE - 1)
+            break;
+
+        last_idx--;
+        if (last_idx < 0)
+            last_idx = em_daq.buff1.len - 1;
+    }
+    return last_idx;
+}
+
 scpi_result_t EM_VM_ReadQ(scpi_t* context)
 {
     if (em_daq.mode == VM)
@@ -226,29 +362,8 @@ scpi_result_t EM_VM_ReadQ(scpi_t* context)
             return SCPI_RES_ERR;
         }
 
-        int last_idx = EM_DMA_LAST_IDX(em_daq.buff1.len, EM_DMA_CH_ADC1, EM_DMA_ADC1);
-
-        #if defined(EM_ADC_MODE_ADC1)
-            #ifdef EM_DAQ_4CH
-                int buff1_size = 5;
-            #else
-                int buff1_size = 3;
-            #endif
-        #elif defined(EM_ADC_MODE_ADC12)
-            int buff1_size = 3;
-        #elif defined(EM_ADC_MODE_ADC1234)
-            int buff1_size = 2;
-        #endif
-
-        for (int x = 0; x < buff1_size; x++) // normalize index to mem size
-        {
-            if (last_idx % buff1_size == buff1_size - 1)
-                break;
-
-            last_idx--;
-            if (last_idx < 0)
-                last_idx = em_daq.buff1.len - 1;
-        }
+        int buff1_size = EM_VM_BUFF1_SIZE;
+        int last_idx = vm_last_idx();
 
         int last_mem = last_idx / buff1_size; // normalized index can be truncated to mem size
         //ASSERT(last_idx % buff1_size == buff1_size - 1);
@@ -353,12 +468,265 @@ scpi_result_t EM_VM_ReadQ(scpi_t* context)
     }
 }
 
+scpi_result_t EM_VM_ReadBinQ(scpi_t* context)
+{
+    if (em_daq.mode != VM)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_MODE);
+        return SCPI_RES_ERR;
+    }
+
+    int slots = em_daq.buff1.len / EM_VM_BUFF1_SIZE; // mem + reserve
+    int last_mem = vm_last_idx() / EM_VM_BUFF1_SIZE;
+
+    if (em_daq.vm_seq == -1) // start seq. transfer with last record only
+        em_daq.vm_seq = last_mem > 0 ? last_mem - 1 : slots - 1;
+
+    int count = last_mem - em_daq.vm_seq;
+    if (count < 0)
+        count += slots;
+
+    int lost = 0;
+    if (count > em_daq.set.mem) // oldest records are already overwritten, skip them
+    {
+        lost = count - em_daq.set.mem;
+        count = em_daq.set.mem;
+    }
+
+    if (count > EM_VM_BIN_MAX) // rest in next call
+        count = EM_VM_BIN_MAX;
+
+    int m = em_daq.vm_seq + 1 + lost;
+
+    for (int k = 0; k < count; k++, m++)
+    {
+        if (m >= slots)
+            m -= slots;
+
+        uint16_t* rec = vm_bin.data + (k * 5);
+
+        #if defined(EM_ADC_MODE_ADC1)
+
+            uint16_t* b1 = ((uint16_t*)em_daq.buff1.data) + (m * EM_VM_BUFF1_SIZE);
+            rec[0] = b1[0];
+            rec[1] = b1[1];
+            rec[2] = b1[2];
+            #ifdef EM_DAQ_4CH
+                rec[3] = b1[3];
+                rec[4] = b1[4];
+            #else
+                rec[3] = 0;
+                rec[4] = 0;
+            #endif
+
+        #elif defined(EM_ADC_MODE_ADC12)
+
+            uint16_t* b1 = ((uint16_t*)em_daq.buff1.data) + (m * 3);
+            uint16_t* b2 = ((uint16_t*)em_daq.buff2.data) + (m * 2);
+            rec[0] = b1[0];
+            rec[1] = b1[1];
+            rec[2] = b1[2];
+            rec[3] = b2[0];
+            rec[4] = b2[1];
+
+        #elif defined(EM_ADC_MODE_ADC1234)
+
+            uint16_t* b1 = ((uint16_t*)em_daq.buff1.data) + (m * 2);
+            rec[0] = b1[0];
+            rec[1] = b1[1];
+            rec[2] = ((uint16_t*)em_daq.buff2.data)[m];
+            rec[3] = ((uint16_t*)em_daq.buff3.data)[m];
+            rec[4] = ((uint16_t*)em_daq.buff4.data)[m];
+        #endif
+    }
+
+    if (count > 0)
+    {
+        em_daq.vm_seq = m - 1;
+        if (em_daq.vm_seq < 0)
+            em_daq.vm_seq = slots - 1;
+
+        em_daq.vref = vm_bin.data[(count - 1) * 5];
+        em_daq.vcc_mv = EM_ADC_VREF_CALVAL * (double)EM_ADC_VREF_CAL / em_daq.vref * 1000;
+    }
+
+    vm_bin.hdr.vcc_k = (uint32_t)(EM_ADC_VREF_CALVAL * (double)EM_ADC_VREF_CAL * 1000.0);
+    vm_bin.hdr.adc_max = (uint16_t)em_daq.adc_max_val;
+    vm_bin.hdr.count = count;
+    vm_bin.hdr.lost = lost;
+    #ifdef EM_DAQ_4CH
+        vm_bin.hdr.chans = 4;
+    #else
+        vm_bin.hdr.chans = 2;
+    #endif
+
+    SCPI_ResultArbitraryBlock(context, &vm_bin, sizeof(vm_bin_hdr_t) + (count * 5 * sizeof(uint16_t)));
+    return SCPI_RES_OK;
+}
+
+static void vm_log_off(void)
+{
+    em_daq.log.en = EM_FALSE;
+    daq_fs_set(&em_daq, EM_VM_FS);
+    daq_mem_set(&em_daq, EM_VM_MEM);
+}
+
+scpi_result_t EM_VM_Log(scpi_t* context)
+{
+    if (em_daq.mode != VM)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_MODE);
+        return SCPI_RES_ERR;
+    }
+
+    uint32_t p1, p2 = 1;
+
+    if (!SCPI_ParamUInt32(context, &p1, TRUE))
+        return SCPI_RES_ERR;
+
+    SCPI_ParamUInt32(context, &p2, FALSE);
+
+    if (p1 > 0)
+    {
+#ifndef EM_DAQ_ROLL
+        SCPI_ErrorPush(context, SCPI_ERROR_FUNCTION_NOT_AVAILABLE);
+        return SCPI_RES_ERR;
+#endif
+        if (p2 < 1 || p2 > EM_LOG_AVG_MAX)
+        {
+            SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+            return SCPI_RES_ERR;
+        }
+
+        em_daq.log.en = EM_FALSE;
+        em_daq.log.avg = p2;
+
+        if (daq_fs_set(&em_daq, p1 * p2) != 0) // ADC runs avg times faster than log
+        {
+            vm_log_off();
+            SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+            return SCPI_RES_ERR;
+        }
+
+        em_daq.log.en = EM_TRUE;
+
+        if (daq_mem_set(&em_daq, EM_VM_MEM) != 0) // DMA circle + record FIFO
+        {
+            vm_log_off();
+            SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+            return SCPI_RES_ERR;
+        }
+    }
+    else
+    {
+        vm_log_off();
+    }
+
+    char rate_s[20];
+    char buff[40];
+    sprint_fast(rate_s, "%s", em_daq.log.active ? em_daq.set.fs_real / em_daq.log.avg : 0, 6);
+    int len = sprintf(buff, "\"OK\",%d,%s", em_daq.log.active, rate_s);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_VM_LogQ(scpi_t* context)
+{
+    char buff[50];
+    int len = sprintf(buff, "%d,%d,%lu,%lu", em_daq.log.active, em_daq.log.avg,
+                      (unsigned long)em_daq.log.seq, (unsigned long)em_daq.log.overruns);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_VM_LogReadQ(scpi_t* context)
+{
+    if (em_daq.mode != VM || em_daq.log.active != EM_TRUE)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_MODE);
+        return SCPI_RES_ERR;
+    }
+
+    daq_log_hdr_t* hdr;
+    uint32_t len = daq_log_read(&em_daq, &hdr); // header + whole records in FIFO order
+
+    hdr->vcc_k = (uint32_t)(EM_ADC_VREF_CALVAL * (double)EM_ADC_VREF_CAL * 1000.0);
+    hdr->adc_max = (uint16_t)em_daq.adc_max_val;
+
+    if (hdr->count > 0 && ((daq_log_rec_t*)(hdr + 1))[hdr->count - 1].vref >= EM_LOG_FRAC)
+    {
+        daq_log_rec_t* last = (daq_log_rec_t*)(hdr + 1) + (hdr->count - 1);
+        em_daq.vref = last->vref / EM_LOG_FRAC;
+        em_daq.vcc_mv = EM_ADC_VREF_CALVAL * (double)EM_ADC_VREF_CAL / em_daq.vref * 1000;
+    }
+
+    SCPI_ResultArbitraryBlock(context, hdr, len);
+    comm_flush((comm_data_t*)context->comm); // scratch is sent zero-copy
+
+    return SCPI_RES_OK;
+}
+
 /************************* [SCOPE Actions] *************************/
 
 scpi_result_t EM_SCOPE_ReadQ(scpi_t* context)
 {
     if (em_daq.mode == SCOPE)
     {
+        const char* p1;
+        const char* p3;
+        size_t p1l = 0, p3l = 0;
+        uint32_t p2 = 0;
+        uint8_t pack = EM_FALSE;
+        uint16_t dec = 0;
+        enum daq_dec dec_mode = DEC_SUB;
+
+        if (SCPI_ParamCharacters(context, &p1, &p1l, FALSE))
+        {
+            if (p1l == 3 && strncmp(p1, "DEC", 3) == 0) // DEC,<factor>,<SUB|PEAK|MEAN>[,PACK], see daq_decimate
+            {
+                if (!SCPI_ParamUInt32(context, &p2, TRUE) ||
+                    !SCPI_ParamCharacters(context, &p3, &p3l, TRUE))
+                {
+                    return SCPI_RES_ERR;
+                }
+
+                if (p3l == 3 && strncmp(p3, "SUB", 3) == 0)
+                    dec_mode = DEC_SUB;
+                else if (p3l == 4 && strncmp(p3, "PEAK", 4) == 0)
+                    dec_mode = DEC_PEAK;
+                else if (p3l == 4 && strncmp(p3, "MEAN", 4) == 0)
+                    dec_mode = DEC_MEAN;
+                else
+                {
+                    SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+                    return SCPI_RES_ERR;
+                }
+
+                if (p2 < 2 || p2 > em_daq.set.mem)
+                {
+                    SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+                    return SCPI_RES_ERR;
+                }
+
+                dec = p2;
+                p1l = 0;
+                SCPI_ParamCharacters(context, &p1, &p1l, FALSE);
+            }
+
+            if (p1l == 4 && strncmp(p1, "PACK", 4) == 0) // 12 bit packed, see daq_pack12
+                pack = EM_TRUE;
+            else if (p1l != 0)
+            {
+                SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+                return SCPI_RES_ERR;
+            }
+        }
+
+        if (em_daq.set.bits != B12) // 8 bit is sent as it is
+            pack = EM_FALSE;
+
         if (em_daq.trig.ready == EM_FALSE)
         {
             SCPI_ResultText(context, EM_RESP_NRDY);
@@ -382,37 +750,107 @@ scpi_result_t EM_SCOPE_ReadQ(scpi_t* context)
         if (em_daq.set.bits == B12)
             buff_len *= 2;
 
+        uint8_t* data[4] = {(uint8_t*)em_daq.buff1.data, (uint8_t*)em_daq.buff2.data,
+                            (uint8_t*)em_daq.buff3.data, (uint8_t*)em_daq.buff4.data};
+
+        uint32_t frst = em_daq.trig.pos_frst; // before re-arm resets it
+        uint16_t mem = em_daq.set.mem;
+
+        em_daq.trig.pretrig_cntr = 0;
+        em_daq.trig.ready = EM_FALSE;
+        em_daq.trig.ready_last = 0;
+
+        daq_seg_rewind(&em_daq); // last segment is sent, sequence starts over
+
+        if (em_daq.dbuf_active == EM_TRUE) // re-arm into other half, captured one is sent meanwhile
+        {
+            daq_dbuf_swap(&em_daq);
+
+            if (em_daq.trig.set.mode != SINGLE)
+                daq_enable(&em_daq, EM_TRUE);
+        }
+
         #if defined(EM_ADC_MODE_ADC1)
 
-            buff_len *= em_daq.set.ch1_en + em_daq.set.ch2_en + em_daq.set.ch3_en + em_daq.set.ch4_en;
+            uint16_t chans = em_daq.set.ch1_en + em_daq.set.ch2_en + em_daq.set.ch3_en + em_daq.set.ch4_en;
+            buff_len *= chans;
+
+            if (dec)
+                buff_len = daq_decimate(data[0], chans, (mem + EM_MEM_RESERVE) * chans, frst, mem, dec, dec_mode, em_daq.set.bits);
 
-            SCPI_ResultArbitraryBlocks(context, buff_len, 0, 0, 0, (uint8_t*)em_daq.buff1.data, NULL, NULL, NULL);
+            if (pack)
+                buff_len = daq_pack12(data[0], buff_len / 2);
+
+            SCPI_ResultArbitraryBlocks(context, buff_len, 0, 0, 0, data[0], NULL, NULL, NULL);
 
         #elif defined(EM_ADC_MODE_ADC12)
 
-            size_t buff_len1 = buff_len * (em_daq.set.ch1_en + em_daq.set.ch2_en);
-            size_t buff_len2 = buff_len * (em_daq.set.ch3_en + em_daq.set.ch4_en);
+            uint16_t chans1 = em_daq.set.ch1_en + em_daq.set.ch2_en;
+            uint16_t chans2 = em_daq.set.ch3_en + em_daq.set.ch4_en;
+            size_t buff_len1 = buff_len * chans1;
+            size_t buff_len2 = buff_len * chans2;
+
+            if (dec)
+            {
+                if (chans1 > 0)
+                    buff_len1 = daq_decimate(data[0], chans1, (mem + EM_MEM_RESERVE) * chans1, frst, mem, dec, dec_mode, em_daq.set.bits);
+                if (chans2 > 0)
+                    buff_len2 = daq_decimate(data[1], chans2, (mem + EM_MEM_RESERVE) * chans2, frst, mem, dec, dec_mode, em_daq.set.bits);
+            }
+
+            if (pack)
+            {
+                buff_len1 = daq_pack12(data[0], buff_len1 / 2);
+                buff_len2 = daq_pack12(data[1], buff_len2 / 2);
+            }
 
             SCPI_ResultArbitraryBlocks(context, buff_len1, buff_len2, 0, 0,
-                                                (em_daq.set.ch1_en == EM_TRUE || em_daq.set.ch2_en == EM_TRUE ? (uint8_t*)em_daq.buff1.data : NULL),
-                                                (em_daq.set.ch3_en == EM_TRUE || em_daq.set.ch4_en == EM_TRUE ? (uint8_t*)em_daq.buff2.data : NULL),
+                                                (em_daq.set.ch1_en == EM_TRUE || em_daq.set.ch2_en == EM_TRUE ? data[0] : NULL),
+                                                (em_daq.set.ch3_en == EM_TRUE || em_daq.set.ch4_en == EM_TRUE ? data[1] : NULL),
                                                 NULL, NULL);
 
         #elif defined(EM_ADC_MODE_ADC1234)
 
+            uint8_t en[4] = {em_daq.set.ch1_en, em_daq.set.ch2_en, em_daq.set.ch3_en, em_daq.set.ch4_en};
+
+            if (dec)
+            {
+                size_t dec_len = 0;
+
+                for (int i = 0; i < 4; i++)
+                {
+                    if (en[i] == EM_TRUE)
+                        dec_len = daq_decimate(data[i], 1, mem + EM_MEM_RESERVE, frst, mem, dec, dec_mode, em_daq.set.bits);
+                }
+                buff_len = dec_len;
+            }
+
+            if (pack)
+            {
+                size_t packed_len = 0;
+
+                for (int i = 0; i < 4; i++)
+                {
+                    if (en[i] == EM_TRUE)
+                        packed_len = daq_pack12(data[i], buff_len / 2);
+                }
+                buff_len = packed_len;
+            }
+
             SCPI_ResultArbitraryBlocks(context, buff_len, buff_len, buff_len, buff_len,
-                                                (em_daq.set.ch1_en == EM_TRUE ? (uint8_t*)em_daq.buff1.data : NULL),
-                                                (em_daq.set.ch2_en == EM_TRUE ? (uint8_t*)em_daq.buff2.data : NULL),
-                                                (em_daq.set.ch3_en == EM_TRUE ? (uint8_t*)em_daq.buff3.data : NULL),
-                                                (em_daq.set.ch4_en == EM_TRUE ? (uint8_t*)em_daq.buff4.data : NULL));
+                                                (em_daq.set.ch1_en == EM_TRUE ? data[0] : NULL),
+                                                (em_daq.set.ch2_en == EM_TRUE ? data[1] : NULL),
+                                                (em_daq.set.ch3_en == EM_TRUE ? data[2] : NULL),
+                                                (em_daq.set.ch4_en == EM_TRUE ? data[3] : NULL));
         #endif
 
-        em_daq.trig.pretrig_cntr = 0;
-        em_daq.trig.ready = EM_FALSE;
-        em_daq.trig.ready_last = 0;
+        if (em_daq.dbuf_active == EM_FALSE)
+        {
+            comm_flush((comm_data_t*)context->comm); // DAQ buffers are sent zero-copy
 
-        if (em_daq.trig.set.mode != SINGLE)
-            daq_enable(&em_daq, EM_TRUE);
+            if (em_daq.trig.set.mode != SINGLE)
+                daq_enable(&em_daq, EM_TRUE);
+        }
 
         return SCPI_RES_OK;
     }
@@ -573,6 +1011,187 @@ scpi_result_t EM_SCOPE_SetQ(scpi_t* context)
     }
 }
 
+scpi_result_t EM_SCOPE_DBuf(scpi_t* context)
+{
+    if (em_daq.mode != SCOPE)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_MODE);
+        return SCPI_RES_ERR;
+    }
+
+    uint32_t p1;
+
+    if (!SCPI_ParamUInt32(context, &p1, TRUE))
+        return SCPI_RES_ERR;
+
+    if (p1 > 1)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+    em_daq.dbuf = p1 ? EM_TRUE : EM_FALSE;
+
+    if (daq_mem_set(&em_daq, em_daq.set.mem) != 0) // realloc, memory which does not fit twice stays single
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+    char buff[10];
+    int len = sprintf(buff, "\"OK\",%d", em_daq.dbuf_active);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_SCOPE_Roll(scpi_t* context)
+{
+    if (em_daq.mode != SCOPE)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_MODE);
+        return SCPI_RES_ERR;
+    }
+
+    uint32_t p1;
+
+    if (!SCPI_ParamUInt32(context, &p1, TRUE))
+        return SCPI_RES_ERR;
+
+    if (p1 > 1)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+#ifndef EM_DAQ_ROLL
+    if (p1 == 1)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_FUNCTION_NOT_AVAILABLE);
+        return SCPI_RES_ERR;
+    }
+#endif
+
+    em_daq.roll.en = p1 ? EM_TRUE : EM_FALSE;
+
+    if (daq_mem_set(&em_daq, em_daq.set.mem) != 0) // realloc, DMA circle + stream buffer or back to triggered memory
+    {
+        em_daq.roll.en = EM_FALSE;
+        daq_mem_set(&em_daq, em_daq.set.mem);
+
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+    char buff[10];
+    int len = sprintf(buff, "\"OK\",%d", em_daq.roll.active);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_SCOPE_RollQ(scpi_t* context)
+{
+    char buff[30];
+    int len = sprintf(buff, "%d,%lu,%lu", em_daq.roll.active, (unsigned long)em_daq.roll.seq, (unsigned long)em_daq.roll.overruns);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_SCOPE_RollReadQ(scpi_t* context)
+{
+    if (em_daq.mode != SCOPE || em_daq.roll.active != EM_TRUE)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_MODE);
+        return SCPI_RES_ERR;
+    }
+
+    uint8_t* data;
+    uint32_t len = daq_roll_read(&em_daq, &data); // whole blocks: uint32 seq + half of each DMA buffer
+
+    SCPI_ResultArbitraryBlock(context, data, len);
+    comm_flush((comm_data_t*)context->comm); // scratch is sent zero-copy
+
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_SCOPE_Seg(scpi_t* context)
+{
+    if (em_daq.mode != SCOPE)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_MODE);
+        return SCPI_RES_ERR;
+    }
+
+    uint32_t p1;
+
+    if (!SCPI_ParamUInt32(context, &p1, TRUE))
+        return SCPI_RES_ERR;
+
+    if (p1 == 1 || p1 > EM_SEG_MAX)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+    em_daq.seg.en = p1;
+
+    if (daq_mem_set(&em_daq, em_daq.set.mem) != 0) // realloc, as many segments as fit, memory which does not fit twice stays single
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+    char buff[15];
+    int len = sprintf(buff, "\"OK\",%d", em_daq.seg.active ? em_daq.seg.num : 0);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_SCOPE_SegQ(scpi_t* context)
+{
+    char buff[20];
+    int len = sprintf(buff, "%d,%d,%d", em_daq.seg.active, em_daq.seg.num, em_daq.seg.cnt);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_SCOPE_SegReadQ(scpi_t* context)
+{
+    if (em_daq.mode != SCOPE || em_daq.seg.active != EM_TRUE)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_MODE);
+        return SCPI_RES_ERR;
+    }
+
+    if (em_daq.trig.ready == EM_FALSE)
+    {
+        SCPI_ResultText(context, EM_RESP_NRDY);
+        return SCPI_RES_OK;
+    }
+
+    uint8_t* hdr;
+    uint8_t* data;
+    uint16_t cnt = daq_seg_read(&em_daq, &hdr, &data); // header table, then segments as in SCOP:READ? each
+
+    em_daq.trig.pretrig_cntr = 0;
+    em_daq.trig.ready = EM_FALSE;
+    em_daq.trig.ready_last = 0;
+
+    daq_seg_rewind(&em_daq);
+
+    SCPI_ResultArbitraryBlocks(context, cnt * sizeof(daq_seg_hdr_t), cnt * em_daq.seg.stride, 0, 0, hdr, data, NULL, NULL);
+    comm_flush((comm_data_t*)context->comm); // segments are sent zero-copy
+
+    if (em_daq.trig.set.mode != SINGLE)
+        daq_enable(&em_daq, EM_TRUE);
+
+    return SCPI_RES_OK;
+}
+
 scpi_result_t EM_SCOPE_ForceTrig(scpi_t* context)
 {
     if (em_daq.mode != SCOPE)
@@ -605,6 +1224,9 @@ scpi_result_t EM_SCOPE_ForceTrig(scpi_t* context)
     daq_enable(&em_daq, EM_FALSE);
     em_daq.trig.pos_frst = EM_DMA_LAST_IDX(em_daq.trig.buff_trig->len, em_daq.trig.dma_ch_trig, em_daq.trig.dma_trig);
 
+    if (em_daq.seg.active == EM_TRUE) // forced capture ends the sequence
+        daq_seg_next(&em_daq, daq_time_us(&em_daq), EM_TRUE);
+
     comm_daq_ready(comm_ptr, EM_RESP_RDY_F, em_daq.trig.pos_frst);
 
     SCPI_ResultText(context, SCPI_OK);
@@ -617,6 +1239,21 @@ scpi_result_t EM_LA_ReadQ(scpi_t* context)
 {
     if (em_daq.mode == LA)
     {
+        const char* p1;
+        size_t p1l = 0;
+        uint8_t comp = EM_FALSE;
+
+        if (SCPI_ParamCharacters(context, &p1, &p1l, FALSE))
+        {
+            if (p1l == 4 && strncmp(p1, "COMP", 4) == 0) // run-length encoded, see daq_la_rle
+                comp = EM_TRUE;
+            else
+            {
+                SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+                return SCPI_RES_ERR;
+            }
+        }
+
         if (em_daq.trig.ready == EM_FALSE)
         {
             SCPI_ResultText(context, EM_RESP_NRDY);
@@ -627,7 +1264,10 @@ scpi_result_t EM_LA_ReadQ(scpi_t* context)
         em_daq.trig.ready = EM_FALSE;
         em_daq.trig.ready_last = 0;
 
-        SCPI_ResultArbitraryBlock(context, em_daq.buff1.data, em_daq.buff1.len);
+        uint16_t len = comp ? daq_la_rle(&em_daq) : em_daq.buff1.len; // DAQ is stopped, encoded in place
+
+        SCPI_ResultArbitraryBlock(context, em_daq.buff1.data, len);
+        comm_flush((comm_data_t*)context->comm); // DAQ buffer is sent zero-copy
 
         if (em_daq.trig.set.mode != SINGLE)
             daq_enable(&em_daq, EM_TRUE);
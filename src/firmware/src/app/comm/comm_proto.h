@@ -15,13 +15,28 @@ scpi_result_t EM_SYS_ModeQ(scpi_t * context);
 scpi_result_t EM_SYS_LimitsQ(scpi_t * context);
 scpi_result_t EM_SYS_InfoQ(scpi_t * context);
 scpi_result_t EM_SYS_UptimeQ(scpi_t* context);
+scpi_result_t EM_SYS_TputQ(scpi_t* context);
+scpi_result_t EM_SYS_Baud(scpi_t* context);
+scpi_result_t EM_SYS_BaudQ(scpi_t* context);
+scpi_result_t EM_SYS_SeqQ(scpi_t* context);
 
 scpi_result_t EM_VM_ReadQ(scpi_t * context);
+scpi_result_t EM_VM_ReadBinQ(scpi_t * context);
+scpi_result_t EM_VM_Log(scpi_t * context);
+scpi_result_t EM_VM_LogQ(scpi_t * context);
+scpi_result_t EM_VM_LogReadQ(scpi_t * context);
 
 scpi_result_t EM_SCOPE_Set(scpi_t * context);
 scpi_result_t EM_SCOPE_SetQ(scpi_t * context);
 scpi_result_t EM_SCOPE_ReadQ(scpi_t * context);
 scpi_result_t EM_SCOPE_ForceTrig(scpi_t * context);
+scpi_result_t EM_SCOPE_DBuf(scpi_t * context);
+scpi_result_t EM_SCOPE_Roll(scpi_t * context);
+scpi_result_t EM_SCOPE_RollQ(scpi_t * context);
+scpi_result_t EM_SCOPE_RollReadQ(scpi_t * context);
+scpi_result_t EM_SCOPE_Seg(scpi_t * context);
+scpi_result_t EM_SCOPE_SegQ(scpi_t * context);
+scpi_result_t EM_SCOPE_SegReadQ(scpi_t * context);
 
 scpi_result_t EM_LA_Set(scpi_t * context);
 scpi_result_t EM_LA_SetQ(scpi_t * context);
@@ -6,7 +6,11 @@
 #include "cfg.h"
 #include "daq.h"
 #include "daq_trig.h"
+#include "daq_roll.h"
+#include "daq_log.h"
+#include "daq_seg.h"
 
+#include "app_sync.h"
 #include "main.h"
 #include "periph/periph_adc.h"
 #include "periph/periph_dma.h"
@@ -22,6 +26,7 @@ static void daq_enable_adc(daq_data_t* self, ADC_TypeDef* adc, uint8_t enable, u
 static void daq_malloc(daq_data_t* self, daq_buff_t* buff, int mem, int reserve, int chans, uint32_t src, uint32_t dma_ch,
                        DMA_TypeDef* dma, enum daq_bits bits);
 static void daq_clear_buff(daq_buff_t* buff);
+static void daq_dbuf_move(daq_buff_t* buff, int offset, DMA_TypeDef* dma, uint32_t dma_ch);
 
 
 void daq_init(daq_data_t* self)
@@ -47,6 +52,23 @@ void daq_init(daq_data_t* self)
     self->smpl_time = 0;
     self->interleaved = EM_FALSE;
     self->dualmode = EM_FALSE;
+    self->dbuf = EM_FALSE;
+    self->dbuf_active = EM_FALSE;
+    self->dbuf_half = 0;
+    self->dbuf_offset = 0;
+    self->roll.en = EM_FALSE;
+    self->roll.active = EM_FALSE;
+    self->roll.seq = 0;
+    self->roll.overruns = 0;
+    self->log.en = EM_FALSE;
+    self->log.active = EM_FALSE;
+    self->log.avg = 1;
+    self->seg.en = 0;
+    self->seg.active = EM_FALSE;
+    self->seg.num = 0;
+    self->seg.cnt = 0;
+    self->seg.stride = 0;
+    self->seg.trig_us = 0;
     self->uwTick = 0;
     self->uwTick_start = 0;
     self->vm_seq = -1;
@@ -153,6 +175,8 @@ void daq_settings_init(daq_data_t* self, uint8_t scope, uint8_t la)
 int daq_mem_set(daq_data_t* self, uint16_t mem_per_ch)
 {
     daq_enable(self, EM_FALSE);
+    daq_roll_stop(self);
+    daq_log_stop(self);
     daq_reset(self);
 
     daq_clear_buff(&self->buff1);
@@ -161,6 +185,11 @@ int daq_mem_set(daq_data_t* self, uint16_t mem_per_ch)
     daq_clear_buff(&self->buff4);
     self->buff_raw_ptr = 0;
     memset(self->buff_raw, 0, EM_DAQ_MAX_MEM * sizeof(uint8_t));
+    self->dbuf_active = EM_FALSE;
+    self->dbuf_half = 0;
+    self->seg.active = EM_FALSE;
+    self->seg.num = 0;
+    self->seg.cnt = 0;
 
     int max_len = EM_DAQ_MAX_MEM;
     if (self->set.bits == B12)
@@ -169,6 +198,10 @@ int daq_mem_set(daq_data_t* self, uint16_t mem_per_ch)
     if (self->mode != LA)
     {
         uint8_t is_vcc = (self->mode == VM ? 1 : 0);
+        uint8_t roll = (self->mode == SCOPE && self->roll.en == EM_TRUE);
+        uint8_t vm_log = (self->mode == VM && self->log.en == EM_TRUE);
+        int alloc = mem_per_ch;
+        int reserve = EM_MEM_RESERVE;
 
         #if defined(EM_ADC_MODE_ADC1)
 
@@ -177,7 +210,13 @@ int daq_mem_set(daq_data_t* self, uint16_t mem_per_ch)
             if (mem_per_ch < 1 || (mem_per_ch * len1) > max_len)
                 return -2;
 
-            daq_malloc(self, &self->buff1, mem_per_ch * len1, EM_MEM_RESERVE, len1, EM_ADC_ADDR(EM_ADC1), EM_DMA_CH_ADC1, EM_DMA_ADC1, self->set.bits);
+            if (roll || vm_log) // short DMA circle only, processed by halves
+            {
+                alloc = daq_roll_ring(self, len1, max_len);
+                reserve = 0;
+            }
+
+            daq_malloc(self, &self->buff1, alloc * len1, reserve, len1, EM_ADC_ADDR(EM_ADC1), EM_DMA_CH_ADC1, EM_DMA_ADC1, self->set.bits);
 
         #elif defined(EM_ADC_MODE_ADC12)
 
@@ -197,10 +236,16 @@ int daq_mem_set(daq_data_t* self, uint16_t mem_per_ch)
             if (mem_per_ch < 1 || (mem_per_ch * total) > max_len)
                 return -2;
 
+            if (roll || vm_log) // short DMA circle only, processed by halves
+            {
+                alloc = daq_roll_ring(self, total, max_len);
+                reserve = 0;
+            }
+
             if (len1 > 0)
-                daq_malloc(self, &self->buff1, mem_per_ch * len1, EM_MEM_RESERVE, len1, EM_ADC_ADDR(EM_ADC1), EM_DMA_CH_ADC1, EM_DMA_ADC1, self->set.bits);
+                daq_malloc(self, &self->buff1, alloc * len1, reserve, len1, EM_ADC_ADDR(EM_ADC1), EM_DMA_CH_ADC1, EM_DMA_ADC1, self->set.bits);
             if (len2 > 0)
-                daq_malloc(self, &self->buff2, mem_per_ch * len2, EM_MEM_RESERVE, len2, EM_ADC_ADDR(EM_ADC2), EM_DMA_CH_ADC2, EM_DMA_ADC2, self->set.bits);
+                daq_malloc(self, &self->buff2, alloc * len2, reserve, len2, EM_ADC_ADDR(EM_ADC2), EM_DMA_CH_ADC2, EM_DMA_ADC2, self->set.bits);
 
         #elif defined(EM_ADC_MODE_ADC1234)
 
@@ -224,16 +269,41 @@ int daq_mem_set(daq_data_t* self, uint16_t mem_per_ch)
             if (mem_per_ch < 1 || (mem_per_ch * total) > max_len)
                 return -2;
 
+            if (roll || vm_log) // short DMA circle only, processed by halves
+            {
+                alloc = daq_roll_ring(self, total, max_len);
+                reserve = 0;
+            }
+
             if (len1 > 0)
-                daq_malloc(self, &self->buff1, mem_per_ch * len1, EM_MEM_RESERVE, len1, EM_ADC_ADDR(EM_ADC1), EM_DMA_CH_ADC1, EM_DMA_ADC1, self->set.bits);
+                daq_malloc(self, &self->buff1, alloc * len1, reserve, len1, EM_ADC_ADDR(EM_ADC1), EM_DMA_CH_ADC1, EM_DMA_ADC1, self->set.bits);
             if (len2 > 0)
-                daq_malloc(self, &self->buff2, mem_per_ch * len2, EM_MEM_RESERVE, len2, EM_ADC_ADDR(EM_ADC2), EM_DMA_CH_ADC2, EM_DMA_ADC2, self->set.bits);
+                daq_malloc(self, &self->buff2, alloc * len2, reserve, len2, EM_ADC_ADDR(EM_ADC2), EM_DMA_CH_ADC2, EM_DMA_ADC2, self->set.bits);
             if (len3 > 0)
-                daq_malloc(self, &self->buff3, mem_per_ch * len3, EM_MEM_RESERVE, len3, EM_ADC_ADDR(EM_ADC3), EM_DMA_CH_ADC3, EM_DMA_ADC3, self->set.bits);
+                daq_malloc(self, &self->buff3, alloc * len3, reserve, len3, EM_ADC_ADDR(EM_ADC3), EM_DMA_CH_ADC3, EM_DMA_ADC3, self->set.bits);
             if (len4 > 0)
-                daq_malloc(self, &self->buff4, mem_per_ch * len4, EM_MEM_RESERVE, len4, EM_ADC_ADDR(EM_ADC4), EM_DMA_CH_ADC4, EM_DMA_ADC4, self->set.bits);
+                daq_malloc(self, &self->buff4, alloc * len4, reserve, len4, EM_ADC_ADDR(EM_ADC4), EM_DMA_CH_ADC4, EM_DMA_ADC4, self->set.bits);
 
         #endif
+
+        /* second copy of all buffers right after the first one, DMA fills one while other is read out */
+        uint16_t offset = (self->buff_raw_ptr + 3) & ~3; // keep word alignment for dual mode DMA
+        if (self->mode == SCOPE && self->seg.en > 1 && roll == EM_FALSE) // segments instead, re-arm needs no readout
+        {
+            daq_seg_start(self, offset);
+        }
+        else if (self->mode == SCOPE && self->dbuf == EM_TRUE && roll == EM_FALSE && offset * 2 <= sizeof(self->buff_raw))
+        {
+            memset(self->buff_raw + offset, 0, offset);
+            self->buff_raw_ptr = offset * 2;
+            self->dbuf_offset = offset;
+            self->dbuf_active = EM_TRUE;
+        }
+
+        if (roll && daq_roll_start(self) != 0) // rest of memory is stream buffer
+            return -2;
+        if (vm_log && daq_log_start(self) != 0) // rest of memory is record FIFO
+            return -2;
     }
     else // mode == LA
     {
@@ -336,6 +406,208 @@ static void daq_malloc(daq_data_t* self, daq_buff_t* buff, int mem, int reserve,
     }
 }
 
+void daq_dbuf_swap(daq_data_t* self)
+{
+    if (self->dbuf_active == EM_FALSE)
+        return;
+
+    int offset = self->dbuf_half ? -(int)self->dbuf_offset : (int)self->dbuf_offset;
+    self->dbuf_half = !self->dbuf_half;
+
+    daq_buff_move(self, offset);
+}
+
+/* all DMA buffers shifted by offset bytes within buff_raw, DAQ disabled */
+void daq_buff_move(daq_data_t* self, int offset)
+{
+    #if defined(EM_ADC_MODE_ADC1)
+        daq_dbuf_move(&self->buff1, offset, EM_DMA_ADC1, EM_DMA_CH_ADC1);
+    #elif defined(EM_ADC_MODE_ADC12)
+        daq_dbuf_move(&self->buff1, offset, EM_DMA_ADC1, EM_DMA_CH_ADC1);
+        daq_dbuf_move(&self->buff2, offset, EM_DMA_ADC2, EM_DMA_CH_ADC2);
+    #elif defined(EM_ADC_MODE_ADC1234)
+        daq_dbuf_move(&self->buff1, offset, EM_DMA_ADC1, EM_DMA_CH_ADC1);
+        daq_dbuf_move(&self->buff2, offset, EM_DMA_ADC2, EM_DMA_CH_ADC2);
+        daq_dbuf_move(&self->buff3, offset, EM_DMA_ADC3, EM_DMA_CH_ADC3);
+        daq_dbuf_move(&self->buff4, offset, EM_DMA_ADC4, EM_DMA_CH_ADC4);
+    #endif
+}
+
+static void daq_dbuf_move(daq_buff_t* buff, int offset, DMA_TypeDef* dma, uint32_t dma_ch)
+{
+    if (buff->data == NULL)
+        return;
+
+    buff->data = ((uint8_t*)buff->data) + offset;
+
+    // DAQ is stopped, restart circular DMA from beginning of the other half (segment)
+    LL_DMA_DisableChannel(dma, dma_ch);
+    LL_DMA_SetMemoryAddress(dma, dma_ch, (uint32_t)buff->data);
+    LL_DMA_SetDataLength(dma, dma_ch, buff->len);
+    LL_DMA_EnableChannel(dma, dma_ch);
+}
+
+/* 12 bit samples packed in place, two samples to three bytes (LE: a[7:0], b[3:0] a[11:8], b[11:4]),
+ * odd count is padded with zero sample, returns length in bytes */
+uint32_t daq_pack12(void* data, uint32_t count)
+{
+    const uint16_t* src = (const uint16_t*)data;
+    uint8_t* dst = (uint8_t*)data;
+    uint32_t wr = 0;
+
+    for (uint32_t i = 0; i < count; i += 2)
+    {
+        uint16_t a = src[i];
+        uint16_t b = (i + 1 < count) ? src[i + 1] : 0; // both read before 3 bytes are written over them
+
+        dst[wr++] = a & 0xFF;
+        dst[wr++] = ((a >> 8) & 0x0F) | ((b & 0x0F) << 4);
+        dst[wr++] = (b >> 4) & 0xFF;
+    }
+
+    return wr;
+}
+
+static inline uint16_t daq_smpl_get(const void* data, uint8_t b12, uint32_t i)
+{
+    return b12 ? ((const uint16_t*)data)[i] : ((const uint8_t*)data)[i];
+}
+
+static inline void daq_smpl_set(void* data, uint8_t b12, uint32_t i, uint16_t val)
+{
+    if (b12)
+        ((uint16_t*)data)[i] = val;
+    else
+        ((uint8_t*)data)[i] = (uint8_t)val;
+}
+
+static void daq_smpl_reverse(void* data, uint8_t b12, uint32_t from, uint32_t to)
+{
+    while (from + 1 < to)
+    {
+        to--;
+        uint16_t tmp = daq_smpl_get(data, b12, from);
+        daq_smpl_set(data, b12, from, daq_smpl_get(data, b12, to));
+        daq_smpl_set(data, b12, to, tmp);
+        from++;
+    }
+}
+
+/* circular capture of len samples rotated in place to linear order starting at frst, then decimated in place by factor,
+ * chans interleaved, mem samples per channel valid, PEAK gives min and max per block, returns length in bytes */
+uint32_t daq_decimate(void* data, uint16_t chans, uint32_t len, uint32_t frst, uint16_t mem, uint16_t factor, enum daq_dec mode, enum daq_bits bits)
+{
+    ASSERT(chans >= 1 && chans <= 4 && factor >= 2 && factor <= mem && frst < len);
+
+    uint8_t b12 = (bits == B12);
+    uint32_t blocks = mem / factor;
+    uint32_t wr = 0;
+
+    /* rotation by three reversals, no extra memory */
+    daq_smpl_reverse(data, b12, 0, frst);
+    daq_smpl_reverse(data, b12, frst, len);
+    daq_smpl_reverse(data, b12, 0, len);
+
+    /* output of block k ends before input of block k + 1 starts, as factor >= 2 */
+    for (uint32_t k = 0; k < blocks; k++)
+    {
+        uint32_t from = k * factor * chans;
+        uint16_t lo[4], hi[4];
+        uint32_t sum[4];
+
+        for (int c = 0; c < chans; c++)
+        {
+            lo[c] = hi[c] = daq_smpl_get(data, b12, from + c);
+            sum[c] = 0;
+        }
+
+        if (mode != DEC_SUB)
+        {
+            for (uint32_t i = 0; i < factor; i++)
+            {
+                for (int c = 0; c < chans; c++)
+                {
+                    uint16_t val = daq_smpl_get(data, b12, from + (i * chans) + c);
+
+                    if (val < lo[c]) lo[c] = val;
+                    if (val > hi[c]) hi[c] = val;
+                    sum[c] += val;
+                }
+            }
+        }
+
+        for (int c = 0; c < chans; c++)
+        {
+            if (mode == DEC_MEAN)
+                daq_smpl_set(data, b12, wr++, (sum[c] + (factor / 2)) / factor);
+            else
+                daq_smpl_set(data, b12, wr++, lo[c]); // SUB: lo is the first sample
+        }
+
+        if (mode == DEC_PEAK)
+        {
+            for (int c = 0; c < chans; c++)
+                daq_smpl_set(data, b12, wr++, hi[c]);
+        }
+    }
+
+    return b12 ? wr * 2 : wr;
+}
+
+/* LA capture run-length encoded in place, result is never longer than raw capture.
+ * token: low nibble = CH1..CH4 level, high nibble h = run of h+1 samples,
+ * h = 15 = run of 16 + N samples, N follows as LEB128 (7 bits per byte, MSB = next byte follows) */
+uint16_t daq_la_rle(daq_data_t* self)
+{
+    uint8_t* data = (uint8_t*)self->buff1.data;
+    const int len = self->buff1.len;
+
+#ifdef EM_DAQ_4CH
+    const uint8_t mask = (1 << EM_GPIO_LA_CH1_NUM) | (1 << EM_GPIO_LA_CH2_NUM) | (1 << EM_GPIO_LA_CH3_NUM) | (1 << EM_GPIO_LA_CH4_NUM);
+#else
+    const uint8_t mask = (1 << EM_GPIO_LA_CH1_NUM) | (1 << EM_GPIO_LA_CH2_NUM);
+#endif
+
+    int rd = 0;
+    int wr = 0;
+
+    while (rd < len)
+    {
+        uint8_t v = data[rd] & mask;
+        int run = 1;
+
+        while (rd + run < len && (data[rd + run] & mask) == v)
+            run++;
+
+        rd += run; // whole run consumed before any write, so wr never passes rd
+
+        uint8_t nib = ((v >> EM_GPIO_LA_CH1_NUM) & 1) | (((v >> EM_GPIO_LA_CH2_NUM) & 1) << 1);
+#ifdef EM_DAQ_4CH
+        nib |= (((v >> EM_GPIO_LA_CH3_NUM) & 1) << 2) | (((v >> EM_GPIO_LA_CH4_NUM) & 1) << 3);
+#endif
+
+        if (run <= 15)
+        {
+            data[wr++] = ((run - 1) << 4) | nib;
+        }
+        else
+        {
+            uint32_t n = run - 16;
+            data[wr++] = 0xF0 | nib;
+
+            do
+            {
+                uint8_t b = n & 0x7F;
+                n >>= 7;
+                data[wr++] = n ? (b | 0x80) : b;
+            }
+            while (n);
+        }
+    }
+
+    return wr;
+}
+
 static void daq_clear_buff(daq_buff_t* buff)
 {
     buff->data = NULL;
@@ -453,6 +725,9 @@ int daq_fs_set(daq_data_t* self, int fs)
     LL_TIM_SetPrescaler(EM_TIM_DAQ, prescaler);
     LL_TIM_SetAutoReload(EM_TIM_DAQ, reload);
 
+    if (self->roll.active == EM_TRUE || self->log.active == EM_TRUE) // DMA circle length follows fs
+        return daq_mem_set(self, self->set.mem);
+
     daq_trig_update(self);
     daq_enable(self, EM_TRUE);
     return 0;
@@ -665,6 +940,8 @@ void daq_reset(daq_data_t* self)
     self->trig.pretrig_cntr = 0;
     self->trig.is_post = EM_FALSE;
 
+    daq_seg_rewind(self);
+
     if (self->buff1.len > 0)
         memset(self->buff1.data, 0, self->buff1.len);
     if (self->buff2.len > 0)
@@ -675,6 +952,21 @@ void daq_reset(daq_data_t* self)
         memset(self->buff4.data, 0, self->buff4.len);
 }
 
+/* microseconds from 1 kHz tick and SysTick down-counter */
+uint32_t daq_time_us(daq_data_t* self)
+{
+    uint32_t ms, val;
+
+    do
+    {
+        ms = *(volatile uint32_t*)&self->uwTick;
+        val = SysTick->VAL;
+    }
+    while (ms != *(volatile uint32_t*)&self->uwTick);
+
+    return (ms * 1000) + ((SysTick->LOAD - val) * 1000 / (SysTick->LOAD + 1));
+}
+
 void daq_enable(daq_data_t* self, uint8_t enable)
 {
     if (enable == EM_FALSE)
@@ -736,6 +1028,10 @@ void daq_enable(daq_data_t* self, uint8_t enable)
 
     self->trig.uwtick_first = self->uwTick;
     self->enabled = enable;
+
+    self->trig.post_epoch++;
+    if (self->trig.post_start == EM_TRUE)
+        xSemaphoreGive(sem6_post); // wake post trigger task waiting for capture end
 }
 
 static void daq_enable_adc(daq_data_t* self, ADC_TypeDef* adc, uint8_t enable, uint32_t dma_ch)
@@ -771,6 +1067,8 @@ void daq_mode_set(daq_data_t* self, enum daq_mode mode)
     daq_reset(self);
     self->dis_hold = EM_TRUE;
     self->mode = mode;
+    self->roll.en = EM_FALSE; // streaming is per session, host enables it again
+    self->log.en = EM_FALSE;
 
     // GPIO init
     if (mode == SCOPE || mode == VM)
@@ -21,6 +21,13 @@ enum daq_bits
     B1 = 1
 };
 
+enum daq_dec
+{
+    DEC_SUB = 0,    /** every Nth sample */
+    DEC_PEAK = 1,   /** min and max of N samples */
+    DEC_MEAN = 2    /** mean of N samples */
+};
+
 enum trig_mode
 {
     AUTO = 0,
@@ -109,9 +116,43 @@ typedef struct
     uint8_t order;          // order from bottom of triggered ch in circular buffer
     uint8_t post_start;     // flag when set posttrigger counting starts
     int post_from;          // position from where start counting posttrigger
+    uint32_t post_epoch;    // incremented by daq_enable, post trigger capture is void if changed
     int dma_pos_catched;    // catched actual DMA circular buffer position
 }daq_trig_data_t;
 
+typedef struct
+{
+    uint8_t en;             // roll mode wanted by user (SCOPE)
+    uint8_t active;         // DMA halves are streamed, trigger is off
+    uint16_t block;         // bytes of one stream block incl. sequence header
+    uint16_t ring;          // DMA circular buffer per channel in samples
+    uint16_t scratch_len;   // TX scratch in bytes, whole blocks
+    uint32_t seq;           // DMA halves done, dropped ones included
+    uint32_t overruns;      // DMA halves dropped as host did not keep up
+}daq_roll_t;
+
+typedef struct
+{
+    uint8_t en;             // VM logger wanted by user
+    uint8_t active;         // DMA halves are block averaged into FIFO
+    uint16_t avg;           // samples per block average
+    uint16_t cntr;          // samples in current block
+    uint16_t scratch_len;   // TX scratch in bytes incl. header, whole records
+    uint32_t sum[5];        // running block sums - vref, ch1..ch4
+    uint32_t seq;           // blocks done, dropped ones included
+    uint32_t overruns;      // blocks dropped as host did not keep up
+}daq_log_t;
+
+typedef struct
+{
+    uint16_t en;            // segments wanted by user (SCOPE), 0 off
+    uint8_t active;         // buffers repeated per segment, trigger re-arms into next one
+    uint16_t num;           // segments which fit buff_raw
+    uint16_t cnt;           // segments captured since last readout
+    uint16_t stride;        // distance between segments in bytes
+    uint32_t trig_us;       // time of last valid trigger
+}daq_seg_t;
+
 typedef struct
 {
     uint8_t ch1_en;         // channel 1 enabled
@@ -153,8 +194,15 @@ typedef struct
     uint8_t enabled;        // main DAQ control
     uint8_t interleaved;    // interleaved enabled
     uint8_t dualmode;       // dual mode enabled
+    uint8_t dbuf;           // double buffering wanted by user (SCOPE)
+    uint8_t dbuf_active;    // double buffering in use - memory fits twice
+    uint8_t dbuf_half;      // which half of buff_raw DMA writes to
+    uint16_t dbuf_offset;   // distance between halves in bytes
 
     daq_trig_data_t trig;       // trigger substruct
+    daq_roll_t roll;            // roll mode substruct
+    daq_log_t log;              // VM logger substruct
+    daq_seg_t seg;              // segmented memory substruct
 }daq_data_t;
 
 void daq_init(daq_data_t* self);
@@ -164,6 +212,12 @@ int daq_fs_set(daq_data_t* self, int fs);
 int daq_ch_set(daq_data_t* self, uint8_t ch1, uint8_t ch2, uint8_t ch3, uint8_t ch4, int fs);
 void daq_reset(daq_data_t* self);
 void daq_enable(daq_data_t* self, uint8_t enable);
+void daq_dbuf_swap(daq_data_t* self);
+void daq_buff_move(daq_data_t* self, int offset);
+uint32_t daq_time_us(daq_data_t* self);
+uint16_t daq_la_rle(daq_data_t* self);
+uint32_t daq_pack12(void* data, uint32_t count);
+uint32_t daq_decimate(void* data, uint16_t chans, uint32_t len, uint32_t frst, uint16_t mem, uint16_t factor, enum daq_dec mode, enum daq_bits bits);
 void daq_mode_set(daq_data_t* self, enum daq_mode mode);
 void daq_settings_save(daq_settings_t* src1, trig_settings_t* src2, daq_settings_t* dst1, trig_settings_t* dst2);
 void daq_settings_init(daq_data_t* self, uint8_t scope, uint8_t la);
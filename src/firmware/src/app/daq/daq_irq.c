@@ -6,6 +6,8 @@
 #include "cfg.h"
 
 #include "app_data.h"
+#include "daq/daq_roll.h"
+#include "daq/daq_log.h"
 #include "main.h"
 
 #include "FreeRTOS.h"
@@ -118,6 +120,31 @@ static void la_irq_ch2(void);
     }
 #endif
 
+#ifdef EM_DAQ_ROLL
+    void EM_DAQ_ROLL_IRQh(void)
+    {
+        traceISR_ENTER();
+        int half = -1;
+
+        if (EM_DAQ_ROLL_HT(EM_DMA_ADC1) == 1) // first half of DMA circle done
+            half = 0;
+        else if (EM_DAQ_ROLL_TC(EM_DMA_ADC1) == 1) // second half done, DMA wraps around
+            half = 1;
+
+        EM_DAQ_ROLL_CLR(EM_DMA_ADC1);
+
+        if (half >= 0)
+        {
+            if (em_daq.mode == VM)
+                daq_log_push(&em_daq, half);
+            else
+                daq_roll_push(&em_daq, half);
+        }
+
+        traceISR_EXIT();
+    }
+#endif
+
 /************************************************************************************************************************/
 
 #ifdef EM_LA_CH1_IRQh
@@ -0,0 +1,166 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "cfg.h"
+#include "daq.h"
+#include "daq_log.h"
+#include "daq_roll.h"
+
+#include "main.h"
+#include "util.h"
+
+#include "FreeRTOS.h"
+#include "stream_buffer.h"
+
+#include <string.h>
+
+#ifdef EM_DAQ_ROLL
+
+/* record FIFO and TX scratch live in buff_raw above the DMA circle, ISR is the only writer, comm task the only reader */
+static StaticStreamBuffer_t log_sb_struct;
+static StreamBufferHandle_t log_sb = NULL;
+static uint8_t* log_scratch = NULL;
+
+
+/* called after DMA circle is allocated with no reserve, DAQ disabled */
+int daq_log_start(daq_data_t* self)
+{
+    if (self->buff1.len == 0 || self->log.avg < 1) // ADC1 DMA paces the logger
+        return -1;
+
+    uint32_t top = (self->buff_raw_ptr + 3) & ~3;
+    uint32_t free = sizeof(self->buff_raw) - top;
+    uint32_t scratch = sizeof(daq_log_hdr_t) + ((free / 3) / sizeof(daq_log_rec_t) * sizeof(daq_log_rec_t));
+
+    if (scratch == sizeof(daq_log_hdr_t) || free - scratch < (sizeof(daq_log_rec_t) * 2) + 1)
+        return -1;
+
+    log_scratch = self->buff_raw + top;
+    log_sb = xStreamBufferCreateStatic(free - scratch - 1, 1, self->buff_raw + top + scratch, &log_sb_struct);
+    ASSERT(log_sb != NULL);
+
+    memset(self->log.sum, 0, sizeof(self->log.sum));
+    self->log.cntr = 0;
+    self->log.scratch_len = scratch;
+    self->log.seq = 0;
+    self->log.overruns = 0;
+    self->log.active = EM_TRUE;
+
+    daq_roll_irq(EM_TRUE);
+    return 0;
+}
+
+void daq_log_stop(daq_data_t* self)
+{
+    if (self->log.active == EM_TRUE)
+        daq_roll_irq(EM_FALSE);
+
+    self->log.active = EM_FALSE;
+    log_sb = NULL;
+}
+
+/* from DMA IRQ - every frame of finished half is summed, each avg frames one record goes to FIFO.
+ * Integer sums run across halves, so block length does not depend on DMA circle */
+void daq_log_push(daq_data_t* self, uint8_t half)
+{
+    if (self->log.active == EM_FALSE)
+        return;
+
+    daq_buff_t* buffs[4] = {&self->buff1, &self->buff2, &self->buff3, &self->buff4};
+    uint32_t* sum = self->log.sum;
+    int frames = (self->buff1.len / self->buff1.chans) / 2;
+    BaseType_t woken = pdFALSE;
+
+    for (int f = 0; f < frames; f++)
+    {
+        int v = 0;
+
+        for (int i = 0; i < 4; i++)
+        {
+            int chans = buffs[i]->chans;
+            if (buffs[i]->len == 0)
+                continue;
+
+            int idx = ((half * frames) + f) * chans;
+
+            if (self->set.bits == B12)
+            {
+                uint16_t* data = ((uint16_t*)buffs[i]->data) + idx;
+                for (int c = 0; c < chans && v < 5; c++)
+                    sum[v++] += data[c];
+            }
+            else
+            {
+                uint8_t* data = ((uint8_t*)buffs[i]->data) + idx;
+                for (int c = 0; c < chans && v < 5; c++)
+                    sum[v++] += data[c];
+            }
+        }
+
+        if (++self->log.cntr < self->log.avg)
+            continue;
+
+        uint32_t avg = self->log.avg;
+        daq_log_rec_t rec = {.seq = ++self->log.seq, .n = avg};
+
+        rec.vref = ((sum[0] * EM_LOG_FRAC) + (avg / 2)) / avg;
+        for (int c = 0; c < 4; c++)
+            rec.ch[c] = ((sum[c + 1] * EM_LOG_FRAC) + (avg / 2)) / avg;
+
+        memset(sum, 0, sizeof(self->log.sum));
+        self->log.cntr = 0;
+
+        if (xStreamBufferSpacesAvailable(log_sb) < sizeof(daq_log_rec_t)) // host too slow, record dropped
+            self->log.overruns++;
+        else
+            xStreamBufferSendFromISR(log_sb, &rec, sizeof(daq_log_rec_t), &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/* whole records moved to TX scratch after header, returns length in bytes incl. header */
+uint32_t daq_log_read(daq_data_t* self, daq_log_hdr_t** data)
+{
+    *data = (daq_log_hdr_t*)log_scratch;
+
+    if (self->log.active == EM_FALSE)
+        return 0;
+
+    size_t len = xStreamBufferBytesAvailable(log_sb);
+    if (len > self->log.scratch_len - sizeof(daq_log_hdr_t))
+        len = self->log.scratch_len - sizeof(daq_log_hdr_t);
+    len -= len % sizeof(daq_log_rec_t);
+
+    if (len > 0)
+        len = xStreamBufferReceive(log_sb, log_scratch + sizeof(daq_log_hdr_t), len, 0);
+
+    (*data)->count = len / sizeof(daq_log_rec_t);
+    return sizeof(daq_log_hdr_t) + len;
+}
+
+#else // EM_DAQ_ROLL
+
+int daq_log_start(daq_data_t* self)
+{
+    return -1;
+}
+
+void daq_log_stop(daq_data_t* self)
+{
+    self->log.active = EM_FALSE;
+}
+
+void daq_log_push(daq_data_t* self, uint8_t half)
+{
+}
+
+uint32_t daq_log_read(daq_data_t* self, daq_log_hdr_t** data)
+{
+    *data = NULL;
+    return 0;
+}
+
+#endif
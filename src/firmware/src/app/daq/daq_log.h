@@ -0,0 +1,38 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_DAQ_LOG_H_
+#define INC_DAQ_LOG_H_
+
+#include "daq.h"
+
+#define EM_LOG_AVG_MAX         10000   // max samples in one block average
+#define EM_LOG_FRAC            16      // block averages are sent in 1/16 LSB
+
+
+/* one block average, FIFO entry */
+typedef struct
+{
+    uint32_t seq;           // block number, gap on host = records dropped
+    uint16_t vref;          // vref average [1/16 LSB]
+    uint16_t ch[4];         // ch1..ch4 averages [1/16 LSB], 0 if not available
+    uint16_t n;             // samples averaged
+}daq_log_rec_t;
+
+/* before records in VM:LOG:READ? block */
+typedef struct
+{
+    uint32_t vcc_k;         // vcc [V] = vcc_k / vref / 1000, vref in LSB
+    uint16_t adc_max;       // max adc value
+    uint16_t count;         // number of records
+}daq_log_hdr_t;
+
+
+int daq_log_start(daq_data_t* self);
+void daq_log_stop(daq_data_t* self);
+void daq_log_push(daq_data_t* self, uint8_t half);
+uint32_t daq_log_read(daq_data_t* self, daq_log_hdr_t** data);
+
+#endif /* INC_DAQ_LOG_H_ */
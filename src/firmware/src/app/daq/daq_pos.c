@@ -0,0 +1,64 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "daq_pos.h"
+
+
+/* pos is at most one buffer length off */
+int daq_pos_wrap(int pos, int len)
+{
+    if (pos < 0)
+        return pos + len;
+    if (pos >= len)
+        return pos - len;
+    return pos;
+}
+
+/* DMA items written going from -> to, forward only */
+int daq_pos_dist(int from, int to, int len)
+{
+    return daq_pos_wrap(to - from, len);
+}
+
+int daq_pos_post_frames(int mem, int pretrigger)
+{
+    return (int)((double)mem * ((double)(100 - pretrigger) / 100.0));
+}
+
+/* normal / single trigger, from = normalized catched DMA pos, order = triggered ch from bottom of frame */
+void daq_pos_post_scope(daq_pos_t* p, int from, int order, int len, int chans, int mem, int pretrigger)
+{
+    int post = daq_pos_post_frames(mem, pretrigger);
+
+    p->trig = daq_pos_wrap(from + order, len);
+    p->post = post * chans;
+    p->last = daq_pos_wrap(p->trig + p->post, len);
+    p->frst = daq_pos_wrap(p->trig - ((mem - post + 1) * chans) + 1, len);
+}
+
+void daq_pos_post_la(daq_pos_t* p, int from, int len, int mem, int pretrigger)
+{
+    p->trig = from;
+    p->post = daq_pos_post_frames(mem, pretrigger);
+    p->last = daq_pos_wrap(p->trig + p->post, len);
+    p->frst = daq_pos_wrap(p->trig - (mem - p->post) + 1, len);
+}
+
+/* auto / disabled trigger, mem frames ending before last whole frame at catched DMA pos */
+void daq_pos_now_scope(daq_pos_t* p, int catched, int len, int chans, int mem)
+{
+    p->trig = 0;
+    p->post = 0;
+    p->last = daq_pos_wrap(catched - ((catched % chans) + chans), len);
+    p->frst = daq_pos_wrap(p->last - (chans * (mem - 1)), len);
+}
+
+void daq_pos_now_la(daq_pos_t* p, int catched, int len, int mem)
+{
+    p->trig = 0;
+    p->post = 0;
+    p->last = catched;
+    p->frst = daq_pos_wrap(catched - (mem - 1), len);
+}
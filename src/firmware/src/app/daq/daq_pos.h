@@ -0,0 +1,29 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_DAQ_POS_H_
+#define INC_DAQ_POS_H_
+
+/* circular buffer position arithmetic of trigger, no peripheral access so it builds on host too */
+
+typedef struct
+{
+    int frst;               // first data pos
+    int trig;               // trigger data pos
+    int last;               // last data pos
+    int post;               // post trigger DMA items after trig
+}daq_pos_t;
+
+
+int daq_pos_wrap(int pos, int len);
+int daq_pos_dist(int from, int to, int len);
+int daq_pos_post_frames(int mem, int pretrigger);
+
+void daq_pos_post_scope(daq_pos_t* p, int from, int order, int len, int chans, int mem, int pretrigger);
+void daq_pos_post_la(daq_pos_t* p, int from, int len, int mem, int pretrigger);
+void daq_pos_now_scope(daq_pos_t* p, int catched, int len, int chans, int mem);
+void daq_pos_now_la(daq_pos_t* p, int catched, int len, int mem);
+
+#endif /* INC_DAQ_POS_H_ */
@@ -0,0 +1,189 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "cfg.h"
+#include "daq.h"
+#include "daq_roll.h"
+
+#include "main.h"
+#include "util.h"
+
+#include "FreeRTOS.h"
+#include "stream_buffer.h"
+
+#include <string.h>
+
+#ifdef EM_DAQ_ROLL
+
+/* stream buffer and TX scratch live in buff_raw above the DMA circle, ISR is the only writer, comm task the only reader */
+static StaticStreamBuffer_t roll_sb_struct;
+static StreamBufferHandle_t roll_sb = NULL;
+static uint8_t* roll_scratch = NULL;
+
+
+/* DMA circle per channel lasting EM_ROLL_PERIOD_MS, even so each half holds whole frames,
+ * at most quarter of memory so stream buffer gets the rest */
+uint16_t daq_roll_ring(daq_data_t* self, int chans, int max_len)
+{
+    int ring = self->set.fs / (1000 / EM_ROLL_PERIOD_MS);
+    int ring_max = max_len / (chans * 4);
+
+    if (ring > ring_max)
+        ring = ring_max;
+    if (ring < EM_ROLL_RING_MIN)
+        ring = EM_ROLL_RING_MIN;
+
+    return ring & ~1;
+}
+
+/* called after DMA circle is allocated with no reserve, DAQ disabled */
+int daq_roll_start(daq_data_t* self)
+{
+    daq_buff_t* buffs[4] = {&self->buff1, &self->buff2, &self->buff3, &self->buff4};
+    uint8_t smpl = (self->set.bits == B12) ? 2 : 1;
+    uint32_t block = sizeof(daq_roll_hdr_t);
+
+    if (self->buff1.len == 0) // ADC1 DMA paces the stream
+        return -1;
+
+    for (int i = 0; i < 4; i++)
+        block += (buffs[i]->len / 2) * smpl;
+
+    uint32_t top = (self->buff_raw_ptr + 3) & ~3;
+    uint32_t free = sizeof(self->buff_raw) - top;
+    uint32_t scratch = (free / 3) / block * block;
+
+    if (block > UINT16_MAX || scratch == 0 || free - scratch < (block * 2) + 1) // stream buffer storage needs 1 extra byte
+        return -1;
+
+    roll_scratch = self->buff_raw + top;
+    roll_sb = xStreamBufferCreateStatic(free - scratch - 1, 1, self->buff_raw + top + scratch, &roll_sb_struct);
+    ASSERT(roll_sb != NULL);
+
+    self->roll.block = block;
+    self->roll.ring = buffs[0]->len / buffs[0]->chans;
+    self->roll.scratch_len = scratch;
+    self->roll.seq = 0;
+    self->roll.overruns = 0;
+    self->roll.active = EM_TRUE;
+
+    daq_roll_irq(EM_TRUE);
+    return 0;
+}
+
+void daq_roll_stop(daq_data_t* self)
+{
+    daq_roll_irq(EM_FALSE);
+
+    self->roll.active = EM_FALSE;
+    roll_sb = NULL;
+}
+
+/* ADC1 DMA half / full IRQ, shared by SCOPE roll mode and VM logger */
+void daq_roll_irq(uint8_t enable)
+{
+    if (enable == EM_TRUE)
+    {
+        EM_DAQ_ROLL_CLR(EM_DMA_ADC1);
+        LL_DMA_EnableIT_HT(EM_DMA_ADC1, EM_DMA_CH_ADC1);
+        LL_DMA_EnableIT_TC(EM_DMA_ADC1, EM_DMA_CH_ADC1);
+
+        NVIC_SetPriority(EM_IRQN_DAQ_ROLL, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), EM_IT_PRI_ADC, 0));
+        NVIC_ClearPendingIRQ(EM_IRQN_DAQ_ROLL);
+        NVIC_EnableIRQ(EM_IRQN_DAQ_ROLL);
+    }
+    else
+    {
+        NVIC_DisableIRQ(EM_IRQN_DAQ_ROLL);
+        LL_DMA_DisableIT_HT(EM_DMA_ADC1, EM_DMA_CH_ADC1);
+        LL_DMA_DisableIT_TC(EM_DMA_ADC1, EM_DMA_CH_ADC1);
+        EM_DAQ_ROLL_CLR(EM_DMA_ADC1);
+    }
+}
+
+/* from DMA IRQ - finished half of every buffer as one block: header, buff1 half, buff2 half.. */
+void daq_roll_push(daq_data_t* self, uint8_t half)
+{
+    if (self->roll.active == EM_FALSE)
+        return;
+
+    daq_buff_t* buffs[4] = {&self->buff1, &self->buff2, &self->buff3, &self->buff4};
+    uint8_t smpl = (self->set.bits == B12) ? 2 : 1;
+    BaseType_t woken = pdFALSE;
+
+    self->roll.seq++;
+
+    if (xStreamBufferSpacesAvailable(roll_sb) < self->roll.block) // host too slow, whole block dropped
+    {
+        self->roll.overruns++;
+        return;
+    }
+
+    daq_roll_hdr_t hdr = {self->roll.seq, self->roll.ring / 2, self->roll.block};
+    xStreamBufferSendFromISR(roll_sb, &hdr, sizeof(daq_roll_hdr_t), &woken);
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (buffs[i]->len == 0)
+            continue;
+
+        uint32_t half_len = (buffs[i]->len / 2) * smpl;
+        xStreamBufferSendFromISR(roll_sb, ((uint8_t*)buffs[i]->data) + (half * half_len), half_len, &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/* whole blocks moved to TX scratch, returns length in bytes */
+uint32_t daq_roll_read(daq_data_t* self, uint8_t** data)
+{
+    *data = roll_scratch;
+
+    if (self->roll.active == EM_FALSE)
+        return 0;
+
+    size_t len = xStreamBufferBytesAvailable(roll_sb);
+    if (len > self->roll.scratch_len)
+        len = self->roll.scratch_len;
+    len -= len % self->roll.block;
+
+    if (len == 0)
+        return 0;
+
+    return xStreamBufferReceive(roll_sb, roll_scratch, len, 0);
+}
+
+#else // EM_DAQ_ROLL
+
+uint16_t daq_roll_ring(daq_data_t* self, int chans, int max_len)
+{
+    return 0;
+}
+
+int daq_roll_start(daq_data_t* self)
+{
+    return -1;
+}
+
+void daq_roll_stop(daq_data_t* self)
+{
+    self->roll.active = EM_FALSE;
+}
+
+void daq_roll_irq(uint8_t enable)
+{
+}
+
+void daq_roll_push(daq_data_t* self, uint8_t half)
+{
+}
+
+uint32_t daq_roll_read(daq_data_t* self, uint8_t** data)
+{
+    *data = NULL;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,31 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_DAQ_ROLL_H_
+#define INC_DAQ_ROLL_H_
+
+#include "daq.h"
+
+#define EM_ROLL_PERIOD_MS      20      // DMA circle duration, half of it is pushed per IRQ
+#define EM_ROLL_RING_MIN       16      // min DMA circle per channel in samples
+
+
+/* before each block, followed by half of every DMA buffer in order buff1..buff4 */
+typedef struct
+{
+    uint32_t seq;           // DMA half number, gap on host = blocks dropped
+    uint16_t frames;        // samples per channel in this block
+    uint16_t len;           // whole block length in bytes incl. this header
+}daq_roll_hdr_t;
+
+
+uint16_t daq_roll_ring(daq_data_t* self, int chans, int max_len);
+int daq_roll_start(daq_data_t* self);
+void daq_roll_stop(daq_data_t* self);
+void daq_roll_irq(uint8_t enable);
+void daq_roll_push(daq_data_t* self, uint8_t half);
+uint32_t daq_roll_read(daq_data_t* self, uint8_t** data);
+
+#endif /* INC_DAQ_ROLL_H_ */
@@ -0,0 +1,83 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "cfg.h"
+#include "daq.h"
+#include "daq_seg.h"
+
+#include "util.h"
+
+#include <string.h>
+
+
+/* segments are copies of all DMA buffers back to back from buff_raw start, header table right after the last one */
+static daq_seg_hdr_t* daq_seg_hdr(daq_data_t* self)
+{
+    return (daq_seg_hdr_t*)(self->buff_raw + (self->seg.num * self->seg.stride));
+}
+
+/* called after buffers of first segment are allocated, offset is their word aligned size, DAQ disabled,
+ * memory which does not fit at least twice stays single */
+void daq_seg_start(daq_data_t* self, uint16_t offset)
+{
+    uint32_t num = sizeof(self->buff_raw) / (offset + sizeof(daq_seg_hdr_t));
+
+    if (num > self->seg.en)
+        num = self->seg.en;
+    if (num < 2)
+        return;
+
+    memset(self->buff_raw + offset, 0, offset * (num - 1));
+
+    self->seg.stride = offset;
+    self->seg.num = num;
+    self->seg.cnt = 0;
+    self->seg.active = EM_TRUE;
+    self->buff_raw_ptr = (offset * num) + (num * sizeof(daq_seg_hdr_t));
+}
+
+/* stores finished capture, DAQ disabled, returns EM_TRUE if DMA was moved to next free segment and DAQ can re-arm
+ * right away, EM_FALSE if all are filled (or last is set) and data are ready to read */
+uint8_t daq_seg_next(daq_data_t* self, uint32_t time_us, uint8_t last)
+{
+    ASSERT(self->seg.cnt < self->seg.num);
+
+    daq_seg_hdr_t* hdr = daq_seg_hdr(self) + self->seg.cnt;
+
+    hdr->time_us = time_us;
+    hdr->frst = self->trig.pos_frst;
+    hdr->len = self->seg.stride;
+
+    self->seg.cnt++;
+
+    if (last == EM_TRUE || self->seg.cnt >= self->seg.num)
+        return EM_FALSE;
+
+    daq_buff_move(self, self->seg.stride);
+    return EM_TRUE;
+}
+
+/* DMA back to first segment, DAQ disabled */
+void daq_seg_rewind(daq_data_t* self)
+{
+    if (self->seg.active == EM_FALSE)
+        return;
+
+    int slot = (self->seg.cnt < self->seg.num) ? self->seg.cnt : self->seg.num - 1; // full sequence stays on last
+
+    if (slot > 0)
+        daq_buff_move(self, -(slot * (int)self->seg.stride));
+
+    self->seg.cnt = 0;
+}
+
+/* header table and captured segments, both zero-copy from buff_raw, returns segments count */
+uint16_t daq_seg_read(daq_data_t* self, uint8_t** hdr, uint8_t** data)
+{
+    *hdr = (uint8_t*)daq_seg_hdr(self);
+    *data = self->buff_raw;
+
+    return self->seg.cnt;
+}
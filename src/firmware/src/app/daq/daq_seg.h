@@ -0,0 +1,28 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_DAQ_SEG_H_
+#define INC_DAQ_SEG_H_
+
+#include "daq.h"
+
+#define EM_SEG_MAX             1024    // max segments wanted by user
+
+
+/* one per captured segment, table is sent before segment data */
+typedef struct
+{
+    uint32_t time_us;       // trigger time, free running 32 bit microseconds
+    uint16_t frst;          // first sample pos in circular segment, as in ReadyX
+    uint16_t len;           // segment length in bytes, same for all
+}daq_seg_hdr_t;
+
+
+void daq_seg_start(daq_data_t* self, uint16_t offset);
+uint8_t daq_seg_next(daq_data_t* self, uint32_t time_us, uint8_t last);
+void daq_seg_rewind(daq_data_t* self);
+uint16_t daq_seg_read(daq_data_t* self, uint8_t** hdr, uint8_t** data);
+
+#endif /* INC_DAQ_SEG_H_ */
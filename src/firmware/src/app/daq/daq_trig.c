@@ -6,6 +6,8 @@
 #include "cfg.h"
 #include "daq.h"
 #include "daq_trig.h"
+#include "daq_pos.h"
+#include "daq_seg.h"
 
 #include "app_sync.h"
 #include "comm/comm.h"
@@ -68,6 +70,9 @@ void daq_trig_init(daq_data_t* self)
 
 void daq_trig_check(daq_data_t* self)
 {
+    if (self->roll.active == EM_TRUE) // no trigger in roll mode, DMA IRQ streams the data
+        return;
+
     if (self->enabled == EM_TRUE) // check pre trigger - if sufficient amount of data available, enable trigger
     {
         self->trig.pretrig_cntr = self->uwTick - self->trig.uwtick_first;
@@ -82,6 +87,9 @@ void daq_trig_check(daq_data_t* self)
             daq_enable(self, EM_FALSE);
 
             self->trig.pos_frst = EM_DMA_LAST_IDX(self->trig.buff_trig->len, self->trig.dma_ch_trig, self->trig.dma_trig);
+            if (self->seg.active == EM_TRUE) // forced capture ends the sequence
+                daq_seg_next(self, daq_time_us(self), EM_TRUE);
+
             comm_daq_ready(comm_ptr, EM_RESP_RDY_F, self->trig.pos_frst);
         }
         else if (self->trig.irq_en == EM_FALSE && self->trig.pretrig_cntr > self->trig.pretrig_val && self->trig.set.mode != DISABLED) // enable IRQ
@@ -155,27 +163,31 @@ void daq_trig_check(daq_data_t* self)
             int catched = EM_DMA_LAST_IDX(self->trig.buff_trig->len, self->trig.dma_ch_trig, self->trig.dma_trig);
             daq_enable(self, EM_FALSE);
 
+            daq_pos_t pos;
+
             if (self->mode == SCOPE)
             {
-                self->trig.pos_last = catched - ((catched % self->trig.buff_trig->chans) + self->trig.buff_trig->chans);
-
-                if (self->trig.pos_last < 0)
-                    self->trig.pos_last += self->trig.buff_trig->len;
-
-                self->trig.pos_frst = self->trig.pos_last - (self->trig.buff_trig->chans * (self->set.mem - 1)); // + 1
-                if (self->trig.pos_frst < 0)
-                    self->trig.pos_frst += self->trig.buff_trig->len;
+                daq_pos_now_scope(&pos, catched, self->trig.buff_trig->len, self->trig.buff_trig->chans, self->set.mem);
+                self->trig.pos_last = pos.last;
+                self->trig.pos_frst = pos.frst;
             }
             else
             {
-                self->trig.pos_frst = catched - (1 * (self->set.mem - 1));
-                if (self->trig.pos_frst < 0)
-                    self->trig.pos_frst += self->trig.buff_trig->len;
+                daq_pos_now_la(&pos, catched, self->trig.buff_trig->len, self->set.mem);
+                self->trig.pos_frst = pos.frst;
             }
 
-            self->trig.ready = EM_TRUE;
             self->trig.is_post = EM_FALSE;
 
+            if (self->seg.active == EM_TRUE && daq_seg_next(self, daq_time_us(self), EM_FALSE) == EM_TRUE)
+            {
+                daq_enable(self, EM_TRUE); // next segment, ready once all are filled
+                self->trig.ready_last = self->trig.ready;
+                return;
+            }
+
+            self->trig.ready = EM_TRUE;
+
             if (aut_or_dis == 1)
                 comm_daq_ready(comm_ptr, EM_RESP_RDY_A, self->trig.pos_frst);       // data ready - trig auto
             else if (aut_or_dis == 2)
@@ -324,6 +336,9 @@ int8_t daq_trig_poststart(daq_data_t* self, int pos)
     self->trig.post_from = pos;
     self->trig.pretrig_cntr = 0;
 
+    if (self->seg.active == EM_TRUE)
+        self->seg.trig_us = daq_time_us(self);
+
     portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
     ASSERT(xSemaphoreGiveFromISR(sem2_trig, &xHigherPriorityTaskWoken) == pdPASS);
     portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
@@ -331,100 +346,109 @@ int8_t daq_trig_poststart(daq_data_t* self, int pos)
     return -1;
 }
 
-void daq_trig_postcount(daq_data_t* self) // TODO slow start ??!! 600 samples (800 ksps)
+/* post-trigger end is known at trigger time as DMA progress from post_from, task sleeps on sem6_post through the window
+ * (mtx1 free for comm) and only the last tick is counted on DMA, then sampling stops before mtx1 is taken */
+void daq_trig_postcount(daq_data_t* self)
 {
+    ASSERT(self->trig.buff_trig != NULL);
 
-    int last_idx = self->trig.post_from;
+    uint32_t epoch = self->trig.post_epoch;
+    int len = self->trig.buff_trig->len;
+    int frame = (self->mode == SCOPE) ? self->trig.buff_trig->chans : 1; // DMA items per DAQ timer tick
+    daq_pos_t pos;
 
-    ASSERT(self->trig.buff_trig != NULL);
+    xSemaphoreTake(sem6_post, 0); // stale abort from previous capture
 
     self->trig.is_post = EM_TRUE;
     self->trig.cntr++;
 
     if (self->mode == SCOPE)
-    {
-        self->trig.pos_trig = last_idx + self->trig.order;
-        if (self->trig.pos_trig >= self->trig.buff_trig->len)
-            self->trig.pos_trig -= self->trig.buff_trig->len;
-
-        int post = (int)((double)self->set.mem * ((double)(100 - self->trig.set.pretrigger) / 100.0));
-        self->trig.posttrig_size = post * self->trig.buff_trig->chans;
-
-        self->trig.pos_last = self->trig.pos_trig + self->trig.posttrig_size;
-        if (self->trig.pos_last >= self->trig.buff_trig->len)
-            self->trig.pos_last -= self->trig.buff_trig->len;
-
-        self->trig.pos_frst = self->trig.pos_trig - ((self->set.mem - post + 1) * self->trig.buff_trig->chans) + 1;
+        daq_pos_post_scope(&pos, self->trig.post_from, self->trig.order, len, frame, self->set.mem, self->trig.set.pretrigger);
+    else
+        daq_pos_post_la(&pos, self->trig.post_from, len, self->set.mem, self->trig.set.pretrigger);
 
-        if (self->trig.pos_frst < 0)
-            self->trig.pos_frst += self->trig.buff_trig->len;
-    }
-    else // mode == LA
-    {
-        self->trig.pos_trig = last_idx;
-        self->trig.posttrig_size = (int)((double)self->set.mem * ((double)(100 - self->trig.set.pretrigger) / 100.0));
+    self->trig.pos_trig = pos.trig;
+    self->trig.pos_last = pos.last;
+    self->trig.pos_frst = pos.frst;
+    self->trig.posttrig_size = pos.post;
 
-        self->trig.pos_last = self->trig.pos_trig + self->trig.posttrig_size;
-        if (self->trig.pos_last >= self->trig.buff_trig->len)
-            self->trig.pos_last -= self->trig.buff_trig->len;
+    /* sleep through most of the window, fs_real is upper bound of ticks per second so wake up is never late */
+    int done = daq_pos_dist(self->trig.post_from, EM_DMA_LAST_IDX(len, self->trig.dma_ch_trig, self->trig.dma_trig), len);
+    double left_ms = ((double)(pos.post - done) / frame) * 1000.0 / self->set.fs_real;
 
-        self->trig.pos_frst = self->trig.pos_trig - (self->set.mem - self->trig.posttrig_size) + 1;
-        if (self->trig.pos_frst < 0)
-            self->trig.pos_frst += self->trig.buff_trig->len;
-    }
+    if (done < pos.post && left_ms > EM_TRIG_POST_SLEEP_MS)
+        xSemaphoreTake(sem6_post, (TickType_t)(left_ms - 1) / portTICK_PERIOD_MS); // given early by daq_enable
 
-    //int pos_last_len = self->trig.buff_trig->len - self->trig.pos_last;  // DMA len of last valid point to compare
-    int target_prev = self->trig.buff_trig->len - self->trig.post_from;
+    /* count the rest on DMA */
+    int target_prev = len - self->trig.post_from;
     int target_sum = 0;
 
-    while(1)
+    while (self->trig.post_epoch == epoch)
     {
-    	EM_IWDG_RST;  // 1
+        EM_IWDG_RST;
 
-        // 15 instructions worst case
-        // Cortex M3 - 1.25 IPC per core -> 72/(15/1.25) = 6 MHz max
-        int target = LL_DMA_GetDataLength(self->trig.dma_trig, self->trig.dma_ch_trig); // 6
+        int target = LL_DMA_GetDataLength(self->trig.dma_trig, self->trig.dma_ch_trig);
 
         int target_diff = target_prev - target;
         if (target_diff >= 0)
             target_sum += target_diff;
         else
-            target_sum += target_diff + self->trig.buff_trig->len;
+            target_sum += target_diff + len;
 
         target_prev = target;
 
-        if (target_sum >= self->trig.posttrig_size) // pos_last_len == target
+        if (target_sum >= pos.post)
         {
-            LL_TIM_DisableCounter(EM_TIM_DAQ);
+            LL_TIM_DisableCounter(EM_TIM_DAQ); // data is safe now, finish can wait for mtx1
+            break;
+        }
+    }
 
-            daq_enable(self, EM_FALSE);
-            self->trig.ready = EM_TRUE;
-            self->trig.is_post = EM_FALSE;
+    ASSERT(xSemaphoreTake(mtx1, portMAX_DELAY) == pdPASS);
 
-            self->trig.pos_diff = self->trig.pos_last - self->trig.pos_trig;
-            if (self->trig.pos_diff < 0)
-                self->trig.pos_diff += self->trig.buff_trig->len;
+    if (self->trig.post_epoch != epoch) // DAQ was disabled or reconfigured meanwhile, capture is void
+    {
+        self->trig.is_post = EM_FALSE;
+        self->trig.post_start = EM_FALSE;
 
-            //self->trig.respond = EM_TRUE; // init async respond ReadyX
+        ASSERT(xSemaphoreGive(mtx1) == pdPASS);
+        return;
+    }
 
-            if (self->trig.forced == EM_TRUE)
-            {
-                comm_daq_ready(comm_ptr, EM_RESP_RDY_F, self->trig.pos_frst);   // data ready - trig forced
-                self->trig.forced = EM_FALSE;
-            }
-            else if (self->trig.set.mode == SINGLE)
-            {
-                comm_daq_ready(comm_ptr, EM_RESP_RDY_S, self->trig.pos_frst);   // data ready - trig single
-            }
-            else
-            {
-                comm_daq_ready(comm_ptr, EM_RESP_RDY_N, self->trig.pos_frst);   // data ready - trig normal
-            }
+    daq_enable(self, EM_FALSE);
+    self->trig.is_post = EM_FALSE;
 
-            break;
-        }
+    self->trig.pos_diff = daq_pos_dist(self->trig.pos_trig, self->trig.pos_last, len);
+
+    /* segmented memory re-arms into next segment right here, without waiting for readout */
+    if (self->seg.active == EM_TRUE && daq_seg_next(self, self->seg.trig_us, self->trig.forced) == EM_TRUE)
+    {
+        self->trig.post_start = EM_FALSE;
+        daq_enable(self, EM_TRUE);
+
+        ASSERT(xSemaphoreGive(mtx1) == pdPASS);
+        return;
+    }
+
+    self->trig.ready = EM_TRUE;
+
+    if (self->trig.forced == EM_TRUE)
+    {
+        comm_daq_ready(comm_ptr, EM_RESP_RDY_F, self->trig.pos_frst);   // data ready - trig forced
+        self->trig.forced = EM_FALSE;
     }
+    else if (self->trig.set.mode == SINGLE)
+    {
+        comm_daq_ready(comm_ptr, EM_RESP_RDY_S, self->trig.pos_frst);   // data ready - trig single
+    }
+    else
+    {
+        comm_daq_ready(comm_ptr, EM_RESP_RDY_N, self->trig.pos_frst);   // data ready - trig normal
+    }
+
     self->trig.post_start = EM_FALSE;
+
+    ASSERT(xSemaphoreGive(mtx1) == pdPASS);
 }
 
 void daq_trig_update(daq_data_t* self)
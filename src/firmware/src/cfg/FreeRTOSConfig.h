@@ -47,7 +47,7 @@
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION  1
 #endif
 #define configUSE_TIMERS                         0
-#define configUSE_COUNTING_SEMAPHORES            0
+#define configUSE_COUNTING_SEMAPHORES            1
 #define configUSE_RECURSIVE_MUTEXES              0
 
 /* Co-routine definitions. */
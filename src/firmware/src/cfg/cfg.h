@@ -15,7 +15,7 @@
 #define EM_DEBUG      // auto enable PWM, SGEN on start and more verbose
 //#define EM_SYSVIEW  // SEGGER System View enabled - less DAQ memory
 
-#define EM_DEV_VER      "0.2.4"
+#define EM_DEV_VER      "0.2.5"
 #define EM_DEV_AUTHOR   "CTU/Jakub Parez"
 
 
@@ -23,9 +23,29 @@
  +                                               board specific                                              +
  +-----------------------------------------------------------------------------------------------------------*/
 
+/*................................................... HOST ..................................................*/
+
+#if defined(EM_HOST)
+
+    #define EM_CORTEX_M3
+
+    /*
+     * F103C8 register model running on PC, see board/HOST
+     * =========layout=========
+     *  DAQ CH1 ........... sine
+     *  DAQ CH2 ........... square
+     *  DAQ CH3 ........... triangle
+     *  DAQ CH4 ........... noisy sine
+     *  LA CH1-4 .......... binary counter
+     *  UART .............. pty
+     *  =======================
+     */
+
+    #include "cfg_host.h"
+
 /*.................................................. F103C8 .................................................*/
 
-#if defined(STM32F103xB)
+#elif defined(STM32F103xB)
 
     #define EM_F103C8
     #define EM_CORTEX_M3
@@ -233,6 +253,7 @@
 // DAQ common ------------------------------------------------------
 #define EM_AUTRIG_MIN_MS       500   // auto trigger ms delay
 #define EM_PRETRIG_MIN_MS      10    // pre trigger minimum ms
+#define EM_TRIG_POST_SLEEP_MS  2     // post trigger window longer than this is slept through, rest counted on DMA
 
 // Counter common --------------------------------------------------
 #define EM_CNTR_BUFF_SZ        200   // buffer size for high frequencies - fast mode
@@ -243,6 +264,7 @@
 // Voltmeter common ------------------------------------------------
 #define EM_VM_FS               100  // voltmeter fs (Hz)
 #define EM_VM_MEM              100  // voltmeter mem
+#define EM_VM_BIN_MAX          25   // voltmeter max records in one binary read
 
 // LED timing ------------------------------------------------------
 #define EM_BLINK_LONG_MS       500  // long blink - startup
@@ -26,7 +26,7 @@
 
 // device -----------------------------------------------------------
 #define EM_DEV_NAME            "EMBO-STM32F103C8-BluePill"   // device specific name
-#define EM_DEV_COMM            "USB + USART1 (115200 bps)"   // device comm methods
+#define EM_DEV_COMM            "USB + USART1 (115200 - 2000000 bps)"   // device comm methods
 #define EM_LL_VER              "1.8.3"                       // STM32 CubeMX LL drivers
 
 // pins strings -----------------------------------------------------
@@ -68,6 +68,14 @@
 #define EM_UART_CLEAR_FLAG(x)  LL_USART_ClearFlag_RXNE(x);  // RXNE flags needs clearing
 #define EM_USB                                      // if emulated USB enabled
 //#define EM_UART_POLLINIT                          // if defined poll for init
+#define EM_UART_BAUD           115200               // UART baud after reset
+#define EM_UART_BAUD_MAX       2000000              // max baud for SYS:BAUD, exact divider
+#define EM_UART_SET_BAUD(x,b)  LL_USART_SetBaudRate(x, 72000000, b)  // USART1 on APB2 72 MHz
+#define EM_UART_TX_DMA                              // if defined UART TX is done by DMA
+#define EM_UART_TX_ADDR        LL_USART_DMA_GetRegAddr(EM_UART)
+#define EM_UART_TX_IRQh        DMA1_Channel4_IRQHandler  // UART TX DMA IRQ handler
+#define EM_UART_TX_DMA_TC(x)   LL_DMA_IsActiveFlag_TC4(x)       // UART TX DMA transfer complete?
+#define EM_UART_TX_DMA_CLR(x)  LL_DMA_ClearFlag_GI4(x)          // UART TX DMA clear flags
 
 // LED -------------------------------------------------------------
 #define EM_LED                                        // LED enabled
@@ -186,6 +194,12 @@
 //#define EM_ADC3_IRQh         ADC3_IRQHandler
 //#define EM_ADC4_IRQh         ADC4_IRQHandler
 
+#define EM_DAQ_ROLL                                      // if defined SCOPE roll mode streams ADC1 DMA halves
+#define EM_DAQ_ROLL_IRQh       DMA1_Channel1_IRQHandler  // ADC1 DMA half / full transfer IRQ handler
+#define EM_DAQ_ROLL_HT(x)      LL_DMA_IsActiveFlag_HT1(x)       // ADC1 DMA half transfer?
+#define EM_DAQ_ROLL_TC(x)      LL_DMA_IsActiveFlag_TC1(x)       // ADC1 DMA transfer complete?
+#define EM_DAQ_ROLL_CLR(x)     LL_DMA_ClearFlag_GI1(x)          // ADC1 DMA clear flags
+
 // DMA -------------------------------------------------------------
 #define EM_DMA_ADC1            DMA1
 //#define EM_DMA_ADC2          DMA1
@@ -196,6 +210,7 @@
 #define EM_DMA_CNTR2           DMA1
 //#define EM_DMA_SGEN          DMA1
 //#define EM_DMA_SGEN2         DMA1
+#define EM_DMA_UART_TX         DMA1
 
 // DMA channels ----------------------------------------------------
 #define EM_DMA_CH_ADC1         LL_DMA_CHANNEL_1
@@ -207,6 +222,7 @@
 #define EM_DMA_CH_CNTR2        LL_DMA_CHANNEL_3
 //#define EM_DMA_CH_SGEN       LL_DMA_CHANNEL_2
 //#define EM_DMA_CH_SGEN2      LL_DMA_CHANNEL_4
+#define EM_DMA_CH_UART_TX      LL_DMA_CHANNEL_4
 
 // IRQ map ---------------------------------------------------------
 #define EM_IRQN_ADC1           ADC1_2_IRQn
@@ -214,6 +230,8 @@
 //#define EM_IRQN_ADC3         ADC3_IRQn
 //#define EM_IRQN_ADC4         ADC4_IRQn
 #define EM_IRQN_UART           USART1_IRQn
+#define EM_IRQN_UART_TX        DMA1_Channel4_IRQn
+#define EM_IRQN_DAQ_ROLL       DMA1_Channel1_IRQn
 #define EM_LA_IRQ_EXTI1        EXTI1_IRQn
 #define EM_LA_IRQ_EXTI2        EXTI2_IRQn
 #define EM_LA_IRQ_EXTI3        EXTI3_IRQn
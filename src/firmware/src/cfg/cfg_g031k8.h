@@ -25,7 +25,7 @@
 
 // device -----------------------------------------------------------
 #define EM_DEV_NAME            "EMBO-STM32G031K8-Nucleo32" // device specific name
-#define EM_DEV_COMM            "USART2 (115200 bps)"       // device comm methods
+#define EM_DEV_COMM            "USART2 (115200 - 2000000 bps)"       // device comm methods
 #define EM_LL_VER              "1.3.0"                     // STM32 CubeMX LL drivers
 
 // pins ------------------------------------------------------------
@@ -67,6 +67,10 @@
 //#define EM_UART_CLEAR_FLAG(x)  LL_USART_ClearFlag_RXNE(x);  // RXNE flags needs clearing
 //#define EM_USB                                    // if emulated USB enabled
 #define EM_UART_POLLINIT                            // if defined poll for init
+#define EM_UART_BAUD           115200               // UART baud after reset
+#define EM_UART_BAUD_MAX       2000000              // max baud for SYS:BAUD, exact divider
+#define EM_UART_SET_BAUD(x,b)  LL_USART_SetBaudRate(x, 64000000, LL_USART_PRESCALER_DIV1, LL_USART_OVERSAMPLING_16, b)  // USART2 on PCLK1 64 MHz
+//#define EM_UART_TX_DMA                            // no free DMA channel with own IRQ, TX polled
 
 // LED -------------------------------------------------------------
 //#define EM_LED                                    // LED enabled
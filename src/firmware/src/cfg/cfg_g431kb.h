@@ -32,7 +32,7 @@
 
 // device -----------------------------------------------------------
 #define EM_DEV_NAME            "EMBO-STM32G431KB-Nucleo32"   // device specific name
-#define EM_DEV_COMM            "USB + USART2 (115200 bps)"         // device comm methods
+#define EM_DEV_COMM            "USB + USART2 (115200 - 3000000 bps)"         // device comm methods
 #define EM_LL_VER              "1.3.0"                      // STM32 CubeMX LL drivers
 
 // pins ------------------------------------------------------------
@@ -73,6 +73,15 @@
 //#define EM_UART_CLEAR_FLAG(x)  LL_USART_ClearFlag_RXNE(x);  // RXNE flags needs clearing
 #define EM_USB                                      // if emulated USB enab
 #define EM_UART_POLLINIT                            // if defined poll for init
+#define EM_UART_BAUD           115200               // UART baud after reset
+#define EM_UART_BAUD_MAX       3000000              // max baud for SYS:BAUD, exact divider
+#define EM_UART_SET_BAUD(x,b)  LL_USART_SetBaudRate(x, 150000000, LL_USART_PRESCALER_DIV1, LL_USART_OVERSAMPLING_16, b)  // USART2 on PCLK1 150 MHz
+#define EM_UART_TX_DMA                              // if defined UART TX is done by DMA
+#define EM_UART_TX_ADDR        LL_USART_DMA_GetRegAddr(EM_UART, LL_USART_DMA_REG_DATA_TRANSMIT)
+#define EM_UART_TX_IRQh        DMA2_Channel2_IRQHandler  // UART TX DMA IRQ handler
+#define EM_UART_TX_DMA_TC(x)   LL_DMA_IsActiveFlag_TC2(x)       // UART TX DMA transfer complete?
+#define EM_UART_TX_DMA_CLR(x)  LL_DMA_ClearFlag_GI2(x)          // UART TX DMA clear flags
+#define EM_DMA_UART_TX_REQ     LL_DMAMUX_REQ_USART2_TX
 
 // LED -------------------------------------------------------------
 #define EM_LED                                      // LED enabled
@@ -190,6 +199,12 @@
 //#define EM_ADC3_IRQh         ADC3_IRQHandler
 //#define EM_ADC4_IRQh         ADC4_IRQHandler
 
+#define EM_DAQ_ROLL                                      // if defined SCOPE roll mode streams ADC1 DMA halves
+#define EM_DAQ_ROLL_IRQh       DMA1_Channel1_IRQHandler  // ADC1 DMA half / full transfer IRQ handler
+#define EM_DAQ_ROLL_HT(x)      LL_DMA_IsActiveFlag_HT1(x)       // ADC1 DMA half transfer?
+#define EM_DAQ_ROLL_TC(x)      LL_DMA_IsActiveFlag_TC1(x)       // ADC1 DMA transfer complete?
+#define EM_DAQ_ROLL_CLR(x)     LL_DMA_ClearFlag_GI1(x)          // ADC1 DMA clear flags
+
 // DMA -------------------------------------------------------------
 #define EM_DMA_ADC1            DMA1
 #define EM_DMA_ADC2            DMA1
@@ -200,6 +215,7 @@
 #define EM_DMA_CNTR2           DMA2
 #define EM_DMA_SGEN            DMA1
 #define EM_DMA_SGEN2           DMA1
+#define EM_DMA_UART_TX         DMA2
 
 // DMA channels ----------------------------------------------------
 #define EM_DMA_CH_ADC1         LL_DMA_CHANNEL_1
@@ -211,6 +227,7 @@
 #define EM_DMA_CH_CNTR2        LL_DMA_CHANNEL_1
 #define EM_DMA_CH_SGEN         LL_DMA_CHANNEL_4
 #define EM_DMA_CH_SGEN2        LL_DMA_CHANNEL_5
+#define EM_DMA_CH_UART_TX      LL_DMA_CHANNEL_2
 
 // IRQ map ---------------------------------------------------------
 #define EM_IRQN_ADC1           ADC1_2_IRQn
@@ -218,6 +235,8 @@
 //#define EM_IRQN_ADC3         ADC3_IRQn
 //#define EM_IRQN_ADC4         ADC4_IRQn
 #define EM_IRQN_UART           USART2_IRQn
+#define EM_IRQN_UART_TX        DMA2_Channel2_IRQn
+#define EM_IRQN_DAQ_ROLL       DMA1_Channel1_IRQn
 #define EM_LA_IRQ_EXTI1        EXTI0_IRQn
 #define EM_LA_IRQ_EXTI2        EXTI1_IRQn
 #define EM_LA_IRQ_EXTI3        EXTI9_5_IRQn
@@ -29,7 +29,7 @@
 
 // device -----------------------------------------------------------
 #define EM_DEV_NAME            "EMBO-STM32L412KB-Nucleo32"   // device specific name
-#define EM_DEV_COMM            "USB + USART2 (115200 bps)"         // device comm methods
+#define EM_DEV_COMM            "USB + USART2 (115200 - 4000000 bps)"         // device comm methods
 #define EM_LL_VER              "1.16.0"                      // STM32 CubeMX LL drivers
 
 // pins ------------------------------------------------------------
@@ -70,6 +70,15 @@
 //#define EM_UART_CLEAR_FLAG(x)  LL_USART_ClearFlag_RXNE(x);  // RXNE flags needs clearing
 #define EM_USB                                      // if emulated USB enab
 #define EM_UART_POLLINIT                            // if defined poll for init
+#define EM_UART_BAUD           115200               // UART baud after reset
+#define EM_UART_BAUD_MAX       4000000              // max baud for SYS:BAUD, exact divider
+#define EM_UART_SET_BAUD(x,b)  LL_USART_SetBaudRate(x, 80000000, LL_USART_OVERSAMPLING_16, b)  // USART2 on PCLK1 80 MHz
+#define EM_UART_TX_DMA                              // if defined UART TX is done by DMA
+#define EM_UART_TX_ADDR        LL_USART_DMA_GetRegAddr(EM_UART, LL_USART_DMA_REG_DATA_TRANSMIT)
+#define EM_UART_TX_IRQh        DMA1_Channel7_IRQHandler  // UART TX DMA IRQ handler
+#define EM_UART_TX_DMA_TC(x)   LL_DMA_IsActiveFlag_TC7(x)       // UART TX DMA transfer complete?
+#define EM_UART_TX_DMA_CLR(x)  LL_DMA_ClearFlag_GI7(x)          // UART TX DMA clear flags
+#define EM_DMA_UART_TX_REQ     LL_DMA_REQUEST_2
 
 // LED -------------------------------------------------------------
 #define EM_LED                                        // LED enabled
@@ -187,6 +196,12 @@
 //#define EM_ADC3_IRQh         ADC3_IRQHandler
 //#define EM_ADC4_IRQh         ADC4_IRQHandler
 
+#define EM_DAQ_ROLL                                      // if defined SCOPE roll mode streams ADC1 DMA halves
+#define EM_DAQ_ROLL_IRQh       DMA1_Channel1_IRQHandler  // ADC1 DMA half / full transfer IRQ handler
+#define EM_DAQ_ROLL_HT(x)      LL_DMA_IsActiveFlag_HT1(x)       // ADC1 DMA half transfer?
+#define EM_DAQ_ROLL_TC(x)      LL_DMA_IsActiveFlag_TC1(x)       // ADC1 DMA transfer complete?
+#define EM_DAQ_ROLL_CLR(x)     LL_DMA_ClearFlag_GI1(x)          // ADC1 DMA clear flags
+
 // DMA -------------------------------------------------------------
 #define EM_DMA_ADC1            DMA1
 #define EM_DMA_ADC2            DMA2
@@ -197,6 +212,7 @@
 #define EM_DMA_CNTR2           DMA1
 //#define EM_DMA_SGEN          DMA1
 //#define EM_DMA_SGEN2         DMA1
+#define EM_DMA_UART_TX         DMA1
 
 // DMA channels ----------------------------------------------------
 #define EM_DMA_CH_ADC1         LL_DMA_CHANNEL_1
@@ -208,6 +224,7 @@
 #define EM_DMA_CH_CNTR2        LL_DMA_CHANNEL_3
 //#define EM_DMA_CH_SGEN       LL_DMA_CHANNEL_3
 //#define EM_DMA_CH_SGEN2      LL_DMA_CHANNEL_4
+#define EM_DMA_CH_UART_TX      LL_DMA_CHANNEL_7
 
 // IRQ map ---------------------------------------------------------
 #define EM_IRQN_ADC1           ADC1_2_IRQn
@@ -215,6 +232,8 @@
 //#define EM_IRQN_ADC3         ADC3_IRQn
 //#define EM_IRQN_ADC4         ADC4_IRQn
 #define EM_IRQN_UART           USART2_IRQn
+#define EM_IRQN_UART_TX        DMA1_Channel7_IRQn
+#define EM_IRQN_DAQ_ROLL       DMA1_Channel1_IRQn
 #define EM_LA_IRQ_EXTI1        EXTI0_IRQn
 #define EM_LA_IRQ_EXTI2        EXTI1_IRQn
 #define EM_LA_IRQ_EXTI3        EXTI3_IRQn
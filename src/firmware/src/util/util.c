@@ -8,12 +8,17 @@
 #include "util.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
 
 void assert2(const char *file, uint32_t line)
 {
+#ifdef EM_HOST
+    fprintf(stderr, "ASSERT %s:%lu\n", file, (unsigned long)line);
+    abort();
+#endif
     while(1);
     //__asm("bkpt 3");
 }
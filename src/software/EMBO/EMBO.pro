@@ -118,15 +118,27 @@ INCLUDEPATH += src/windows/
 SOURCES += \
     lib/qdial2.cpp \
     src/core.cpp \
+    src/decode.cpp \
+    src/fftengine.cpp \
+    src/labits.cpp \
+    src/ladecodeproc.cpp \
+    src/ladecoder.cpp \
     lib/ctkrangeslider.cpp \
     lib/qcustomplot.cpp \
     src/main.cpp \
     src/messages.cpp \
     src/msg.cpp \
+    src/plotlod.cpp \
     src/qcpcursors.cpp \
     src/recorder.cpp \
+    src/recstream.cpp \
+    src/rxparser.cpp \
+    src/scopeproc.cpp \
     src/settings.cpp \
+    src/softtrig.cpp \
+    src/trigalign.cpp \
     src/utils.cpp \
+    src/waveavg.cpp \
     src/windows/window__main.cpp \
     src/windows/window_cntr.cpp \
     src/windows/window_la.cpp \
@@ -140,17 +152,29 @@ HEADERS += \
     src/containers.h \
     src/core.h \
     src/css.h \
+    src/decode.h \
+    src/fftengine.h \
     src/interfaces.h \
+    src/labits.h \
+    src/ladecodeproc.h \
+    src/ladecoder.h \
     lib/ctkrangeslider.h \
     lib/fftw3.h \
     lib/qcustomplot.h \
     src/messages.h \
     src/movemean.h \
     src/msg.h \
+    src/plotlod.h \
     src/qcpcursors.h \
     src/recorder.h \
+    src/recstream.h \
+    src/rxparser.h \
+    src/scopeproc.h \
     src/settings.h \
+    src/softtrig.h \
+    src/trigalign.h \
     src/utils.h \
+    src/waveavg.h \
     src/windows/window__main.h \
     src/windows/window_cntr.h \
     src/windows/window_la.h \
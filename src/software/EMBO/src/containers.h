@@ -118,6 +118,7 @@ public:
     int la_ch2_pin;
     int la_ch3_pin;
     int la_ch4_pin;
+    QString features;   // optional features, one char each (V = VM:READ:BIN?, P = SCOP:DBUF, B = SYS:BAUD, C = LA:READ? COMP, K = SCOP:READ? PACK, D = SCOP:READ? DEC, R = SCOP:ROLL, L = VM:LOG, Q = SYS:SEQ? pipelining)
 };
 
 class DaqSettings
@@ -6,6 +6,7 @@
 #include "core.h"
 #include "utils.h"
 #include "msg.h"
+#include "settings.h"
 
 #include <QObject>
 #include <QDebug>
@@ -18,7 +19,7 @@
 
 
 #define TIMER_COMM          10
-#define TIMER_COMM_MIN      1
+#define TIMER_COMM_MIN      1   // next batch right after response, device paces the loop
 #define TIMER_RX            1500
 #define TIMER_RENDER        100
 
@@ -30,6 +31,9 @@ Core* Core::m_instance = Q_NULLPTR;
 Core::Core(QObject* parent) : QObject(parent)
 {
     m_meanLatency.setSize(MOVEMEAN_LATENCY);
+
+    m_baudMax = Settings::getValue(CFG_COMM_BAUD_MAX, COMM_BAUD_MAX).toInt();
+    m_windowMax = qBound(1, Settings::getValue(CFG_COMM_WINDOW, COMM_WINDOW).toInt(), COMM_WINDOW_MAX);
 }
 
 Core::~Core()
@@ -40,7 +44,7 @@ Core::~Core()
 void Core::on_startThread()
 {
     m_serial = new QSerialPort();
-    m_serial->setBaudRate(QSerialPort::Baud115200);
+    m_serial->setBaudRate(COMM_BAUD_DEFAULT);
     m_serial->setDataBits(QSerialPort::Data8);
     m_serial->setParity(QSerialPort::NoParity);
     m_serial->setStopBits(QSerialPort::OneStop);
@@ -66,6 +70,7 @@ void Core::on_startThread()
     m_msg_sys_info = new Msg_SYS_Info(this);
     m_msg_sys_mode = new Msg_SYS_Mode(this);
     m_msg_sys_uptime = new Msg_SYS_Uptime(this);
+    m_msg_sys_baud = new Msg_SYS_Baud(this);
 
     connect(m_serial, &QSerialPort::errorOccurred, this, &Core::on_serial_errorOccurred);
     connect(m_serial, &QSerialPort::readyRead, this, &Core::on_serial_readyRead);
@@ -80,6 +85,9 @@ void Core::on_startThread()
 bool Core::openComm(QString port)
 {
     m_serial->setPortName(port);
+    m_serial->setBaudRate(COMM_BAUD_DEFAULT);
+    m_baud = COMM_BAUD_DEFAULT;
+    m_baudStep = BAUD_NONE;
     m_state = OPENING;
     emit stateChanged(m_state);
 
@@ -91,12 +99,15 @@ bool Core::openComm(QString port)
 
         m_serial->clear();
 
-        m_mainBuffer.clear();
+        rxReset();
         m_waitingMsgs.clear();
         m_activeMsgs.clear();
+        m_sentBatches.clear();
+        m_sentLen = 0;
+        m_window = 1;
+        m_timer_latency.start();
 
-        assert(m_activeMsgs.isEmpty());
-        m_activeMsgs.append(m_msg_dummy);
+        activeAdd(m_msg_dummy);
 
         send();
 
@@ -118,6 +129,14 @@ void Core::openCommInit()
 
 bool Core::closeComm()
 {
+    if (m_baud != COMM_BAUD_DEFAULT && m_serial->isOpen()) // leave device ready for next connect
+    {
+        QString tx = QString(EMBO_SYS_BAUD) + " " + QString::number(COMM_BAUD_DEFAULT) + EMBO_NEWLINE;
+        m_serial->write(tx.toStdString().c_str(), tx.size());
+        m_serial->waitForBytesWritten(100);
+        m_baud = COMM_BAUD_DEFAULT;
+    }
+
     m_state = DISCONNECTED;
     m_serial->close(); // TODO enque
     m_timer_rxTimeout->stop();
@@ -134,8 +153,10 @@ void Core::startComm()
     qInfo() << ">>Connected2<<";
     m_state = CONNECTED;
     emit stateChanged(m_state);
+    m_window = m_devInfo.features.contains('Q') ? m_windowMax : 1; // device queues lines while busy
+    m_batchCnt = 0;
+    m_batchCntMs = m_timer_latency.elapsed();
     m_timer_comm->start(TIMER_COMM);
-    m_timer_latency.restart();
     m_meanLatency.reset();
     m_timer_render->start(TIMER_RENDER);
 }
@@ -157,12 +178,12 @@ void Core::msgAdd(Msg* msg, bool isQuery, QString params)
     //if (!params.isEmpty())
     msg->setParams(params);
 
-    m_waitingMsgs.append(msg);
+    m_waitingMsgs.append(MsgReq{msg, isQuery, params});
 }
 
 void Core::getLatencyMs(double& mean, double& max)
 {
-    mean = m_meanLatency.getMean(); // m_latency > TIMER_COMM ? m_latency - TIMER_COMM : 0);
+    mean = m_meanLatency.getMean();
     max = m_meanLatency.getMax();
 }
 
@@ -185,34 +206,70 @@ void Core::on_actionEMBO_Help()
 
 /* private */
 
-void Core::send()
+QString Core::txLine(bool seqTag)
 {
-    assert(m_activeMsgs.size() > 0);
-
-    QString tx;
-    int it = 0;
+    QString tx = seqTag ? QString(EMBO_SYS_SEQ) + "? " + QString::number(m_seq + 1) : "";
+    int it = seqTag ? 1 : 0;
 
-    for(auto msg : m_activeMsgs)
+    for (const auto& req : m_activeMsgs)
     {
         if (it > 0)
             tx.append(EMBO_DELIM1);
 
-        tx.append( msg->getCmd() +
-                  (msg->getIsQuery() ? "?" : "") +
-                  (msg->getParams().isEmpty() ? "" : " " + msg->getParams()));
+        tx.append( req.msg->getCmd() +
+                  (req.isQuery ? "?" : "") +
+                  (req.params.isEmpty() ? "" : " " + req.params));
         it++;
     }
     tx.append(EMBO_NEWLINE);
 
+    return tx;
+}
+
+void Core::send()
+{
+    assert(m_activeMsgs.size() > 0);
+
+    MsgBatch batch;
+    batch.seqTag = m_window > 1; // pipelined - response starts with seq echo, must match oldest batch
+    QString tx = txLine(batch.seqTag);
+
     m_serial->write(tx.toStdString().c_str(), tx.size());
 
     qInfo() << "sent: " << tx;
-    m_timer_rxTimeout->start(TIMER_RX);
-    m_timer_comm->stop();
 
-    m_latency = m_timer_latency.elapsed();
-    m_meanLatency.addVal(m_latency);
-    m_timer_latency.restart();
+    if (m_sentBatches.isEmpty())
+        m_timer_rxTimeout->start(TIMER_RX);
+
+    batch.seq = ++m_seq;
+    batch.reqs = m_activeMsgs;
+    batch.sentMs = m_timer_latency.elapsed();
+    batch.len = tx.size();
+    m_sentLen += batch.len;
+    m_sentBatches.enqueue(batch);
+    m_activeMsgs.clear();
+
+    if (m_state == CONNECTED && m_sentBatches.size() < m_window) // fill the window
+        m_timer_comm->start(TIMER_COMM_MIN);
+    else
+        m_timer_comm->stop();
+}
+
+/* room for next batch: window not full and line fits device RX FIFO next to unanswered lines */
+bool Core::sendReady()
+{
+    if (m_sentBatches.isEmpty())
+        return true; // device takes single line up to its RX_BUFF_LEN
+
+    if (m_sentBatches.size() >= m_window)
+        return false;
+
+    return m_sentLen + txLine(m_window > 1).size() <= COMM_RX_FIFO;
+}
+
+void Core::activeAdd(Msg* msg)
+{
+    m_activeMsgs.append(MsgReq{msg, msg->getIsQuery(), msg->getParams()});
 }
 
 void Core::openComm2()
@@ -220,16 +277,100 @@ void Core::openComm2()
     m_open_comm = false;
     m_state = CONNECTING2;
 
-    m_activeMsgs.append(m_msg_idn);
-    m_activeMsgs.append(m_msg_sys_lims);
-    m_activeMsgs.append(m_msg_sys_info);
+    activeAdd(m_msg_idn);
+    activeAdd(m_msg_sys_lims);
+    activeAdd(m_msg_sys_info);
     //m_msg_sys_mode->setIsQuery(true);
     //m_msg_sys_mode->setParams("");
-    //m_activeMsgs.append(m_msg_sys_mode);
+    //activeAdd(m_msg_sys_mode);
 
     send();
 }
 
+/* after IDN, LIM and INFO: switch UART to fastest baud both sides support, then verify by echo */
+void Core::openComm3()
+{
+    switch (m_baudStep)
+    {
+    case BAUD_NONE:
+        if (!m_devInfo.features.contains('B') || m_baudMax <= COMM_BAUD_DEFAULT)
+            break;
+
+        m_baudStep = BAUD_QUERY;
+        m_msg_sys_baud->setIsQuery(true);
+        m_msg_sys_baud->setParams("");
+        activeAdd(m_msg_sys_baud);
+        send();
+        return;
+
+    case BAUD_QUERY:
+        if (m_baudDev <= 0 || qMin(m_baudMax, m_baudDevMax) <= m_baudDev) // USB or already fast
+            break;
+
+        m_baudStep = BAUD_SET;
+        m_msg_sys_baud->setIsQuery(false);
+        m_msg_sys_baud->setParams(QString::number(qMin(m_baudMax, m_baudDevMax)));
+        activeAdd(m_msg_sys_baud);
+        send();
+        return;
+
+    case BAUD_SET: // device switches right after OK is out
+        m_baud = m_msg_sys_baud->getParams().toInt();
+        m_serial->setBaudRate(m_baud);
+
+        m_baudStep = BAUD_VERIFY;
+        m_msg_sys_baud->setIsQuery(true);
+        m_msg_sys_baud->setParams("");
+        activeAdd(m_msg_sys_baud);
+        send();
+        return;
+
+    case BAUD_VERIFY:
+        if (m_baudDev != m_baud)
+        {
+            QTimer::singleShot(0, this, &Core::baudFallback); // not inside rx parsing, buffer is reset
+            return;
+        }
+        qInfo() << "UART baud: " << m_baud;
+        break;
+
+    case BAUD_FALLBACK:
+        if (m_baudDev != COMM_BAUD_DEFAULT)
+        {
+            err("UART baud negotiation failed!", true);
+            return;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    m_baudStep = BAUD_DONE;
+    startComm();
+}
+
+/* new baud does not work, device reverts by itself when not confirmed */
+void Core::baudFallback()
+{
+    qInfo() << "UART baud " << m_baud << " failed, back to " << COMM_BAUD_DEFAULT;
+
+    m_timer_rxTimeout->stop();
+    m_sentBatches.clear();
+    m_sentLen = 0;
+    rxReset();
+
+    m_baud = COMM_BAUD_DEFAULT;
+    m_serial->setBaudRate(m_baud);
+    m_serial->clear();
+
+    m_baudStep = BAUD_FALLBACK;
+    m_msg_sys_baud->setIsQuery(true);
+    m_msg_sys_baud->setParams("");
+    activeAdd(m_msg_sys_baud);
+    send();
+}
+
 /* slots */
 
 void Core::on_openComm(const QString port)
@@ -277,200 +418,165 @@ void Core::on_serial_readyRead()
 {
     /************************************* 1. READ ALL - APPEND TO BUFFER  *************************************/
 
-    m_mainBuffer.append(m_serial->readAll());
-
-    /************************************* 2. SPLIT BUFFER INTO MESSAGES  **************************************/
+    m_rx.append(m_serial->readAll());
 
-    int msg_cnt = 0;
-    QByteArrayList messages;
-    int bin_header_len = 0;
-    int bin_len_total = 0;
-    int bin_msg_it = -1;
-    int hashIdx = m_mainBuffer.indexOf('#');
+    m_timer_rxTimeout->start(); // restart timeout timer
 
-    if (hashIdx > -1) // binary message is somewhere in the buffer
-    {
-        int buf_sz = m_mainBuffer.size();
-        auto left_part = m_mainBuffer.left(hashIdx);
+    /****************************** 2. SCAN NEW BYTES ONLY - CURSOR IS KEPT BETWEEN CALLS ******************************/
 
-        if (m_mainBuffer.size() > hashIdx + 5)
-        {
-            int n = m_mainBuffer[hashIdx + 1] - '0';
-            int bin_len = m_mainBuffer.mid(hashIdx + 2, n).toInt();
-            bin_len_total = 1 + n + bin_len;
-            int bin_msg_start = 0;
-            int bin_msg_end = 0;
+    RxParser::Result res;
 
-            if (buf_sz >= hashIdx + bin_len_total) // binary message is complete into messages
-            {
-                bin_header_len = 2 + n;
-                bin_msg_start = hashIdx;
-                bin_msg_end = hashIdx + 1 + bin_len_total;
-                bin_msg_it = 0;
-
-                // split for message skipping binary message
-                int j = 0;
-                for(int i = 0; i < bin_msg_start; i++) { // split left side of buffer into messages
-                    if (m_mainBuffer.at(i) == '\n') {
-                        messages.append(m_mainBuffer.mid(j, (i - 1) - j));
-                        msg_cnt++;
-                        bin_msg_it++;
-                        j = i + 1;
-                    }
-                }
-                for(int i = bin_msg_end + 1; i < m_mainBuffer.length(); i++) { // split right side of buffer
-                    if (m_mainBuffer.at(i) == '\n') {
-                        messages.append(m_mainBuffer.mid(j, (i - 1) - j));
-                        msg_cnt++;
-                        j = i + 1;
-                    }
-                }
-            }
-        }
-    }
-    else // standard text messages only
+    while ((res = m_rx.next()) == RxParser::RX_MSG)
     {
-        // split for message
-        messages = m_mainBuffer.split('\n');
-        msg_cnt = m_mainBuffer.count('\n');
-
-        for (int r = 0; r < messages.size(); r++) // remove \r
-            if (!messages[r].isEmpty())
-                messages[r] = messages[r].remove(messages[r].size() - 1, 1);
+        if (!rxDispatch(m_rx.data(), m_rx.msgStart(), m_rx.msgEnd()))
+            return;
     }
 
-    //qInfo() << "MSG CNT: " << msg_cnt;
-
-    m_timer_rxTimeout->start(); // restart timeout timer
+    if (res == RxParser::RX_ERR)
+    {
+        err(COMM_FATAL_ERR + QByteArray(m_rx.data() + m_rx.msgStart(), qMin(m_rx.size() - m_rx.msgStart(), 50)), true);
+        return;
+    }
 
+    /********************************* 3. DROP PROCESSED BYTES - ONCE PER CALL *********************************/
 
-    /***************************************** 3. ITERATE MESSAGES  ******************************************/
+    m_rx.compact();
 
+    if (m_open_comm)
+        openComm2();
+}
 
-    for(int i = 0; i < msg_cnt; i++) // iterate all full messages and split them into submessages
-    {
-        if (messages[i].isEmpty()) // skip empty message
-            continue;
+bool Core::rxDispatch(const char* buff, int msg_start, int msg_end)
+{
+    const QVector<RxSpan>& spans = m_rx.spans();
 
-        //qInfo() << "rx msg: " << messages[i];
+    if (spans.isEmpty()) // skip empty message
+        return true;
 
-        m_mainBuffer = m_mainBuffer.right(m_mainBuffer.size() - (messages[i].size() + 2)); // remove message from buffer
+    //qInfo() << "rx msg: " << QByteArray::fromRawData(buff + msg_start, msg_end - msg_start);
 
-        /************************************* 4. HANDLE ASYNC MESSAGE  *************************************/
+    /************************************* 4. HANDLE ASYNC MESSAGE  *************************************/
 
+    if (spans.size() == 1 && !spans[0].bin)
+    {
+        const QByteArray message = QByteArray::fromRawData(buff + spans[0].start, spans[0].len);
         Ready ready = Ready::NOT_READY;
 
-        if (messages[i].contains(EMBO_READY_A)) ready = Ready::READY_AUTO;
-        if (messages[i].contains(EMBO_READY_N)) ready = Ready::READY_NORMAL;
-        if (messages[i].contains(EMBO_READY_S)) ready = Ready::READY_SINGLE;
-        if (messages[i].contains(EMBO_READY_F)) ready = Ready::READY_FORCED;
-        if (messages[i].contains(EMBO_READY_D)) ready = Ready::READY_DISABLED;
+        if (message.contains(EMBO_READY_A)) ready = Ready::READY_AUTO;
+        if (message.contains(EMBO_READY_N)) ready = Ready::READY_NORMAL;
+        if (message.contains(EMBO_READY_S)) ready = Ready::READY_SINGLE;
+        if (message.contains(EMBO_READY_F)) ready = Ready::READY_FORCED;
+        if (message.contains(EMBO_READY_D)) ready = Ready::READY_DISABLED;
 
         if (ready != Ready::NOT_READY) // handle RDY async message, which is different
         {
-            qInfo() << messages[i];
-            auto toks = messages[i].split(',');
+            qInfo() << message;
+            auto toks = message.split(',');
 
             if (toks.size() == 2)
             {
                 emit daqReady(ready, toks[1].toInt());
-                continue;
+                return true;
             }
             else
             {
-                err(COMM_FATAL_ERR + messages[i] + m_mainBuffer, true);
-                return;
+                err(COMM_FATAL_ERR + QByteArray(buff + msg_start, msg_end - msg_start), true);
+                return false;
             }
         }
+    }
 
-        /******************************** 5. SPLIT MESSAGE INTO SUBMESSAGES  *********************************/
+    if (m_sentBatches.isEmpty()) // response without request
+    {
+        err(COMM_FATAL_ERR + QByteArray(buff + msg_start, qMin(msg_end - msg_start, 100)), true);
+        return false;
+    }
 
-        QByteArrayList submessages;
+    const MsgBatch& batch = m_sentBatches.head(); // device answers lines strictly in order
+    int spanIt = 0;
 
-        if (i == bin_msg_it) // if message contains binary message, split to submessage is tricky
+    if (batch.seqTag) // first submessage is seq echo, checked before any callback fires
+    {
+        if (spans[0].bin || QByteArray::fromRawData(buff + spans[0].start, spans[0].len).toUInt() != batch.seq)
         {
-            int bin_msg_start = messages[i].indexOf('#');
-            int bin_msg_end = bin_msg_start + bin_len_total;
-
-            // split for submessage skipping binary message
-            int j = 0;
-            int msg_len = messages[i].length();
-
-            for(int k = 0; k < bin_msg_start; k++) { // split left side of message to submessage
-                if (messages[i].at(k) == ';') {
-                    submessages.append(messages[i].mid(j, k - j));
-                    j = k + 1;
-                }
-            }
-            for(int k = bin_msg_end + 1; k < msg_len; k++) { // split right side of message to submessage
-                if (messages[i].at(k) == ';') {
-                    submessages.append(messages[i].mid(j, k - j));
-                    j = k + 1;
-                }
-            }
-            if (j < msg_len)
-                submessages.append(messages[i].mid(j, msg_len));
-
-            //qInfo() << "BIN MSG submsg cnt: " << submessages.size();
+            err(COMM_FATAL_ERR + QByteArray(buff + msg_start, qMin(msg_end - msg_start, 100)), true);
+            return false;
         }
-        else // split text message into submsg
-        {
-            submessages = messages[i].split(';');
+        spanIt = 1;
+    }
 
-            //qInfo() << "TXT MSG submsg cnt:" << submessages.size();
-        }
+    m_submsgIt = 0;
+    int activeMsg_size = batch.reqs.size();
 
-        m_submsgIt = 0;
-        int activeMsg_size = m_activeMsgs.size();
+    /************************************* 5. ITERATE SUBMESSAGES ***************************************/
 
-        /************************************* 6. ITERATE SUBMESSAGES ***************************************/
+    for (; spanIt < spans.size(); spanIt++) // now iterate all submessages and do virtual actions
+    {
+        const auto& span = spans[spanIt];
+
+        if (m_state == DISCONNECTED) // if closing return
+            return false;
 
-        for(const QByteArray submessage : submessages) // now iterate all submessages and do virtual actions
+        if (m_submsgIt >= activeMsg_size) // safety guard - if submessage iterator dont match current state return error
         {
-            if (submessage.isEmpty()) // skip empty submessage
-                continue;
+            err(COMM_FATAL_ERR + QByteArray(buff + msg_start, qMin(msg_end - msg_start, 100)), true);
+            return false;
+        }
 
-            if (m_state == DISCONNECTED) // if closing return
-                return;
+        /************************************* 6. EMIT CALLBACKS ****************************************/
 
-            if (m_submsgIt >= activeMsg_size) // safety guard - if submessage iterator dont match current state return error
-            {
-                err(COMM_FATAL_ERR + messages[i] + m_mainBuffer, true);
-                return;
-            }
+        const MsgReq& req = batch.reqs[m_submsgIt++];
+        Msg* msg = req.msg;
 
-            /************************************* 7. EMIT CALLBACKS ****************************************/
+        msg->setIsQuery(req.isQuery); // as it was sent, newer batch may have changed it
+        msg->setParams(req.params);
 
-            if (submessage.at(0) == '#')
-                m_activeMsgs[m_submsgIt++]->fire(submessage.right(submessage.size() - bin_header_len)); // fire binary data action
-            else
-                m_activeMsgs[m_submsgIt++]->fire(QString(submessage)); // fire standard text message action
-        }
+        if (span.bin)
+            msg->fire(QByteArray::fromRawData(buff + span.start, span.len)); // fire binary data action - no copy
+        else
+            msg->fire(QString::fromLatin1(buff + span.start, span.len)); // fire standard text message action
+    }
 
-        /************************************** 8. LAST MESSAGE - CLEANUP ***********************************/
+    /************************************** 7. LAST MESSAGE - CLEANUP ***********************************/
 
-        if (m_submsgIt == activeMsg_size) // success - do post actions, clean up, reset timers
-        {
-            m_submsgIt = 0;
-            m_timer_rxTimeout->stop();
-            m_activeMsgs.clear();
+    if (m_submsgIt == activeMsg_size) // success - do post actions, clean up, reset timers
+    {
+        m_submsgIt = 0;
 
-            m_commTimeoutMs = TIMER_COMM - m_latencyAvgMs;
-            if (m_commTimeoutMs < TIMER_COMM_MIN)
-                m_commTimeoutMs = TIMER_COMM_MIN;
+        m_latency = (int)(m_timer_latency.elapsed() - batch.sentMs); // round trip of this batch
+        m_meanLatency.addVal(m_latency);
+        m_batchCnt++;
 
-            if (m_state == CONNECTING2)
-                startComm();
-            else if (m_state == CONNECTED)
-                m_timer_comm->start(m_commTimeoutMs);
-        }
+        m_sentLen -= batch.len;
+        m_sentBatches.dequeue();
+
+        if (m_sentBatches.isEmpty())
+            m_timer_rxTimeout->stop();
+        else
+            m_timer_rxTimeout->start(TIMER_RX); // next batch already in device
+
+        if (m_state == CONNECTING2)
+            openComm3();
+        else if (m_state == CONNECTED && !m_timer_comm->isActive())
+            m_timer_comm->start(TIMER_COMM_MIN); // response driven, no fixed period
     }
-    if (m_open_comm)
-        openComm2();
+    return true;
+}
+
+void Core::rxReset()
+{
+    m_rx.reset();
+    m_submsgIt = 0;
 }
 
 void Core::on_timer_rxTimeout()
 {
+    if (m_state == CONNECTING2 && m_baudStep == BAUD_VERIFY) // device already back at default baud
+    {
+        baudFallback();
+        return;
+    }
+
     err("Communication timeout!", true);
 }
 
@@ -483,34 +589,34 @@ void Core::on_timer_comm()
         return;
     }
 
-    if (!m_activeMsgs.isEmpty()) // CPU is not keeping up
+    if (m_activeMsgs.isEmpty()) // else batch built before still waits for room
     {
-        qInfo() << "Communication is throttling!";
-        return;
-    }
+        if (m_mode != NO_MODE && m_mode != m_mode_last) // mode change
+        {
+            m_msg_sys_mode->setIsQuery(false);
+            m_msg_sys_mode->setParams(m_mode == LA ? "LA" : (m_mode == SCOPE ? "SCOPE" : "VM"));
+            activeAdd(m_msg_sys_mode);
+        }
+        m_mode_last = m_mode;
 
-    if (m_mode != NO_MODE && m_mode != m_mode_last) // mode change
-    {
-        m_msg_sys_mode->setIsQuery(false);
-        m_msg_sys_mode->setParams(m_mode == LA ? "LA" : (m_mode == SCOPE ? "SCOPE" : "VM"));
-        m_activeMsgs.append(m_msg_sys_mode);
-    }
-    m_mode_last = m_mode;
+        int waitingSize = m_waitingMsgs.size(); // add messages from waiting queue
+        if (waitingSize > 0)
+        {
+            m_activeMsgs.append(m_waitingMsgs.mid(0, waitingSize));
+            m_waitingMsgs.remove(0, waitingSize);
+        }
 
-    int waitingSize = m_waitingMsgs.size(); // add messages from waiting queue
-    if (waitingSize > 0)
-    {
-        m_activeMsgs.append(m_waitingMsgs.mid(0, waitingSize));
-        m_waitingMsgs.remove(0, waitingSize);
-    }
+        for (auto instr : emboInstruments) // add active permanent messages
+        {
+            for (auto msg : instr->getActiveMsgs())
+                activeAdd(msg);
+        }
 
-    for (auto instr : emboInstruments) // add active permanent messages
-    {
-        for (auto msg : instr->getActiveMsgs())
-            m_activeMsgs.append(msg);
+        activeAdd(m_msg_sys_uptime); // add uptime life check msg
     }
 
-    m_activeMsgs.append(m_msg_sys_uptime); // add uptime life check msg
+    if (!sendReady()) // window full, timer is started again by next response
+        return;
 
     send(); // finally send all
 }
@@ -522,8 +628,11 @@ void Core::on_timer_render()
 
     getLatencyMs(latency_mean, latency_max);
 
-    m_latencyAvgMs = (int)latency_mean;
+    qint64 now = m_timer_latency.elapsed();
+    int rate = now > m_batchCntMs ? (int)(m_batchCnt * 1000 / (now - m_batchCntMs)) : 0; // answered batches per second
+    m_batchCnt = 0;
+    m_batchCntMs = now;
 
-    emit latencyAndUptime(m_commTimeoutMs, (int)latency_mean, (int)latency_max, getUptime());
+    emit latencyAndUptime((int)latency_mean, (int)latency_max, m_window, rate, getUptime());
     //emit coreRender();
 }
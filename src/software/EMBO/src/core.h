@@ -11,6 +11,7 @@
 #include "interfaces.h"
 #include "movemean.h"
 #include "containers.h"
+#include "rxparser.h"
 
 #include <QObject>
 #include <QTimer>
@@ -18,6 +19,7 @@
 #include <QString>
 #include <QSerialPort>
 #include <QVector>
+#include <QQueue>
 
 #include <assert.h>
 
@@ -50,6 +52,8 @@ PWM and signal generator.<br>And of course, it's opensource! \
 #define CFG_MAIN_PORT       "main/port"
 #define CFG_RUN_MONTH       "main/run_month"
 #define CFG_REC_DIR         "rec/dir"
+#define CFG_COMM_BAUD_MAX   "comm/baud_max"
+#define CFG_COMM_WINDOW     "comm/window"
 
 #define CFG_VM_CH1_EN       "vm/ch1_en"
 #define CFG_VM_CH2_EN       "vm/ch2_en"
@@ -59,8 +63,42 @@ PWM and signal generator.<br>And of course, it's opensource! \
 #define CFG_VM_PLT          "vm/plt"
 #define CFG_VM_SHOW_PLOT    "vm/show_plot"
 #define CFG_VM_SPLINE       "vm/spline"
+#define CFG_VM_LOG_RATE     "vm/log_rate"
+#define CFG_VM_LOG_AVG      "vm/log_avg"
 
 #define CFG_SCOPE_SPLINE    "scope/spline"
+#define CFG_SCOPE_AVG_MODE  "scope/avg_mode"
+#define CFG_SCOPE_POLICY    "scope/proc_policy"
+#define CFG_SCOPE_FFT_WIN   "scope/fft_window"
+#define CFG_SCOPE_FFT_WELCH "scope/fft_welch"
+#define CFG_SCOPE_DBUF      "scope/double_buffer"
+#define CFG_SCOPE_DEC       "scope/decimation"
+#define CFG_SCOPE_TRIG_ALGN "scope/trig_align"
+#define CFG_SCOPE_STRIG     "scope/strig_mode"
+#define CFG_SCOPE_STRIG_CH  "scope/strig_ch"
+#define CFG_SCOPE_STRIG_POL "scope/strig_polarity"
+#define CFG_SCOPE_STRIG_LVL "scope/strig_level"
+#define CFG_SCOPE_STRIG_LO  "scope/strig_lo"
+#define CFG_SCOPE_STRIG_HI  "scope/strig_hi"
+#define CFG_SCOPE_STRIG_T   "scope/strig_time"
+#define CFG_SCOPE_SEG       "scope/segments"
+#define CFG_SCOPE_SEG_NUM   "scope/seg_num"
+#define CFG_SCOPE_SEG_OVR   "scope/seg_overlay"
+#define CFG_FFT_WISDOM      "fft/wisdom"
+
+#define CFG_LA_DECODE       "la/decode"
+#define CFG_LA_UART_BAUD    "la/uart_baud"
+#define CFG_LA_SPI_MODE     "la/spi_mode"
+#define CFG_LA_UART_RX      "la/uart_rx"
+#define CFG_LA_SPI_CLK      "la/spi_clk"
+#define CFG_LA_SPI_MOSI     "la/spi_mosi"
+#define CFG_LA_SPI_MISO     "la/spi_miso"
+#define CFG_LA_SPI_CS       "la/spi_cs"
+#define CFG_LA_I2C_SCL      "la/i2c_scl"
+#define CFG_LA_I2C_SDA      "la/i2c_sda"
+#define CFG_LA_PATTERN      "la/pattern"
+#define CFG_LA_PATTERN_STR  "la/pattern_str"
+#define CFG_LA_PATTERN_T    "la/pattern_time"
 
 #define EMBO_NEWLINE        "\r\n"
 #define EMBO_DELIM1         ";"
@@ -77,6 +115,11 @@ PWM and signal generator.<br>And of course, it's opensource! \
 #define EMBO_READY_D        "ReadyD"
 
 #define READ_ERROR_CNT      5  // when more than 5 read erros happen, instrument is closed
+#define COMM_BAUD_DEFAULT   115200   // UART baud after device reset, negotiated higher with SYS:BAUD
+#define COMM_BAUD_MAX       2000000  // default limit, most USB-UART bridges handle it
+#define COMM_WINDOW         4        // default max batches in flight, device needs feature Q (RX line FIFO)
+#define COMM_WINDOW_MAX     8
+#define COMM_RX_FIFO        255      // device RX FIFO (RX_FIFO_LEN - 1), bytes of unanswered lines must fit
 
 #define TITLE_LEFT          10
 #define TITLE_TOP_WIN       6
@@ -108,6 +151,7 @@ public:
     QString getUptime() const { return m_uptime; }
     void setUptime(QString uptime) { m_uptime = uptime; }
     void setMode(Mode mode, bool alsoLast = false) { m_mode = mode; if (alsoLast) m_mode_last = mode; }
+    void setBaudDev(int now, int max) { m_baudDev = now; m_baudDevMax = max; }
 
      /* singleton */
     static Core* getInstance(QObject* parent = 0)
@@ -129,7 +173,7 @@ signals:
     void daqReady(Ready ready, int firstPos);
     void stateChanged(const State state);
     void msgDisplay(const QString name, MsgBoxType type);
-    void latencyAndUptime(int latency_fix, int latency_mean, int latency_max, const QString uptime);
+    void latencyAndUptime(int latency_mean, int latency_max, int window, int rate, const QString uptime);
     void finished();
     void coreRender();
 
@@ -143,8 +187,15 @@ private slots:
 private:
     explicit Core(QObject* parent = 0);
 
+    QString txLine(bool seqTag);
     void send();
+    bool sendReady();
+    void activeAdd(Msg* msg);
     void openComm2();
+    void openComm3();
+    void baudFallback();
+    bool rxDispatch(const char* buff, int msg_start, int msg_end);
+    void rxReset();
 
     /* instance */
     static Core* m_instance;
@@ -164,23 +215,38 @@ private:
     QTimer* m_timer_render;
     QTimer* m_timer_comm;
 
-    /* latency timer */
+    /* latency timer - round trip of each batch */
     QElapsedTimer m_timer_latency;
     int m_latency = 0;
     MoveMean<int> m_meanLatency;
 
-    /* latency avg val and rx timeout */
-    int m_latencyAvgMs = 0;
-    int m_commTimeoutMs = 0;
+    /* UART baud negotiation after connect */
+    enum BaudStep { BAUD_NONE, BAUD_QUERY, BAUD_SET, BAUD_VERIFY, BAUD_FALLBACK, BAUD_DONE };
+    BaudStep m_baudStep = BAUD_NONE;
+    int m_baud = COMM_BAUD_DEFAULT;     // current port baud
+    int m_baudMax = COMM_BAUD_MAX;      // user limit
+    int m_baudDev = 0;                  // device baud, 0 = connected by USB
+    int m_baudDevMax = 0;
 
     /* data */
     DevInfo m_devInfo;
     QString m_uptime = "";
 
-    /* message buffers */
-    QVector<Msg*> m_waitingMsgs;
-    QVector<Msg*> m_activeMsgs;
-    QByteArray m_mainBuffer;
+    /* message buffers - msg objects are shared by batches, so query flag and params are kept per request */
+    struct MsgReq { Msg* msg; bool isQuery; QString params; };
+    struct MsgBatch { quint32 seq; bool seqTag; QVector<MsgReq> reqs; qint64 sentMs; int len; };
+    QVector<MsgReq> m_waitingMsgs;
+    QVector<MsgReq> m_activeMsgs;       // batch being built
+    QQueue<MsgBatch> m_sentBatches;     // sent, waiting for response, oldest first
+    int m_sentLen = 0;                  // bytes of unanswered lines
+    quint32 m_seq = 0;
+
+    /* pipelining */
+    int m_window = 1;                   // batches in flight now, 1 = stop and wait
+    int m_windowMax = COMM_WINDOW;      // user limit
+    int m_batchCnt = 0;                 // answered batches since last render
+    qint64 m_batchCntMs = 0;
+    RxParser m_rx;                      // rx stream, state kept between reads
     int m_submsgIt = 0;
 
     /* message objects */
@@ -193,6 +259,7 @@ private:
     Msg_SYS_Info* m_msg_sys_info;
     Msg_SYS_Mode* m_msg_sys_mode;
     Msg_SYS_Uptime* m_msg_sys_uptime;
+    Msg_SYS_Baud* m_msg_sys_baud;
 };
 
 #endif // CORE_H
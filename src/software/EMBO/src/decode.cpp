@@ -0,0 +1,351 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "decode.h"
+
+#include <string.h>
+#include <assert.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DECODE_X86
+#include <immintrin.h>
+#endif
+
+
+/* output cursor of one channel with fused (gain * vcc / max) and offset */
+struct DecodeCh
+{
+    double* dst;
+    double scale;
+    double offset;
+};
+
+/* ------------------------------------------------ scalar ------------------------------------------------ */
+
+template <typename T, int CH>
+static void decode_recs_scalar(const T* src, int recs, DecodeCh* ch)
+{
+    for (int r = 0; r < recs; r++, src += CH)
+    {
+        for (int c = 0; c < CH; c++)
+            ch[c].dst[r] = src[c] * ch[c].scale + ch[c].offset;
+    }
+    for (int c = 0; c < CH; c++)
+        ch[c].dst += recs;
+}
+
+/* ------------------------------------------------- SSE2 ------------------------------------------------- */
+
+#ifdef DECODE_X86
+
+/* 4 samples to int32 */
+__attribute__((target("sse2"))) static inline __m128i sse2_load4(const uint16_t* p)
+{
+    return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)p), _mm_setzero_si128());
+}
+
+__attribute__((target("sse2"))) static inline __m128i sse2_load4(const uint8_t* p)
+{
+    int32_t v;
+    memcpy(&v, p, 4);
+    __m128i z = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), z), z);
+}
+
+/* returns count of processed records, rest is left for scalar tail */
+template <typename T, int CH>
+__attribute__((target("sse2"))) static int decode_recs_sse2(const T* src, int recs, DecodeCh* ch)
+{
+    int r = 0;
+
+    if (CH == 1)
+    {
+        const __m128d s = _mm_set1_pd(ch[0].scale), o = _mm_set1_pd(ch[0].offset);
+        double* d = ch[0].dst;
+        for (; r + 4 <= recs; r += 4, src += 4)
+        {
+            __m128i x = sse2_load4(src);
+            _mm_storeu_pd(d + r,     _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(x), s), o));
+            _mm_storeu_pd(d + r + 2, _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(x, 8)), s), o));
+        }
+    }
+    else if (CH == 2)
+    {
+        const __m128d s = _mm_setr_pd(ch[0].scale, ch[1].scale), o = _mm_setr_pd(ch[0].offset, ch[1].offset);
+        double* d0 = ch[0].dst;
+        double* d1 = ch[1].dst;
+        for (; r + 2 <= recs; r += 2, src += 4)
+        {
+            __m128i x = sse2_load4(src);
+            __m128d a = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(x), s), o);                   // r0c0 r0c1
+            __m128d b = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(x, 8)), s), o); // r1c0 r1c1
+            _mm_storeu_pd(d0 + r, _mm_unpacklo_pd(a, b));
+            _mm_storeu_pd(d1 + r, _mm_unpackhi_pd(a, b));
+        }
+    }
+    else if (CH == 4)
+    {
+        const __m128d s01 = _mm_setr_pd(ch[0].scale, ch[1].scale), o01 = _mm_setr_pd(ch[0].offset, ch[1].offset);
+        const __m128d s23 = _mm_setr_pd(ch[2].scale, ch[3].scale), o23 = _mm_setr_pd(ch[2].offset, ch[3].offset);
+        double* d0 = ch[0].dst;
+        double* d1 = ch[1].dst;
+        double* d2 = ch[2].dst;
+        double* d3 = ch[3].dst;
+        for (; r + 2 <= recs; r += 2, src += 8)
+        {
+            __m128i x = sse2_load4(src);
+            __m128i y = sse2_load4(src + 4);
+            __m128d a01 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(x), s01), o01);
+            __m128d a23 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(x, 8)), s23), o23);
+            __m128d b01 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(y), s01), o01);
+            __m128d b23 = _mm_add_pd(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(y, 8)), s23), o23);
+            _mm_storeu_pd(d0 + r, _mm_unpacklo_pd(a01, b01));
+            _mm_storeu_pd(d1 + r, _mm_unpackhi_pd(a01, b01));
+            _mm_storeu_pd(d2 + r, _mm_unpacklo_pd(a23, b23));
+            _mm_storeu_pd(d3 + r, _mm_unpackhi_pd(a23, b23));
+        }
+    }
+
+    for (int c = 0; c < CH; c++)
+        ch[c].dst += r;
+    return r;
+}
+
+/* ------------------------------------------------- AVX2 ------------------------------------------------- */
+
+/* 8 samples to int32 */
+__attribute__((target("avx2"))) static inline __m256i avx2_load8(const uint16_t* p)
+{
+    return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)p));
+}
+
+__attribute__((target("avx2"))) static inline __m256i avx2_load8(const uint8_t* p)
+{
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)p));
+}
+
+__attribute__((target("avx2"))) static inline __m256d avx2_lo(__m256i x, __m256d s, __m256d o)
+{
+    return _mm256_add_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(x)), s), o);
+}
+
+__attribute__((target("avx2"))) static inline __m256d avx2_hi(__m256i x, __m256d s, __m256d o)
+{
+    return _mm256_add_pd(_mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1)), s), o);
+}
+
+template <typename T, int CH>
+__attribute__((target("avx2"))) static int decode_recs_avx2(const T* src, int recs, DecodeCh* ch)
+{
+    int r = 0;
+
+    if (CH == 1)
+    {
+        const __m256d s = _mm256_set1_pd(ch[0].scale), o = _mm256_set1_pd(ch[0].offset);
+        double* d = ch[0].dst;
+        for (; r + 8 <= recs; r += 8, src += 8)
+        {
+            __m256i x = avx2_load8(src);
+            _mm256_storeu_pd(d + r,     avx2_lo(x, s, o));
+            _mm256_storeu_pd(d + r + 4, avx2_hi(x, s, o));
+        }
+    }
+    else if (CH == 2)
+    {
+        const __m256d s = _mm256_setr_pd(ch[0].scale, ch[1].scale, ch[0].scale, ch[1].scale);
+        const __m256d o = _mm256_setr_pd(ch[0].offset, ch[1].offset, ch[0].offset, ch[1].offset);
+        double* d0 = ch[0].dst;
+        double* d1 = ch[1].dst;
+        for (; r + 4 <= recs; r += 4, src += 8)
+        {
+            __m256i x = avx2_load8(src);
+            __m256d a = avx2_lo(x, s, o);   // r0c0 r0c1 r1c0 r1c1
+            __m256d b = avx2_hi(x, s, o);   // r2c0 r2c1 r3c0 r3c1
+            // unpack gives r0 r2 r1 r3 order, swap middle qwords
+            _mm256_storeu_pd(d0 + r, _mm256_permute4x64_pd(_mm256_unpacklo_pd(a, b), 0xD8));
+            _mm256_storeu_pd(d1 + r, _mm256_permute4x64_pd(_mm256_unpackhi_pd(a, b), 0xD8));
+        }
+    }
+    else if (CH == 4)
+    {
+        const __m256d s = _mm256_setr_pd(ch[0].scale, ch[1].scale, ch[2].scale, ch[3].scale);
+        const __m256d o = _mm256_setr_pd(ch[0].offset, ch[1].offset, ch[2].offset, ch[3].offset);
+        double* d0 = ch[0].dst;
+        double* d1 = ch[1].dst;
+        double* d2 = ch[2].dst;
+        double* d3 = ch[3].dst;
+        for (; r + 4 <= recs; r += 4, src += 16)
+        {
+            __m256i x = avx2_load8(src);
+            __m256i y = avx2_load8(src + 8);
+            __m256d v0 = avx2_lo(x, s, o);
+            __m256d v1 = avx2_hi(x, s, o);
+            __m256d v2 = avx2_lo(y, s, o);
+            __m256d v3 = avx2_hi(y, s, o);
+            // 4x4 transpose, records to channels
+            __m256d t0 = _mm256_unpacklo_pd(v0, v1);   // r0c0 r1c0 r0c2 r1c2
+            __m256d t1 = _mm256_unpackhi_pd(v0, v1);   // r0c1 r1c1 r0c3 r1c3
+            __m256d t2 = _mm256_unpacklo_pd(v2, v3);
+            __m256d t3 = _mm256_unpackhi_pd(v2, v3);
+            _mm256_storeu_pd(d0 + r, _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd(d1 + r, _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd(d2 + r, _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd(d3 + r, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+    }
+
+    for (int c = 0; c < CH; c++)
+        ch[c].dst += r;
+    return r;
+}
+
+/* 16 samples from 24 bytes, each lane shuffles 12 bytes so every uint16 holds its sample's two bytes,
+ * even samples are masked, odd are shifted, returns count of unpacked samples */
+__attribute__((target("avx2"))) static int unpack12_avx2(const uint8_t* src, int count, uint16_t* dst)
+{
+    const __m256i shuf = _mm256_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11,
+                                          0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11);
+    const __m256i mask = _mm256_set1_epi16(0x0FFF);
+    const int bytes = (count + 1) / 2 * 3;
+    int n = 0;
+
+    for (; n + 16 <= count && (n / 2 * 3) + 28 <= bytes; n += 16) // second lane loads 16 bytes at +12
+    {
+        const uint8_t* p = src + (n / 2 * 3);
+        __m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)p)),
+                                            _mm_loadu_si128((const __m128i*)(p + 12)), 1);
+        x = _mm256_shuffle_epi8(x, shuf);
+        _mm256_storeu_si256((__m256i*)(dst + n), _mm256_blend_epi16(_mm256_and_si256(x, mask), _mm256_srli_epi16(x, 4), 0xAA));
+    }
+
+    return n;
+}
+
+#endif // DECODE_X86
+
+/* ------------------------------------------------ engine ------------------------------------------------ */
+
+/* linear span of whole records */
+template <typename T, int CH>
+static void decode_recs(const T* src, int recs, DecodeCh* ch, DecodeIsa isa)
+{
+    int done = 0;
+#ifdef DECODE_X86
+    if (CH != 3)
+    {
+        if (isa == DECODE_AVX2)
+            done = decode_recs_avx2<T,CH>(src, recs, ch);
+        else if (isa == DECODE_SSE2)
+            done = decode_recs_sse2<T,CH>(src, recs, ch);
+    }
+#else
+    (void)isa;
+#endif
+    decode_recs_scalar<T,CH>(src + done * CH, recs - done, ch);
+}
+
+/* linear span starting at absolute buffer index i, may begin and end in the middle of a record */
+template <typename T, int CH>
+static void decode_span(const T* buff, int i, int len, DecodeCh* ch, DecodeIsa isa)
+{
+    int c = i % CH;
+    for (; c != 0 && len > 0; c = (c + 1) % CH, i++, len--)
+        *(ch[c].dst++) = buff[i] * ch[c].scale + ch[c].offset;
+
+    int recs = len / CH;
+    decode_recs<T,CH>(buff + i, recs, ch, isa);
+    i += recs * CH;
+    len -= recs * CH;
+
+    for (c = 0; len > 0; c++, i++, len--)
+        *(ch[c].dst++) = buff[i] * ch[c].scale + ch[c].offset;
+}
+
+template <typename T, int CH>
+static void decode_circ_t(int from, int total, int bufflen, const T* buff, DecodeCh* ch, DecodeIsa isa)
+{
+    int len1 = bufflen - from;
+    if (len1 > total)
+        len1 = total;
+
+    decode_span<T,CH>(buff, from, len1, ch, isa);
+    if (total > len1)
+        decode_span<T,CH>(buff, 0, total - len1, ch, isa);
+}
+
+template <typename T>
+static void decode_circ_ch(int from, int total, int bufflen, const T* buff, int ch_num, DecodeCh* ch, DecodeIsa isa)
+{
+    switch (ch_num)
+    {
+    case 1: decode_circ_t<T,1>(from, total, bufflen, buff, ch, isa); break;
+    case 2: decode_circ_t<T,2>(from, total, bufflen, buff, ch, isa); break;
+    case 3: decode_circ_t<T,3>(from, total, bufflen, buff, ch, isa); break;
+    case 4: decode_circ_t<T,4>(from, total, bufflen, buff, ch, isa); break;
+    default: assert(0);
+    }
+}
+
+DecodeIsa decode_isa()
+{
+#ifdef DECODE_X86
+    static const DecodeIsa isa = __builtin_cpu_supports("avx2") ? DECODE_AVX2 :
+                                 (__builtin_cpu_supports("sse2") ? DECODE_SSE2 : DECODE_SCALAR);
+    return isa;
+#else
+    return DECODE_SCALAR;
+#endif
+}
+
+void decode_unpack12(const uint8_t* src, int count, uint16_t* dst, DecodeIsa isa)
+{
+    int n = 0;
+#ifdef DECODE_X86
+    if (isa == DECODE_AVX2) // SSE2 has no byte shuffle, scalar is as fast there
+        n = unpack12_avx2(src, count, dst);
+#else
+    (void)isa;
+#endif
+
+    for (; n + 2 <= count; n += 2)
+    {
+        const uint8_t* p = src + (n / 2 * 3);
+        dst[n] = p[0] | ((p[1] & 0x0F) << 8);
+        dst[n + 1] = (p[1] >> 4) | (p[2] << 4);
+    }
+
+    if (n < count) // odd count, pair padded with zero sample
+    {
+        const uint8_t* p = src + (n / 2 * 3);
+        dst[n] = p[0] | ((p[1] & 0x0F) << 8);
+    }
+}
+
+int decode_circ(int from, int total, int bufflen, DaqBits bits, double vcc, const uint8_t* buff, int ch_num,
+                double* const* out, const double* gain, const double* offset, DecodeIsa isa)
+{
+    assert(total > 0 && bufflen >= total && from >= 0 && from < bufflen && buff != NULL);
+    assert(ch_num >= 1 && ch_num <= 4);
+
+    const double max = (bits == B12) ? 4095.0 : 255.0;
+
+    DecodeCh ch[4];
+    for (int c = 0; c < ch_num; c++)
+    {
+        assert(out[c] != NULL);
+        ch[c].dst = out[c];
+        ch[c].scale = gain[c] * vcc / max;
+        ch[c].offset = offset[c];
+    }
+
+    if (bits == B12)
+        decode_circ_ch<uint16_t>(from, total, bufflen, (const uint16_t*)buff, ch_num, ch, isa);
+    else if (bits == B8)
+        decode_circ_ch<uint8_t>(from, total, bufflen, buff, ch_num, ch, isa);
+    else
+        assert(0);
+
+    return total;
+}
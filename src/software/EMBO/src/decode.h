@@ -0,0 +1,33 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef DECODE_H
+#define DECODE_H
+
+#include "containers.h"
+
+#include <stdint.h>
+
+
+enum DecodeIsa
+{
+    DECODE_SCALAR = 0,
+    DECODE_SSE2   = 1,
+    DECODE_AVX2   = 2
+};
+
+/* best instruction set of this cpu, detected only once */
+DecodeIsa decode_isa();
+
+/* deinterleave raw DAQ circular buffer into ch_num channels, sample i belongs to channel i % ch_num,
+ * out = raw / max * vcc * gain + offset, returns count of decoded samples */
+int decode_circ(int from, int total, int bufflen, DaqBits bits, double vcc, const uint8_t* buff, int ch_num,
+                double* const* out, const double* gain, const double* offset, DecodeIsa isa = decode_isa());
+
+/* 12 bit samples packed two to three bytes (LE: a[7:0], b[3:0] a[11:8], b[11:4]) back to uint16,
+ * src holds (count + 1) / 2 * 3 bytes */
+void decode_unpack12(const uint8_t* src, int count, uint16_t* dst, DecodeIsa isa = decode_isa());
+
+#endif // DECODE_H
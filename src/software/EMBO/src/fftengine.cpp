@@ -0,0 +1,187 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "fftengine.h"
+
+#include <QtMath>
+
+#include <string.h>
+#include <assert.h>
+
+
+#define FFT_DB_FLOOR    1e-12   // -240 dB, avoids log of zero
+
+
+FftEngine::~FftEngine()
+{
+    clear();
+}
+
+void FftEngine::clear()
+{
+    for (auto it = m_plans.begin(); it != m_plans.end(); ++it)
+    {
+        fftw_destroy_plan(it->plan);
+        fftw_free(it->in);
+        fftw_free(it->out);
+    }
+
+    m_plans.clear();
+    m_pow.clear();
+    m_win.clear();
+    m_winLen = 0;
+}
+
+FftEngine::Plan* FftEngine::getPlan(int size)
+{
+    auto it = m_plans.find(size);
+    if (it != m_plans.end())
+        return &it.value();
+
+    Plan p;
+    p.in = fftw_alloc_real(size);
+    p.out = fftw_alloc_complex(size / 2 + 1);
+    p.plan = NULL;
+
+    if (p.in != NULL && p.out != NULL)
+    {
+        // MEASURE is slow only first time, wisdom makes it instant afterwards
+        p.plan = fftw_plan_dft_r2c_1d(size, p.in, p.out, FFTW_MEASURE);
+        m_wisdomChanged = true;
+    }
+
+    if (p.plan == NULL)
+    {
+        if (p.in != NULL) fftw_free(p.in);
+        if (p.out != NULL) fftw_free(p.out);
+        return NULL;
+    }
+
+    return &m_plans.insert(size, p).value();
+}
+
+const QVector<double>& FftEngine::getWindow(FftWindow window, int len, double& sum)
+{
+    if (window != m_winType || len != m_winLen)
+    {
+        m_win.resize(len);
+        double* w = m_win.data();
+        double N = (len > 1) ? (len - 1) : 1;
+
+        for (int i = 0; i < len; i++)
+        {
+            double x = 2 * M_PI * i / N;
+
+            if (window == FFT_WIN_BLACKMAN_HARRIS)
+                w[i] = 0.35875 - 0.48829*cos(x) + 0.14128*cos(2*x) - 0.01168*cos(3*x);
+            else if (window == FFT_WIN_FLATTOP)
+                w[i] = 0.21557895 - 0.41663158*cos(x) + 0.277263158*cos(2*x) - 0.083578947*cos(3*x) + 0.006947368*cos(4*x);
+            else
+                w[i] = 0.5 * (1 - cos(x)); // hanning
+        }
+
+        m_winSum = 0;
+        for (int i = 0; i < len; i++)
+            m_winSum += w[i];
+
+        m_winType = window;
+        m_winLen = len;
+    }
+
+    sum = m_winSum;
+    return m_win;
+}
+
+bool FftEngine::compute(const double* y, int n, int size, FftWindow window, int welch, QVector<double>& out_db)
+{
+    assert(size >= 2 && n > 0);
+
+    Plan* p = getPlan(size);
+    if (p == NULL)
+        return false;
+
+    if (n > size)
+        n = size;
+    if (welch < 1)
+        welch = 1;
+
+    /* welch segments with 50 % overlap: n = (welch + 1) * seg / 2 */
+    int seg = (welch == 1) ? n : (2 * n) / (welch + 1);
+    if (seg < 16)
+    {
+        seg = n;
+        welch = 1;
+    }
+    int step = (welch == 1) ? 0 : (n - seg) / (welch - 1);
+
+    double win_sum;
+    const double* w = getWindow(window, seg, win_sum).constData();
+
+    const int bins = size / 2;
+    m_pow.fill(0, bins);
+    double* pw = m_pow.data();
+
+    for (int s = 0; s < welch; s++)
+    {
+        const double* ys = y + s * step;
+
+        for (int i = 0; i < seg; i++)
+            p->in[i] = w[i] * ys[i];
+
+        memset(p->in + seg, 0, (size - seg) * sizeof(double)); // zero pad
+
+        fftw_execute(p->plan);
+
+        for (int k = 0; k < bins; k++)
+            pw[k] += p->out[k][0] * p->out[k][0] + p->out[k][1] * p->out[k][1];
+    }
+
+    /* single sided amplitude, corrected by window coherent gain */
+    const double scale = 2.0 / win_sum;
+    const double norm = 1.0 / welch;
+
+    out_db.resize(bins);
+    double* db = out_db.data();
+
+    for (int k = 0; k < bins; k++)
+    {
+        double mag = sqrt(pw[k] * norm) * scale;
+        db[k] = 20 * log10(mag > FFT_DB_FLOOR ? mag : FFT_DB_FLOOR);
+    }
+
+    return true;
+}
+
+QString FftEngine::exportWisdom()
+{
+    m_wisdomChanged = false;
+
+    char* str = fftw_export_wisdom_to_string();
+    if (str == NULL)
+        return QString();
+
+    QString ret = QString::fromLatin1(str);
+    fftw_free(str);
+
+    return ret;
+}
+
+bool FftEngine::importWisdom(const QString& wisdom)
+{
+    if (wisdom.isEmpty())
+        return false;
+
+    return fftw_import_wisdom_from_string(wisdom.toLatin1().constData()) != 0;
+}
+
+QString FftEngine::windowName(FftWindow window)
+{
+    if (window == FFT_WIN_BLACKMAN_HARRIS)
+        return "Blackman-Harris";
+    else if (window == FFT_WIN_FLATTOP)
+        return "Flat-top";
+    else
+        return "Hanning";
+}
@@ -0,0 +1,64 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef FFTENGINE_H
+#define FFTENGINE_H
+
+#include "lib/fftw3.h"
+
+#include <QVector>
+#include <QString>
+#include <QMap>
+
+
+enum FftWindow
+{
+    FFT_WIN_HANNING         = 0,
+    FFT_WIN_BLACKMAN_HARRIS = 1,
+    FFT_WIN_FLATTOP         = 2
+};
+
+/* real-to-complex magnitude spectrum with cached plans and window tables, not thread-safe */
+class FftEngine
+{
+public:
+    FftEngine() {}
+    ~FftEngine();
+
+    /* spectrum of y[0..n) zero padded to size, out = size/2 bins in dB (amplitude), welch = segment count */
+    bool compute(const double* y, int n, int size, FftWindow window, int welch, QVector<double>& out_db);
+
+    /* drop all plans and buffers */
+    void clear();
+
+    bool isWisdomChanged() const { return m_wisdomChanged; }
+    QString exportWisdom();
+    static bool importWisdom(const QString& wisdom);
+
+    static QString windowName(FftWindow window);
+
+private:
+    struct Plan
+    {
+        fftw_plan plan;
+        double* in;
+        fftw_complex* out;
+    };
+
+    Plan* getPlan(int size);
+    const QVector<double>& getWindow(FftWindow window, int len, double& sum);
+
+    QMap<int, Plan> m_plans;    // per fft size
+
+    QVector<double> m_win;
+    FftWindow m_winType = FFT_WIN_HANNING;
+    int m_winLen = 0;
+    double m_winSum = 0;
+
+    QVector<double> m_pow;      // welch power accumulator
+    bool m_wisdomChanged = false;
+};
+
+#endif // FFTENGINE_H
@@ -0,0 +1,242 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "labits.h"
+#include "lib/qcustomplot.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <cmath>
+#include <assert.h>
+
+
+void LaBits::setData(const uint8_t* data, int len, int firstPos, int mem, const int* pins, int ch_num)
+{
+    assert(len > 0 && mem >= 0 && ch_num <= LA_CH_MAX);
+
+    m_size = mem;
+    m_chNum = ch_num;
+
+    const int words = (mem + 63) / 64;
+
+    for (int c = 0; c < LA_CH_MAX; c++)
+    {
+        m_plane[c].resize(c < ch_num ? words : 0);
+        m_edges[c].resize(0);
+        m_pending[c] = (c < ch_num);
+    }
+
+    /* one word = 64 samples of all channels, raw byte read only once */
+    for (int w = 0, k = 0, i = firstPos; w < words; w++)
+    {
+        quint64 acc[LA_CH_MAX] = {};
+        int n = std::min(64, mem - k);
+
+        for (int b = 0; b < n; b++, k++, i++)
+        {
+            if (i >= len)
+                i = 0;
+
+            uint8_t v = data[i];
+
+            for (int c = 0; c < ch_num; c++)
+                acc[c] |= (quint64)((v >> pins[c]) & 1) << b;
+        }
+
+        for (int c = 0; c < ch_num; c++)
+            m_plane[c][w] = acc[c];
+    }
+
+    for (int c = 0; c < ch_num; c++)
+        findEdges(c);
+}
+
+void LaBits::findEdges(int ch)
+{
+    QVector<int>& edges = m_edges[ch];
+    const quint64* p = m_plane[ch].constData();
+    const int words = m_plane[ch].size();
+
+    if (words == 0)
+        return;
+
+    quint64 carry = p[0] & 1; // no edge at sample 0
+
+    for (int w = 0; w < words; w++)
+    {
+        quint64 x = p[w];
+        quint64 diff = x ^ ((x << 1) | carry); // bit j set = sample j differs from j-1
+        carry = x >> 63;
+
+        if (w == words - 1 && (m_size & 63))
+            diff &= (1ULL << (m_size & 63)) - 1;
+
+        while (diff)
+        {
+            edges.append(w * 64 + qCountTrailingZeroBits(diff));
+            diff &= diff - 1;
+        }
+    }
+}
+
+void LaBits::clear()
+{
+    for (int c = 0; c < LA_CH_MAX; c++)
+    {
+        m_plane[c].clear();
+        m_edges[c].clear();
+        m_pending[c] = false;
+    }
+
+    m_size = 0;
+    m_chNum = 0;
+}
+
+int LaBits::nextEdge(int ch, int from) const
+{
+    const QVector<int>& e = m_edges[ch];
+    auto it = std::upper_bound(e.constBegin(), e.constEnd(), from);
+
+    return it == e.constEnd() ? -1 : *it;
+}
+
+int LaBits::prevEdge(int ch, int from) const
+{
+    const QVector<int>& e = m_edges[ch];
+    auto it = std::lower_bound(e.constBegin(), e.constEnd(), from);
+
+    return it == e.constBegin() ? -1 : *(it - 1);
+}
+
+int LaBits::memoryUsage() const
+{
+    int ret = 0;
+
+    for (int c = 0; c < LA_CH_MAX; c++)
+        ret += m_plane[c].size() * sizeof(quint64) + m_edges[c].size() * sizeof(int);
+
+    return ret;
+}
+
+bool LaBits::render(QCPGraph* graph, int ch, double dt, int pixels)
+{
+    if (ch >= m_chNum || m_size == 0 || dt <= 0)
+        return true;
+
+    if (!m_pending[ch] && graph->data()->isEmpty()) // graph was cleared meanwhile, keep it so
+        return true;
+
+    m_pending[ch] = false;
+
+    const QCPRange rng = graph->keyAxis()->range();
+    const int n = m_size;
+
+    /* first sample >= lower, first sample > upper, clamped before int cast */
+    int i0 = (int)qBound(0.0, std::ceil(rng.lower / dt), (double)n);
+    int i1 = (int)qBound(0.0, std::floor(rng.upper / dt) + 1, (double)n);
+
+    /* one point outside on each side, so lines reach the edges */
+    if (i0 > 0) i0--;
+    if (i1 < n) i1++;
+
+    int cnt = i1 - i0;
+    if (cnt <= 0)
+    {
+        graph->data()->clear();
+        return true;
+    }
+    if (pixels < 1)
+        pixels = 1;
+
+    m_outKeys.resize(0);
+    m_outValues.resize(0);
+
+    if (cnt <= LA_PTS_PER_PIXEL * pixels) // every sample
+    {
+        m_outKeys.reserve(cnt);
+        m_outValues.reserve(cnt);
+
+        for (int i = i0; i < i1; i++)
+        {
+            m_outKeys.append(i * dt);
+            m_outValues.append(level(ch, i));
+        }
+
+        graph->setData(m_outKeys, m_outValues, true);
+        return true;
+    }
+
+    /* edges inside visible range */
+    const int* e = m_edges[ch].constData();
+    const int e_num = m_edges[ch].size();
+    int e0 = std::upper_bound(e, e + e_num, i0) - e;
+    int e1 = std::lower_bound(e, e + e_num, i1) - e;
+
+    if (e1 - e0 <= pixels) // two points per edge
+    {
+        bool lvl = level(ch, i0);
+
+        m_outKeys.reserve(2 * (e1 - e0) + 2);
+        m_outValues.reserve(2 * (e1 - e0) + 2);
+
+        m_outKeys.append(i0 * dt);
+        m_outValues.append(lvl);
+
+        for (int j = e0; j < e1; j++)
+        {
+            m_outKeys.append((e[j] - 1) * dt);
+            m_outValues.append(lvl);
+            lvl = !lvl;
+            m_outKeys.append(e[j] * dt);
+            m_outValues.append(lvl);
+        }
+
+        m_outKeys.append((i1 - 1) * dt);
+        m_outValues.append(lvl);
+    }
+    else // per pixel, toggling pixel is drawn as full 0..1 swing
+    {
+        m_outKeys.reserve(2 * pixels + 1);
+        m_outValues.reserve(2 * pixels + 1);
+
+        int j = e0;
+
+        for (int b = 0; b < pixels; b++)
+        {
+            int s0 = i0 + (int)((qint64)cnt * b / pixels);
+            int s1 = i0 + (int)((qint64)cnt * (b + 1) / pixels);
+
+            if (s1 <= s0)
+                continue;
+
+            bool toggles = false;
+            while (j < e1 && e[j] < s1)
+            {
+                toggles = true;
+                j++;
+            }
+
+            if (toggles)
+            {
+                m_outKeys.append(s0 * dt);
+                m_outValues.append(0);
+                m_outKeys.append((s0 + (s1 - s0) / 2) * dt);
+                m_outValues.append(1);
+            }
+            else
+            {
+                m_outKeys.append(s0 * dt);
+                m_outValues.append(level(ch, s0));
+            }
+        }
+
+        m_outKeys.append((i1 - 1) * dt);
+        m_outValues.append(level(ch, i1 - 1));
+    }
+
+    graph->setData(m_outKeys, m_outValues, true);
+    return false;
+}
@@ -0,0 +1,65 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef LABITS_H
+#define LABITS_H
+
+#include <QVector>
+
+#include <stdint.h>
+
+class QCPGraph;
+
+
+#define LA_CH_MAX           4
+#define LA_PTS_PER_PIXEL    2   // below this density samples are drawn exactly
+
+
+/* logic analyzer capture as packed bitplanes (1 bit per sample) plus edge list per channel */
+class LaBits
+{
+public:
+    LaBits() {}
+
+    /* unpack mem samples of raw circular buffer starting at firstPos, pins[ch] = bit of channel in raw byte */
+    void setData(const uint8_t* data, int len, int firstPos, int mem, const int* pins, int ch_num);
+    void clear();
+
+    bool isEmpty() const { return m_size == 0; }
+    int size() const { return m_size; }
+    int chNum() const { return m_chNum; }
+
+    bool level(int ch, int i) const { return (m_plane[ch][i >> 6] >> (i & 63)) & 1; }
+    const QVector<quint64>& plane(int ch) const { return m_plane[ch]; }    // 64 samples per word, LSB first
+    bool startLevel(int ch) const { return m_size > 0 && level(ch, 0); }
+
+    /* sample indexes where level differs from previous sample, sorted */
+    const QVector<int>& edges(int ch) const { return m_edges[ch]; }
+
+    /* first edge > from / last edge < from, -1 if none */
+    int nextEdge(int ch, int from) const;
+    int prevEdge(int ch, int from) const;
+
+    /* bytes used by bitplanes and edge lists */
+    int memoryUsage() const;
+
+    /* pushes visible part of channel into graph, key of sample i is i * dt, returns false when decimated */
+    bool render(QCPGraph* graph, int ch, double dt, int pixels);
+
+private:
+    void findEdges(int ch);
+
+    int m_size = 0;
+    int m_chNum = 0;
+    bool m_pending[LA_CH_MAX] = {};     // new data not yet rendered
+
+    QVector<quint64> m_plane[LA_CH_MAX];
+    QVector<int> m_edges[LA_CH_MAX];
+
+    QVector<double> m_outKeys;
+    QVector<double> m_outValues;
+};
+
+#endif // LABITS_H
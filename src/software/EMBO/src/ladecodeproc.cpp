@@ -0,0 +1,99 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "ladecodeproc.h"
+
+#include <QMutexLocker>
+#include <QElapsedTimer>
+
+
+LaDecodeProc::LaDecodeProc(QObject* parent) : QObject(parent)
+{
+}
+
+LaDecodeProc::~LaDecodeProc()
+{
+    delete m_decoder;
+}
+
+void LaDecodeProc::submit(const LaBits& bits, const LaDecoderCfg& cfg, int seq)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_pendingBits = bits; // implicitly shared, cheap
+    m_pendingCfg = cfg;
+    m_pendingSeq = seq;
+    m_pendingValid = true;
+
+    if (m_busy)
+        return;
+
+    m_busy = true;
+
+    QMetaObject::invokeMethod(this, "on_run", Qt::QueuedConnection);
+}
+
+bool LaDecodeProc::takeResult(LaDecodeResult& out)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (!m_backReady)
+        return false;
+
+    std::swap(out, m_back);
+    m_backReady = false;
+
+    return true;
+}
+
+void LaDecodeProc::on_run()
+{
+    forever
+    {
+        m_lock.lock();
+
+        if (!m_pendingValid)
+        {
+            m_busy = false;
+            m_lock.unlock();
+            return;
+        }
+
+        LaBits bits = m_pendingBits;
+        LaDecoderCfg cfg = m_pendingCfg;
+        int seq = m_pendingSeq;
+        m_pendingBits.clear();
+        m_pendingValid = false;
+
+        m_lock.unlock();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        if (cfg != m_cfg || m_decoder == NULL)
+        {
+            delete m_decoder;
+            m_decoder = LaDecoder::create(cfg, bits.chNum());
+            m_cfg = cfg;
+        }
+
+        LaDecodeResult res;
+        res.seq = seq;
+        res.proto = (m_decoder != NULL) ? cfg.proto : LA_PROTO_NONE;
+
+        if (m_decoder != NULL) // captures are not contiguous, every one is decoded from sample 0
+        {
+            m_decoder->reset();
+            m_decoder->decode(bits, bits.size(), res.frames);
+        }
+
+        res.ms = timer.nsecsElapsed() / 1000000.0;
+
+        m_lock.lock();
+        std::swap(res, m_back);
+        m_backReady = true;
+        m_lock.unlock();
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef LADECODEPROC_H
+#define LADECODEPROC_H
+
+#include "labits.h"
+#include "ladecoder.h"
+
+#include <QObject>
+#include <QVector>
+#include <QMutex>
+
+
+/* decoded frames of one capture, handed to GUI at plot timer tick */
+class LaDecodeResult
+{
+public:
+    int seq = -1;
+    LaProto proto = LA_PROTO_NONE;
+    QVector<LaFrame> frames;
+    double ms = 0;
+};
+
+/* protocol decoding of LA captures, lives in its own thread */
+class LaDecodeProc : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LaDecodeProc(QObject* parent = nullptr);
+    ~LaDecodeProc();
+
+    /* called from GUI thread, newest capture wins, seq is returned with result */
+    void submit(const LaBits& bits, const LaDecoderCfg& cfg, int seq);
+    bool takeResult(LaDecodeResult& out);
+
+private slots:
+    void on_run();
+
+private:
+    QMutex m_lock;
+    bool m_busy = false;
+    bool m_pendingValid = false;
+    LaBits m_pendingBits;
+    LaDecoderCfg m_pendingCfg;
+    int m_pendingSeq = -1;
+
+    LaDecodeResult m_back;
+    bool m_backReady = false;
+
+    /* worker state */
+    LaDecoder* m_decoder = NULL;
+    LaDecoderCfg m_cfg;
+};
+
+#endif // LADECODEPROC_H
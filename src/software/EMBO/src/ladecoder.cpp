@@ -0,0 +1,304 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "ladecoder.h"
+
+#include <algorithm>
+#include <limits.h>
+
+
+#define UART_MIN_SPB    2.0     // less samples per bit can not be decoded
+
+
+bool LaDecoderCfg::operator==(const LaDecoderCfg& o) const
+{
+    return proto == o.proto && fs == o.fs &&
+           uart_rx == o.uart_rx && uart_baud == o.uart_baud &&
+           spi_clk == o.spi_clk && spi_mosi == o.spi_mosi && spi_miso == o.spi_miso && spi_cs == o.spi_cs && spi_mode == o.spi_mode &&
+           i2c_scl == o.i2c_scl && i2c_sda == o.i2c_sda;
+}
+
+LaDecoder* LaDecoder::create(const LaDecoderCfg& cfg, int ch_num)
+{
+    auto valid = [ch_num](int ch) { return ch >= 0 && ch < ch_num; };
+
+    if (cfg.proto == LA_PROTO_UART)
+    {
+        if (!valid(cfg.uart_rx) || cfg.fs <= 0 || cfg.uart_baud <= 0)
+            return NULL;
+
+        return new LaDecoderUart(cfg.uart_rx, cfg.fs, cfg.uart_baud);
+    }
+    else if (cfg.proto == LA_PROTO_SPI)
+    {
+        if (!valid(cfg.spi_clk) || !valid(cfg.spi_mosi))
+            return NULL;
+
+        return new LaDecoderSpi(cfg.spi_clk, cfg.spi_mosi, valid(cfg.spi_miso) ? cfg.spi_miso : -1,
+                                valid(cfg.spi_cs) ? cfg.spi_cs : -1, cfg.spi_mode);
+    }
+    else if (cfg.proto == LA_PROTO_I2C)
+    {
+        if (!valid(cfg.i2c_scl) || !valid(cfg.i2c_sda))
+            return NULL;
+
+        return new LaDecoderI2c(cfg.i2c_scl, cfg.i2c_sda);
+    }
+
+    return NULL;
+}
+
+QString LaDecoder::protoName(LaProto proto)
+{
+    if (proto == LA_PROTO_UART)
+        return "UART";
+    else if (proto == LA_PROTO_SPI)
+        return "SPI";
+    else if (proto == LA_PROTO_I2C)
+        return "I2C";
+    else
+        return "None";
+}
+
+/********************************* UART *********************************/
+
+void LaDecoderUart::decode(const LaBits& bits, int end, QVector<LaFrame>& out)
+{
+    if (m_spb < UART_MIN_SPB)
+    {
+        m_pos = end;
+        return;
+    }
+
+    forever
+    {
+        /* start bit = falling edge */
+        int e = m_pos - 1;
+        do
+        {
+            e = bits.nextEdge(m_rx, e);
+        }
+        while (e >= 0 && e < end && bits.level(m_rx, e));
+
+        if (e < 0 || e >= end)
+        {
+            m_pos = end;
+            return;
+        }
+
+        int stop = e + (int)(9.5 * m_spb);
+        if (stop >= end) // frame not complete yet
+        {
+            m_pos = e;
+            return;
+        }
+
+        if (bits.level(m_rx, e + (int)(0.5 * m_spb))) // glitch
+        {
+            m_pos = e + 1;
+            continue;
+        }
+
+        int val = 0;
+        for (int b = 0; b < 8; b++)
+            val |= bits.level(m_rx, e + (int)((1.5 + b) * m_spb)) << b;
+
+        LaFrame f;
+        f.start = e;
+        f.end = std::min(e + (int)(10 * m_spb) - 1, end - 1);
+        f.ch = m_rx;
+        f.text = QString::asprintf("0x%02X", val);
+        if (val >= 0x20 && val < 0x7F)
+            f.text += QString(" '") + QChar(val) + "'";
+        f.error = !bits.level(m_rx, stop); // framing error
+        out.append(f);
+
+        m_pos = stop;
+    }
+}
+
+/********************************* SPI *********************************/
+
+LaDecoderSpi::LaDecoderSpi(int clk, int mosi, int miso, int cs, int mode) :
+    m_clk(clk), m_mosi(mosi), m_miso(miso), m_cs(cs)
+{
+    m_sampleRising = (mode == 0 || mode == 3); // CPOL == CPHA samples on rising edge
+}
+
+void LaDecoderSpi::reset()
+{
+    LaDecoder::reset();
+
+    m_bit = 0;
+    m_mosiVal = 0;
+    m_misoVal = 0;
+}
+
+void LaDecoderSpi::flushWord(QVector<LaFrame>& out, int end, bool error)
+{
+    LaFrame f;
+    f.start = m_start;
+    f.end = end;
+    f.ch = m_mosi;
+    f.text = QString::asprintf("0x%02X", m_mosiVal);
+    if (m_miso >= 0)
+        f.text += QString::asprintf(" / 0x%02X", m_misoVal);
+    f.error = error;
+    out.append(f);
+
+    m_bit = 0;
+    m_mosiVal = 0;
+    m_misoVal = 0;
+}
+
+void LaDecoderSpi::decode(const LaBits& bits, int end, QVector<LaFrame>& out)
+{
+    forever
+    {
+        int c = bits.nextEdge(m_clk, m_pos - 1);
+        int d = (m_cs >= 0) ? bits.nextEdge(m_cs, m_pos - 1) : -1;
+
+        if (c < 0 || c >= end) c = INT_MAX;
+        if (d < 0 || d >= end) d = INT_MAX;
+
+        if (c == INT_MAX && d == INT_MAX)
+        {
+            m_pos = end;
+            return;
+        }
+
+        if (d <= c) // CS change, word boundary
+        {
+            m_pos = d + 1;
+
+            if (bits.level(m_cs, d) && m_bit > 0) // deselected in the middle of word
+                flushWord(out, d, true);
+
+            m_bit = 0;
+            m_mosiVal = 0;
+            m_misoVal = 0;
+            continue;
+        }
+
+        m_pos = c + 1;
+
+        if (bits.level(m_clk, c) != m_sampleRising)
+            continue;
+        if (m_cs >= 0 && bits.level(m_cs, c)) // not selected
+            continue;
+
+        if (m_bit == 0)
+            m_start = c;
+
+        m_mosiVal = (m_mosiVal << 1) | bits.level(m_mosi, c);
+        if (m_miso >= 0)
+            m_misoVal = (m_misoVal << 1) | bits.level(m_miso, c);
+
+        if (++m_bit == 8)
+            flushWord(out, c, false);
+    }
+}
+
+/********************************* I2C *********************************/
+
+void LaDecoderI2c::reset()
+{
+    LaDecoder::reset();
+
+    m_busy = false;
+    m_addr = false;
+    m_bit = 0;
+    m_byte = 0;
+}
+
+void LaDecoderI2c::decode(const LaBits& bits, int end, QVector<LaFrame>& out)
+{
+    forever
+    {
+        int c = bits.nextEdge(m_scl, m_pos - 1);
+        int d = bits.nextEdge(m_sda, m_pos - 1);
+
+        if (c < 0 || c >= end) c = INT_MAX;
+        if (d < 0 || d >= end) d = INT_MAX;
+
+        if (c == INT_MAX && d == INT_MAX)
+        {
+            m_pos = end;
+            return;
+        }
+
+        if (c <= d) // SCL first, SDA sampled on rising edge
+        {
+            m_pos = c + 1;
+
+            if (!m_busy || !bits.level(m_scl, c))
+                continue;
+
+            bool b = bits.level(m_sda, c);
+
+            if (m_bit == 0)
+                m_start = c;
+
+            if (m_bit < 8)
+            {
+                m_byte = (m_byte << 1) | b;
+                m_bit++;
+                continue;
+            }
+
+            LaFrame f;
+            f.start = m_start;
+            f.end = c;
+            f.ch = m_sda;
+            if (m_addr)
+                f.text = QString::asprintf("ADDR 0x%02X %s", m_byte >> 1, (m_byte & 1) ? "R" : "W");
+            else
+                f.text = QString::asprintf("0x%02X", m_byte);
+            f.text += b ? " NAK" : " ACK";
+            f.error = false;
+            out.append(f);
+
+            m_addr = false;
+            m_bit = 0;
+            m_byte = 0;
+        }
+        else // SDA change, only START / STOP when SCL is high
+        {
+            m_pos = d + 1;
+
+            if (!bits.level(m_scl, d))
+                continue;
+
+            LaFrame f;
+            f.start = d;
+            f.end = d;
+            f.ch = m_sda;
+
+            if (!bits.level(m_sda, d))
+            {
+                f.text = m_busy ? "Sr" : "S";
+                f.error = m_busy && m_bit > 1; // one SCL rise always precedes Sr
+
+                m_busy = true;
+                m_addr = true;
+            }
+            else
+            {
+                if (!m_busy)
+                    continue;
+
+                f.text = "P";
+                f.error = m_bit > 1;
+
+                m_busy = false;
+            }
+
+            out.append(f);
+
+            m_bit = 0;
+            m_byte = 0;
+        }
+    }
+}
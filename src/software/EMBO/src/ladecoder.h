@@ -0,0 +1,131 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef LADECODER_H
+#define LADECODER_H
+
+#include "labits.h"
+
+#include <QString>
+#include <QVector>
+
+
+enum LaProto
+{
+    LA_PROTO_NONE = 0,
+    LA_PROTO_UART = 1,
+    LA_PROTO_SPI  = 2,
+    LA_PROTO_I2C  = 3
+};
+
+/* one decoded word or bus condition */
+struct LaFrame
+{
+    int start;          // first sample
+    int end;            // last sample
+    int ch;             // channel annotation belongs to
+    QString text;
+    bool error;
+};
+
+/* channel mapping and protocol params, channel -1 = not used */
+struct LaDecoderCfg
+{
+    LaProto proto = LA_PROTO_NONE;
+    double fs = 0;              // real sample rate
+
+    int uart_rx = 0;
+    int uart_baud = 9600;
+
+    int spi_clk = 0;
+    int spi_mosi = 1;
+    int spi_miso = 2;
+    int spi_cs = 3;             // active low
+    int spi_mode = 0;           // CPOL << 1 | CPHA
+
+    int i2c_scl = 0;
+    int i2c_sda = 1;
+
+    bool operator==(const LaDecoderCfg& o) const;
+    bool operator!=(const LaDecoderCfg& o) const { return !(*this == o); }
+};
+
+/* protocol decoder working on LaBits edge lists, decode() with growing end continues where the last call ended,
+ * state belongs to one capture, reset() before next one */
+class LaDecoder
+{
+public:
+    virtual ~LaDecoder() {}
+
+    /* decode samples up to end (exclusive), appends finished frames */
+    virtual void decode(const LaBits& bits, int end, QVector<LaFrame>& out) = 0;
+
+    /* start over, next decode begins at sample 0 */
+    virtual void reset() { m_pos = 0; }
+
+    int getPos() const { return m_pos; }
+
+    /* NULL if proto is none or channels are out of capture */
+    static LaDecoder* create(const LaDecoderCfg& cfg, int ch_num);
+    static QString protoName(LaProto proto);
+
+protected:
+    int m_pos = 0;      // samples before this are done
+};
+
+/* 8N1, idle high, LSB first */
+class LaDecoderUart : public LaDecoder
+{
+public:
+    LaDecoderUart(int rx, double fs, int baud) : m_rx(rx), m_spb(fs / baud) {}
+
+    void decode(const LaBits& bits, int end, QVector<LaFrame>& out) override;
+
+private:
+    int m_rx;
+    double m_spb;       // samples per bit
+};
+
+/* MSB first, 8 bit words, CS optional */
+class LaDecoderSpi : public LaDecoder
+{
+public:
+    LaDecoderSpi(int clk, int mosi, int miso, int cs, int mode);
+
+    void decode(const LaBits& bits, int end, QVector<LaFrame>& out) override;
+    void reset() override;
+
+private:
+    void flushWord(QVector<LaFrame>& out, int end, bool error);
+
+    int m_clk, m_mosi, m_miso, m_cs;
+    bool m_sampleRising;
+
+    int m_bit = 0;
+    int m_start = 0;
+    int m_mosiVal = 0;
+    int m_misoVal = 0;
+};
+
+/* 7 bit addressing, START / STOP / ACK detection */
+class LaDecoderI2c : public LaDecoder
+{
+public:
+    LaDecoderI2c(int scl, int sda) : m_scl(scl), m_sda(sda) {}
+
+    void decode(const LaBits& bits, int end, QVector<LaFrame>& out) override;
+    void reset() override;
+
+private:
+    int m_scl, m_sda;
+
+    bool m_busy = false;    // between START and STOP
+    bool m_addr = false;    // next byte is address
+    int m_bit = 0;          // 0..7 data, 8 = ack
+    int m_byte = 0;
+    int m_start = 0;
+};
+
+#endif // LADECODER_H
@@ -6,6 +6,7 @@
 
 #include "messages.h"
 #include "core.h"
+#include "utils.h"
 
 /****************************** Messages - SCPI ******************************/
 
@@ -95,7 +96,7 @@ void Msg_SYS_Lims::on_dataRx()
 
     QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
 
-    if (tokens.size() != 17 || tokens[6].size() < 2 || tokens[16].size() != 4)
+    if ((tokens.size() != 17 && tokens.size() != 18) || tokens[6].size() < 2 || tokens[16].size() != 4)
     {
         core->err(INVALID_MSG + m_rxData, true);
         return;
@@ -126,6 +127,7 @@ void Msg_SYS_Lims::on_dataRx()
     devInfo->la_ch2_pin = tokens[16][1].toLatin1() - '0';
     devInfo->la_ch3_pin = tokens[16][2].toLatin1() - '0';
     devInfo->la_ch4_pin = tokens[16][3].toLatin1() - '0';
+    devInfo->features = tokens.size() > 17 ? tokens[17] : ""; // older firmware has no features field
 }
 
 
@@ -193,6 +195,29 @@ void Msg_SYS_Uptime::on_dataRx()
     core->setUptime(m_rxData);
 }
 
+void Msg_SYS_Baud::on_dataRx()
+{
+    qInfo() << "SYS:BAUD: " <<  m_rxData;
+    auto core = Core::getInstance(this);
+
+    if (!getIsQuery())
+    {
+        if (!m_rxData.contains(EMBO_OK))
+            core->err("UART baud change failed! " + m_rxData, true);
+        return;
+    }
+
+    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+
+    if (tokens.size() != 2)
+    {
+        core->setBaudDev(-1, -1); // garbled, wrong baud
+        return;
+    }
+
+    core->setBaudDev(tokens[0].toInt(), tokens[1].toInt());
+}
+
 void Msg_Dummy::on_dataRx()
 {
     qInfo() << "STB: " <<  m_rxData;
@@ -204,6 +229,26 @@ void Msg_Dummy::on_dataRx()
 
 void Msg_VM_Read::on_dataRx()
 {
+    if (!m_rxDataBin.isEmpty()) // binary block - all new samples at once
+    {
+        QVector<double> ch1, ch2, ch3, ch4, vcc;
+        int lost = 0;
+
+        int count = get_vm_from_bin(m_rxDataBin, &ch1, &ch2, &ch3, &ch4, &vcc, &lost);
+
+        qInfo() << "VM:READ:BIN: count: " << count << " lost: " << lost;
+
+        if (count < 0)
+        {
+            emit err(INVALID_MSG "VM:READ:BIN", CRITICAL, true);
+            return;
+        }
+
+        if (count > 0)
+            emit resultBin(ch1, ch2, ch3, ch4, vcc, lost);
+        return;
+    }
+
     qInfo() << "VM:READ: " <<  m_rxData;
 
     if (m_rxData.contains("Empty"))
@@ -220,6 +265,51 @@ void Msg_VM_Read::on_dataRx()
     emit result(tokens[0], tokens[1], tokens[2], tokens[3], tokens[4]);
 }
 
+void Msg_VM_Log::on_dataRx()
+{
+    qInfo() << "VM:LOG: " <<  m_rxData;
+
+    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+
+    if (getIsQuery())
+    {
+        if (tokens.size() != 4)
+        {
+            emit err(INVALID_MSG + m_rxData, CRITICAL, true);
+            return;
+        }
+
+        emit result(tokens[0] == "1", tokens[1].toInt(), tokens[2].toUInt(), tokens[3].toUInt());
+    }
+    else
+    {
+        if (tokens.size() != 3 || !m_rxData.contains(EMBO_OK))
+        {
+            emit err("VM logger set failed! " + m_rxData, CRITICAL, true);
+            return;
+        }
+
+        emit ok(tokens[1], tokens[2]); // 1 = logging, real record rate
+    }
+}
+
+void Msg_VM_LogRead::on_dataRx()
+{
+    QVector<double> ch1, ch2, ch3, ch4, vcc;
+    QVector<quint32> seq;
+
+    int count = get_vmlog_from_bin(m_rxDataBin, &ch1, &ch2, &ch3, &ch4, &vcc, &seq);
+
+    if (count < 0)
+    {
+        emit err(INVALID_MSG "VM:LOG:READ", CRITICAL, true);
+        return;
+    }
+
+    if (count > 0)
+        emit result(ch1, ch2, ch3, ch4, vcc, seq);
+}
+
 /***************************** Messages - SCOP **************************/
 
 void Msg_SCOP_Read::on_dataRx()
@@ -227,7 +317,7 @@ void Msg_SCOP_Read::on_dataRx()
     qInfo() << "SCOP:READ: size: " <<  m_rxDataBin.size();
     //qInfo () << m_rxDataBin.toHex();
 
-    emit result(m_rxDataBin);
+    emit result(QByteArray(m_rxDataBin.constData(), m_rxDataBin.size())); // deep copy, rx data is view only
 }
 
 void Msg_SCOP_Set::on_dataRx()
@@ -293,6 +383,91 @@ void Msg_SCOP_ForceTrig::on_dataRx()
     emit ok();
 }
 
+void Msg_SCOP_DBuf::on_dataRx()
+{
+    qInfo() << "SCOP:DBUF: " <<  m_rxData;
+
+    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+
+    if (tokens.size() != 2 || !m_rxData.contains(EMBO_OK))
+    {
+        emit err("SCOPE double buffering set failed! " + m_rxData, CRITICAL, true);
+        return;
+    }
+
+    emit ok(tokens[1]); // 1 = active, 0 = memory does not fit twice yet
+}
+
+void Msg_SCOP_Roll::on_dataRx()
+{
+    qInfo() << "SCOP:ROLL: " <<  m_rxData;
+
+    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+
+    if (getIsQuery())
+    {
+        if (tokens.size() != 3)
+        {
+            emit err(INVALID_MSG + m_rxData, CRITICAL, true);
+            return;
+        }
+
+        emit result(tokens[0] == "1", tokens[1].toUInt(), tokens[2].toUInt());
+    }
+    else
+    {
+        if (tokens.size() != 2 || !m_rxData.contains(EMBO_OK))
+        {
+            emit err("SCOPE roll mode set failed! " + m_rxData, CRITICAL, true);
+            return;
+        }
+
+        emit ok(tokens[1]); // 1 = streaming, 0 = triggered
+    }
+}
+
+void Msg_SCOP_RollRead::on_dataRx()
+{
+    //qInfo() << "SCOP:ROLL:READ: size: " <<  m_rxDataBin.size();
+
+    emit result(QByteArray(m_rxDataBin.constData(), m_rxDataBin.size())); // deep copy, rx data is view only
+}
+
+void Msg_SCOP_Seg::on_dataRx()
+{
+    qInfo() << "SCOP:SEG: " <<  m_rxData;
+
+    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+
+    if (getIsQuery())
+    {
+        if (tokens.size() != 3)
+        {
+            emit err(INVALID_MSG + m_rxData, CRITICAL, true);
+            return;
+        }
+
+        emit result(tokens[0] == "1", tokens[1].toInt(), tokens[2].toInt());
+    }
+    else
+    {
+        if (tokens.size() != 2 || !m_rxData.contains(EMBO_OK))
+        {
+            emit err("SCOPE segmented memory set failed! " + m_rxData, CRITICAL, true);
+            return;
+        }
+
+        emit ok(tokens[1]); // segments which fit device memory, 0 = off
+    }
+}
+
+void Msg_SCOP_SegRead::on_dataRx()
+{
+    qInfo() << "SCOP:SEG:READ: size: " <<  m_rxDataBin.size();
+
+    emit result(QByteArray(m_rxDataBin.constData(), m_rxDataBin.size())); // deep copy, rx data is view only
+}
+
 /***************************** Messages - LA ****************************/
 
 void Msg_LA_Read::on_dataRx()
@@ -300,7 +475,66 @@ void Msg_LA_Read::on_dataRx()
     qInfo() << "LA:READ: size: " <<  m_rxDataBin.size();
     //qInfo () << m_rxDataBin.toHex();
 
-    emit result(m_rxDataBin);
+    if (getParams() == EMBO_LA_COMP)
+    {
+        emit result(decodeRle(m_rxDataBin));
+        return;
+    }
+
+    emit result(QByteArray(m_rxDataBin.constData(), m_rxDataBin.size())); // deep copy, rx data is view only
+}
+
+/* inverse of firmware daq_la_rle, channel levels are put back to their GPIO bits, other bits are 0
+ * token: low nibble = CH1..CH4, high nibble h = run of h+1, h = 15 = run of 16 + LEB128 */
+QByteArray Msg_LA_Read::decodeRle(const QByteArray& data)
+{
+    auto info = Core::getInstance(this)->getDevInfo();
+    const int pins[4] = { info->la_ch1_pin, info->la_ch2_pin, info->la_ch3_pin, info->la_ch4_pin };
+
+    uint8_t lut[16];
+    for (int n = 0; n < 16; n++)
+    {
+        lut[n] = 0;
+        for (int c = 0; c < 4; c++)
+        {
+            if ((n >> c) & 1)
+                lut[n] |= 1 << pins[c];
+        }
+    }
+
+    const int out_max = info->mem + info->daq_reserve;
+
+    QByteArray out;
+    out.reserve(out_max);
+
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data.constData());
+    const int sz = data.size();
+
+    for (int i = 0; i < sz; )
+    {
+        uint8_t t = p[i++];
+        int run = (t >> 4) + 1;
+
+        if (run == 16)
+        {
+            int n = 0;
+            for (int shift = 0; i < sz && shift < 21; shift += 7)
+            {
+                uint8_t b = p[i++];
+                n |= (b & 0x7F) << shift;
+                if (!(b & 0x80))
+                    break;
+            }
+            run += n;
+        }
+
+        if (out.size() + run > out_max) // corrupted
+            break;
+
+        out.append(run, (char)lut[t & 0x0F]);
+    }
+
+    return out; // length is checked by WindowLa
 }
 
 void Msg_LA_Set::on_dataRx()
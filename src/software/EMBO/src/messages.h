@@ -20,14 +20,27 @@
 #define EMBO_SYS_INFO       ":SYS:INFO"
 #define EMBO_SYS_MODE       ":SYS:MODE"
 #define EMBO_SYS_UPTIME     ":SYS:UPT"
+#define EMBO_SYS_BAUD       ":SYS:BAUD"
+#define EMBO_SYS_SEQ        ":SYS:SEQ"
 
 #define EMBO_VM_READ        ":VM:READ"
+#define EMBO_VM_READ_BIN    ":VM:READ:BIN"
+#define EMBO_VM_LOG         ":VM:LOG"
+#define EMBO_VM_LOG_READ    ":VM:LOG:READ"
 
 #define EMBO_SCOP_READ      ":SCOP:READ"
 #define EMBO_SCOP_SET       ":SCOP:SET"
 #define EMBO_SCOP_FORCETRIG ":SCOP:FORC"
+#define EMBO_SCOP_DBUF      ":SCOP:DBUF"
+#define EMBO_SCOP_ROLL      ":SCOP:ROLL"
+#define EMBO_SCOP_ROLL_READ ":SCOP:ROLL:READ"
+#define EMBO_SCOP_SEG       ":SCOP:SEG"
+#define EMBO_SCOP_SEG_READ  ":SCOP:SEG:READ"
+#define EMBO_SCOP_PACK      "PACK"         // SCOP:READ? param - 12 bit samples packed 2 to 3 bytes
+#define EMBO_SCOP_DEC       "DEC"          // SCOP:READ? param - DEC,<factor>,<SUB|PEAK|MEAN>, linear decimated frame
 
 #define EMBO_LA_READ        ":LA:READ"
+#define EMBO_LA_COMP        "COMP"         // LA:READ? param - run-length encoded data
 #define EMBO_LA_SET         ":LA:SET"
 #define EMBO_LA_FORCETRIG   ":LA:FORC"
 
@@ -109,6 +122,14 @@ public:
     virtual void on_dataRx() override;
 };
 
+class Msg_SYS_Baud : public Msg
+{
+    Q_OBJECT
+public:
+    explicit Msg_SYS_Baud(QObject* parent=0) : Msg(EMBO_SYS_BAUD, true, parent) {};
+    virtual void on_dataRx() override;
+};
+
 class Msg_Dummy : public Msg
 {
     Q_OBJECT
@@ -123,10 +144,33 @@ class Msg_VM_Read : public Msg
 {
     Q_OBJECT
 public:
-    explicit Msg_VM_Read(QObject* parent=0) : Msg(EMBO_VM_READ, true, parent) {};
+    explicit Msg_VM_Read(QObject* parent=0, bool bin=false) : Msg(bin ? EMBO_VM_READ_BIN : EMBO_VM_READ, true, parent) {};
     virtual void on_dataRx() override;
 signals:
     void result(const QString ch1, const QString ch2, const QString ch3, const QString ch4, const QString vcc);
+    void resultBin(const QVector<double> ch1, const QVector<double> ch2, const QVector<double> ch3, const QVector<double> ch4,
+                   const QVector<double> vcc, int lost);
+};
+
+class Msg_VM_Log : public Msg
+{
+    Q_OBJECT
+public:
+    explicit Msg_VM_Log(QObject* parent=0) : Msg(EMBO_VM_LOG, false, parent) {};
+    virtual void on_dataRx() override;
+signals:
+    void result(bool active, int avg, quint32 seq, quint32 overruns);
+};
+
+class Msg_VM_LogRead : public Msg
+{
+    Q_OBJECT
+public:
+    explicit Msg_VM_LogRead(QObject* parent=0) : Msg(EMBO_VM_LOG_READ, true, parent) {};
+    virtual void on_dataRx() override;
+signals:
+    void result(const QVector<double> ch1, const QVector<double> ch2, const QVector<double> ch3, const QVector<double> ch4,
+                const QVector<double> vcc, const QVector<quint32> seq);
 };
 
 /***************************** Messages - SCOP **************************/
@@ -162,6 +206,54 @@ public:
     virtual void on_dataRx() override;
 };
 
+class Msg_SCOP_DBuf : public Msg
+{
+    Q_OBJECT
+public:
+    explicit Msg_SCOP_DBuf(QObject* parent=0) : Msg(EMBO_SCOP_DBUF, false, parent) {};
+    virtual void on_dataRx() override;
+};
+
+class Msg_SCOP_Roll : public Msg
+{
+    Q_OBJECT
+public:
+    explicit Msg_SCOP_Roll(QObject* parent=0) : Msg(EMBO_SCOP_ROLL, false, parent) {};
+    virtual void on_dataRx() override;
+signals:
+    void result(bool active, quint32 seq, quint32 overruns);
+};
+
+class Msg_SCOP_RollRead : public Msg
+{
+    Q_OBJECT
+public:
+    explicit Msg_SCOP_RollRead(QObject* parent=0) : Msg(EMBO_SCOP_ROLL_READ, true, parent) {};
+    virtual void on_dataRx() override;
+signals:
+    void result(const QByteArray data);
+};
+
+class Msg_SCOP_Seg : public Msg
+{
+    Q_OBJECT
+public:
+    explicit Msg_SCOP_Seg(QObject* parent=0) : Msg(EMBO_SCOP_SEG, false, parent) {};
+    virtual void on_dataRx() override;
+signals:
+    void result(bool active, int num, int cnt);
+};
+
+class Msg_SCOP_SegRead : public Msg
+{
+    Q_OBJECT
+public:
+    explicit Msg_SCOP_SegRead(QObject* parent=0) : Msg(EMBO_SCOP_SEG_READ, true, parent) {};
+    virtual void on_dataRx() override;
+signals:
+    void result(const QByteArray data);
+};
+
 /***************************** Messages - LA ****************************/
 
 class Msg_LA_Read : public Msg
@@ -172,6 +264,8 @@ public:
     virtual void on_dataRx() override;
 signals:
     void result(const QByteArray data);
+private:
+    QByteArray decodeRle(const QByteArray& data);
 };
 
 class Msg_LA_Set : public Msg
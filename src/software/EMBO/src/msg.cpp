@@ -30,4 +30,5 @@ void Msg::fire(const QByteArray data)
 {
     m_rxDataBin = data;
     emit rx_bin();
+    m_rxDataBin.clear(); // data can be raw view into core rx buffer, dont keep it
 }
@@ -23,7 +23,7 @@ public:
     virtual ~Msg() {};
 
     void fire(const QString data);
-    void fire(const QByteArray data);
+    void fire(const QByteArray data); // data is valid only inside on_dataRx, copy before queued emit
 
     QString getCmd() { return this->m_cmd; }
     bool getIsQuery() { return this->m_isQuery; }
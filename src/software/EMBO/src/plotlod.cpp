@@ -0,0 +1,148 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "plotlod.h"
+
+#include <algorithm>
+#include <assert.h>
+
+
+void PlotLod::setData(const QVector<double>& keys, const QVector<double>& values)
+{
+    assert(keys.size() == values.size());
+
+    m_keys = keys;
+    m_values = values;
+    m_pending = true;
+
+    int n = values.size();
+    int level = 0;
+    const double* src_min = values.constData();
+    const double* src_max = values.constData();
+
+    while (n > 1)
+    {
+        int m = (n + 1) / 2;
+
+        if (m_min.size() <= level)
+        {
+            m_min.resize(level + 1);
+            m_max.resize(level + 1);
+        }
+
+        m_min[level].resize(m);
+        m_max[level].resize(m);
+
+        double* dmin = m_min[level].data();
+        double* dmax = m_max[level].data();
+
+        for (int j = 0; j < n / 2; j++)
+        {
+            dmin[j] = std::min(src_min[2*j], src_min[2*j+1]);
+            dmax[j] = std::max(src_max[2*j], src_max[2*j+1]);
+        }
+        if (n & 1)
+        {
+            dmin[m-1] = src_min[n-1];
+            dmax[m-1] = src_max[n-1];
+        }
+
+        src_min = dmin;
+        src_max = dmax;
+        n = m;
+        level++;
+    }
+
+    m_min.resize(level);
+    m_max.resize(level);
+}
+
+void PlotLod::clear()
+{
+    m_keys.clear();
+    m_values.clear();
+    m_min.clear();
+    m_max.clear();
+    m_pending = false;
+}
+
+bool PlotLod::render(QCPGraph* graph, int pixels)
+{
+    if (m_keys.isEmpty())
+        return true;
+
+    if (!m_pending && graph->data()->isEmpty()) // graph was cleared meanwhile, forget it too
+    {
+        clear();
+        return true;
+    }
+
+    m_pending = false;
+
+    const QCPRange rng = graph->keyAxis()->range();
+    const double* k = m_keys.constData();
+    const double* v = m_values.constData();
+    const int n = m_keys.size();
+
+    int i0 = std::lower_bound(k, k + n, rng.lower) - k;
+    int i1 = std::upper_bound(k, k + n, rng.upper) - k;
+
+    /* one point outside on each side, so lines reach the edges */
+    if (i0 > 0) i0--;
+    if (i1 < n) i1++;
+
+    int cnt = i1 - i0;
+    if (pixels < 1)
+        pixels = 1;
+
+    m_outKeys.resize(0);
+    m_outValues.resize(0);
+
+    if (cnt <= LOD_PTS_PER_PIXEL * pixels)
+    {
+        m_outKeys.reserve(cnt);
+        m_outValues.reserve(cnt);
+
+        for (int i = i0; i < i1; i++)
+        {
+            m_outKeys.append(k[i]);
+            m_outValues.append(v[i]);
+        }
+
+        graph->setData(m_outKeys, m_outValues, true);
+        return true;
+    }
+
+    /* smallest level with at most one block per pixel */
+    int level = 0;
+    int block = 2;
+    while (block * pixels < cnt && level + 1 < m_min.size())
+    {
+        block *= 2;
+        level++;
+    }
+
+    const double* bmin = m_min[level].constData();
+    const double* bmax = m_max[level].constData();
+    int j0 = i0 / block;
+    int j1 = (i1 - 1) / block;
+
+    m_outKeys.reserve(2 * (j1 - j0 + 1));
+    m_outValues.reserve(2 * (j1 - j0 + 1));
+
+    for (int j = j0; j <= j1; j++)
+    {
+        int first = j * block;
+        int mid = std::min(first + block / 2, n - 1);
+
+        m_outKeys.append(k[first]);
+        m_outValues.append(bmin[j]);
+        m_outKeys.append(k[mid]);
+        m_outValues.append(bmax[j]);
+    }
+
+    graph->setData(m_outKeys, m_outValues, true);
+    return false;
+}
@@ -0,0 +1,49 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef PLOTLOD_H
+#define PLOTLOD_H
+
+#include "lib/qcustomplot.h"
+
+#include <QVector>
+
+
+#define LOD_PTS_PER_PIXEL   2   // below this density points are drawn exactly
+
+
+/* min/max pyramid of one trace, graph gets only ~2 points per pixel of visible key range */
+class PlotLod
+{
+public:
+    PlotLod() {}
+
+    /* keys must be sorted, O(n) once per frame */
+    void setData(const QVector<double>& keys, const QVector<double>& values);
+    void clear();
+
+    bool isEmpty() const { return m_keys.isEmpty(); }
+    int size() const { return m_keys.size(); }
+    const QVector<double>& keys() const { return m_keys; }
+    const QVector<double>& values() const { return m_values; }
+
+    /* pushes visible part into graph, returns false when decimated */
+    bool render(QCPGraph* graph, int pixels);
+
+private:
+    bool m_pending = false;     // new data not yet rendered
+
+    QVector<double> m_keys;
+    QVector<double> m_values;
+
+    /* level k has blocks of 2^(k+1) samples */
+    QVector<QVector<double>> m_min;
+    QVector<QVector<double>> m_max;
+
+    QVector<double> m_outKeys;
+    QVector<double> m_outValues;
+};
+
+#endif // PLOTLOD_H
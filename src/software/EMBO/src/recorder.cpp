@@ -6,6 +6,7 @@
 #include "recorder.h"
 
 #include <QDir>
+#include <QFileInfo>
 #include <QPixmap>
 #include <QDateTime>
 #include <QStandardPaths>
@@ -58,7 +59,13 @@ QString Recorder::generateFilePath(QString prefix, QString ext)
 
 bool Recorder::createFile(QString prefix, QMap<QString,QString> header)
 {
-    generateFilePath(prefix, m_ext);
+    return openFile(generateFilePath(prefix, m_ext), header);
+}
+
+bool Recorder::openFile(QString path, QMap<QString,QString> header)
+{
+    m_file_path = path;
+    m_file_name = QFileInfo(path).fileName();
 
     m_file.setFileName(m_file_path);
     m_file.open(QIODevice::Append);
@@ -39,12 +39,14 @@ public:
     bool setDelim(Delim delim);
 
     QString getDir() const { return m_dir; }
+    QString getExt() const { return m_ext; }
     QString getFilePath() const { return m_file_path; }
     QString getFileName() const { return m_file_name; }
     Delim getDelim() const { return m_delim; }
     QString generateFilePath(QString prefix, QString ext);
 
     bool createFile(QString prefix, QMap<QString,QString> header);
+    bool openFile(QString path, QMap<QString,QString> header);
     QString closeFile();
 
     QString takeScreenshot(QString prefix, QWidget* widget);
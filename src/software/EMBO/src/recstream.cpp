@@ -0,0 +1,339 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "recstream.h"
+
+#include <QtEndian>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDir>
+
+#include <cmath>
+#include <cstring>
+
+
+#define REC_TAG_LEN         4
+#define REC_CHUNK_HDR_LEN   8
+#define REC_DATA_HDR_LEN    24
+#define REC_GAP_LEN         12
+
+
+static void put_u16(QByteArray& b, quint16 val)
+{
+    uchar tmp[2];
+    qToLittleEndian<quint16>(val, tmp);
+    b.append((const char*)tmp, 2);
+}
+
+static void put_u32(QByteArray& b, quint32 val)
+{
+    uchar tmp[4];
+    qToLittleEndian<quint32>(val, tmp);
+    b.append((const char*)tmp, 4);
+}
+
+static void put_f32(QByteArray& b, float val)
+{
+    quint32 raw;
+    std::memcpy(&raw, &val, 4);
+    put_u32(b, raw);
+}
+
+static void put_f64(QByteArray& b, double val)
+{
+    quint64 raw;
+    uchar tmp[8];
+    std::memcpy(&raw, &val, 8);
+    qToLittleEndian<quint64>(raw, tmp);
+    b.append((const char*)tmp, 8);
+}
+
+static float get_f32(const uchar* p)
+{
+    quint32 raw = qFromLittleEndian<quint32>(p);
+    float val;
+    std::memcpy(&val, &raw, 4);
+    return val;
+}
+
+static double get_f64(const uchar* p)
+{
+    quint64 raw = qFromLittleEndian<quint64>(p);
+    double val;
+    std::memcpy(&val, &raw, 8);
+    return val;
+}
+
+
+RecStream::RecStream(QObject* parent) : QThread(parent)
+{
+}
+
+RecStream::~RecStream()
+{
+    if (isRunning())
+        close();
+}
+
+bool RecStream::open(const QString& path, const QMap<QString,QString>& header, const QStringList& cols)
+{
+    m_path = path;
+    m_file.setFileName(path);
+
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QByteArray meta;
+    for (auto i = header.begin(); i != header.end(); ++i)
+        meta.append((i.key() + "\t" + i.value() + "\n").toUtf8());
+
+    m_file.write(REC_MAGIC, 8);
+    chunkWrite("META", meta);
+    chunkWrite("COLS", cols.join('\n').toUtf8());
+
+    m_block.clear();
+    m_block_rows = 0;
+    m_stop = false;
+    m_dropped = 0;
+
+    start(QThread::LowPriority);
+    return true;
+}
+
+QString RecStream::close()
+{
+    m_stop = true;
+    wait();
+
+    m_file.flush();
+    m_file.close();
+
+    return m_path;
+}
+
+void RecStream::push(double t_ms, const float* v, int cols)
+{
+    RecFrame frame;
+    frame.t = t_ms;
+    frame.cols = qMin(cols, REC_COLS_MAX);
+    frame.lost = 0;
+
+    for (int i = 0; i < frame.cols; i++)
+        frame.v[i] = v[i];
+
+    if (!m_queue.push(frame))
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecStream::pushGap(double t_ms, quint32 lost)
+{
+    RecFrame frame;
+    frame.t = t_ms;
+    frame.cols = 0;
+    frame.lost = lost;
+
+    if (!m_queue.push(frame))
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RecStream::run()
+{
+    RecFrame frame;
+    QElapsedTimer since_flush;
+    since_flush.start();
+
+    while (true)
+    {
+        bool any = false;
+
+        while (m_queue.pop(frame))
+        {
+            any = true;
+
+            if (frame.lost > 0)
+            {
+                QByteArray gap;
+                put_f64(gap, frame.t);
+                put_u32(gap, frame.lost);
+
+                blockFlush();
+                chunkWrite("GAP ", gap);
+            }
+            else
+            {
+                blockAdd(frame);
+            }
+        }
+
+        if (since_flush.elapsed() > REC_FLUSH_MS) // partial block on disk, so crash loses 1 s at most
+        {
+            blockFlush();
+            m_file.flush();
+            since_flush.restart();
+        }
+
+        if (!any)
+        {
+            if (m_stop)
+                break;
+
+            msleep(REC_IDLE_MS);
+        }
+    }
+
+    blockFlush();
+}
+
+/* rows share one DATA chunk while time step and column count stay the same */
+void RecStream::blockAdd(const RecFrame& frame)
+{
+    if (m_block_rows > 0)
+    {
+        bool split = (frame.cols != m_block_cols || m_block_rows >= REC_BLOCK_ROWS);
+
+        if (!split && m_block_rows == 1)
+            m_block_dt = frame.t - m_block_t0;
+        else if (!split)
+            split = std::fabs((frame.t - m_block_tlast) - m_block_dt) > std::fabs(m_block_dt) * 1e-6 + 1e-9;
+
+        if (split)
+            blockFlush();
+    }
+
+    if (m_block_rows == 0)
+    {
+        m_block_t0 = frame.t;
+        m_block_dt = 0;
+        m_block_cols = frame.cols;
+        m_block.reserve(REC_BLOCK_ROWS * REC_COLS_MAX);
+    }
+
+    for (int i = 0; i < frame.cols; i++)
+        m_block.append(frame.v[i]);
+
+    m_block_tlast = frame.t;
+    m_block_rows++;
+}
+
+void RecStream::blockFlush()
+{
+    if (m_block_rows == 0)
+        return;
+
+    QByteArray payload;
+    payload.reserve(REC_DATA_HDR_LEN + (m_block.size() * 4));
+
+    put_f64(payload, m_block_t0);
+    put_f64(payload, m_block_dt);
+    put_u32(payload, m_block_rows);
+    put_u16(payload, m_block_cols);
+    put_u16(payload, 0);
+
+    for (float v : m_block) // samples as pushed, no rescaling per block
+        put_f32(payload, v);
+
+    chunkWrite("DATA", payload);
+
+    m_block.clear();
+    m_block_rows = 0;
+}
+
+void RecStream::chunkWrite(const char* tag, const QByteArray& payload)
+{
+    QByteArray hdr(tag, REC_TAG_LEN);
+    put_u32(hdr, payload.size());
+
+    m_file.write(hdr);
+    m_file.write(payload);
+}
+
+QString RecStream::toText(const QString& path, Delim delim, int precision)
+{
+    QFile in(path);
+    if (!in.open(QIODevice::ReadOnly))
+        return "";
+
+    if (in.read(8) != REC_MAGIC)
+        return "";
+
+    Recorder rec(precision);
+    rec.setDelim(delim);
+
+    QFileInfo info(path);
+    QString out = QDir(info.absolutePath()).filePath(info.completeBaseName() + rec.getExt());
+    QFile::remove(out);
+
+    QMap<QString,QString> header;
+    bool opened = false;
+
+    /* chunk by chunk, recordings may be larger than memory */
+    while (true)
+    {
+        QByteArray hdr = in.read(REC_CHUNK_HDR_LEN);
+        if (hdr.size() < REC_CHUNK_HDR_LEN)
+            break;
+
+        QByteArray tag = hdr.left(REC_TAG_LEN);
+        qint64 len = qFromLittleEndian<quint32>((const uchar*)hdr.constData() + REC_TAG_LEN);
+
+        if (len > in.bytesAvailable()) // truncated, keep what is complete
+            break;
+
+        QByteArray data = in.read(len);
+        if (data.size() < len)
+            break;
+
+        const uchar* c = (const uchar*)data.constData();
+
+        if (tag == "META")
+        {
+            const QStringList lines = QString::fromUtf8(data).split('\n', QString::SkipEmptyParts);
+            for (const auto& line : lines)
+                header.insert(line.section('\t', 0, 0), line.section('\t', 1));
+        }
+        else if (tag == "COLS")
+        {
+            if (!rec.openFile(out, header))
+                return "";
+            opened = true;
+
+            const QStringList cols = QString::fromUtf8(data).split('\n');
+            for (const auto& col : cols)
+                rec << col;
+            rec << ENDL;
+        }
+        else if (tag == "DATA" && opened && len >= REC_DATA_HDR_LEN)
+        {
+            double t0 = get_f64(c);
+            double dt = get_f64(c + 8);
+            qint64 rows = qFromLittleEndian<quint32>(c + 16);
+            int cols = qFromLittleEndian<quint16>(c + 20);
+
+            if (cols > REC_COLS_MAX || REC_DATA_HDR_LEN + (rows * cols * 4) > len)
+                break;
+
+            c += REC_DATA_HDR_LEN;
+
+            for (qint64 r = 0; r < rows; r++)
+            {
+                rec << t0 + (r * dt);
+                for (int i = 0; i < cols; i++, c += 4)
+                    rec << (double)get_f32(c);
+                rec << ENDL;
+            }
+        }
+        else if (tag == "GAP " && opened && len >= REC_GAP_LEN)
+        {
+            rec << get_f64(c) << QString("GAP") << (int)qFromLittleEndian<quint32>(c + 8) << ENDL;
+        }
+    }
+
+    in.close();
+
+    if (!opened)
+        return "";
+
+    return rec.closeFile();
+}
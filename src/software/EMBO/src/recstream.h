@@ -0,0 +1,132 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef RECSTREAM_H
+#define RECSTREAM_H
+
+#include "recorder.h"
+
+#include <QThread>
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QFile>
+#include <QByteArray>
+#include <QVector>
+
+#include <atomic>
+#include <vector>
+
+
+#define REC_EXT             ".ebr"
+#define REC_MAGIC           "EMBOREC2"
+#define REC_COLS_MAX        4           // values per row, time excluded
+#define REC_QUEUE_LEN       65536       // rows, power of 2, ~2 s at 30 kHz
+#define REC_BLOCK_ROWS      4096        // max rows per DATA chunk
+#define REC_IDLE_MS         20          // writer sleep when queue is empty
+#define REC_FLUSH_MS        1000        // partial DATA chunk written after this
+
+
+/* one row or gap marker, plain data so queue never allocates */
+struct RecFrame
+{
+    double t;                   // ms
+    float v[REC_COLS_MAX];
+    quint16 cols;
+    quint32 lost;               // > 0 = gap marker, rows lost before t
+};
+
+/* single producer single consumer ring, lock-free, one slot always empty */
+template<typename T, int N>
+class RecQueue
+{
+    static_assert((N & (N - 1)) == 0, "RecQueue length must be power of 2");
+
+public:
+    RecQueue() : m_buff(N) {}
+
+    bool push(const T& item) // producer only
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t next = (head + 1) & (N - 1);
+
+        if (next == m_tail.load(std::memory_order_acquire))
+            return false;
+
+        m_buff[head] = item;
+        m_head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) // consumer only
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        if (tail == m_head.load(std::memory_order_acquire))
+            return false;
+
+        item = m_buff[tail];
+        m_tail.store((tail + 1) & (N - 1), std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> m_buff;
+    std::atomic<size_t> m_head {0};
+    std::atomic<size_t> m_tail {0};
+};
+
+/*
+ * Binary recording, GUI thread pushes rows, writer thread formats and writes them.
+ * File: REC_MAGIC, then chunks [char tag[4], u32 len, payload], all little endian:
+ *   META  "key\tvalue\n" lines (UTF-8)
+ *   COLS  column names separated by '\n', time column first
+ *   DATA  f64 t0 [ms], f64 dt [ms], u32 rows, u16 cols, u16 0, rows * cols f32 value (row major)
+ *   GAP   f64 t [ms], u32 rows lost
+ */
+class RecStream : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit RecStream(QObject* parent = nullptr);
+    ~RecStream();
+
+    bool open(const QString& path, const QMap<QString,QString>& header, const QStringList& cols);
+    QString close();
+
+    /* GUI thread, never blocks, row is dropped and counted when writer is behind */
+    void push(double t_ms, const float* v, int cols);
+    void pushGap(double t_ms, quint32 lost);
+
+    quint64 getDropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /* offline conversion to text with Recorder formatting, returns output path or empty on failure */
+    static QString toText(const QString& path, Delim delim, int precision);
+
+protected:
+    void run() override;
+
+private:
+    void blockAdd(const RecFrame& frame);
+    void blockFlush();
+    void chunkWrite(const char* tag, const QByteArray& payload);
+
+    QFile m_file;
+    QString m_path;
+    RecQueue<RecFrame, REC_QUEUE_LEN> m_queue;
+    std::atomic<bool> m_stop {false};
+    std::atomic<quint64> m_dropped {0};
+
+    /* writer state */
+    QVector<float> m_block;
+    double m_block_t0 = 0;
+    double m_block_dt = 0;
+    double m_block_tlast = 0;
+    int m_block_rows = 0;
+    int m_block_cols = 0;
+};
+
+#endif // RECSTREAM_H
@@ -0,0 +1,121 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "rxparser.h"
+
+
+void RxParser::reset()
+{
+    m_buff.clear();
+    m_spans.clear();
+    m_scan = 0;
+    m_msgStart = 0;
+    m_subStart = 0;
+    m_done = false;
+}
+
+void RxParser::append(const QByteArray& data)
+{
+    m_buff.append(data);
+}
+
+RxParser::Result RxParser::next()
+{
+    if (m_done)
+    {
+        m_spans.clear();
+        m_msgStart = m_scan;
+        m_done = false;
+    }
+
+    const char* buff = m_buff.constData();
+    const int buff_sz = m_buff.size();
+
+    while (m_scan < buff_sz)
+    {
+        const char c = buff[m_scan];
+
+        if (c == '#' && m_scan == m_subStart) // binary block #<n><len><data> at submessage start
+        {
+            if (m_scan + 2 > buff_sz) // header not complete, parse it again next time
+                break;
+
+            int n = buff[m_scan + 1] - '0';
+            if (n < 1 || n > 9)
+                return RX_ERR;
+
+            if (m_scan + 2 + n > buff_sz)
+                break;
+
+            int bin_len = 0;
+            for (int k = 0; k < n; k++)
+            {
+                const char d = buff[m_scan + 2 + k];
+                if (d < '0' || d > '9') // garbled header would move scan backwards
+                    return RX_ERR;
+                bin_len = (bin_len * 10) + (d - '0');
+            }
+
+            int bin_start = m_scan + 2 + n;
+            if (bin_start + bin_len > buff_sz) // data not complete, payload is never rescanned
+                break;
+
+            m_spans.append({bin_start, bin_len, true});
+            m_scan = bin_start + bin_len;
+            m_subStart = -1; // only delimiter or newline may follow
+            continue;
+        }
+
+        if (c == ';' || c == '\n') // end of submessage
+        {
+            if (m_subStart >= 0)
+            {
+                int sub_end = m_scan;
+                if (c == '\n' && sub_end > m_subStart && buff[sub_end - 1] == '\r')
+                    sub_end--;
+                if (sub_end > m_subStart)
+                    m_spans.append({m_subStart, sub_end - m_subStart, false});
+            }
+
+            m_scan++;
+            m_subStart = m_scan;
+
+            if (c == '\n') // end of message
+            {
+                m_done = true;
+                return RX_MSG;
+            }
+            continue;
+        }
+
+        m_scan++;
+    }
+
+    return RX_MORE;
+}
+
+/* drops processed bytes, once per read - buffer stays linear so block payloads go to Msg as views */
+void RxParser::compact()
+{
+    if (m_done)
+    {
+        m_spans.clear();
+        m_msgStart = m_scan;
+        m_done = false;
+    }
+
+    if (m_msgStart == 0)
+        return;
+
+    int consumed = m_msgStart;
+    m_buff.remove(0, consumed);
+
+    m_msgStart = 0;
+    m_scan -= consumed;
+    if (m_subStart >= 0)
+        m_subStart -= consumed;
+    for (auto& span : m_spans)
+        span.start -= consumed;
+}
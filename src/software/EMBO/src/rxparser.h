@@ -0,0 +1,53 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef RXPARSER_H
+#define RXPARSER_H
+
+#include <QByteArray>
+#include <QVector>
+
+
+/* one submessage of a respond, offsets into RxParser buffer */
+struct RxSpan
+{
+    int start;
+    int len;
+    bool bin;           // #<n><len> block payload
+};
+
+/* single pass splitter of device responds - ';' ends submessage, '\n' ends message, #<n><len> blocks
+ * are taken whole at submessage start, so every byte is scanned once however the stream is chunked */
+class RxParser
+{
+public:
+    enum Result
+    {
+        RX_MORE = 0,    // need more data
+        RX_MSG  = 1,    // message complete, spans valid until next call
+        RX_ERR  = 2     // malformed block header
+    };
+
+    void reset();
+    void append(const QByteArray& data);
+    Result next();
+    void compact();
+
+    const char* data() const { return m_buff.constData(); }
+    const QVector<RxSpan>& spans() const { return m_spans; }
+    int msgStart() const { return m_msgStart; }
+    int msgEnd() const { return m_scan; }
+    int size() const { return m_buff.size(); }
+
+private:
+    QByteArray m_buff;
+    QVector<RxSpan> m_spans;    // submessages of current message
+    int m_scan = 0;             // scan cursor, bytes before are parsed
+    int m_msgStart = 0;         // start of current message
+    int m_subStart = 0;         // start of current text submessage, -1 after binary block
+    bool m_done = false;        // last next() returned message, next one starts after it
+};
+
+#endif // RXPARSER_H
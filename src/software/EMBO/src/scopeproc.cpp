@@ -0,0 +1,570 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "scopeproc.h"
+#include "utils.h"
+#include "decode.h"
+
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QtMath>
+
+#include <algorithm>
+#include <assert.h>
+
+
+ScopeProc::ScopeProc(QObject* parent) : QObject(parent)
+{
+}
+
+ScopeProc::~ScopeProc()
+{
+}
+
+void ScopeProc::setPolicy(ProcPolicy policy)
+{
+    QMutexLocker locker(&m_lock);
+    m_policy = policy;
+}
+
+void ScopeProc::submit(const ScopeJob& job)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (m_busy)
+    {
+        if (m_policy == PROC_DROP)
+        {
+            m_dropped++;
+            return;
+        }
+
+        if (m_pendingValid) // coalesce, newest frame wins
+            m_dropped++;
+
+        m_pending = job;
+        m_pendingValid = true;
+        return;
+    }
+
+    m_pending = job;
+    m_pendingValid = true;
+    m_busy = true;
+
+    QMetaObject::invokeMethod(this, "on_run", Qt::QueuedConnection);
+}
+
+bool ScopeProc::takeResult(ScopeResult& out)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (!m_backReady)
+        return false;
+
+    std::swap(out, m_back);
+    m_backReady = false;
+
+    return true;
+}
+
+void ScopeProc::flush()
+{
+    QMutexLocker locker(&m_lock);
+
+    m_pendingValid = false;
+    m_backReady = false;
+    m_epoch++;
+}
+
+void ScopeProc::on_run()
+{
+    forever
+    {
+        m_lock.lock();
+
+        if (!m_pendingValid)
+        {
+            m_busy = false;
+            m_lock.unlock();
+            return;
+        }
+
+        ScopeJob job = m_pending;
+        m_pending.data.clear();
+        m_pendingValid = false;
+        int epoch = m_epoch;
+
+        m_lock.unlock();
+
+        process(job, m_work);
+
+        m_lock.lock();
+
+        if (epoch == m_epoch) // results of flushed settings are thrown away
+        {
+            m_work.dropped = m_dropped;
+            std::swap(m_work, m_back);
+            m_backReady = true;
+        }
+
+        m_lock.unlock();
+    }
+}
+
+void ScopeProc::process(ScopeJob& job, ScopeResult& res)
+{
+    const DaqSettings& set = job.daqSet;
+    const bool en[4] = { set.ch1_en, set.ch2_en, set.ch3_en, set.ch4_en };
+
+    QElapsedTimer timer;
+    timer.start();
+
+    res.mem = set.mem;
+    res.ch_num = en[0] + en[1] + en[2] + en[3];
+    res.envelope = false;
+    res.trig_aligned = false;
+    res.trig_shift = 0;
+    res.strig_reject = false;
+    res.meas_valid = false;
+    res.fft_valid = false;
+    res.fft_err = false;
+
+    for (int i = 0; i < STAGE_CNT; i++)
+        res.stage_ms[i] = 0;
+
+    /************* parse circular buffer(s) *************/
+
+    for (int i = 0; i < 4; i++)
+        res.y[i].resize(set.mem);
+
+    decode(job, res);
+
+    if (res.ch_num == 0 || res.found / res.ch_num != set.mem) // wrong data size, GUI decides
+    {
+        res.stage_ms[STAGE_DECODE] = timer.nsecsElapsed() / 1000000.0;
+        return;
+    }
+
+    if (job.trig_align)
+        align(job, res);
+
+    for (int i = 0; i < 4; i++)
+        res.overlay[i].resize(0);
+
+    if (!job.overlay.isEmpty())
+        overlay(job, res);
+
+    /* software trigger, frames without condition skip rest of pipeline and averaging */
+    const int strig_ch = job.strig.ch - 1;
+
+    if (job.strig.mode != STRIG_OFF && !job.roll && strig_ch >= 0 && strig_ch < 4 && en[strig_ch] &&
+        m_strig.scan(job.strig, res.y[strig_ch].constData(), set.mem, set.fs_real_n) < 0)
+    {
+        res.strig_reject = true;
+    }
+
+    res.stage_ms[STAGE_DECODE] = timer.nsecsElapsed() / 1000000.0;
+
+    if (res.strig_reject)
+        return;
+
+    double* y1 = res.y[0].data();
+    double* y2 = res.y[1].data();
+    double* y3 = res.y[2].data();
+    double* y4 = res.y[3].data();
+
+    /************* math *************/
+
+    timer.restart();
+
+    if (job.math_2minus1 && en[0] && en[1])
+    {
+        for (int i = 0; i < set.mem; i++)
+            y1[i] = y2[i] - y1[i];
+    }
+
+    if (job.math_4minus3 && en[2] && en[3])
+    {
+        for (int i = 0; i < set.mem; i++)
+            y3[i] = y4[i] - y3[i];
+    }
+
+    res.stage_ms[STAGE_MATH] = timer.nsecsElapsed() / 1000000.0;
+
+    /************* average *************/
+
+    timer.restart();
+
+    if (job.average)
+    {
+        if (job.average_gen != m_avgGen || set.mem != m_avgMem)
+        {
+            for (int i = 0; i < 4; i++)
+                m_avg[i].setup(job.average_mode, job.average_num, en[i] ? set.mem : 0);
+
+            m_avgGen = job.average_gen;
+            m_avgMem = set.mem;
+        }
+
+        for (int i = 0; i < 4; i++)
+        {
+            if (!en[i])
+                continue;
+
+            m_avg[i].process(res.y[i]);
+
+            if (job.average_mode == AVG_ENVELOPE)
+                res.ymin[i] = m_avg[i].getMin();
+        }
+
+        res.envelope = (job.average_mode == AVG_ENVELOPE);
+    }
+
+    res.stage_ms[STAGE_AVG] = timer.nsecsElapsed() / 1000000.0;
+
+    /************* meas *************/
+
+    timer.restart();
+
+    if (job.meas_en)
+    {
+        int ch = job.meas_ch;
+
+        if (job.math_xy_12 && ch == 0) // XY graph values are Y channel
+            ch = 1;
+        else if (job.math_xy_34 && ch == 2)
+            ch = 3;
+
+        if (ch >= 0 && ch < 4 && en[ch] && set.mem > 0)
+        {
+            const double* y = res.y[ch].constData();
+            double sum = 0, sum2 = 0;
+            double min = y[0], max = y[0];
+
+            for (int i = 0; i < set.mem; i++)
+            {
+                sum += y[i];
+                sum2 += y[i] * y[i];
+                if (y[i] < min) min = y[i];
+                if (y[i] > max) max = y[i];
+            }
+
+            res.meas_avg = sum / set.mem;
+            res.meas_rms = sqrt(sum2 / set.mem);
+            res.meas_min = min;
+            res.meas_max = max;
+            res.meas_vpp = max - min;
+            res.meas_valid = true;
+        }
+    }
+
+    res.stage_ms[STAGE_MEAS] = timer.nsecsElapsed() / 1000000.0;
+
+    /************* FFT *************/
+
+    timer.restart();
+
+    if (job.fft)
+    {
+        int ch = job.fft_ch - 1;
+
+        if (ch >= 0 && ch < 4 && en[ch])
+        {
+            if (m_fft.compute(res.y[ch].constData(), set.mem, job.fft_size, job.fft_window, job.fft_welch, res.fft_db))
+                res.fft_valid = true;
+            else
+                res.fft_err = true;
+
+            if (m_fft.isWisdomChanged())
+                emit fftWisdom(m_fft.exportWisdom());
+        }
+    }
+    else
+        m_fft.clear();
+
+    res.stage_ms[STAGE_FFT] = timer.nsecsElapsed() / 1000000.0;
+}
+
+/* trigger crossing found on trigger channel with level in its volts, all channels moved by same fraction of sample,
+ * before math and averaging so both work on aligned frames */
+void ScopeProc::align(const ScopeJob& job, ScopeResult& res)
+{
+    const DaqSettings& set = job.daqSet;
+    const bool en[4] = { set.ch1_en, set.ch2_en, set.ch3_en, set.ch4_en };
+    const int ch = set.trig_ch - 1;
+
+    if (!job.triggered || job.dec_factor > 1 || ch < 0 || ch > 3 || !en[ch] || set.mem < 4)
+        return;
+
+    const int post = (int)((double)set.mem * ((double)(100 - set.trig_pre) / 100.0));
+    const int nominal = qBound(0, set.mem - post - 1, set.mem - 2);
+    const int window = qMax(TRIG_ALIGN_WIN_MIN, set.mem / TRIG_ALIGN_WIN_DIV);
+    const double level = (set.trig_val / 100.0) * job.vcc * job.gain[ch] + job.offset[ch];
+
+    double pos;
+    if (!TrigAlign::find(res.y[ch].constData(), set.mem, level, set.trig_edge, nominal, window, job.trig_interp, pos))
+        return;
+
+    res.trig_shift = pos - nominal;
+    res.trig_aligned = true;
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (en[i])
+            m_align.shift(res.y[i], res.trig_shift, job.trig_interp);
+    }
+}
+
+/* other segments go through decode and alignment same as frame, math, averaging and measurement are for frame only */
+void ScopeProc::overlay(const ScopeJob& job, ScopeResult& res)
+{
+    const DaqSettings& set = job.daqSet;
+    const bool en[4] = { set.ch1_en, set.ch2_en, set.ch3_en, set.ch4_en };
+
+    ScopeJob seg = job;
+    seg.overlay.clear();
+    seg.overlay_first.clear();
+    m_ovr.ch_num = res.ch_num;
+
+    for (int k = 0; k < job.overlay.size() && k < job.overlay_first.size(); k++)
+    {
+        seg.data = job.overlay[k];
+        seg.firstPos = job.overlay_first[k];
+
+        for (int i = 0; i < 4; i++)
+            m_ovr.y[i].resize(set.mem);
+
+        decode(seg, m_ovr);
+
+        if (m_ovr.found / res.ch_num != set.mem)
+            continue;
+
+        if (job.trig_align)
+            align(seg, m_ovr);
+
+        for (int i = 0; i < 4; i++)
+        {
+            if (en[i])
+                res.overlay[i].append(m_ovr.y[i]);
+        }
+    }
+}
+
+/* decimated trace back to mem samples in place, every block holds its value (PEAK: min first half, max second half) */
+static void dec_expand(QVector<double>& y, int mem, int factor, bool peak)
+{
+    const int blocks = peak ? y.size() / 2 : y.size();
+
+    y.resize(mem);
+    double* d = y.data();
+
+    for (int i = mem - 1; i >= 0; i--) // source index is never above i
+    {
+        int k = std::min(i / factor, blocks - 1);
+        d[i] = peak ? d[2 * k + (i - k * factor >= factor / 2)] : d[k];
+    }
+}
+
+/* packed 12 bit buffers (SCOP:READ? PACK) back to raw uint16 layout, each ADC buffer is packed separately,
+ * n = samples per channel in frame */
+bool ScopeProc::unpack(ScopeJob& job, int n)
+{
+    const DaqSettings& set = job.daqSet;
+    int seg[4] = { 0, 0, 0, 0 };
+    int seg_num = 0;
+
+    if (job.adc_num == 1)
+        seg[seg_num++] = n * (set.ch1_en + set.ch2_en + set.ch3_en + set.ch4_en);
+    else if (job.adc_num == 2)
+    {
+        if (set.ch1_en || set.ch2_en)
+            seg[seg_num++] = n * (set.ch1_en + set.ch2_en);
+        if (set.ch3_en || set.ch4_en)
+            seg[seg_num++] = n * (set.ch3_en + set.ch4_en);
+    }
+    else if (job.adc_num == 4)
+    {
+        const bool en[4] = { set.ch1_en, set.ch2_en, set.ch3_en, set.ch4_en };
+        for (int i = 0; i < 4; i++)
+        {
+            if (en[i])
+                seg[seg_num++] = n;
+        }
+    }
+
+    int packed_len = 0;
+    int samples = 0;
+    for (int i = 0; i < seg_num; i++)
+    {
+        packed_len += (seg[i] + 1) / 2 * 3;
+        samples += seg[i];
+    }
+
+    if (packed_len != job.data.size())
+        return false;
+
+    m_unpacked.resize(samples * 2);
+
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(job.data.constData());
+    uint16_t* dst = reinterpret_cast<uint16_t*>(m_unpacked.data());
+
+    for (int i = 0; i < seg_num; i++)
+    {
+        decode_unpack12(src, seg[i], dst);
+        src += (seg[i] + 1) / 2 * 3;
+        dst += seg[i];
+    }
+
+    std::swap(job.data, m_unpacked); // old packed buffer is reused next time
+    return true;
+}
+
+void ScopeProc::decode(ScopeJob& job, ScopeResult& res)
+{
+    const DaqSettings& set = job.daqSet;
+    int ch_num = res.ch_num;
+    int found = 0;
+
+    QVector<double>* _y1 = (set.ch1_en ? &res.y[0] : NULL);
+    QVector<double>* _y2 = (set.ch2_en ? &res.y[1] : NULL);
+    QVector<double>* _y3 = (set.ch3_en ? &res.y[2] : NULL);
+    QVector<double>* _y4 = (set.ch4_en ? &res.y[3] : NULL);
+
+    const double* g = job.gain;
+    const double* o = job.offset;
+
+    /* decimated frame is linear from trigger order start, without reserve */
+    const bool dec = job.dec_factor > 1 && job.dec_factor <= set.mem;
+    const int dec_len = dec ? (set.mem / job.dec_factor) * (job.dec_mode == DEC_PEAK ? 2 : 1) : 0;
+
+    if (ch_num == 0 || (job.packed && !unpack(job, dec ? dec_len : set.mem + job.daq_reserve)))
+    {
+        res.found = 0;
+        return;
+    }
+
+    if (dec)
+    {
+        job.firstPos = 0;
+        job.daq_reserve = 0;
+
+        for (int i = 0; i < 4; i++)
+            res.y[i].resize(dec_len);
+    }
+
+    const uint8_t* dataU8 = reinterpret_cast<const uint8_t*>(job.data.constData());
+
+    if (job.adc_num == 1)
+    {
+        uint8_t* buff1 = (uint8_t*)dataU8;
+        int buff1_len = job.data.size();
+
+        if (set.bits == B12)
+            buff1_len /= 2;
+
+        int buff1_mem = buff1_len - (job.daq_reserve * ch_num);
+
+        found += get_vals_from_circ(job.firstPos, buff1_mem, buff1_len, set.bits, job.vcc, buff1, _y1, _y2, _y3, _y4,
+                                    g[0], g[1], g[2], g[3], o[0], o[1], o[2], o[3]);
+    }
+    else if (job.adc_num == 2)
+    {
+        int buff_part = job.data.size();
+        int buff_part_raw = buff_part;
+
+        if (set.bits == B12)
+            buff_part /= 2;
+        buff_part /= ch_num;
+        buff_part_raw /= ch_num;
+
+        uint8_t* buff_it = (uint8_t*)dataU8;
+
+        uint8_t* buff1 = NULL;
+        int buff1_len = 0;
+        int buff1_mem;
+
+        uint8_t* buff2 = NULL;
+        int buff2_len = 0;
+        int buff2_mem;
+
+        if (set.ch1_en)
+        {
+            buff1 = buff_it;
+            buff_it += buff_part_raw;
+            buff1_len += buff_part;
+        }
+        if (set.ch2_en)
+        {
+            if (!set.ch1_en)
+                buff1 = buff_it;
+            buff_it += buff_part_raw;
+            buff1_len += buff_part;
+        }
+        if (set.ch3_en)
+        {
+            buff2 = buff_it;
+            buff_it += buff_part_raw;
+            buff2_len += buff_part;
+        }
+        if (set.ch4_en)
+        {
+            if (!set.ch3_en)
+                buff2 = buff_it;
+            buff2_len += buff_part;
+        }
+
+        buff1_mem = buff1_len - (job.daq_reserve * (set.ch1_en + set.ch2_en));
+        buff2_mem = buff2_len - (job.daq_reserve * (set.ch3_en + set.ch4_en));
+
+        if (set.ch1_en || set.ch2_en)
+            found += get_vals_from_circ(job.firstPos, buff1_mem, buff1_len, set.bits, job.vcc, buff1, _y1, _y2, NULL, NULL,
+                                        g[0], g[1], 0, 0, o[0], o[1], 0, 0);
+        if (set.ch3_en || set.ch4_en)
+            found += get_vals_from_circ(job.firstPos, buff2_mem, buff2_len, set.bits, job.vcc, buff2, _y3, _y4, NULL, NULL,
+                                        g[2], g[3], 0, 0, o[2], o[3], 0, 0);
+    }
+    else if (job.adc_num == 4)
+    {
+        int buff_part = job.data.size();
+        int buff_part_raw = buff_part;
+
+        if (set.bits == B12)
+            buff_part /= 2;
+        buff_part /= ch_num;
+        buff_part_raw /= ch_num;
+
+        uint8_t* buff_it = (uint8_t*)dataU8;
+        int buff_mem = buff_part - job.daq_reserve;
+
+        QVector<double>* y[4] = { _y1, _y2, _y3, _y4 };
+
+        for (int i = 0; i < 4; i++)
+        {
+            if (y[i] == NULL)
+                continue;
+
+            found += get_vals_from_circ(job.firstPos, buff_mem, buff_part, set.bits, job.vcc, buff_it, y[i], NULL, NULL, NULL,
+                                        g[i], 0, 0, 0, o[i], 0, 0, 0);
+            buff_it += buff_part_raw;
+        }
+    }
+    else assert(0);
+
+    res.found = found;
+
+    if (dec)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            if (found == dec_len * ch_num)
+                dec_expand(res.y[i], set.mem, job.dec_factor, job.dec_mode == DEC_PEAK);
+            else
+                res.y[i].resize(set.mem);
+        }
+
+        if (found == dec_len * ch_num)
+            res.found = set.mem * ch_num;
+    }
+}
@@ -0,0 +1,180 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef SCOPEPROC_H
+#define SCOPEPROC_H
+
+#include "containers.h"
+#include "waveavg.h"
+#include "trigalign.h"
+#include "softtrig.h"
+#include "fftengine.h"
+
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
+
+
+enum ProcPolicy
+{
+    PROC_DROP       = 0,    // frame arriving while busy is thrown away
+    PROC_COALESCE   = 1     // frame arriving while busy replaces the waiting one
+};
+
+enum ScopeDec
+{
+    DEC_OFF         = 0,    // full resolution
+    DEC_SUB         = 1,    // every Nth sample
+    DEC_PEAK        = 2,    // min and max of N samples
+    DEC_MEAN        = 3     // mean of N samples
+};
+
+enum ProcStage
+{
+    STAGE_DECODE = 0,
+    STAGE_MATH,
+    STAGE_AVG,
+    STAGE_MEAS,
+    STAGE_FFT,
+    STAGE_CNT
+};
+
+/* everything one frame needs, snapshot taken on GUI thread */
+class ScopeJob
+{
+public:
+    QByteArray data;
+    int firstPos;
+
+    DaqSettings daqSet;
+    bool packed;            // 12 bit samples packed 2 to 3 bytes
+    int dec_factor;         // device decimated the frame, 1 = full resolution
+    ScopeDec dec_mode;
+    int adc_num;
+    int daq_reserve;
+    double vcc;
+    double gain[4];
+    double offset[4];
+
+    bool math_2minus1;
+    bool math_4minus3;
+    bool math_xy_12;
+    bool math_xy_34;
+
+    bool triggered;         // READY_NORMAL / READY_SINGLE frame
+    bool trig_align;        // move frame to sub-sample trigger crossing
+    AlignInterp trig_interp;
+    bool roll;
+    SoftTrigCfg strig;
+
+    QVector<QByteArray> overlay;    // other memory segments drawn behind frame, same layout as data
+    QVector<int> overlay_first;
+
+    bool average;
+    AvgMode average_mode;
+    int average_num;
+    int average_gen;        // bumped by GUI whenever averaging must restart
+
+    bool meas_en;
+    int meas_ch;            // graph index
+
+    bool fft;
+    int fft_ch;
+    int fft_size;
+    FftWindow fft_window;
+    int fft_welch;          // welch segments, 1 = off
+};
+
+/* processed frame, handed to GUI at plot timer tick */
+class ScopeResult
+{
+public:
+    int mem = 0;
+    int found = 0;
+    int ch_num = 0;
+
+    QVector<double> y[4];
+    QVector<double> ymin[4];    // envelope lower traces
+    bool envelope = false;
+
+    bool trig_aligned = false;
+    double trig_shift = 0;      // samples frame was moved by
+    bool strig_reject = false;  // software trigger condition not found, frame not to be shown
+
+    QVector<QVector<double>> overlay[4];    // decoded overlay segments of each channel
+
+    bool meas_valid = false;
+    double meas_vpp = 0;
+    double meas_rms = 0;
+    double meas_avg = 0;
+    double meas_min = 0;
+    double meas_max = 0;
+
+    bool fft_valid = false;
+    bool fft_err = false;
+    QVector<double> fft_db;
+
+    double stage_ms[STAGE_CNT] = {};
+    int dropped = 0;            // frames dropped or coalesced so far
+};
+
+/* post-processing pipeline of scope frames, lives in its own thread */
+class ScopeProc : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ScopeProc(QObject* parent = nullptr);
+    ~ScopeProc();
+
+    void setPolicy(ProcPolicy policy);
+
+    /* called from GUI thread, never blocks on processing */
+    void submit(const ScopeJob& job);
+    bool takeResult(ScopeResult& out);
+
+    /* forget queued frame and result, used when settings change */
+    void flush();
+
+signals:
+    void fftWisdom(const QString wisdom);
+
+private slots:
+    void on_run();
+
+private:
+    void process(ScopeJob& job, ScopeResult& res);
+    void decode(ScopeJob& job, ScopeResult& res);
+    bool unpack(ScopeJob& job, int n);
+    void align(const ScopeJob& job, ScopeResult& res);
+    void overlay(const ScopeJob& job, ScopeResult& res);
+
+    QMutex m_lock;
+    ProcPolicy m_policy = PROC_COALESCE;
+    bool m_busy = false;
+    bool m_pendingValid = false;
+    ScopeJob m_pending;
+    int m_dropped = 0;
+    int m_epoch = 0;
+
+    /* double buffer, worker fills work and swaps it with back, GUI swaps back with its front */
+    ScopeResult m_work;
+    ScopeResult m_back;
+    bool m_backReady = false;
+
+    /* worker state */
+    QByteArray m_unpacked;
+    WaveAvg m_avg[4];
+    int m_avgGen = -1;
+    int m_avgMem = 0;
+    TrigAlign m_align;
+    ScopeResult m_ovr;
+    SoftTrig m_strig;
+
+    FftEngine m_fft;
+};
+
+#endif // SCOPEPROC_H
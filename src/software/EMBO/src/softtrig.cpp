@@ -0,0 +1,266 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "softtrig.h"
+
+#include <QtMath>
+
+#include <algorithm>
+#include <string.h>
+
+
+/* fractional sample where level is crossed between i-1 and i */
+static inline double cross(const double* y, int i, double level)
+{
+    double d = y[i] - y[i - 1];
+    return d == 0 ? i : (i - 1) + (level - y[i - 1]) / d;
+}
+
+static inline bool width_ok(SoftTrigMode mode, double w, double width)
+{
+    return (mode == STRIG_PULSE_GT || mode == STRIG_SLEW_GT) ? w > width : w < width;
+}
+
+int SoftTrig::scan(const SoftTrigCfg& cfg, const double* y, int len, double fs)
+{
+    if (cfg.mode == STRIG_OFF)
+        return 0;
+
+    if (len < 2)
+        return -1;
+
+    const double width = cfg.time * fs;
+
+    if (cfg.mode == STRIG_PULSE_GT || cfg.mode == STRIG_PULSE_LT)
+        classify(y, len, cfg.level, cfg.level);
+    else
+        classify(y, len, qMin(cfg.lo, cfg.hi), qMax(cfg.lo, cfg.hi));
+
+    findEvents();
+
+    switch (cfg.mode)
+    {
+    case STRIG_PULSE_GT:
+    case STRIG_PULSE_LT:
+        return scanPulse(cfg, y, width);
+    case STRIG_RUNT:
+        return scanRunt(cfg);
+    case STRIG_WINDOW:
+        return scanWindow(cfg);
+    case STRIG_SLEW_GT:
+    case STRIG_SLEW_LT:
+        return scanSlew(cfg, y, width);
+    default:
+        return 0;
+    }
+}
+
+void SoftTrig::classify(const double* y, int len, double lo, double hi)
+{
+    m_cls.resize(len);
+    uint8_t* c = m_cls.data();
+
+    for (int i = 0; i < len; i++) // no branches, compiler vectorizes
+        c[i] = (uint8_t)((y[i] >= lo) + (y[i] >= hi));
+}
+
+void SoftTrig::findEvents()
+{
+    const uint8_t* c = m_cls.constData();
+    const int len = m_cls.size();
+
+    m_ev.resize(0);
+
+    int i = 1;
+    while (i < len)
+    {
+        if (i + 8 <= len)
+        {
+            uint64_t a, b;
+            memcpy(&a, c + i, 8);
+            memcpy(&b, c + i - 1, 8);
+
+            if (a != b)
+            {
+                for (int end = i + 8; i < end; i++)
+                {
+                    if (c[i] != c[i - 1])
+                        m_ev.append(i);
+                }
+            }
+            else
+                i += 8;
+
+            continue;
+        }
+
+        if (c[i] != c[i - 1])
+            m_ev.append(i);
+        i++;
+    }
+}
+
+/* single level, classes alternate 0 / 2, every event closes previous pulse */
+int SoftTrig::scanPulse(const SoftTrigCfg& cfg, const double* y, double width)
+{
+    const uint8_t* c = m_cls.constData();
+    double start = -1;
+
+    for (int i : m_ev)
+    {
+        bool rise = c[i] > c[i - 1];
+        double t = cross(y, i, cfg.level);
+
+        if (start >= 0 && width_ok(cfg.mode, t - start, width))
+            return i;
+
+        bool wanted = cfg.polarity == BOTH || rise == (cfg.polarity == RISING);
+        start = wanted ? t : -1;
+    }
+
+    return -1;
+}
+
+int SoftTrig::scanRunt(const SoftTrigCfg& cfg)
+{
+    const uint8_t* c = m_cls.constData();
+    int armed = 0; // 1 = left bottom upwards, -1 = left top downwards
+
+    for (int i : m_ev)
+    {
+        uint8_t prev = c[i - 1];
+        uint8_t cur = c[i];
+
+        if ((armed > 0 && cur == 0) || (armed < 0 && cur == 2)) // back without reaching other level
+            return i;
+
+        armed = 0;
+
+        if (prev == 0 && cur == 1 && cfg.polarity != FALLING)
+            armed = 1;
+        else if (prev == 2 && cur == 1 && cfg.polarity != RISING)
+            armed = -1;
+    }
+
+    return -1;
+}
+
+int SoftTrig::scanWindow(const SoftTrigCfg& cfg)
+{
+    const uint8_t* c = m_cls.constData();
+
+    for (int i : m_ev)
+    {
+        if (c[i] == 2 && cfg.polarity != FALLING)
+            return i;
+        if (c[i] == 0 && cfg.polarity != RISING)
+            return i;
+    }
+
+    return -1;
+}
+
+/* transition starts when bottom (top) class is left and ends when top (bottom) is reached, 0 -> 2 in one sample too */
+int SoftTrig::scanSlew(const SoftTrigCfg& cfg, const double* y, double width)
+{
+    const uint8_t* c = m_cls.constData();
+    const double lo = qMin(cfg.lo, cfg.hi);
+    const double hi = qMax(cfg.lo, cfg.hi);
+
+    int dir = 0;
+    double start = 0;
+
+    for (int i : m_ev)
+    {
+        uint8_t prev = c[i - 1];
+        uint8_t cur = c[i];
+
+        if (prev == 0)
+        {
+            dir = (cfg.polarity != FALLING) ? 1 : 0;
+            start = cross(y, i, lo);
+        }
+        else if (prev == 2)
+        {
+            dir = (cfg.polarity != RISING) ? -1 : 0;
+            start = cross(y, i, hi);
+        }
+
+        if (dir > 0 && cur == 2)
+        {
+            if (width_ok(cfg.mode, cross(y, i, hi) - start, width))
+                return i;
+            dir = 0;
+        }
+        else if (dir < 0 && cur == 0)
+        {
+            if (width_ok(cfg.mode, cross(y, i, lo) - start, width))
+                return i;
+            dir = 0;
+        }
+        else if (cur == 0 || cur == 2) // returned where it started
+            dir = 0;
+    }
+
+    return -1;
+}
+
+int SoftTrig::scanPattern(const SoftTrigPattern& pat, const LaBits& bits, double fs)
+{
+    if (!pat.enabled)
+        return 0;
+
+    const int size = bits.size();
+    const int ch_num = bits.chNum();
+    const int mask = pat.mask & ((1 << ch_num) - 1);
+    const int need = qMax(1, (int)qCeil(pat.time * fs));
+    const int words = (size + 63) / 64;
+
+    int run = 0;
+
+    for (int w = 0; w < words; w++)
+    {
+        quint64 m = ~0ULL;
+
+        for (int c = 0; c < ch_num; c++)
+        {
+            if ((mask >> c) & 1)
+            {
+                quint64 p = bits.plane(c)[w];
+                m &= ((pat.value >> c) & 1) ? p : ~p;
+            }
+        }
+
+        const int n = std::min(64, size - w * 64);
+        if (n < 64)
+            m &= (1ULL << n) - 1;
+
+        if (m == 0)
+        {
+            run = 0;
+        }
+        else if (m == ~0ULL)
+        {
+            if (run + 64 >= need)
+                return w * 64 + (need - run) - 1;
+            run += 64;
+        }
+        else
+        {
+            for (int b = 0; b < n; b++)
+            {
+                if ((m >> b) & 1)
+                {
+                    if (++run >= need)
+                        return w * 64 + b;
+                }
+                else
+                    run = 0;
+            }
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,77 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef SOFTTRIG_H
+#define SOFTTRIG_H
+
+#include "containers.h"
+#include "labits.h"
+
+#include <QVector>
+
+#include <stdint.h>
+
+
+enum SoftTrigMode
+{
+    STRIG_OFF       = 0,
+    STRIG_PULSE_GT  = 1,    // pulse between level crossings wider than time
+    STRIG_PULSE_LT  = 2,    // pulse narrower than time
+    STRIG_RUNT      = 3,    // crosses lo (hi) and returns without reaching hi (lo)
+    STRIG_WINDOW    = 4,    // leaves window lo .. hi
+    STRIG_SLEW_GT   = 5,    // lo to hi transition slower than time
+    STRIG_SLEW_LT   = 6     // lo to hi transition faster than time
+};
+
+/* analog condition of one scope channel */
+class SoftTrigCfg
+{
+public:
+    SoftTrigMode mode = STRIG_OFF;
+    int ch = 1;                     // 1 - 4
+    DaqTrigEdge polarity = RISING;  // positive pulse / runt, exit above window, rising slew (FALLING opposite, BOTH any)
+    double level = 1.65;            // pulse [V]
+    double lo = 1.0;                // runt, window, slew [V]
+    double hi = 2.3;
+    double time = 0.001;            // pulse width, slew time [s]
+};
+
+/* LA channels pattern, bit 0 = CH1 */
+class SoftTrigPattern
+{
+public:
+    bool enabled = false;
+    int mask = 0;                   // channels compared
+    int value = 0;                  // wanted levels of compared channels
+    double time = 0;                // pattern must hold at least [s]
+};
+
+/* PC side triggers evaluated on whole frames. Samples are classified below lo / between / above hi in one branch free
+ * pass, quiet runs are skipped 8 classes at once and only class changes go through the condition state machine. */
+class SoftTrig
+{
+public:
+    SoftTrig() {}
+
+    /* sample where frame qualifies, -1 if it does not, fs [Hz] */
+    int scan(const SoftTrigCfg& cfg, const double* y, int len, double fs);
+
+    /* sample where pattern held for its time, -1 if never, bitplanes compared 64 samples at once */
+    static int scanPattern(const SoftTrigPattern& pat, const LaBits& bits, double fs);
+
+private:
+    void classify(const double* y, int len, double lo, double hi);
+    void findEvents();
+
+    int scanPulse(const SoftTrigCfg& cfg, const double* y, double width);
+    int scanRunt(const SoftTrigCfg& cfg);
+    int scanWindow(const SoftTrigCfg& cfg);
+    int scanSlew(const SoftTrigCfg& cfg, const double* y, double width);
+
+    QVector<uint8_t> m_cls;         // 0 below lo, 1 between, 2 above hi
+    QVector<int> m_ev;              // samples whose class differs from previous one
+};
+
+#endif // SOFTTRIG_H
@@ -0,0 +1,114 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "trigalign.h"
+
+#include <QtMath>
+
+#include <algorithm>
+#include <climits>
+
+
+static inline double lanczos(double x)
+{
+    if (x == 0)
+        return 1;
+
+    const double px = M_PI * x;
+    return (TRIG_ALIGN_SINC_TAPS * sin(px) * sin(px / TRIG_ALIGN_SINC_TAPS)) / (px * px);
+}
+
+double TrigAlign::sample(const double* y, int len, double t, AlignInterp interp)
+{
+    if (t <= 0)
+        return y[0];
+    if (t >= len - 1)
+        return y[len - 1];
+
+    const int i0 = (int)t;
+    const double frac = t - i0;
+
+    if (interp == ALIGN_LINEAR || frac == 0)
+        return y[i0] + (y[std::min(i0 + 1, len - 1)] - y[i0]) * frac;
+
+    double sum = 0, wsum = 0;
+
+    for (int k = i0 - TRIG_ALIGN_SINC_TAPS + 1; k <= i0 + TRIG_ALIGN_SINC_TAPS; k++)
+    {
+        double w = lanczos(t - k);
+        sum += y[qBound(0, k, len - 1)] * w;
+        wsum += w;
+    }
+
+    return sum / wsum; // normalized, no ripple on DC
+}
+
+bool TrigAlign::find(const double* y, int len, double level, DaqTrigEdge edge, int nominal, int window,
+                     AlignInterp interp, double& pos)
+{
+    const int from = std::max(0, nominal - window);
+    const int to = std::min(len - 2, nominal + window);
+
+    int best = -1;
+    int best_dist = INT_MAX;
+
+    for (int i = from; i <= to; i++)
+    {
+        bool rise = y[i] < level && y[i + 1] >= level;
+        bool fall = y[i] > level && y[i + 1] <= level;
+
+        if ((edge == RISING && !rise) || (edge == FALLING && !fall) || (edge == BOTH && !rise && !fall))
+            continue;
+
+        int dist = abs(i - nominal);
+        if (dist < best_dist)
+        {
+            best = i;
+            best_dist = dist;
+        }
+    }
+
+    if (best < 0)
+        return false;
+
+    double lo = best;
+    double hi = best + 1;
+
+    if (interp == ALIGN_LINEAR)
+    {
+        pos = lo + (level - y[best]) / (y[best + 1] - y[best]);
+        return true;
+    }
+
+    /* sinc interpolant passes through samples, so sign change between them holds */
+    const bool up = y[best] < level;
+
+    for (int i = 0; i < TRIG_ALIGN_SINC_ITER; i++)
+    {
+        double mid = (lo + hi) / 2;
+        if ((sample(y, len, mid, ALIGN_SINC) < level) == up)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    pos = (lo + hi) / 2;
+    return true;
+}
+
+void TrigAlign::shift(QVector<double>& y, double shift, AlignInterp interp)
+{
+    const int len = y.size();
+
+    if (len < 2 || qAbs(shift) < 1e-6)
+        return;
+
+    m_tmp = y;
+    const double* src = m_tmp.constData();
+    double* dst = y.data();
+
+    for (int i = 0; i < len; i++)
+        dst[i] = sample(src, len, i + shift, interp);
+}
@@ -0,0 +1,44 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef TRIGALIGN_H
+#define TRIGALIGN_H
+
+#include "containers.h"
+
+#include <QVector>
+
+
+#define TRIG_ALIGN_WIN_MIN      8       // crossing searched at least +-N samples around trigger
+#define TRIG_ALIGN_WIN_DIV      10      // or +-mem/N samples
+#define TRIG_ALIGN_SINC_TAPS    3       // lanczos kernel half width
+#define TRIG_ALIGN_SINC_ITER    12      // bisection steps, 1/4096 sample
+
+enum AlignInterp
+{
+    ALIGN_LINEAR = 0,
+    ALIGN_SINC   = 1    // lanczos windowed sinc
+};
+
+/* AWD trigger fires a few samples after real crossing, frames are moved so crossing lands on same fractional time */
+class TrigAlign
+{
+public:
+    TrigAlign() {}
+
+    /* exact crossing of level nearest to nominal index, false if none within window */
+    static bool find(const double* y, int len, double level, DaqTrigEdge edge, int nominal, int window,
+                     AlignInterp interp, double& pos);
+
+    /* y[i] = y(i + shift) resampled in place, edges hold first / last sample */
+    void shift(QVector<double>& y, double shift, AlignInterp interp);
+
+private:
+    static double sample(const double* y, int len, double t, AlignInterp interp);
+
+    QVector<double> m_tmp;
+};
+
+#endif // TRIGALIGN_H
@@ -5,10 +5,12 @@
 
 #include "utils.h"
 #include "containers.h"
+#include "decode.h"
 
 #include <QString>
 #include <QDebug>
 #include <QMessageBox>
+#include <QtEndian>
 
 #include <math.h>
 #include <assert.h>
@@ -135,81 +137,23 @@ int get_vals_from_circ(int from, int total, int bufflen, DaqBits daq_bits, doubl
 {
     assert(total > 0 && bufflen >= total && buff != NULL);
 
-    int found = 0;
-    int ch_num = 0;
-
-    if (ch1 != NULL) ch_num++;
-    if (ch2 != NULL) ch_num++;
-    if (ch3 != NULL) ch_num++;
-    if (ch4 != NULL) ch_num++;
-
-    QVector<double>* _ch1 = NULL;
-    QVector<double>* _ch2 = NULL;
-    QVector<double>* _ch3 = NULL;
-    QVector<double>* _ch4 = NULL;
-
-    QVector<double>* ch1_copy = ch1;
-    QVector<double>* ch2_copy = ch2;
-    QVector<double>* ch3_copy = ch3;
+    QVector<double>* chs[4] = { ch1, ch2, ch3, ch4 };
+    const double gains[4] = { gain1, gain2, gain3, gain4 };
+    const double offsets[4] = { offset1, offset2, offset3, offset4 };
 
-    QVector<double>** it;
+    double* out[4];
+    int ch_num = 0;
 
-    for (int i = 0; i < ch_num; i++) // sort algorithm
+    for (int i = 0; i < 4; i++) // sort algorithm, gains stay bound to output order
     {
-        if      (i == 0) it = &_ch1;
-        else if (i == 1) it = &_ch2;
-        else if (i == 2) it = &_ch3;
-        else             it = &_ch4;
-
-        if      (i < 1 && ch1_copy != NULL) { *it = ch1_copy; ch1_copy = NULL; continue; }
-        else if (i < 2 && ch2_copy != NULL) { *it = ch2_copy; ch2_copy = NULL; continue; }
-        else if (i < 3 && ch3_copy != NULL) { *it = ch3_copy; ch3_copy = NULL; continue; }
-        else                                { *it = ch4; continue; }
+        if (chs[i] != NULL)
+            out[ch_num++] = chs[i]->data();
     }
 
-    int k1 = 0, k2 = 0, k3 = 0, k4 = 0;
-    for (int k = 0, i = from; k < total; k++, i++)
-    {
-        if (i >= bufflen)
-            i = 0;
-
-        found++;
-        double val = 0;
-
-        if (daq_bits == B12)
-        {
-            uint16_t raw = (*((uint16_t*)(((uint8_t*)buff)+(i*2))));
-            val = (raw / 4095.0) * vcc;
-        }
-        else if (daq_bits == B8)
-        {
-            uint16_t raw = (((uint8_t*)buff)[i]);
-            val = (raw / 255.0) * vcc;
-        }
-        else assert(0);
-
-        if (i % ch_num == 0)
-        {
-            if (_ch1 != NULL)
-                (*_ch1)[k1++] = (gain1 * val) + offset1;
-        }
-        else if (ch_num > 1 && i % ch_num == 1)
-        {
-            if (_ch2 != NULL)
-                (*_ch2)[k2++] = (gain2 * val) + offset2;
-        }
-        else if (ch_num > 2 && i % ch_num == 2)
-        {
-            if (_ch3 != NULL)
-                (*_ch3)[k3++] = (gain3 * val) + offset3;
-        }
-        else if (ch_num > 3) // && i % ch_num == 3)
-        {
-            if (_ch4 != NULL)
-                (*_ch4)[k4++] = (gain4 * val) + offset4;
-        }
-    }
-    return found;
+    if (ch_num == 0)
+        return 0;
+
+    return decode_circ(from, total, bufflen, daq_bits, vcc, buff, ch_num, out, gains, offsets);
 }
 
 
@@ -242,8 +186,99 @@ const QString h_manual_to_auto(double fs, int mem, double& div_format, double& d
     return suffix;
 }
 
+// VM:READ:BIN? block: header (u32 vcc_k, u16 adc_max, u16 count, u16 lost, u16 chans), then count * (vref,ch1,ch2,ch3,ch4) u16 LE
+int get_vm_from_bin(const QByteArray& data, QVector<double>* ch1, QVector<double>* ch2, QVector<double>* ch3, QVector<double>* ch4,
+                    QVector<double>* vcc, int* lost)
+{
+    const int hdr_len = 12;
+    const int rec_len = 5 * 2;
+
+    if (data.size() < hdr_len)
+        return -1;
+
+    const uchar* p = (const uchar*)data.constData();
+
+    double vcc_k = qFromLittleEndian<quint32>(p) / 1000.0;
+    double adc_max = qFromLittleEndian<quint16>(p + 4);
+    int count = qFromLittleEndian<quint16>(p + 6);
+    *lost = qFromLittleEndian<quint16>(p + 8);
 
+    if (data.size() != hdr_len + (count * rec_len) || adc_max <= 0)
+        return -1;
 
+    ch1->resize(count);
+    ch2->resize(count);
+    ch3->resize(count);
+    ch4->resize(count);
+    vcc->resize(count);
 
+    double* _ch1 = ch1->data();
+    double* _ch2 = ch2->data();
+    double* _ch3 = ch3->data();
+    double* _ch4 = ch4->data();
+    double* _vcc = vcc->data();
 
+    p += hdr_len;
+
+    for (int i = 0; i < count; i++, p += rec_len)
+    {
+        quint16 vref = qFromLittleEndian<quint16>(p);
+        double v = vref > 0 ? vcc_k / vref : 0;
+        double k = v / adc_max;
+
+        _vcc[i] = v;
+        _ch1[i] = qFromLittleEndian<quint16>(p + 2) * k;
+        _ch2[i] = qFromLittleEndian<quint16>(p + 4) * k;
+        _ch3[i] = qFromLittleEndian<quint16>(p + 6) * k;
+        _ch4[i] = qFromLittleEndian<quint16>(p + 8) * k;
+    }
 
+    return count;
+}
+
+// VM:LOG:READ? block: header (u32 vcc_k, u16 adc_max, u16 count), then count * (u32 seq, vref, ch1..ch4, n) u16 LE,
+// vref and channels are block averages in 1/16 LSB
+int get_vmlog_from_bin(const QByteArray& data, QVector<double>* ch1, QVector<double>* ch2, QVector<double>* ch3, QVector<double>* ch4,
+                       QVector<double>* vcc, QVector<quint32>* seq)
+{
+    const int hdr_len = 8;
+    const int rec_len = 16;
+    const double frac = 16.0;
+
+    if (data.size() < hdr_len)
+        return -1;
+
+    const uchar* p = (const uchar*)data.constData();
+
+    double vcc_k = qFromLittleEndian<quint32>(p) / 1000.0;
+    double adc_max = qFromLittleEndian<quint16>(p + 4);
+    int count = qFromLittleEndian<quint16>(p + 6);
+
+    if (data.size() != hdr_len + (count * rec_len) || adc_max <= 0)
+        return -1;
+
+    ch1->resize(count);
+    ch2->resize(count);
+    ch3->resize(count);
+    ch4->resize(count);
+    vcc->resize(count);
+    seq->resize(count);
+
+    p += hdr_len;
+
+    for (int i = 0; i < count; i++, p += rec_len)
+    {
+        double vref = qFromLittleEndian<quint16>(p + 4) / frac;
+        double v = vref > 0 ? vcc_k / vref : 0;
+        double k = v / adc_max / frac;
+
+        (*seq)[i] = qFromLittleEndian<quint32>(p);
+        (*vcc)[i] = v;
+        (*ch1)[i] = qFromLittleEndian<quint16>(p + 6) * k;
+        (*ch2)[i] = qFromLittleEndian<quint16>(p + 8) * k;
+        (*ch3)[i] = qFromLittleEndian<quint16>(p + 10) * k;
+        (*ch4)[i] = qFromLittleEndian<quint16>(p + 12) * k;
+    }
+
+    return count;
+}
@@ -27,4 +27,10 @@ int get_vals_from_circ(int from, int total, int bufflen, DaqBits daq_bits, doubl
 
 const QString h_manual_to_auto(double fs, int mem, double& div_format, double& div_sec);
 
+int get_vm_from_bin(const QByteArray& data, QVector<double>* ch1, QVector<double>* ch2, QVector<double>* ch3, QVector<double>* ch4,
+                    QVector<double>* vcc, int* lost);
+
+int get_vmlog_from_bin(const QByteArray& data, QVector<double>* ch1, QVector<double>* ch2, QVector<double>* ch3, QVector<double>* ch4,
+                       QVector<double>* vcc, QVector<quint32>* seq);
+
 #endif // UTILS_H
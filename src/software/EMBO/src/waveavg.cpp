@@ -0,0 +1,127 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "waveavg.h"
+
+#include <assert.h>
+
+
+void WaveAvg::setup(AvgMode mode, int num, int len)
+{
+    assert(num > 0 && len >= 0);
+
+    m_mode = mode;
+    m_num = num;
+    m_len = len;
+
+    reset();
+}
+
+void WaveAvg::reset()
+{
+    m_cnt = 0;
+    m_it = 0;
+
+    m_acc.fill(0, m_len);
+    m_min.clear();
+    m_frames.clear();
+
+    if (m_mode == AVG_MEAN)
+        m_frames.resize(m_num);
+    else if (m_mode == AVG_ENVELOPE)
+        m_min.fill(0, m_len);
+}
+
+void WaveAvg::process(QVector<double>& y)
+{
+    assert(y.size() >= m_len);
+
+    double* acc = m_acc.data();
+    double* yd = y.data();
+
+    if (m_mode == AVG_MEAN)
+    {
+        QVector<double>& frame = m_frames[m_it];
+        bool full = (m_cnt == m_num);
+
+        if (!full)
+        {
+            frame.resize(m_len);
+            m_cnt++;
+        }
+
+        double* old = frame.data();
+
+        for (int i = 0; i < m_len; i++)
+        {
+            acc[i] += yd[i] - (full ? old[i] : 0);
+            old[i] = yd[i];
+        }
+
+        if (++m_it == m_num)
+        {
+            m_it = 0;
+
+            if (full) // resum whole window once per N frames, so rounding error can not build up
+            {
+                m_acc.fill(0);
+                for (int j = 0; j < m_num; j++)
+                {
+                    const double* f = m_frames[j].constData();
+                    for (int i = 0; i < m_len; i++)
+                        acc[i] += f[i];
+                }
+            }
+        }
+
+        const double k = 1.0 / m_cnt;
+        for (int i = 0; i < m_len; i++)
+            yd[i] = acc[i] * k;
+    }
+    else if (m_mode == AVG_EXP)
+    {
+        if (m_cnt < m_num)
+            m_cnt++;
+
+        const double alpha = 1.0 / m_cnt; // plain mean until N frames are in
+
+        for (int i = 0; i < m_len; i++)
+        {
+            acc[i] += alpha * (yd[i] - acc[i]);
+            yd[i] = acc[i];
+        }
+    }
+    else // AVG_PEAK, AVG_ENVELOPE
+    {
+        if (m_cnt == m_num)
+            m_cnt = 0;
+
+        double* mn = m_min.data();
+        bool env = (m_mode == AVG_ENVELOPE);
+
+        if (m_cnt++ == 0)
+        {
+            for (int i = 0; i < m_len; i++)
+                acc[i] = yd[i];
+
+            if (env)
+            {
+                for (int i = 0; i < m_len; i++)
+                    mn[i] = yd[i];
+            }
+        }
+        else
+        {
+            for (int i = 0; i < m_len; i++)
+            {
+                if (env && yd[i] < mn[i])
+                    mn[i] = yd[i];
+                if (yd[i] > acc[i])
+                    acc[i] = yd[i];
+                yd[i] = acc[i];
+            }
+        }
+    }
+}
@@ -0,0 +1,48 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef WAVEAVG_H
+#define WAVEAVG_H
+
+#include <QVector>
+
+
+enum AvgMode
+{
+    AVG_MEAN     = 0,   // running mean of last N frames
+    AVG_EXP      = 1,   // exponential, alpha = 1/N
+    AVG_PEAK     = 2,   // max hold, restarted every N frames
+    AVG_ENVELOPE = 3    // min and max hold, restarted every N frames
+};
+
+/* per-channel waveform averaging, O(len) per frame for any N */
+class WaveAvg
+{
+public:
+    WaveAvg() {}
+
+    void setup(AvgMode mode, int num, int len);
+    void reset();
+
+    /* averages frame y in place, in envelope mode y becomes max and lower trace is getMin() */
+    void process(QVector<double>& y);
+
+    const QVector<double>& getMin() const { return m_min; }
+    AvgMode getMode() const { return m_mode; }
+    int getCnt() const { return m_cnt; }
+
+private:
+    AvgMode m_mode = AVG_MEAN;
+    int m_num = 1;
+    int m_len = 0;
+    int m_cnt = 0;
+    int m_it = 0;
+
+    QVector<QVector<double>> m_frames;  // ring of last N frames, mean only
+    QVector<double> m_acc;              // running sum / exp state / max
+    QVector<double> m_min;
+};
+
+#endif // WAVEAVG_H
@@ -205,8 +205,8 @@ void WindowMain::statusBarLoad()
     m_status_icon_comm = new QLabel(this);
     m_status_comm = new QLabel(" Disconnected ", this);
     m_status_latency = new QLabel("", this);
-    m_status_latency->setToolTip("[fixed spacing + real mean] (real peak)");
-    m_status_latency->setMinimumWidth(220);
+    m_status_latency->setToolTip("[batch round trip mean] (peak), answered batches per second x batches in flight");
+    m_status_latency->setMinimumWidth(260);
     m_status_uptime = new QLabel("", this);
 
     QSpacerItem* status_spacer1 = new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Preferred);
@@ -604,7 +604,15 @@ void WindowMain::on_pushButton_scan_clicked()
     m_ui->listWidget_ports->clear();
 
     auto ports = QSerialPortInfo::availablePorts();
-    int ports_sz = ports.size();
+
+#if !defined(Q_OS_WIN)
+    /* firmware host build (board/HOST) links its pty as /tmp/embo-sim* */
+    QStringList sims = QDir("/tmp").entryList(QStringList() << "embo-sim*", QDir::System | QDir::Files);
+#else
+    QStringList sims;
+#endif
+
+    int ports_sz = ports.size() + sims.size();
 
     m_ui->label_titlePorts->setText("Ports (" + QString::number(ports_sz) + ")");
 
@@ -623,6 +631,17 @@ void WindowMain::on_pushButton_scan_clicked()
 
             m_ui->listWidget_ports->addItem(item);
         }
+        for(auto& sim : sims)
+        {
+            QListWidgetItem* item = new QListWidgetItem(m_ui->listWidget_ports);
+            item->setIcon(QIcon(":/main/img/serial2.png"));
+            QString val = sim + " — EMBO host simulator";
+            item->setText(val.size() <= 20 ? val : val.left(16) + "...");
+            item->setToolTip("/tmp/" + val);
+            item->setData(Qt::UserRole, "/tmp/" + sim);
+
+            m_ui->listWidget_ports->addItem(item);
+        }
         m_ui->listWidget_ports->setCurrentRow(0);
         m_ui->pushButton_connect->setEnabled(true);
     }
@@ -665,10 +684,10 @@ void WindowMain::on_pushButton_disconnect_clicked()
     emit closeComm(false);
 }
 
-void WindowMain::on_latencyAndUptime(int latency_fix, int latency_mean, int latency_max, const QString uptime)
+void WindowMain::on_latencyAndUptime(int latency_mean, int latency_max, int window, int rate, const QString uptime)
 {
-    m_status_latency->setText("Latency: " + QString::number(latency_fix) + "+" + QString::number(latency_mean) +
-                              " ms (max " + QString::number(latency_max) + " ms)");
+    m_status_latency->setText("Latency: " + QString::number(latency_mean) + " ms (max " + QString::number(latency_max) + " ms), " +
+                              QString::number(rate) + " req/s" + (window > 1 ? " x" + QString::number(window) : ""));
     m_status_uptime->setText("Uptime: " + uptime);
 
     if (m_w_vm->isVisible())
@@ -13,6 +13,12 @@
 #include <QDebug>
 #include <QLabel>
 #include <QMessageBox>
+#include <QVBoxLayout>
+#include <QFormLayout>
+#include <QHeaderView>
+
+#include <algorithm>
+
 
 #define Y_LIM                   0.20
 #define TRIG_VAL_PRE_TIMEOUT    3000
@@ -52,6 +58,8 @@ WindowLa::WindowLa(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowLa
     /* QCP */
 
     initQcp();
+    initDecode();
+    initPattern();
 
     /* statusbar */
 
@@ -264,6 +272,7 @@ void WindowLa::initQcp()
     connect(m_axis_ch4->axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), m_axis_ch3->axis(QCPAxis::atBottom), SLOT(setRange(QCPRange)));
 
     connect(m_axis_ch1->axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), m_axis_ch1->axis(QCPAxis::atTop), SLOT(setRange(QCPRange)));
+    connect(m_axis_ch1->axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), this, SLOT(on_qcpRangeChanged(QCPRange)));
     connect(m_axis_ch2->axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), m_axis_ch2->axis(QCPAxis::atTop), SLOT(setRange(QCPRange)));
     connect(m_axis_ch3->axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), m_axis_ch3->axis(QCPAxis::atTop), SLOT(setRange(QCPRange)));
     connect(m_axis_ch4->axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), m_axis_ch4->axis(QCPAxis::atTop), SLOT(setRange(QCPRange)));
@@ -301,6 +310,10 @@ void WindowLa::initQcp()
 
 WindowLa::~WindowLa()
 {
+    m_decodeThread->quit();
+    m_decodeThread->wait();
+    delete m_decode;
+
     delete m_ui;
 }
 
@@ -324,6 +337,15 @@ void WindowLa::on_timer_plot() // 60 FPS
         m_cursors4->refresh(rngV.lower, rngV.upper, rngH.lower, rngH.upper, false); // true
     }
 
+    if (m_decode->takeResult(m_decodeRes))
+    {
+        if (m_decodeRes.proto != m_decodeCfg.proto) // decoder changed meanwhile
+            m_decodeRes.frames.clear();
+
+        decodeTableFill();
+        decodeOverlay();
+    }
+
     m_ui->customPlot->replot();
 }
 
@@ -394,51 +416,28 @@ void WindowLa::on_msg_read(const QByteArray data)
         return;
     }
 
-    std::vector<qreal> buff(data_sz);
+    const int pins[LA_CH_MAX] = { info->la_ch1_pin, info->la_ch2_pin, info->la_ch3_pin, info->la_ch4_pin };
 
-    QVector<double> y1(m_daqSet.mem);
-    QVector<double> y2(m_daqSet.mem);
-    QVector<double> y3(m_daqSet.mem);
-    QVector<double> y4(m_daqSet.mem);
+    assert(m_tLen > 0);
 
-    for (int k = 0, i = m_firstPos; k < m_daqSet.mem; k++, i++)
-    {
-        if (i >= data_sz)
-            i = 0;
-
-        bool ch1 = (data[i] & (1 << info->la_ch1_pin)) != 0;
-        bool ch2 = (data[i] & (1 << info->la_ch2_pin)) != 0;
-        bool ch3 = false;
-        bool ch4 = false;
-
-        if (info->daq_ch == 4)
-        {
-            ch3 = (data[i] & (1 << info->la_ch3_pin)) != 0;
-            ch4 = (data[i] & (1 << info->la_ch4_pin)) != 0;
-        }
+    m_bitsNext.setData(reinterpret_cast<const uint8_t*>(data.constData()), data_sz, m_firstPos, m_daqSet.mem, pins,
+                       info->daq_ch == 4 ? 4 : 2);
 
-        y1[k] = ch1 ? 1.0 : 0.0;
-        y2[k] = ch2 ? 1.0 : 0.0;
-        if (info->daq_ch == 4)
-        {
-            y3[k] = ch3 ? 1.0 : 0.0;
-            y4[k] = ch4 ? 1.0 : 0.0;
-        }
+    if (SoftTrig::scanPattern(m_pattern, m_bitsNext, m_daqSet.fs_real_n) < 0) // pattern not found, last capture stays
+    {
+        m_pattern_rejected++;
+        seqStatus();
+        return;
     }
 
-    assert(!m_t.isEmpty());
+    std::swap(m_bits, m_bitsNext);
 
-    m_ui->customPlot->graph(GRAPH_CH1)->setData(m_t, y1);
-    m_ui->customPlot->graph(GRAPH_CH2)->setData(m_t, y2);
-
-    if (info->daq_ch == 4)
-    {
-        m_ui->customPlot->graph(GRAPH_CH3)->setData(m_t, y3);
-        m_ui->customPlot->graph(GRAPH_CH4)->setData(m_t, y4);
-    }
+    lodRender();
 
     m_seq_num++;
-    m_status_seq->setText("Sequence Number: " + QString::number(m_seq_num));
+    seqStatus();
+
+    decodeSubmit();
 
     //m_ui->customPlot->replot();
 }
@@ -468,7 +467,7 @@ void WindowLa::on_msg_daqReady(Ready ready, int firstPos)
         m_ui->radioButton_trigLed->setChecked(false);
 
     if (m_instrEnabled)
-        Core::getInstance()->msgAdd(m_msg_read, true);
+        Core::getInstance()->msgAdd(m_msg_read, true, m_comp ? EMBO_LA_COMP : "");
 }
 
 void WindowLa::on_msg_ok_forceTrig(const QString, const QString)
@@ -514,6 +513,191 @@ void WindowLa::on_actionViewLines_triggered(bool checked)
     m_ui->customPlot->replot();
 }
 
+/********** Decode **********/
+
+void WindowLa::on_actionDecodeNone_triggered(bool checked) // exclusive with - other decoders
+{
+    if (checked)
+        setDecode(LA_PROTO_NONE);
+    else
+        m_ui->actionDecodeNone->setChecked(true);
+}
+
+void WindowLa::on_actionDecodeUART_triggered(bool checked) // exclusive with - other decoders
+{
+    if (checked)
+        setDecode(LA_PROTO_UART);
+    else
+        m_ui->actionDecodeUART->setChecked(true);
+}
+
+void WindowLa::on_actionDecodeSPI_triggered(bool checked) // exclusive with - other decoders
+{
+    if (checked)
+        setDecode(LA_PROTO_SPI);
+    else
+        m_ui->actionDecodeSPI->setChecked(true);
+}
+
+void WindowLa::on_actionDecodeI2C_triggered(bool checked) // exclusive with - other decoders
+{
+    if (checked)
+        setDecode(LA_PROTO_I2C);
+    else
+        m_ui->actionDecodeI2C->setChecked(true);
+}
+
+void WindowLa::on_actionDecodeUartBaud_triggered()
+{
+    bool ok;
+    int baud = QInputDialog::getInt(this, "EMBO - UART Decoder", "Baud rate:", m_decodeCfg.uart_baud, 1, 100000000, 1, &ok);
+
+    if (ok)
+    {
+        m_decodeCfg.uart_baud = baud;
+        Settings::setValue(CFG_LA_UART_BAUD, baud);
+        decodeSubmit();
+    }
+}
+
+void WindowLa::on_actionDecodeSpiMode_triggered()
+{
+    bool ok;
+    int mode = QInputDialog::getInt(this, "EMBO - SPI Decoder", "Mode (CPOL << 1 | CPHA):", m_decodeCfg.spi_mode, 0, 3, 1, &ok);
+
+    if (ok)
+    {
+        m_decodeCfg.spi_mode = mode;
+        Settings::setValue(CFG_LA_SPI_MODE, mode);
+        decodeSubmit();
+    }
+}
+
+void WindowLa::on_actionDecodeTable_triggered(bool checked)
+{
+    m_decodeDock->setVisible(checked);
+
+    if (checked)
+        decodeTableFill();
+}
+
+void WindowLa::on_decodeSearch_textChanged(const QString& text)
+{
+    for (int i = 0; i < m_decodeTable->rowCount(); i++)
+    {
+        auto item = m_decodeTable->item(i, 2);
+        bool match = text.isEmpty() || (item != NULL && item->text().contains(text, Qt::CaseInsensitive));
+
+        m_decodeTable->setRowHidden(i, !match);
+    }
+}
+
+void WindowLa::on_decodeTable_cellDoubleClicked(int row, int)
+{
+    const QVector<LaFrame>& frames = m_decodeRes.frames;
+
+    if (row < 0 || row >= frames.size() || frames[row].start >= m_tLen)
+        return;
+
+    auto axis = m_axis_ch1->axis(QCPAxis::atBottom);
+    axis->setRange(tKey(frames[row].start), axis->range().size(), Qt::AlignCenter);
+}
+
+/********** Software Trigger **********/
+
+/* "1X0X" -> mask 0b0101, value 0b0001, CH1 first */
+static bool pattern_parse(const QString& str, int& mask, int& value)
+{
+    if (str.isEmpty() || str.size() > LA_CH_MAX)
+        return false;
+
+    mask = 0;
+    value = 0;
+
+    for (int i = 0; i < str.size(); i++)
+    {
+        QChar c = str[i].toUpper();
+
+        if (c == '1')
+            value |= 1 << i;
+        else if (c != '0' && c != 'X')
+            return false;
+
+        if (c != 'X')
+            mask |= 1 << i;
+    }
+
+    return true;
+}
+
+void WindowLa::initPattern()
+{
+    m_patternStr = Settings::getValue(CFG_LA_PATTERN_STR, "1XXX").toString();
+    m_pattern.time = Settings::getValue(CFG_LA_PATTERN_T, 0.0).toDouble();
+    m_pattern.enabled = Settings::getValue(CFG_LA_PATTERN, false).toBool();
+
+    if (!pattern_parse(m_patternStr, m_pattern.mask, m_pattern.value))
+    {
+        m_patternStr = "1XXX";
+        pattern_parse(m_patternStr, m_pattern.mask, m_pattern.value);
+    }
+
+    m_ui->actionPatternEnabled->setChecked(m_pattern.enabled);
+    m_ui->actionPatternSet->setText("Pattern Settings... (" + m_patternStr + ")");
+}
+
+void WindowLa::on_actionPatternEnabled_triggered(bool checked)
+{
+    m_pattern.enabled = checked;
+    m_pattern_rejected = 0;
+
+    Settings::setValue(CFG_LA_PATTERN, checked);
+    seqStatus();
+}
+
+void WindowLa::on_actionPatternSet_triggered()
+{
+    const QString title = "EMBO - Pattern Trigger";
+    bool ok;
+
+    QString str = QInputDialog::getText(this, title, "Pattern CH1..CH4 (1, 0, X = any):", QLineEdit::Normal, m_patternStr, &ok);
+    if (!ok)
+        return;
+
+    int mask, value;
+    if (!pattern_parse(str, mask, value))
+    {
+        msgBox(this, "Pattern must be 1 to 4 characters of 1, 0 or X", WARNING);
+        return;
+    }
+
+    double time = QInputDialog::getDouble(this, title, "Held at least [us]:", m_pattern.time * 1e6, 0, 1e9, 3, &ok);
+    if (!ok)
+        return;
+
+    m_patternStr = str.toUpper();
+    m_pattern.mask = mask;
+    m_pattern.value = value;
+    m_pattern.time = time / 1e6;
+    m_pattern_rejected = 0;
+
+    Settings::setValue(CFG_LA_PATTERN_STR, m_patternStr);
+    Settings::setValue(CFG_LA_PATTERN_T, m_pattern.time);
+
+    m_ui->actionPatternSet->setText("Pattern Settings... (" + m_patternStr + ")");
+    seqStatus();
+}
+
+void WindowLa::seqStatus()
+{
+    QString text = "Sequence Number: " + QString::number(m_seq_num);
+
+    if (m_pattern.enabled)
+        text += " | Pattern rejected: " + QString::number(m_pattern_rejected);
+
+    m_status_seq->setText(text);
+}
+
 /********** Export **********/
 
 void WindowLa::on_actionExportSave_triggered()
@@ -548,21 +732,19 @@ void WindowLa::on_actionExportSave_triggered()
     }
     else
     {
-        auto data_1 = m_ui->customPlot->graph(GRAPH_CH1)->data();
-        auto data_2 = m_ui->customPlot->graph(GRAPH_CH2)->data();
-        auto data_3 = m_ui->customPlot->graph(GRAPH_CH3)->data();
-        auto data_4 = m_ui->customPlot->graph(GRAPH_CH4)->data();
+        /* graphs hold only visible part, full capture is in bitplanes */
+        int ch_num = m_bits.chNum();
 
-        for (int i = 0; i < data_1->size(); i++)
+        for (int i = 0; i < m_bits.size(); i++)
         {
-            if (m_daqSet.ch1_en)
-                m_rec << (int)(data_1->at(i)->value);
-            if (m_daqSet.ch2_en)
-                m_rec << (int)(data_2->at(i)->value);
-            if (m_daqSet.ch3_en)
-                m_rec << (int)(data_3->at(i)->value);
-            if (m_daqSet.ch4_en)
-                m_rec << (int)(data_4->at(i)->value);
+            if (m_daqSet.ch1_en && ch_num > 0)
+                m_rec << (int)m_bits.level(0, i);
+            if (m_daqSet.ch2_en && ch_num > 1)
+                m_rec << (int)m_bits.level(1, i);
+            if (m_daqSet.ch3_en && ch_num > 2)
+                m_rec << (int)m_bits.level(2, i);
+            if (m_daqSet.ch4_en && ch_num > 3)
+                m_rec << (int)m_bits.level(3, i);
             m_rec << ENDL;
         }
 
@@ -746,6 +928,11 @@ void WindowLa::on_qcpMouseWheel(QWheelEvent*)
     m_ui->horizontalSlider_trigPre->setStyleSheet(CSS_LA_TRIG_PRE_OFF);
 }
 
+void WindowLa::on_qcpRangeChanged(const QCPRange&)
+{
+    lodRender();
+}
+
 void WindowLa::on_qcpMousePress(QMouseEvent*)
 {
     m_ui->pushButton_reset->hide();
@@ -817,10 +1004,10 @@ void WindowLa::on_pushButton_resetZoom_clicked()
     m_ui->pushButton_reset->show();
     m_ui->pushButton_resetZoom->hide();
 
-    if (m_t.isEmpty())
+    if (m_tLen == 0)
         return;
 
-    double x = m_t[m_t.size()-1];
+    double x = tLast();
 
     if (x >= 2)
         m_timeTicker->setTimeFormat("%s s");
@@ -1040,12 +1227,12 @@ void WindowLa::on_spinBox_trigPre_valueChanged(int arg1)
     m_ignoreValuesChanged = true;
     m_ui->dial_trigPre->setValue(arg1);
 
-    if (!m_t.isEmpty())
+    if (m_tLen > 0)
     {
-        m_cursorTrigPre1->setValue(arg1, 0, 1, 0, m_t[m_t.size()-1]);
-        m_cursorTrigPre2->setValue(arg1, 0, 1, 0, m_t[m_t.size()-1]);
-        m_cursorTrigPre3->setValue(arg1, 0, 1, 0, m_t[m_t.size()-1]);
-        m_cursorTrigPre4->setValue(arg1, 0, 1, 0, m_t[m_t.size()-1]);
+        m_cursorTrigPre1->setValue(arg1, 0, 1, 0, tLast());
+        m_cursorTrigPre2->setValue(arg1, 0, 1, 0, tLast());
+        m_cursorTrigPre3->setValue(arg1, 0, 1, 0, tLast());
+        m_cursorTrigPre4->setValue(arg1, 0, 1, 0, tLast());
     }
 
     m_cursorTrigPre1->show(true);
@@ -1070,12 +1257,12 @@ void WindowLa::on_dial_trigPre_valueChanged(int value)
     m_ignoreValuesChanged = true;
     m_ui->spinBox_trigPre->setValue(value);
 
-    if (!m_t.isEmpty())
+    if (m_tLen > 0)
     {
-        m_cursorTrigPre1->setValue(value, 0, 1, 0, m_t[m_t.size()-1]);
-        m_cursorTrigPre2->setValue(value, 0, 1, 0, m_t[m_t.size()-1]);
-        m_cursorTrigPre3->setValue(value, 0, 1, 0, m_t[m_t.size()-1]);
-        m_cursorTrigPre4->setValue(value, 0, 1, 0, m_t[m_t.size()-1]);
+        m_cursorTrigPre1->setValue(value, 0, 1, 0, tLast());
+        m_cursorTrigPre2->setValue(value, 0, 1, 0, tLast());
+        m_cursorTrigPre3->setValue(value, 0, 1, 0, tLast());
+        m_cursorTrigPre4->setValue(value, 0, 1, 0, tLast());
     }
 
     m_cursorTrigPre1->show(true);
@@ -1455,6 +1642,7 @@ void WindowLa::showEvent(QShowEvent*)
     m_ignoreValuesChanged = true;
 
     m_seq_num = 0;
+    m_pattern_rejected = 0;
 
     enablePanel(false);
 
@@ -1465,6 +1653,7 @@ void WindowLa::showEvent(QShowEvent*)
     auto info = Core::getInstance()->getDevInfo();
 
     m_err_cntr = 0;
+    m_comp = info->features.contains('C');
     m_ref_v = info->ref_mv / 1000.0;
     m_status_vcc->setText(" Vcc: " + QString::number(info->ref_mv) + " mV");
 
@@ -1596,10 +1785,10 @@ void WindowLa::rescaleYAxis()
 
 void WindowLa::rescaleXAxis()
 {
-    if (m_t.isEmpty())
+    if (m_tLen == 0)
         return;
 
-    m_axis_ch1->axis(QCPAxis::atBottom)->setRange(0, m_t[m_t.size()-1]);
+    m_axis_ch1->axis(QCPAxis::atBottom)->setRange(0, tLast());
     //m_axis_ch2->axis(QCPAxis::atBottom)->setRange(0, m_t_last);
     //m_axis_ch3->axis(QCPAxis::atBottom)->setRange(0, m_t_last);
     //m_axis_ch4->axis(QCPAxis::atBottom)->setRange(0, m_t_last);
@@ -1617,15 +1806,8 @@ void WindowLa::createX()
 {
     if (m_last_fs != m_daqSet.fs || m_last_mem != m_daqSet.mem)
     {
-        double x = 0;
-        double dt = 1.0 / m_daqSet.fs_real_n;
-        m_t.resize(m_daqSet.mem);
-
-        for (int i = 0; i < m_daqSet.mem; i++)
-        {
-            m_t[i] = x;
-            x += dt;
-        }
+        m_dt = 1.0 / m_daqSet.fs_real_n;
+        m_tLen = m_daqSet.mem;
     }
 
     m_last_fs = m_daqSet.fs;
@@ -1633,10 +1815,10 @@ void WindowLa::createX()
 
     if (m_zoomed)
     {
-        if (m_t.isEmpty())
+        if (m_tLen == 0)
             return;
 
-        double x = m_t[m_t.size()-1];
+        double x = tLast();
 
         if (x >= 2)
             m_timeTicker->setTimeFormat("%s s");
@@ -1647,6 +1829,223 @@ void WindowLa::createX()
     }
 }
 
+void WindowLa::lodRender()
+{
+    int pixels = m_axis_ch1->width();
+
+    for (int i = 0; i < m_bits.chNum(); i++)
+        m_bits.render(m_ui->customPlot->graph(GRAPH_CH1 + i), i, m_dt, pixels);
+
+    decodeOverlay();
+}
+
+void WindowLa::initDecode()
+{
+    m_decodeCfg.proto = (LaProto)Settings::getValue(CFG_LA_DECODE, LA_PROTO_NONE).toInt();
+    m_decodeCfg.uart_baud = Settings::getValue(CFG_LA_UART_BAUD, 9600).toInt();
+    m_decodeCfg.spi_mode = Settings::getValue(CFG_LA_SPI_MODE, 0).toInt();
+
+    m_decodeChSel = {
+        { LA_PROTO_UART, "RX",   &m_decodeCfg.uart_rx,  CFG_LA_UART_RX,  false, NULL, NULL },
+        { LA_PROTO_SPI,  "CLK",  &m_decodeCfg.spi_clk,  CFG_LA_SPI_CLK,  false, NULL, NULL },
+        { LA_PROTO_SPI,  "MOSI", &m_decodeCfg.spi_mosi, CFG_LA_SPI_MOSI, false, NULL, NULL },
+        { LA_PROTO_SPI,  "MISO", &m_decodeCfg.spi_miso, CFG_LA_SPI_MISO, true,  NULL, NULL },
+        { LA_PROTO_SPI,  "CS",   &m_decodeCfg.spi_cs,   CFG_LA_SPI_CS,   true,  NULL, NULL },
+        { LA_PROTO_I2C,  "SCL",  &m_decodeCfg.i2c_scl,  CFG_LA_I2C_SCL,  false, NULL, NULL },
+        { LA_PROTO_I2C,  "SDA",  &m_decodeCfg.i2c_sda,  CFG_LA_I2C_SDA,  false, NULL, NULL },
+    };
+
+    m_decodeThread = new QThread(this);
+    m_decodeThread->setObjectName("LaDecode");
+
+    m_decode = new LaDecodeProc();
+    m_decode->moveToThread(m_decodeThread);
+    m_decodeThread->start();
+
+    /* searchable table of decoded frames */
+    QFont font("Roboto", 10);
+
+    m_decodeSearch = new QLineEdit(this);
+    m_decodeSearch->setPlaceholderText("Search...");
+    m_decodeSearch->setFont(font);
+
+    m_decodeTable = new QTableWidget(0, 3, this);
+    m_decodeTable->setHorizontalHeaderLabels({"Time", "Channel", "Data"});
+    m_decodeTable->horizontalHeader()->setStretchLastSection(true);
+    m_decodeTable->verticalHeader()->hide();
+    m_decodeTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_decodeTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_decodeTable->setFont(font);
+
+    /* decoder signal to channel mapping, MISO and CS are optional */
+    QFormLayout* chLayout = new QFormLayout();
+    chLayout->setContentsMargins(2, 2, 2, 2);
+
+    for (int i = 0; i < m_decodeChSel.size(); i++)
+    {
+        DecodeChSel& sel = m_decodeChSel[i];
+
+        *sel.ch = Settings::getValue(sel.cfg, *sel.ch).toInt();
+
+        sel.label = new QLabel(sel.name, this);
+        sel.label->setFont(font);
+        sel.box = new QComboBox(this);
+        sel.box->setFont(font);
+        if (sel.optional)
+            sel.box->addItem("None", -1);
+        for (int ch = 0; ch < LA_CH_MAX; ch++)
+            sel.box->addItem("CH" + QString::number(ch + 1), ch);
+        sel.box->setCurrentIndex(qMax(0, sel.box->findData(*sel.ch)));
+
+        chLayout->addRow(sel.label, sel.box);
+
+        connect(sel.box, static_cast<void (QComboBox::*)(int)>(&QComboBox::activated), this, [this, i](int index)
+        {
+            DecodeChSel& sel = m_decodeChSel[i];
+            *sel.ch = sel.box->itemData(index).toInt();
+            Settings::setValue(sel.cfg, *sel.ch);
+            decodeSubmit();
+        });
+    }
+
+    QWidget* widget = new QWidget(this);
+    QVBoxLayout* layout = new QVBoxLayout(widget);
+    layout->setContentsMargins(2, 2, 2, 2);
+    layout->addLayout(chLayout);
+    layout->addWidget(m_decodeSearch);
+    layout->addWidget(m_decodeTable);
+
+    m_decodeDock = new QDockWidget("Decoded Frames", this);
+    m_decodeDock->setWidget(widget);
+    addDockWidget(Qt::RightDockWidgetArea, m_decodeDock);
+    m_decodeDock->hide();
+
+    connect(m_decodeSearch, &QLineEdit::textChanged, this, &WindowLa::on_decodeSearch_textChanged);
+    connect(m_decodeTable, &QTableWidget::cellDoubleClicked, this, &WindowLa::on_decodeTable_cellDoubleClicked);
+    connect(m_decodeDock, &QDockWidget::visibilityChanged, m_ui->actionDecodeTable, &QAction::setChecked);
+
+    setDecode(m_decodeCfg.proto);
+}
+
+void WindowLa::setDecode(LaProto proto)
+{
+    if (proto < LA_PROTO_NONE || proto > LA_PROTO_I2C)
+        proto = LA_PROTO_NONE;
+
+    m_decodeCfg.proto = proto;
+
+    Settings::setValue(CFG_LA_DECODE, proto);
+
+    m_ui->actionDecodeNone->setChecked(proto == LA_PROTO_NONE);
+    m_ui->actionDecodeUART->setChecked(proto == LA_PROTO_UART);
+    m_ui->actionDecodeSPI->setChecked(proto == LA_PROTO_SPI);
+    m_ui->actionDecodeI2C->setChecked(proto == LA_PROTO_I2C);
+
+    decodeChSelShow();
+    decodeSubmit();
+}
+
+void WindowLa::decodeChSelShow()
+{
+    for (auto& sel : m_decodeChSel)
+    {
+        sel.label->setVisible(sel.proto == m_decodeCfg.proto);
+        sel.box->setVisible(sel.proto == m_decodeCfg.proto);
+    }
+}
+
+void WindowLa::decodeSubmit()
+{
+    if (m_decodeCfg.proto == LA_PROTO_NONE || m_bits.isEmpty())
+    {
+        m_decodeRes = LaDecodeResult();
+
+        decodeTableFill();
+        decodeOverlay();
+        return;
+    }
+
+    m_decodeCfg.fs = m_daqSet.fs_real_n;
+    m_decode->submit(m_bits, m_decodeCfg, m_seq_num);
+}
+
+void WindowLa::decodeOverlay()
+{
+    for (auto item : m_decodeItems)
+        m_ui->customPlot->removeItem(item);
+    m_decodeItems.clear();
+
+    const QVector<LaFrame>& frames = m_decodeRes.frames;
+
+    if (frames.isEmpty() || m_tLen == 0)
+        return;
+
+    QCPAxisRect* rects[4] = { m_axis_ch1, m_axis_ch2, m_axis_ch3, m_axis_ch4 };
+    QCPRange rng = m_axis_ch1->axis(QCPAxis::atBottom)->range();
+    QFont font("Roboto", 8);
+
+    /* only visible ones, first frame on screen is found by bisection */
+    int first = std::lower_bound(frames.constBegin(), frames.constEnd(), rng.lower, [this](const LaFrame& f, double t)
+                                 { return f.end < m_tLen && tKey(f.end) < t; }) - frames.constBegin();
+
+    for (int i = first; i < frames.size() && m_decodeItems.size() < DECODE_OVERLAY_MAX; i++)
+    {
+        const LaFrame& f = frames[i];
+
+        if (f.end >= m_tLen || f.ch < 0 || f.ch > 3)
+            continue;
+        if (tKey(f.start) > rng.upper)
+            break;
+
+        QCPAxisRect* rect = rects[f.ch];
+        QCPItemText* item = new QCPItemText(m_ui->customPlot);
+
+        item->setClipAxisRect(rect);
+        item->position->setAxes(rect->axis(QCPAxis::atBottom), rect->axis(QCPAxis::atLeft));
+        item->position->setCoords((tKey(f.start) + tKey(f.end)) / 2, 0.5);
+        item->setText(f.text);
+        item->setFont(font);
+        item->setColor(f.error ? QColor(Qt::red) : QColor(Qt::black));
+        item->setPen(QPen(f.error ? QColor(Qt::red) : QColor(Qt::gray)));
+        item->setBrush(QBrush(QColor(255, 255, 255, 200)));
+        item->setPadding(QMargins(3, 1, 3, 1));
+
+        m_decodeItems.append(item);
+    }
+}
+
+void WindowLa::decodeTableFill()
+{
+    if (!m_decodeDock->isVisible())
+        return;
+
+    const QVector<LaFrame>& frames = m_decodeRes.frames;
+
+    m_decodeTable->setUpdatesEnabled(false);
+    m_decodeTable->setRowCount(frames.size());
+
+    for (int i = 0; i < frames.size(); i++)
+    {
+        const LaFrame& f = frames[i];
+        double t = (f.start < m_tLen) ? tKey(f.start) : 0;
+
+        auto time = new QTableWidgetItem(format_unit(t, "s", 6));
+        auto ch = new QTableWidgetItem("CH" + QString::number(f.ch + 1));
+        auto text = new QTableWidgetItem(f.text);
+
+        if (f.error)
+            text->setForeground(QColor(Qt::red));
+
+        m_decodeTable->setItem(i, 0, time);
+        m_decodeTable->setItem(i, 1, ch);
+        m_decodeTable->setItem(i, 2, text);
+    }
+
+    m_decodeTable->setUpdatesEnabled(true);
+
+    on_decodeSearch_textChanged(m_decodeSearch->text());
+}
+
 void WindowLa::updatePanel()
 {
     auto info = Core::getInstance()->getDevInfo();
@@ -1792,12 +2191,12 @@ void WindowLa::updatePanel()
     m_ui->dial_trigPre->setValue(m_daqSet.trig_pre);
     m_ui->spinBox_trigPre->setValue(m_daqSet.trig_pre);
 
-    if (!m_t.isEmpty())
+    if (m_tLen > 0)
     {
-        m_cursorTrigPre1->setValue(m_daqSet.trig_pre, 0, 1, 0, m_t[m_t.size()-1]);
-        m_cursorTrigPre2->setValue(m_daqSet.trig_pre, 0, 1, 0, m_t[m_t.size()-1]);
-        m_cursorTrigPre3->setValue(m_daqSet.trig_pre, 0, 1, 0, m_t[m_t.size()-1]);
-        m_cursorTrigPre4->setValue(m_daqSet.trig_pre, 0, 1, 0, m_t[m_t.size()-1]);
+        m_cursorTrigPre1->setValue(m_daqSet.trig_pre, 0, 1, 0, tLast());
+        m_cursorTrigPre2->setValue(m_daqSet.trig_pre, 0, 1, 0, tLast());
+        m_cursorTrigPre3->setValue(m_daqSet.trig_pre, 0, 1, 0, tLast());
+        m_cursorTrigPre4->setValue(m_daqSet.trig_pre, 0, 1, 0, tLast());
     }
 
     m_ui->horizontalSlider_trigPre->setValue(m_daqSet.trig_pre * 10.0);
@@ -11,9 +11,17 @@
 #include "qcpcursors.h"
 #include "containers.h"
 #include "recorder.h"
+#include "labits.h"
+#include "ladecodeproc.h"
+#include "softtrig.h"
 
 #include <QMainWindow>
 #include <QLabel>
+#include <QThread>
+#include <QDockWidget>
+#include <QTableWidget>
+#include <QLineEdit>
+#include <QComboBox>
 
 
 #define TIMER_LA_PLOT           33.0    // cursors refresh rate = 30 FPS
@@ -23,6 +31,8 @@
 #define GRAPH_CH3       2
 #define GRAPH_CH4       3
 
+#define DECODE_OVERLAY_MAX      200     // annotations drawn at once, rest is in table
+
 #define CURSOR_DEFAULT_H_MIN    400
 #define CURSOR_DEFAULT_H_MAX    600
 #define CURSOR_DEFAULT_V_MIN    400
@@ -74,6 +84,21 @@ private slots:
     void on_actionViewPoints_triggered(bool checked);
     void on_actionViewLines_triggered(bool checked);
 
+    /* GUI slots - Menu - Decode */
+    void on_actionDecodeNone_triggered(bool checked);
+    void on_actionDecodeUART_triggered(bool checked);
+    void on_actionDecodeSPI_triggered(bool checked);
+    void on_actionDecodeI2C_triggered(bool checked);
+    void on_actionDecodeUartBaud_triggered();
+    void on_actionDecodeSpiMode_triggered();
+    void on_actionDecodeTable_triggered(bool checked);
+    void on_decodeSearch_textChanged(const QString& text);
+    void on_decodeTable_cellDoubleClicked(int row, int);
+
+    /* GUI slots - Menu - Software Trigger */
+    void on_actionPatternEnabled_triggered(bool checked);
+    void on_actionPatternSet_triggered();
+
     /* GUI slots - Menu - Export */
     void on_actionExportSave_triggered();
     void on_actionExportPNG_triggered();
@@ -92,6 +117,7 @@ private slots:
     /* GUI slots - QCP */
     void on_qcpMouseWheel(QWheelEvent*);
     void on_qcpMousePress(QMouseEvent*);
+    void on_qcpRangeChanged(const QCPRange&);
 
     /* GUI slots - right pannel - main */
     void on_radioButton_zoomH_clicked(bool checked);
@@ -154,6 +180,19 @@ private:
     void rescaleXAxis();
     void rescaleYAxis();
     void createX();
+    double tKey(int i) const { return i * m_dt; }
+    double tLast() const { return (m_tLen - 1) * m_dt; }
+    void lodRender();
+
+    void initDecode();
+    void setDecode(LaProto proto);
+    void decodeSubmit();
+    void decodeOverlay();
+    void decodeTableFill();
+    void decodeChSelShow();
+
+    void initPattern();
+    void seqStatus();
 
     void updatePanel();
     void enablePanel(bool en);
@@ -173,7 +212,8 @@ private:
 
     /* X time axis vars */
     QSharedPointer<QCPAxisTickerTime> m_timeTicker;
-    QVector<double> m_t;
+    double m_dt = 0;                    // sampling period, key of sample i is i * m_dt
+    int m_tLen = 0;
 
     /* QCP axis */
     QCPAxisRect* m_axis_ch1;
@@ -181,6 +221,29 @@ private:
     QCPAxisRect* m_axis_ch3;
     QCPAxisRect* m_axis_ch4;
 
+    /* packed capture with edge lists, graphs hold only visible part */
+    LaBits m_bits;
+    LaBits m_bitsNext;              // capture waiting for pattern check
+
+    /* software trigger */
+    SoftTrigPattern m_pattern;
+    QString m_patternStr;           // CH1 first, 1 / 0 / X
+    int m_pattern_rejected = 0;
+
+    /* protocol decoding */
+    QThread* m_decodeThread;
+    LaDecodeProc* m_decode;
+    LaDecodeResult m_decodeRes;
+    LaDecoderCfg m_decodeCfg;
+    QList<QCPItemText*> m_decodeItems;
+    QDockWidget* m_decodeDock;
+    QLineEdit* m_decodeSearch;
+    QTableWidget* m_decodeTable;
+
+    /* channel of one decoder signal, shown only for its protocol */
+    struct DecodeChSel { LaProto proto; const char* name; int* ch; const char* cfg; bool optional; QLabel* label; QComboBox* box; };
+    QVector<DecodeChSel> m_decodeChSel;
+
     /* status bar */
     QLabel* m_status_vcc;
     QLabel* m_status_seq;
@@ -239,6 +302,7 @@ private:
     int m_last_mem = 0;
     int m_err_cntr = 0;
     bool m_refresh = true;
+    bool m_comp = false;            // LA:READ? COMP supported
 
     /* last widget enabled values */
     bool m_last_trigEnabled = true;
@@ -16,11 +16,17 @@
 #include <QMap>
 #include <QDateTime>
 #include <QMessageBox>
+#include <QtEndian>
+
+#include <limits>
 
 
 #define Y_LIM1                  0.50    // spline on
 #define Y_LIM2                  0.15    // spline off
 #define TRIG_VAL_PRE_TIMEOUT    3000    // trig cursors visible time
+#define ROLL_HDR_LEN            8       // SCOP:ROLL:READ? block header - uint32 seq, uint16 frames, uint16 block len
+#define SEG_HDR_LEN             8       // SCOP:SEG:READ? table entry - uint32 trigger us, uint16 first pos, uint16 segment len
+#define SEG_MAX                 1024    // device EM_SEG_MAX
 
 #define FFT_MAX_SIZE            131072  // 1048576 //65536
 #define FFT_DB_MIN              -100
@@ -37,9 +43,17 @@ WindowScope::WindowScope(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wi
     m_timer_trigSliders = new QTimer(this);
     m_timer_trigSliders->setSingleShot(true);
 
+    m_timer_roll = new QTimer(this);
+    m_timer_roll->setTimerType(Qt::PreciseTimer);
+
     m_msg_set = new Msg_SCOP_Set(this);
     m_msg_read = new Msg_SCOP_Read(this);
     m_msg_forceTrig = new Msg_SCOP_ForceTrig(this);
+    m_msg_dbuf = new Msg_SCOP_DBuf(this);
+    m_msg_roll = new Msg_SCOP_Roll(this);
+    m_msg_rollRead = new Msg_SCOP_RollRead(this);
+    m_msg_seg = new Msg_SCOP_Seg(this);
+    m_msg_segRead = new Msg_SCOP_SegRead(this);
 
     connect(m_msg_set, &Msg_SCOP_Set::ok2, this, &WindowScope::on_msg_ok_set, Qt::QueuedConnection);
     connect(m_msg_set, &Msg_SCOP_Set::err, this, &WindowScope::on_msg_err, Qt::QueuedConnection);
@@ -51,13 +65,42 @@ WindowScope::WindowScope(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wi
     connect(m_msg_forceTrig, &Msg_SCOP_ForceTrig::ok, this, &WindowScope::on_msg_ok_forceTrig, Qt::QueuedConnection);
     //connect(m_msg_forceTrig, &Msg_SCOP_ForceTrig::err, this, &WindowScope::on_msg_err, Qt::QueuedConnection);
 
+    connect(m_msg_dbuf, &Msg_SCOP_DBuf::err, this, &WindowScope::on_msg_err, Qt::QueuedConnection);
+
+    connect(m_msg_roll, &Msg_SCOP_Roll::ok, this, &WindowScope::on_msg_ok_roll, Qt::QueuedConnection);
+    connect(m_msg_roll, &Msg_SCOP_Roll::result, this, &WindowScope::on_msg_roll, Qt::QueuedConnection);
+    connect(m_msg_roll, &Msg_SCOP_Roll::err, this, &WindowScope::on_msg_err, Qt::QueuedConnection);
+
+    connect(m_msg_rollRead, &Msg_SCOP_RollRead::err, this, &WindowScope::on_msg_err, Qt::QueuedConnection);
+    connect(m_msg_rollRead, &Msg_SCOP_RollRead::result, this, &WindowScope::on_msg_rollRead, Qt::QueuedConnection);
+
+    connect(m_msg_seg, &Msg_SCOP_Seg::ok, this, &WindowScope::on_msg_ok_seg, Qt::QueuedConnection);
+    connect(m_msg_seg, &Msg_SCOP_Seg::result, this, &WindowScope::on_msg_seg, Qt::QueuedConnection);
+    connect(m_msg_seg, &Msg_SCOP_Seg::err, this, &WindowScope::on_msg_err, Qt::QueuedConnection);
+
+    connect(m_msg_segRead, &Msg_SCOP_SegRead::err, this, &WindowScope::on_msg_err, Qt::QueuedConnection);
+    connect(m_msg_segRead, &Msg_SCOP_SegRead::result, this, &WindowScope::on_msg_segRead, Qt::QueuedConnection);
+
     connect(Core::getInstance(), &Core::daqReady, this, &WindowScope::on_msg_daqReady, Qt::QueuedConnection);
 
     connect(m_timer_plot, &QTimer::timeout, this, &WindowScope::on_timer_plot);
+    connect(m_timer_roll, &QTimer::timeout, this, &WindowScope::on_timer_roll);
     connect(m_timer_trigSliders, &QTimer::timeout, this, &WindowScope::on_hideTrigSliders);
 
     connect(m_ui->actionEMBO_Help, SIGNAL(triggered()), Core::getInstance(), SLOT(on_actionEMBO_Help()));
 
+    /* post-processing thread */
+
+    m_procThread = new QThread(this);
+    FftEngine::importWisdom(Settings::getValue(CFG_FFT_WISDOM, "").toString()); // before worker plans anything
+
+    m_proc = new ScopeProc();
+    m_proc->setPolicy((ProcPolicy)Settings::getValue(CFG_SCOPE_POLICY, PROC_COALESCE).toInt());
+    m_proc->moveToThread(m_procThread);
+    m_procThread->start();
+
+    connect(m_proc, &ScopeProc::fftWisdom, this, &WindowScope::on_proc_fftWisdom, Qt::QueuedConnection);
+
     /* QCP */
 
     initQcp();
@@ -93,10 +136,6 @@ WindowScope::WindowScope(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wi
     m_ui->spinBox_average->setRange(1, MAX_SCOPE_AVG);
     m_ui->spinBox_average->setValue(AVERAGE_DEFAULT);
 
-    m_average_buff_ch1 = QVector<QVector<double>>(MAX_SCOPE_AVG);
-    m_average_buff_ch2 = QVector<QVector<double>>(MAX_SCOPE_AVG);
-    m_average_buff_ch3 = QVector<QVector<double>>(MAX_SCOPE_AVG);
-    m_average_buff_ch4 = QVector<QVector<double>>(MAX_SCOPE_AVG);
 
     /* styles */
 
@@ -109,8 +148,29 @@ WindowScope::WindowScope(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wi
     /* settings */
 
     m_ui->actionInterpSinc->setChecked(Settings::getValue(CFG_SCOPE_SPLINE, true).toBool());
+    m_ui->actionDoubleBuffer->setChecked(Settings::getValue(CFG_SCOPE_DBUF, false).toBool());
+    m_ui->actionTrigAlign->setChecked(Settings::getValue(CFG_SCOPE_TRIG_ALGN, true).toBool());
+    m_trig_align = m_ui->actionTrigAlign->isChecked();
     on_actionInterpSinc_triggered(m_ui->actionInterpSinc->isChecked());
 
+    setAvgMode((AvgMode)Settings::getValue(CFG_SCOPE_AVG_MODE, AVG_MEAN).toInt());
+    setDecMode((ScopeDec)Settings::getValue(CFG_SCOPE_DEC, DEC_PEAK).toInt());
+
+    m_strig.ch = Settings::getValue(CFG_SCOPE_STRIG_CH, 1).toInt();
+    m_strig.polarity = (DaqTrigEdge)Settings::getValue(CFG_SCOPE_STRIG_POL, RISING).toInt();
+    m_strig.level = Settings::getValue(CFG_SCOPE_STRIG_LVL, 1.65).toDouble();
+    m_strig.lo = Settings::getValue(CFG_SCOPE_STRIG_LO, 1.0).toDouble();
+    m_strig.hi = Settings::getValue(CFG_SCOPE_STRIG_HI, 2.3).toDouble();
+    m_strig.time = Settings::getValue(CFG_SCOPE_STRIG_T, 0.001).toDouble();
+    setSoftTrigMode((SoftTrigMode)Settings::getValue(CFG_SCOPE_STRIG, STRIG_OFF).toInt());
+    setFftWindow((FftWindow)Settings::getValue(CFG_SCOPE_FFT_WIN, FFT_WIN_HANNING).toInt());
+    setFftWelch(Settings::getValue(CFG_SCOPE_FFT_WELCH, 1).toInt());
+
+    m_seg_want = Settings::getValue(CFG_SCOPE_SEG, 0).toInt();
+    m_seg_overlay = Settings::getValue(CFG_SCOPE_SEG_OVR, true).toBool();
+    m_ui->actionSegmented->setChecked(m_seg_want > 0);
+    m_ui->actionSegOverlay->setChecked(m_seg_overlay);
+
     /* event filter */
 
     m_ui->dial_trigPre->installEventFilter(this);
@@ -141,6 +201,13 @@ void WindowScope::statusBarLoad()
     m_status_seq = new QLabel("Sequence Number: 0", this);
     m_status_smpl = new QLabel("Sampling Time: 1.5", this);
     m_status_ets = new QLabel("", this);
+    m_status_proc = new QLabel("", this);
+
+    m_seg_spin = new QSpinBox(this);
+    m_seg_spin->setPrefix("Segment ");
+    m_seg_spin->setRange(1, 1);
+    m_seg_spin->setVisible(false);
+    connect(m_seg_spin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &WindowScope::on_segSpin_valueChanged);
 
     QWidget* widget = new QWidget(this);
     QLabel* status_zoom = new QLabel("<span>Zoom with Scroll Wheel, Move with Mouse Drag&nbsp;&nbsp;<span>", this);
@@ -150,6 +217,8 @@ void WindowScope::statusBarLoad()
     m_status_seq->setFont(font1);
     m_status_smpl->setFont(font1);
     m_status_ets->setFont(font1);
+    m_status_proc->setFont(font1);
+    m_seg_spin->setFont(font1);
     status_zoom->setFont(font1);
 
     QLabel* status_img = new QLabel(this);
@@ -185,6 +254,7 @@ void WindowScope::statusBarLoad()
     QLabel* status_spacer5 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
     QLabel* status_spacer6 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
     QLabel* status_spacer7 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
+    QLabel* status_spacer8 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
 
     QSpacerItem* status_spacer0 = new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Preferred);
 
@@ -200,11 +270,14 @@ void WindowScope::statusBarLoad()
     layout->addWidget(status_spacer5, 0,8,1,1,Qt::AlignVCenter);
     layout->addWidget(m_status_seq,   0,9,1,1,Qt::AlignVCenter);
     layout->addWidget(status_spacer6, 0,10,1,1,Qt::AlignVCenter);
-    layout->addWidget(m_status_line3, 0,11,1,1,Qt::AlignVCenter);
-    layout->addWidget(status_spacer7, 0,12,1,1,Qt::AlignVCenter);
-    layout->addWidget(m_status_ets,   0,13,1,1,Qt::AlignVCenter | Qt::AlignLeft);
-    layout->addItem(status_spacer0,   0,14,1,1,Qt::AlignVCenter);
-    layout->addWidget(status_zoom,    0,15,1,1,Qt::AlignVCenter);
+    layout->addWidget(m_status_proc,  0,11,1,1,Qt::AlignVCenter);
+    layout->addWidget(status_spacer8, 0,12,1,1,Qt::AlignVCenter);
+    layout->addWidget(m_status_line3, 0,13,1,1,Qt::AlignVCenter);
+    layout->addWidget(status_spacer7, 0,14,1,1,Qt::AlignVCenter);
+    layout->addWidget(m_status_ets,   0,15,1,1,Qt::AlignVCenter | Qt::AlignLeft);
+    layout->addWidget(m_seg_spin,     0,16,1,1,Qt::AlignVCenter | Qt::AlignLeft);
+    layout->addItem(status_spacer0,   0,17,1,1,Qt::AlignVCenter);
+    layout->addWidget(status_zoom,    0,18,1,1,Qt::AlignVCenter);
     layout->setMargin(0);
     layout->setSpacing(0);
 
@@ -248,6 +321,10 @@ void WindowScope::initQcp()
     m_ui->customPlot->addGraph(m_axis_scope->axis(QCPAxis::atBottom), m_axis_scope->axis(QCPAxis::atLeft));
     m_ui->customPlot->addGraph(m_axis_scope->axis(QCPAxis::atBottom), m_axis_scope->axis(QCPAxis::atLeft));
     m_ui->customPlot->addGraph(m_axis_fft->axis(QCPAxis::atBottom), m_axis_fft->axis(QCPAxis::atLeft));
+    m_ui->customPlot->addGraph(m_axis_scope->axis(QCPAxis::atBottom), m_axis_scope->axis(QCPAxis::atLeft));
+    m_ui->customPlot->addGraph(m_axis_scope->axis(QCPAxis::atBottom), m_axis_scope->axis(QCPAxis::atLeft));
+    m_ui->customPlot->addGraph(m_axis_scope->axis(QCPAxis::atBottom), m_axis_scope->axis(QCPAxis::atLeft));
+    m_ui->customPlot->addGraph(m_axis_scope->axis(QCPAxis::atBottom), m_axis_scope->axis(QCPAxis::atLeft));
 
     m_ui->customPlot->graph(GRAPH_CH1)->setPen(QPen(QColor(COLOR1)));
     m_ui->customPlot->graph(GRAPH_CH2)->setPen(QPen(QColor(COLOR2)));
@@ -255,6 +332,29 @@ void WindowScope::initQcp()
     m_ui->customPlot->graph(GRAPH_CH4)->setPen(QPen(QColor(COLOR4)));
     m_ui->customPlot->graph(GRAPH_FFT)->setPen(QPen(QColor(COLOR1)));
 
+    const int graphs_env[4][2] = { {GRAPH_CH1, GRAPH_CH1_MIN}, {GRAPH_CH2, GRAPH_CH2_MIN},
+                                   {GRAPH_CH3, GRAPH_CH3_MIN}, {GRAPH_CH4, GRAPH_CH4_MIN} };
+    for (int i = 0; i < 4; i++) // envelope band = min trace filled up to max trace
+    {
+        QColor color = m_ui->customPlot->graph(graphs_env[i][0])->pen().color();
+        m_ui->customPlot->graph(graphs_env[i][1])->setPen(QPen(color));
+        color.setAlpha(60);
+        m_ui->customPlot->graph(graphs_env[i][1])->setBrush(QBrush(color));
+        m_ui->customPlot->graph(graphs_env[i][1])->setChannelFillGraph(m_ui->customPlot->graph(graphs_env[i][0]));
+    }
+
+    /* segment overlay, one curve per channel, segments split by NaN, under live traces */
+    m_ui->customPlot->addLayer("segments", m_ui->customPlot->layer("main"), QCustomPlot::limBelow);
+
+    for (int i = 0; i < 4; i++)
+    {
+        QColor color = m_ui->customPlot->graph(i)->pen().color();
+        color.setAlpha(60);
+        m_seg_curves[i] = new QCPCurve(m_axis_scope->axis(QCPAxis::atBottom), m_axis_scope->axis(QCPAxis::atLeft));
+        m_seg_curves[i]->setPen(QPen(color));
+        m_seg_curves[i]->setLayer("segments");
+    }
+
     m_spline = true;
 
     m_ui->customPlot->graph(GRAPH_CH1)->setSpline(m_spline);
@@ -262,6 +362,10 @@ void WindowScope::initQcp()
     m_ui->customPlot->graph(GRAPH_CH3)->setSpline(m_spline);
     m_ui->customPlot->graph(GRAPH_CH4)->setSpline(m_spline);
     m_ui->customPlot->graph(GRAPH_FFT)->setSpline(false);
+    m_ui->customPlot->graph(GRAPH_CH1_MIN)->setSpline(m_spline);
+    m_ui->customPlot->graph(GRAPH_CH2_MIN)->setSpline(m_spline);
+    m_ui->customPlot->graph(GRAPH_CH3_MIN)->setSpline(m_spline);
+    m_ui->customPlot->graph(GRAPH_CH4_MIN)->setSpline(m_spline);
 
     m_timeTicker = QSharedPointer<QCPAxisTickerTime>(new QCPAxisTickerTime);
     m_timeTicker2 = QSharedPointer<QCPAxisTickerFixed>(new QCPAxisTickerFixed);
@@ -299,6 +403,7 @@ void WindowScope::initQcp()
     connect(m_axis_fft->axis(QCPAxis::atLeft), SIGNAL(rangeChanged(QCPRange)), m_axis_fft->axis(QCPAxis::atRight), SLOT(setRange(QCPRange)));
 
     connect(m_ui->customPlot, SIGNAL(mouseWheel(QWheelEvent*)), this, SLOT(on_qcpMouseWheel(QWheelEvent*)));
+    connect(m_axis_scope->axis(QCPAxis::atBottom), SIGNAL(rangeChanged(QCPRange)), this, SLOT(on_qcpRangeChanged(QCPRange)));
     connect(m_ui->customPlot, SIGNAL(mousePress(QMouseEvent*)), this, SLOT(on_qcpMousePress(QMouseEvent*)));
 
     if (m_axis_scope->visible())
@@ -336,14 +441,11 @@ void WindowScope::initQcp()
 
 WindowScope::~WindowScope()
 {
-    delete m_ui;
+    m_procThread->quit();
+    m_procThread->wait();
+    delete m_proc;
 
-    if (m_fft_in != NULL)
-        fftw_free(m_fft_in);
-    if (m_fft_out != NULL)
-        fftw_free(m_fft_out);
-    if (m_fft_plan != NULL)
-        fftw_destroy_plan(m_fft_plan);
+    delete m_ui;
 }
 
 void WindowScope::on_actionAbout_triggered()
@@ -363,9 +465,31 @@ void WindowScope::on_timer_plot() // 60 FPS
         m_cursors->refresh(rngV.lower, rngV.upper, rngH.lower, rngH.upper, false); // true
     }
 
+    if (m_proc->takeResult(m_procRes))
+        applyResult();
+
     m_ui->customPlot->replot();
 }
 
+void WindowScope::on_timer_roll()
+{
+    if (!m_roll || m_roll_pending || !m_instrEnabled)
+        return;
+
+    m_roll_pending = true;
+    Core::getInstance()->msgAdd(m_msg_rollRead, true, "");
+
+    if (++m_roll_polls % ROLL_STAT_POLLS == 0)
+        Core::getInstance()->msgAdd(m_msg_roll, true, "");
+}
+
+/******************************** post-processing ********************************/
+
+void WindowScope::on_proc_fftWisdom(const QString wisdom)
+{
+    Settings::setValue(CFG_FFT_WISDOM, wisdom);
+}
+
 /******************************** MSG slots ********************************/
 
 void WindowScope::on_msg_err(const QString text, MsgBoxType type, bool needClose)
@@ -387,6 +511,11 @@ void WindowScope::on_msg_ok_set(double maxZ, double smpl_time, double fs_real_n,
 
     updatePanel();
     m_msgPending = false;
+
+    if (m_daqSet.mem > getMaxMem()) // double buffering needs less memory than device has set
+        sendSet();
+    else if (m_seg_want > 0) // device lays segments out again for new memory
+        Core::getInstance()->msgAdd(m_msg_seg, true, "");
 }
 
 void WindowScope::on_msg_set(DaqBits bits, int mem, int fs, bool ch1, bool ch2, bool ch3, bool ch4, int trig_ch, int trig_val,
@@ -412,6 +541,9 @@ void WindowScope::on_msg_set(DaqBits bits, int mem, int fs, bool ch1, bool ch2,
 
     updatePanel();
     m_msgPending = false;
+
+    if (m_seg_want > 0)
+        Core::getInstance()->msgAdd(m_msg_seg, true, "");
 }
 
 void WindowScope::on_msg_read(const QByteArray data)
@@ -419,372 +551,299 @@ void WindowScope::on_msg_read(const QByteArray data)
     if (m_msgPending)
         return;
 
-    /************* parse circular buffer(s) *************/
-
-    auto info = Core::getInstance()->getDevInfo();
-    int ch_num = m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en;
-
-    const uint8_t* dataU8 = reinterpret_cast<const uint8_t*>(data.constData());
-
-    QVector<double> y1(m_daqSet.mem);
-    QVector<double> y2(m_daqSet.mem);
-    QVector<double> y3(m_daqSet.mem);
-    QVector<double> y4(m_daqSet.mem);
-
-    QVector<double>* _y1 = (m_daqSet.ch1_en ? &y1 : NULL);
-    QVector<double>* _y2 = (m_daqSet.ch2_en ? &y2 : NULL);
-    QVector<double>* _y3 = (m_daqSet.ch3_en ? &y3 : NULL);
-    QVector<double>* _y4 = (m_daqSet.ch4_en ? &y4 : NULL);
-
-    double vcc = info->ref_mv / 1000.0;
-    int found = 0;
-
-    if (info->adc_num == 1)
-    {
-        uint8_t* buff1 = (uint8_t*)dataU8;
-        int buff1_len = data.size();
-
-        if (m_daqSet.bits == B12)
-            buff1_len /= 2;
+    /************* hand frame to pipeline *************/
 
-        int buff1_mem = buff1_len - (info->daq_reserve * ch_num);
+    submitFrame(data, m_firstPos, Core::getInstance()->getDevInfo()->daq_reserve, m_read_dec, m_pack && m_daqSet.bits == B12);
 
-        found += get_vals_from_circ(m_firstPos, buff1_mem, buff1_len, m_daqSet.bits, vcc, buff1, _y1, _y2, _y3, _y4,
-                                    m_gain1, m_gain2, m_gain3, m_gain4, m_offset1, m_offset2, m_offset3, m_offset4);
+    /************** ETS ****************/
 
-    }
-    else if (info->adc_num == 2)
+    if (m_ets)
     {
-        int buff_part = data.size();
-        int buff_part_raw = buff_part;
-
-        if (m_daqSet.bits == B12)
-            buff_part /= 2;
-        buff_part /= ch_num;
-        buff_part_raw /= ch_num;
-
-        uint8_t* buff_it = (uint8_t*)dataU8;
-
-        uint8_t* buff1 = NULL;
-        int buff1_len = 0;
-        int buff1_mem;
-
-        uint8_t* buff2 = NULL;
-        int buff2_len = 0;
-        int buff2_mem;
+        double fin = m_ets_freq;
+        if (m_ets_pwm)
+            fin = WindowPwm::getFreqReal().toDouble();
 
-        if (m_daqSet.ch1_en)
-        {
-            buff1 = buff_it;
-            buff_it += buff_part_raw;
-            buff1_len += buff_part;
-        }
-        if (m_daqSet.ch2_en)
-        {
-            if (!m_daqSet.ch1_en)
-                buff1 = buff_it;
-            buff_it += buff_part_raw;
-            buff1_len += buff_part;
-        }
-        if (m_daqSet.ch3_en)
-        {
-            buff2 = buff_it;
-            buff_it += buff_part_raw;
-            buff2_len += buff_part;
-        }
-        if (m_daqSet.ch4_en)
+        if (m_fin_last != fin)
         {
-            if (!m_daqSet.ch3_en)
-                buff2 = buff_it;
-            //buff_it += buff_part_raw;
-            buff2_len += buff_part;
+            m_last_fs = 0;
+            m_rescale_needed = true;
+            updatePanel();
         }
 
-        buff1_mem = buff1_len - (info->daq_reserve * (m_daqSet.ch1_en + m_daqSet.ch2_en));
-        buff2_mem = buff2_len - (info->daq_reserve * (m_daqSet.ch3_en + m_daqSet.ch4_en));
+        m_fin_last = fin;
+    }
+}
 
-        if (m_daqSet.ch1_en || m_daqSet.ch2_en)
-            found += get_vals_from_circ(m_firstPos, buff1_mem, buff1_len, m_daqSet.bits, vcc, buff1, _y1, _y2, NULL, NULL,
-                                        m_gain1, m_gain2, 0, 0, m_offset1, m_offset2, 0, 0);
-        if (m_daqSet.ch3_en || m_daqSet.ch4_en)
-            found += get_vals_from_circ(m_firstPos, buff2_mem, buff2_len, m_daqSet.bits, vcc, buff2, _y3, _y4, NULL, NULL,
-                                        m_gain3, m_gain4, 0, 0, m_offset3, m_offset4, 0, 0);
+void WindowScope::submitFrame(const QByteArray& data, int firstPos, int reserve, int dec_factor, bool packed)
+{
+    auto info = Core::getInstance()->getDevInfo();
 
-    }
-    else if (info->adc_num == 4)
+    ScopeJob job;
+    job.data = data;
+    job.firstPos = firstPos;
+
+    job.daqSet = m_daqSet;
+    job.packed = packed;
+    job.dec_factor = dec_factor;
+    job.dec_mode = m_read_dec_mode;
+    job.adc_num = info->adc_num;
+    job.daq_reserve = reserve;
+    job.vcc = info->ref_mv / 1000.0;
+
+    job.gain[0] = m_gain1;
+    job.gain[1] = m_gain2;
+    job.gain[2] = m_gain3;
+    job.gain[3] = m_gain4;
+    job.offset[0] = m_offset1;
+    job.offset[1] = m_offset2;
+    job.offset[2] = m_offset3;
+    job.offset[3] = m_offset4;
+
+    job.math_2minus1 = m_math_2minus1;
+    job.math_4minus3 = m_math_4minus3;
+    job.math_xy_12 = m_math_xy_12;
+    job.math_xy_34 = m_math_xy_34;
+
+    job.triggered = !m_roll && (m_ready == Ready::READY_NORMAL || m_ready == Ready::READY_SINGLE);
+    job.trig_align = m_trig_align;
+    job.trig_interp = m_spline ? ALIGN_SINC : ALIGN_LINEAR;
+    job.roll = m_roll;
+    job.strig = m_strig;
+    if (m_roll) // held frames would freeze stream
+        job.strig.mode = STRIG_OFF;
+
+    if (m_seg_overlay && !m_roll) // segments are empty unless last read was segmented
     {
-        int buff_part = data.size();
-        int buff_part_raw = buff_part;
+        for (int i = 0; i < m_seg_data.size(); i++)
+        {
+            if (i == m_seg_idx)
+                continue;
 
-        if (m_daqSet.bits == B12)
-            buff_part /= 2;
-        buff_part /= ch_num;
-        buff_part_raw /= ch_num;
+            job.overlay.append(m_seg_data[i]);
+            job.overlay_first.append(m_seg_first[i]);
+        }
+    }
 
-        uint8_t* buff_it = (uint8_t*)dataU8;
+    job.average = m_average;
+    job.average_mode = m_average_mode;
+    job.average_num = m_average_num;
+    job.average_gen = m_average_gen;
 
-        uint8_t* buff1 = NULL;
-        int buff1_len = buff_part;
-        int buff1_mem = buff1_len - (info->daq_reserve);
+    job.meas_en = m_meas_en;
+    job.meas_ch = m_meas_ch;
 
-        uint8_t* buff2 = NULL;
-        int buff2_len = buff_part;
-        int buff2_mem = buff2_len - (info->daq_reserve);
+    job.fft = m_fft;
+    job.fft_ch = m_fft_ch;
+    job.fft_size = m_fft_size;
+    job.fft_window = m_fft_window;
+    job.fft_welch = m_fft_welch;
 
-        uint8_t* buff3 = NULL;
-        int buff3_len = buff_part;
-        int buff3_mem = buff3_len - (info->daq_reserve);
+    m_proc->submit(job);
+}
 
-        uint8_t* buff4 = NULL;
-        int buff4_len = buff_part;
-        int buff4_mem = buff4_len - (info->daq_reserve);
+void WindowScope::on_msg_rollRead(const QByteArray data)
+{
+    m_roll_pending = false;
 
-        if (m_daqSet.ch1_en)
-        {
-            buff1 = buff_it;
-            buff_it += buff_part_raw;
-        }
-        if (m_daqSet.ch2_en)
-        {
-            buff2 = buff_it;
-            buff_it += buff_part_raw;
-        }
-        if (m_daqSet.ch3_en)
-        {
-            buff3 = buff_it;
-            buff_it += buff_part_raw;
-        }
-        if (m_daqSet.ch4_en)
-        {
-            buff4 = buff_it;
-            buff_it += buff_part_raw;
-        }
+    if (!m_roll || m_msgPending)
+        return;
 
-        if (m_daqSet.ch1_en)
-            found += get_vals_from_circ(m_firstPos, buff1_mem, buff1_len, m_daqSet.bits, vcc, buff1, _y1, NULL, NULL, NULL,
-                                        m_gain1, 0, 0, 0, m_offset1, 0, 0, 0);
-        if (m_daqSet.ch2_en)
-            found += get_vals_from_circ(m_firstPos, buff2_mem, buff2_len, m_daqSet.bits, vcc, buff2, _y2, NULL, NULL, NULL,
-                                        m_gain2, 0, 0, 0, m_offset2, 0, 0, 0);
-        if (m_daqSet.ch3_en)
-            found += get_vals_from_circ(m_firstPos, buff3_mem, buff3_len, m_daqSet.bits, vcc, buff3, _y3, NULL, NULL, NULL,
-                                        m_gain3, 0, 0, 0, m_offset3, 0, 0, 0);
-        if (m_daqSet.ch4_en)
-            found += get_vals_from_circ(m_firstPos, buff4_mem, buff4_len, m_daqSet.bits, vcc, buff4, _y4, NULL, NULL, NULL,
-                                        m_gain4, 0, 0, 0, m_offset4, 0, 0, 0);
+    /* samples per block of each DAQ buffer, same split as device buffers */
+    auto info = Core::getInstance()->getDevInfo();
+    int chans[4] = { 0, 0, 0, 0 };
 
+    if (info->adc_num == 1)
+        chans[0] = m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en;
+    else if (info->adc_num == 2)
+    {
+        chans[0] = m_daqSet.ch1_en + m_daqSet.ch2_en;
+        chans[1] = m_daqSet.ch3_en + m_daqSet.ch4_en;
     }
-    else assert(0);
-
-    if (found / ch_num != m_daqSet.mem) // wrong data size
+    else
     {
-        m_err_cntr++;
-        if (m_err_cntr > READ_ERROR_CNT)
-        {
-            on_msg_err(QString(INVALID_MSG) + " (data size wrong -> " + QString::number(found) + "!=" +
-                       QString::number((m_daqSet.mem * ch_num)) + ")", CRITICAL, true);
-            m_err_cntr = 0;
-        }
-
-        return;
+        chans[0] = m_daqSet.ch1_en;
+        chans[1] = m_daqSet.ch2_en;
+        chans[2] = m_daqSet.ch3_en;
+        chans[3] = m_daqSet.ch4_en;
     }
 
-    /************* math *************/
+    const int smpl = (m_daqSet.bits == B12 ? 2 : 1);
+    const int frame_len = (chans[0] + chans[1] + chans[2] + chans[3]) * smpl;
 
-    if (m_math_2minus1 || m_math_4minus3)
+    for (int i = 0; i < 4; i++) // settings changed, start history over
     {
-        for (int i = 0; i < m_daqSet.mem; i++)
-        {
-            if (m_math_2minus1 && m_daqSet.ch1_en && m_daqSet.ch2_en)
-                y1[i] = y2[i] - y1[i];
-
-            if (m_math_4minus3 && m_daqSet.ch3_en && m_daqSet.ch4_en)
-                y3[i] = y4[i] - y3[i];
-        }
+        int hist_len = m_daqSet.mem * chans[i] * smpl;
+        if (m_roll_hist[i].size() != hist_len)
+            m_roll_hist[i] = QByteArray(hist_len, 0);
     }
 
-    /************* average *************/
+    const uchar* it = reinterpret_cast<const uchar*>(data.constData());
+    int pos = 0;
+    bool appended = false;
 
-    if (m_average)
+    while (pos + ROLL_HDR_LEN <= data.size())
     {
-        if (m_average_cnt < m_average_num)
-            m_average_cnt++;
+        quint32 seq = qFromLittleEndian<quint32>(it + pos);
+        int frames = qFromLittleEndian<quint16>(it + pos + 4);
+        int len = qFromLittleEndian<quint16>(it + pos + 6);
 
-        for (int i = 0; i < m_daqSet.mem; i++)
-        {
-            double acc1 = 0;
-            double acc2 = 0;
-            double acc3 = 0;
-            double acc4 = 0;
+        if (len <= ROLL_HDR_LEN || pos + len > data.size()) // broken stream
+            break;
 
-            if (m_daqSet.ch1_en) m_average_buff_ch1[m_average_it][i] = y1[i];
-            if (m_daqSet.ch2_en) m_average_buff_ch2[m_average_it][i] = y2[i];
-            if (m_daqSet.ch3_en) m_average_buff_ch3[m_average_it][i] = y3[i];
-            if (m_daqSet.ch4_en) m_average_buff_ch4[m_average_it][i] = y4[i];
+        if (m_roll_seq != 0 && seq != m_roll_seq + 1)
+            m_roll_gaps += seq - m_roll_seq - 1;
+        m_roll_seq = seq;
 
-            for (int j = 0; j < m_average_cnt; j++)
-            {
-                if (m_daqSet.ch1_en) acc1 += m_average_buff_ch1[j][i];
-                if (m_daqSet.ch2_en) acc2 += m_average_buff_ch2[j][i];
-                if (m_daqSet.ch3_en) acc3 += m_average_buff_ch3[j][i];
-                if (m_daqSet.ch4_en) acc4 += m_average_buff_ch4[j][i];
-            }
-
-            if (m_daqSet.ch1_en) y1[i] = acc1 / m_average_cnt;
-            if (m_daqSet.ch2_en) y2[i] = acc2 / m_average_cnt;
-            if (m_daqSet.ch3_en) y3[i] = acc3 / m_average_cnt;
-            if (m_daqSet.ch4_en) y4[i] = acc4 / m_average_cnt;
-        }
+        if (ROLL_HDR_LEN + (frames * frame_len) == len) // else block from before settings change
+        {
+            const char* blk = data.constData() + pos + ROLL_HDR_LEN;
 
-        m_average_it++;
+            for (int i = 0; i < 4; i++)
+            {
+                if (chans[i] == 0)
+                    continue;
 
-        if (m_average_it == m_average_num)
-            m_average_it = 0;
-    }
+                int n = frames * chans[i] * smpl;
+                int hist_len = m_roll_hist[i].size();
 
-    /************* plot data *************/
+                if (n >= hist_len)
+                    m_roll_hist[i] = QByteArray(blk + n - hist_len, hist_len);
+                else
+                {
+                    m_roll_hist[i].remove(0, n);
+                    m_roll_hist[i].append(blk, n);
+                }
 
-    assert(!m_t.isEmpty());
+                blk += n;
+            }
 
-    if (m_math_xy_12 || m_math_xy_34)
-    {
-        if (m_math_xy_12)
-        {
-            if (m_daqSet.ch1_en && m_daqSet.ch2_en)
-                m_ui->customPlot->graph(GRAPH_CH1)->setData(y1, y2);
+            appended = true;
         }
 
-        if (m_math_xy_34)
-        {
-            if (m_daqSet.ch3_en && m_daqSet.ch4_en)
-                m_ui->customPlot->graph(GRAPH_CH3)->setData(y3, y4);
-        }
+        pos += len;
     }
-    else
-    {
-        if (m_daqSet.ch1_en)
-            m_ui->customPlot->graph(GRAPH_CH1)->setData(m_t, y1);
 
-        if (!m_math_2minus1 && m_daqSet.ch2_en)
-            m_ui->customPlot->graph(GRAPH_CH2)->setData(m_t, y2);
+    if (!appended)
+        return;
 
-        if (m_daqSet.ch3_en)
-            m_ui->customPlot->graph(GRAPH_CH3)->setData(m_t, y3);
+    QByteArray frame; // linear frame of all buffers, newest sample last
+    frame.reserve(m_daqSet.mem * frame_len);
 
-        if (!m_math_4minus3 && m_daqSet.ch4_en)
-            m_ui->customPlot->graph(GRAPH_CH4)->setData(m_t, y4);
-    }
+    for (int i = 0; i < 4; i++)
+        frame.append(m_roll_hist[i]);
 
-    /************* meas *************/
+    submitFrame(frame, 0, 0, 1, false);
+    rollStatus();
+}
 
-    if (m_meas_en)
-    {
-        QString meas_vpp_s;
-        QString meas_rms_s;
-        QString meas_avg_s;
-        QString meas_min_s;
-        QString meas_max_s;
+void WindowScope::on_msg_roll(bool active, quint32, quint32 overruns)
+{
+    m_roll_overruns = overruns;
 
-        auto data_begin = m_ui->customPlot->graph(m_meas_ch)->data()->constBegin();
-        auto data_end = m_ui->customPlot->graph(m_meas_ch)->data()->constEnd();
+    if (m_roll && !active) // device left roll mode on its own
+        on_msg_ok_roll(EMBO_SET_FALSE, "");
+    else
+        rollStatus();
+}
 
-        double avg = std::accumulate(data_begin, data_end, .0, [](double a, QCPGraphData b) { return a + b.value;}) / std::distance(data_begin, data_end);
-        double rms = sqrt((std::accumulate(data_begin, data_end, .0, [](double a, QCPGraphData b) { return a + (b.value * b.value);}) / std::distance(data_begin, data_end)));
-        double min = std::min_element(data_begin, data_end, [](QCPGraphData a, QCPGraphData b) { return a.value < b.value; })->value; // m_meas_min;
-        double max = std::max_element(data_begin, data_end, [](QCPGraphData a, QCPGraphData b) { return a.value < b.value; })->value; // m_meas_max;
-        double vpp = max - min;
+void WindowScope::on_msg_ok_roll(const QString val1, const QString)
+{
+    m_roll = (val1 == EMBO_SET_TRUE);
+    m_ui->actionRoll->setChecked(m_roll);
+    m_ui->menuTrigger->setEnabled(!m_roll); // software trigger is off while rolling
 
-        meas_vpp_s = meas_vpp_s.asprintf(vpp >= 100 || vpp <= -10  ? "%.2f" : (vpp >= 10 || vpp < 0 ? "%.3f" : "%.4f"), vpp);
-        meas_rms_s = meas_rms_s.asprintf(rms >= 100 || rms <= -10  ? "%.2f" : (rms >= 10 || rms < 0 ? "%.3f" : "%.4f"), rms);
-        meas_avg_s = meas_avg_s.asprintf(avg >= 100 || avg <= -10  ? "%.2f" : (avg >= 10 || avg < 0 ? "%.3f" : "%.4f"), avg);
-        meas_min_s = meas_min_s.asprintf(min >= 100 || min <= -10  ? "%.2f" : (min >= 10 || min < 0 ? "%.3f" : "%.4f"), min);
-        meas_max_s = meas_max_s.asprintf(max >= 100 || max <= -10  ? "%.2f" : (max >= 10 || max < 0 ? "%.3f" : "%.4f"), max);
+    rollReset();
 
-        m_ui->textBrowser_measVpp->setHtml("<p align=\"right\">" + meas_vpp_s + " </p>");
-        m_ui->textBrowser_measRms->setHtml("<p align=\"right\">" + meas_rms_s + " </p>");
-        m_ui->textBrowser_measAvg->setHtml("<p align=\"right\">" + meas_avg_s + " </p>");
-        m_ui->textBrowser_measMin->setHtml("<p align=\"right\">" + meas_min_s + " </p>");
-        m_ui->textBrowser_measMax->setHtml("<p align=\"right\">" + meas_max_s + " </p>");
+    if (m_roll)
+    {
+        m_status_line3->setVisible(true);
+        m_timer_roll->start((int)TIMER_SCOPE_ROLL);
     }
-
-    /************* FFT *************/
-
-    if (m_fft)
+    else
     {
-        QVector<double>* y = NULL;
+        m_timer_roll->stop();
 
-        if (m_fft_ch == 1 && m_daqSet.ch1_en)
-            y = &y1;
-        else if (m_fft_ch == 2 && m_daqSet.ch2_en)
-            y = &y2;
-        else if (m_fft_ch == 3 && m_daqSet.ch3_en)
-            y = &y3;
-        else if (m_fft_ch == 4 && m_daqSet.ch4_en)
-            y = &y4;
-
-        if (y != NULL && m_fft_in != NULL)
+        if (!m_ets && m_seg_num == 0) // label is shared with ETS and segments
         {
-            memset(m_fft_in, 0, m_fft_size); // zero pad
-            memcpy(m_fft_in, (*y).data(), m_daqSet.mem * sizeof(double));
+            m_status_ets->setText("");
+            m_status_line3->setVisible(false);
+        }
+    }
 
-            for (int i = 0; i < m_daqSet.mem; i++)
-            {
-                double multiplier = 0.5 * (1 - cos(2*M_PI*i/(m_daqSet.mem - 1))); // hanning window
-                m_fft_in[i] = multiplier * m_fft_in[i];
-            }
+    rollStatus();
+}
 
-            fftw_execute(m_fft_plan);
+/* header table first, then segments back to back, each padded to its len */
+void WindowScope::on_msg_segRead(const QByteArray data)
+{
+    if (m_seg_num == 0 || m_msgPending)
+        return;
 
-            double scale = 1.0 / (double)m_daqSet.mem;
-            QVector<double> fft_db;
+    auto info = Core::getInstance()->getDevInfo();
+    const int ch_num = m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en;
+    const int frame_sz = (m_daqSet.mem + info->daq_reserve) * ch_num * (m_daqSet.bits == B12 ? 2 : 1);
+    const uint8_t* raw = reinterpret_cast<const uint8_t*>(data.constData());
 
-            for (int re = 0, im = m_fft_size - 1; re < m_fft_size / 2; re++, im--)
-            {
-                m_fft_out[re] *= scale; // normalize
-                m_fft_out[im] *= scale;
+    int len = data.size() >= SEG_HDR_LEN ? (raw[6] | (raw[7] << 8)) : 0;
+    if (len < frame_sz || data.size() % (SEG_HDR_LEN + len) != 0)
+    {
+        m_err_cntr++;
+        if (m_err_cntr > READ_ERROR_CNT)
+        {
+            on_msg_err(QString(INVALID_MSG) + " (segments size wrong -> " + QString::number(data.size()) + ")", CRITICAL, true);
+            m_err_cntr = 0;
+        }
+        return;
+    }
 
-                double db = 20 * log10(sqrt((m_fft_out[re] * m_fft_out[re]) + (m_fft_out[im] * m_fft_out[im]))); // complex to dB
-                fft_db.append(db);
-            }
+    const int cnt = data.size() / (SEG_HDR_LEN + len);
 
-            m_ui->customPlot->graph(GRAPH_FFT)->setData(m_fft_x, fft_db);
+    m_seg_data.resize(cnt);
+    m_seg_first.resize(cnt);
+    m_seg_time.resize(cnt);
 
-            if (m_rescale_fft_needed)
-            {
-                m_axis_fft->axis(QCPAxis::atLeft)->setRange(FFT_DB_MIN, FFT_DB_MAX);
-                //m_axis_fft->axis(QCPAxis::atLeft)->rescale();
-                m_axis_fft->axis(QCPAxis::atBottom)->setRange(0, m_daqSet.fs_real_n / 2);
-                m_rescale_fft_needed = false;
-            }
-        }
+    for (int i = 0; i < cnt; i++)
+    {
+        const uint8_t* hdr = raw + (i * SEG_HDR_LEN);
+        m_seg_time[i] = hdr[0] | (hdr[1] << 8) | (hdr[2] << 16) | ((quint32)hdr[3] << 24);
+        m_seg_first[i] = hdr[4] | (hdr[5] << 8);
+        m_seg_data[i] = data.mid((cnt * SEG_HDR_LEN) + (i * len), frame_sz);
     }
 
-    /************* seq num *************/
-
-    m_seq_num++;
-    m_status_seq->setText("Sequence Number: " + QString::number(m_seq_num));
+    m_seg_spin->blockSignals(true);
+    m_seg_spin->setRange(1, cnt);
+    m_seg_spin->setSuffix(" / " + QString::number(cnt));
+    m_seg_spin->setValue(cnt); // newest
+    m_seg_spin->blockSignals(false);
+    m_seg_idx = cnt - 1;
 
-    /************** ETS ****************/
+    segShow();
+}
 
-    if (m_ets)
-    {
-        double fin = m_ets_freq;
-        if (m_ets_pwm)
-            fin = WindowPwm::getFreqReal().toDouble();
+void WindowScope::on_msg_seg(bool active, int num, int)
+{
+    if (m_seg_num != (active ? num : 0))
+        on_msg_ok_seg(QString::number(active ? num : 0), "");
+}
 
-        if (m_fin_last != fin)
-        {
-            m_last_fs = 0;
-            m_rescale_needed = true;
-            updatePanel();
-        }
+void WindowScope::on_msg_ok_seg(const QString val1, const QString)
+{
+    m_seg_num = val1.toInt();
 
-        m_fin_last = fin;
-    }
+    segReset();
 
-    /************* finally replot *************/
+    m_seg_spin->setVisible(m_seg_num > 0);
 
-    //m_ui->customPlot->replot();
+    if (m_seg_num > 0)
+    {
+        m_status_line3->setVisible(true);
+        m_status_ets->setText("Segments: " + QString::number(m_seg_num) + " fit memory");
+    }
+    else if (!m_ets && !m_roll) // label is shared with ETS and roll
+    {
+        m_status_ets->setText("");
+        m_status_line3->setVisible(false);
+    }
 }
 
 void WindowScope::on_msg_daqReady(Ready ready, int firstPos)
@@ -812,7 +871,12 @@ void WindowScope::on_msg_daqReady(Ready ready, int firstPos)
         m_ui->radioButton_trigLed->setChecked(false);
 
     if (m_instrEnabled)
-        Core::getInstance()->msgAdd(m_msg_read, true);
+    {
+        if (m_seg_num > 0 && !m_roll) // all segments in one read
+            Core::getInstance()->msgAdd(m_msg_segRead, true, "");
+        else
+            Core::getInstance()->msgAdd(m_msg_read, true, readParams());
+    }
 }
 
 void WindowScope::on_msg_ok_forceTrig(const QString, const QString)
@@ -877,11 +941,144 @@ void WindowScope::on_actionInterpSinc_triggered(bool checked) // exclusive with
     m_ui->customPlot->graph(GRAPH_CH2)->setSpline(checked);
     m_ui->customPlot->graph(GRAPH_CH3)->setSpline(checked);
     m_ui->customPlot->graph(GRAPH_CH4)->setSpline(checked);
+    m_ui->customPlot->graph(GRAPH_CH1_MIN)->setSpline(checked);
+    m_ui->customPlot->graph(GRAPH_CH2_MIN)->setSpline(checked);
+    m_ui->customPlot->graph(GRAPH_CH3_MIN)->setSpline(checked);
+    m_ui->customPlot->graph(GRAPH_CH4_MIN)->setSpline(checked);
 
+    lodRender();
     rescaleYAxis();
     m_ui->customPlot->replot();
 }
 
+void WindowScope::on_actionAvgMean_triggered(bool checked) // exclusive with - other avg modes
+{
+    if (checked)
+        setAvgMode(AVG_MEAN);
+    else
+        m_ui->actionAvgMean->setChecked(true);
+}
+
+void WindowScope::on_actionAvgExp_triggered(bool checked)
+{
+    if (checked)
+        setAvgMode(AVG_EXP);
+    else
+        m_ui->actionAvgExp->setChecked(true);
+}
+
+void WindowScope::on_actionAvgPeak_triggered(bool checked)
+{
+    if (checked)
+        setAvgMode(AVG_PEAK);
+    else
+        m_ui->actionAvgPeak->setChecked(true);
+}
+
+void WindowScope::on_actionAvgEnvelope_triggered(bool checked)
+{
+    if (checked)
+        setAvgMode(AVG_ENVELOPE);
+    else
+        m_ui->actionAvgEnvelope->setChecked(true);
+}
+
+void WindowScope::on_actionTrigAlign_triggered(bool checked)
+{
+    m_trig_align = checked;
+
+    Settings::setValue(CFG_SCOPE_TRIG_ALGN, checked);
+
+    if (m_average) // unaligned history would blur aligned frames
+        on_pushButton_average_off_clicked();
+}
+
+void WindowScope::on_actionDecOff_triggered(bool checked) // exclusive with - other dec modes
+{
+    if (checked)
+        setDecMode(DEC_OFF);
+    else
+        m_ui->actionDecOff->setChecked(true);
+}
+
+void WindowScope::on_actionDecSub_triggered(bool checked)
+{
+    if (checked)
+        setDecMode(DEC_SUB);
+    else
+        m_ui->actionDecSub->setChecked(true);
+}
+
+void WindowScope::on_actionDecPeak_triggered(bool checked)
+{
+    if (checked)
+        setDecMode(DEC_PEAK);
+    else
+        m_ui->actionDecPeak->setChecked(true);
+}
+
+void WindowScope::on_actionDecMean_triggered(bool checked)
+{
+    if (checked)
+        setDecMode(DEC_MEAN);
+    else
+        m_ui->actionDecMean->setChecked(true);
+}
+
+void WindowScope::on_actionRoll_triggered(bool checked)
+{
+    m_ui->actionRoll->setChecked(m_roll); // until device confirms
+
+    Core::getInstance()->msgAdd(m_msg_roll, false, checked ? EMBO_SET_TRUE : EMBO_SET_FALSE);
+}
+
+void WindowScope::on_actionSegmented_triggered(bool checked)
+{
+    int num = 0;
+
+    if (checked)
+    {
+        bool ok;
+        num = QInputDialog::getInt(this, "EMBO - Segmented Memory", "Segments (each trigger fills next one):",
+                                   Settings::getValue(CFG_SCOPE_SEG_NUM, 16).toInt(), 2, SEG_MAX, 1, &ok);
+        if (!ok)
+        {
+            m_ui->actionSegmented->setChecked(m_seg_want > 0);
+            return;
+        }
+
+        Settings::setValue(CFG_SCOPE_SEG_NUM, num);
+    }
+
+    m_seg_want = num;
+    Settings::setValue(CFG_SCOPE_SEG, num);
+
+    Core::getInstance()->msgAdd(m_msg_seg, false, QString::number(num));
+}
+
+void WindowScope::on_actionSegOverlay_triggered(bool checked)
+{
+    m_seg_overlay = checked;
+    Settings::setValue(CFG_SCOPE_SEG_OVR, checked);
+
+    segShow();
+}
+
+void WindowScope::on_segSpin_valueChanged(int value)
+{
+    m_seg_idx = value - 1;
+
+    segShow();
+}
+
+void WindowScope::on_actionDoubleBuffer_triggered(bool checked)
+{
+    Settings::setValue(CFG_SCOPE_DBUF, checked);
+
+    Core::getInstance()->msgAdd(m_msg_dbuf, false, checked ? EMBO_SET_TRUE : EMBO_SET_FALSE);
+    sendSet(); // max memory changed
+}
+
 /********** Export **********/
 
 void WindowScope::on_actionExportSave_triggered()
@@ -924,16 +1121,21 @@ void WindowScope::on_actionExportSave_triggered()
         auto data_3 = m_ui->customPlot->graph(GRAPH_CH3)->data();
         auto data_4 = m_ui->customPlot->graph(GRAPH_CH4)->data();
 
-        for (int i = 0; i < data_1->size(); i++)
+        /* graphs may hold decimated data, full traces are in LOD */
+        const PlotLod* lod = m_lod;
+        bool full = !lod[GRAPH_CH1].isEmpty() || !lod[GRAPH_CH2].isEmpty() || !lod[GRAPH_CH3].isEmpty() || !lod[GRAPH_CH4].isEmpty();
+        int len = full ? m_t.size() : data_1->size();
+
+        for (int i = 0; i < len; i++)
         {
             if (m_daqSet.ch1_en)
-                m_rec << data_1->at(i)->value;
+                m_rec << (full ? lod[GRAPH_CH1].values().value(i) : data_1->at(i)->value);
             if (m_daqSet.ch2_en)
-                m_rec << data_2->at(i)->value;
+                m_rec << (full ? lod[GRAPH_CH2].values().value(i) : data_2->at(i)->value);
             if (m_daqSet.ch3_en)
-                m_rec << data_3->at(i)->value;
+                m_rec << (full ? lod[GRAPH_CH3].values().value(i) : data_3->at(i)->value);
             if (m_daqSet.ch4_en)
-                m_rec << data_4->at(i)->value;
+                m_rec << (full ? lod[GRAPH_CH4].values().value(i) : data_4->at(i)->value);
             m_rec << ENDL;
         }
 
@@ -1531,6 +1733,62 @@ void WindowScope::on_actionFFT_1048576_triggered(bool checked)
     }
 }
 
+void WindowScope::on_actionFFTWinHanning_triggered(bool checked) // exclusive with - other windows
+{
+    if (checked)
+        setFftWindow(FFT_WIN_HANNING);
+    else
+        m_ui->actionFFTWinHanning->setChecked(true);
+}
+
+void WindowScope::on_actionFFTWinBlackmanHarris_triggered(bool checked)
+{
+    if (checked)
+        setFftWindow(FFT_WIN_BLACKMAN_HARRIS);
+    else
+        m_ui->actionFFTWinBlackmanHarris->setChecked(true);
+}
+
+void WindowScope::on_actionFFTWinFlattop_triggered(bool checked)
+{
+    if (checked)
+        setFftWindow(FFT_WIN_FLATTOP);
+    else
+        m_ui->actionFFTWinFlattop->setChecked(true);
+}
+
+void WindowScope::on_actionFFTWelch_1_triggered(bool checked) // exclusive with - other segment counts
+{
+    if (checked)
+        setFftWelch(1);
+    else
+        m_ui->actionFFTWelch_1->setChecked(true);
+}
+
+void WindowScope::on_actionFFTWelch_4_triggered(bool checked)
+{
+    if (checked)
+        setFftWelch(4);
+    else
+        m_ui->actionFFTWelch_4->setChecked(true);
+}
+
+void WindowScope::on_actionFFTWelch_8_triggered(bool checked)
+{
+    if (checked)
+        setFftWelch(8);
+    else
+        m_ui->actionFFTWelch_8->setChecked(true);
+}
+
+void WindowScope::on_actionFFTWelch_16_triggered(bool checked)
+{
+    if (checked)
+        setFftWelch(16);
+    else
+        m_ui->actionFFTWelch_16->setChecked(true);
+}
+
 /********** ETS **********/
 
 void WindowScope::on_actionETS_Custom_triggered(bool checked)
@@ -1577,24 +1835,143 @@ void WindowScope::on_actionETS_Enabled_triggered(bool checked)
     m_rescale_needed = true;
     updatePanel();
 
-    if (checked)
+    if (checked)
+    {
+        if (m_ets_pwm && !m_ets_pwm_shown)
+        {
+            emit showPwm();
+            m_ets_pwm_shown = true;
+        }
+
+        m_status_line3->setVisible(true);
+    }
+    else
+    {
+        if (!m_roll && m_seg_num == 0) // label is shared with roll and segments
+        {
+            m_status_ets->setText("");
+            m_status_line3->setVisible(false);
+        }
+        m_ui->actionETS_fSEQ->setText("fSEQ: ?");
+        m_ui->actionETS_coef->setText("coef:  ?");
+    }
+
+}
+
+/********** Software Trigger **********/
+
+void WindowScope::on_actionStrigOff_triggered(bool checked) // exclusive with - other soft trig modes
+{
+    if (checked)
+        setSoftTrigMode(STRIG_OFF);
+    else
+        m_ui->actionStrigOff->setChecked(true);
+}
+
+void WindowScope::on_actionStrigPulseGt_triggered(bool checked)
+{
+    if (checked)
+        setSoftTrigMode(STRIG_PULSE_GT);
+    else
+        m_ui->actionStrigPulseGt->setChecked(true);
+}
+
+void WindowScope::on_actionStrigPulseLt_triggered(bool checked)
+{
+    if (checked)
+        setSoftTrigMode(STRIG_PULSE_LT);
+    else
+        m_ui->actionStrigPulseLt->setChecked(true);
+}
+
+void WindowScope::on_actionStrigRunt_triggered(bool checked)
+{
+    if (checked)
+        setSoftTrigMode(STRIG_RUNT);
+    else
+        m_ui->actionStrigRunt->setChecked(true);
+}
+
+void WindowScope::on_actionStrigWindow_triggered(bool checked)
+{
+    if (checked)
+        setSoftTrigMode(STRIG_WINDOW);
+    else
+        m_ui->actionStrigWindow->setChecked(true);
+}
+
+void WindowScope::on_actionStrigSlewGt_triggered(bool checked)
+{
+    if (checked)
+        setSoftTrigMode(STRIG_SLEW_GT);
+    else
+        m_ui->actionStrigSlewGt->setChecked(true);
+}
+
+void WindowScope::on_actionStrigSlewLt_triggered(bool checked)
+{
+    if (checked)
+        setSoftTrigMode(STRIG_SLEW_LT);
+    else
+        m_ui->actionStrigSlewLt->setChecked(true);
+}
+
+void WindowScope::on_actionStrigSettings_triggered()
+{
+    const QString title = "EMBO - Software Trigger";
+    const QStringList pols = { "Rising / Positive / Above", "Falling / Negative / Below", "Both" };
+    const SoftTrigMode mode = m_strig.mode;
+    const bool pulse = (mode == STRIG_PULSE_GT || mode == STRIG_PULSE_LT || mode == STRIG_OFF);
+    const bool range = (mode != STRIG_PULSE_GT && mode != STRIG_PULSE_LT);
+    const bool time = (mode != STRIG_RUNT && mode != STRIG_WINDOW);
+
+    SoftTrigCfg cfg = m_strig;
+    bool ok;
+
+    cfg.ch = QInputDialog::getInt(this, title, "Channel:", cfg.ch, 1, 4, 1, &ok);
+    if (!ok)
+        return;
+
+    QString pol = QInputDialog::getItem(this, title, "Polarity:", pols, (int)cfg.polarity, false, &ok);
+    if (!ok)
+        return;
+    cfg.polarity = (DaqTrigEdge)pols.indexOf(pol);
+
+    if (pulse)
+    {
+        cfg.level = QInputDialog::getDouble(this, title, "Pulse level [V]:", cfg.level, -1000, 1000, 3, &ok);
+        if (!ok)
+            return;
+    }
+
+    if (range)
     {
-        if (m_ets_pwm && !m_ets_pwm_shown)
-        {
-            emit showPwm();
-            m_ets_pwm_shown = true;
-        }
+        cfg.lo = QInputDialog::getDouble(this, title, "Low level [V]:", cfg.lo, -1000, 1000, 3, &ok);
+        if (!ok)
+            return;
 
-        m_status_line3->setVisible(true);
+        cfg.hi = QInputDialog::getDouble(this, title, "High level [V]:", cfg.hi, -1000, 1000, 3, &ok);
+        if (!ok)
+            return;
     }
-    else
+
+    if (time)
     {
-        m_status_ets->setText("");
-        m_status_line3->setVisible(false);
-        m_ui->actionETS_fSEQ->setText("fSEQ: ?");
-        m_ui->actionETS_coef->setText("coef:  ?");
+        cfg.time = QInputDialog::getDouble(this, title, mode == STRIG_SLEW_GT || mode == STRIG_SLEW_LT ?
+                                           "Slew time [us]:" : "Pulse width [us]:", cfg.time * 1e6, 0, 1e9, 3, &ok) / 1e6;
+        if (!ok)
+            return;
     }
 
+    m_strig = cfg;
+    m_strig_rejected = 0;
+
+    Settings::setValue(CFG_SCOPE_STRIG_CH, cfg.ch);
+    Settings::setValue(CFG_SCOPE_STRIG_POL, (int)cfg.polarity);
+    Settings::setValue(CFG_SCOPE_STRIG_LVL, cfg.level);
+    Settings::setValue(CFG_SCOPE_STRIG_LO, cfg.lo);
+    Settings::setValue(CFG_SCOPE_STRIG_HI, cfg.hi);
+    Settings::setValue(CFG_SCOPE_STRIG_T, cfg.time);
 }
 
 /********** Cursors **********/
@@ -1704,6 +2081,11 @@ void WindowScope::on_qcpMouseWheel(QWheelEvent*)
     m_ui->horizontalSlider_trigVal->setStyleSheet(CSS_SCOPE_TRIG_VAL_OFF);
 }
 
+void WindowScope::on_qcpRangeChanged(const QCPRange&)
+{
+    lodRender();
+}
+
 void WindowScope::on_qcpMousePress(QMouseEvent*)
 {
     m_ui->pushButton_reset->hide();
@@ -2615,18 +2997,10 @@ void WindowScope::on_pushButton_average_off_clicked()
     m_ui->pushButton_average_on->show();
     m_ui->pushButton_average_off->hide();
 
-    for (int i = 0 ; i < MAX_SCOPE_AVG ; i++)
-    {
-        if (m_daqSet.ch1_en) m_average_buff_ch1[i].resize(m_daqSet.mem);
-        if (m_daqSet.ch2_en) m_average_buff_ch2[i].resize(m_daqSet.mem);
-        if (m_daqSet.ch3_en) m_average_buff_ch3[i].resize(m_daqSet.mem);
-        if (m_daqSet.ch4_en) m_average_buff_ch4[i].resize(m_daqSet.mem);
-    }
-
-    m_average_cnt = 0;
-    m_average_it = 0;
     m_average_num = m_ui->spinBox_average->value();
 
+    m_average_gen++; // worker restarts averaging with next frame
+
     m_ui->spinBox_average->setEnabled(false);
     m_ui->spinBox_average->setStyleSheet(CSS_SPINBOX);
 
@@ -2640,13 +3014,10 @@ void WindowScope::on_pushButton_average_on_clicked()
     m_ui->pushButton_average_off->show();
     m_ui->pushButton_average_on->hide();
 
-    for (int i = 0 ; i < MAX_SCOPE_AVG ; i++)
-    {
-        m_average_buff_ch1[i].clear();
-        m_average_buff_ch2[i].clear();
-        m_average_buff_ch3[i].clear();
-        m_average_buff_ch4[i].clear();
-    }
+    m_ui->customPlot->graph(GRAPH_CH1_MIN)->data()->clear();
+    m_ui->customPlot->graph(GRAPH_CH2_MIN)->data()->clear();
+    m_ui->customPlot->graph(GRAPH_CH3_MIN)->data()->clear();
+    m_ui->customPlot->graph(GRAPH_CH4_MIN)->data()->clear();
 
     m_ui->spinBox_average->setEnabled(true);
     m_ui->spinBox_average->setStyleSheet(CSS_SPINBOX_NODIS);
@@ -2797,19 +3168,6 @@ void WindowScope::on_pushButton_fft_on_clicked()
 
     m_ui->customPlot->replot();
 
-    if (m_fft_in != NULL)
-        fftw_free(m_fft_in);
-    if (m_fft_out != NULL)
-        fftw_free(m_fft_out);
-    if (m_fft_plan != NULL)
-        fftw_destroy_plan(m_fft_plan);
-
-    fftw_cleanup();
-
-    m_fft_in = NULL;
-    m_fft_out = NULL;
-    m_fft_plan = NULL;
-
     //m_ui->horizontalSlider_cursorH->setStyleSheet(CSS_CURSOR_H);
 }
 
@@ -2826,6 +3184,7 @@ void WindowScope::closeEvent(QCloseEvent*)
     emit closing(WindowScope::staticMetaObject.className());
 
      m_timer_plot->stop();
+     m_timer_roll->stop();
 }
 
 void WindowScope::showEvent(QShowEvent*)
@@ -2833,6 +3192,7 @@ void WindowScope::showEvent(QShowEvent*)
     m_ignoreValuesChanged = true;
 
     m_seq_num = 0;
+    m_strig_rejected = 0;
 
     enablePanel(false);
 
@@ -2858,6 +3218,33 @@ void WindowScope::showEvent(QShowEvent*)
         //m_ui->label_pins->setText("Vertical (" + m_pin1 + ", " + m_pin2 + ", " + m_pin3 + ", " + m_pin4 + ")");
     }
 
+    m_pack = info->features.contains('K');
+
+    m_dec_en = info->features.contains('D');
+    m_ui->menuDecimation->setEnabled(m_dec_en);
+
+    bool dbuf = info->features.contains('P');
+    m_ui->actionDoubleBuffer->setEnabled(dbuf);
+    if (!dbuf)
+        m_ui->actionDoubleBuffer->setChecked(false);
+    else
+        Core::getInstance()->msgAdd(m_msg_dbuf, false, m_ui->actionDoubleBuffer->isChecked() ? EMBO_SET_TRUE : EMBO_SET_FALSE);
+
+    bool roll = info->features.contains('R');
+    m_ui->actionRoll->setEnabled(roll);
+    on_msg_ok_roll(EMBO_SET_FALSE, "");
+    if (roll) // device may still stream from last time
+        Core::getInstance()->msgAdd(m_msg_roll, false, EMBO_SET_FALSE);
+
+    bool seg = info->features.contains('S');
+    m_ui->actionSegmented->setEnabled(seg);
+    m_ui->actionSegOverlay->setEnabled(seg);
+    on_msg_ok_seg("0", "");
+    if (!seg)
+        m_ui->actionSegmented->setChecked(false);
+    else
+        Core::getInstance()->msgAdd(m_msg_seg, false, QString::number(m_seg_want));
+
     Core::getInstance()->msgAdd(m_msg_set, true, "");
 
     if (m_instrEnabled)
@@ -3101,32 +3488,11 @@ void WindowScope::createX()
                 fft_x += fft_dt;
             }
 
-            m_ui->actionFFTwindow->setText("wind:   Hanning");
+            m_ui->actionFFTwindow->setText("wind:   " + FftEngine::windowName(m_fft_window));
             //m_ui->menuFFTsamples->setText("size:    " + QString::number(m_fft_size));
             m_ui->actionFFTresolution->setText("res:      " + QString::number(fft_dt_real, 10, 2) + " Hz");
 
-            if (m_fft_in != NULL)
-                fftw_free(m_fft_in);
-            if (m_fft_out != NULL)
-                fftw_free(m_fft_out);
-            if (m_fft_plan != NULL)
-                fftw_destroy_plan(m_fft_plan);
-
-            fftw_cleanup();
-
-            m_fft_in = NULL;
-            m_fft_out = NULL;
-            m_fft_plan = NULL;
-
-            m_fft_in  = fftw_alloc_real(m_fft_size);
-            m_fft_out = fftw_alloc_real(m_fft_size);
-            m_fft_plan = fftw_plan_r2r_1d(m_fft_size, m_fft_in, m_fft_out, FFTW_R2HC, FFTW_ESTIMATE);
-
-            if (m_fft_in == NULL || m_fft_out == NULL || m_fft_plan == NULL)
-            {
-                msgBox(this, "FFTW alloc memory failed!", CRITICAL);
-                on_pushButton_fft_on_clicked();
-            }
+            // plan and buffers are owned by ScopeProc in worker thread
         }
 
         /* ETS */
@@ -3175,6 +3541,8 @@ void WindowScope::updatePanel()
 
     m_ignoreValuesChanged = true;
 
+    m_proc->flush();
+
     on_pushButton_average_on_clicked();
 
     createX();
@@ -3304,10 +3672,7 @@ void WindowScope::updatePanel()
 
     /* MAX FS AND MEM */
 
-    int max_mem = info->mem;
-    if (m_daqSet.bits == B12)
-        max_mem /= 2;
-    max_mem /= (m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en);
+    int max_mem = getMaxMem();
 
     m_ui->spinBox_mem->setRange(2,max_mem);
     m_ui->dial_mem->setRange(2,max_mem);
@@ -3402,6 +3767,399 @@ void WindowScope::enablePanel(bool en)
     m_ui->groupBox_utils->setEnabled(en);
 }
 
+void WindowScope::applyResult()
+{
+    ScopeResult& res = m_procRes;
+
+    if (res.mem != m_daqSet.mem || m_t.size() != res.mem) // settings changed meanwhile
+        return;
+
+    if (res.ch_num == 0 || res.found / res.ch_num != m_daqSet.mem) // wrong data size
+    {
+        m_err_cntr++;
+        if (m_err_cntr > READ_ERROR_CNT)
+        {
+            on_msg_err(QString(INVALID_MSG) + " (data size wrong -> " + QString::number(res.found) + "!=" +
+                       QString::number((m_daqSet.mem * res.ch_num)) + ")", CRITICAL, true);
+            m_err_cntr = 0;
+        }
+
+        return;
+    }
+
+    if (res.strig_reject) // software trigger condition not found, last frame stays
+    {
+        m_strig_rejected++;
+        m_status_proc->setText(QString::asprintf("Proc: software trigger rejected %d | drop %d", m_strig_rejected, res.dropped));
+        return;
+    }
+
+    const QVector<double>& y1 = res.y[0];
+    const QVector<double>& y2 = res.y[1];
+    const QVector<double>& y3 = res.y[2];
+    const QVector<double>& y4 = res.y[3];
+
+    /************* plot data *************/
+
+    if (m_math_xy_12 || m_math_xy_34)
+    {
+        for (int i = 0; i <= GRAPH_CH4_MIN; i++)
+            m_lod[i].clear();
+
+        if (m_math_xy_12)
+        {
+            if (m_daqSet.ch1_en && m_daqSet.ch2_en)
+                m_ui->customPlot->graph(GRAPH_CH1)->setData(y1, y2);
+        }
+
+        if (m_math_xy_34)
+        {
+            if (m_daqSet.ch3_en && m_daqSet.ch4_en)
+                m_ui->customPlot->graph(GRAPH_CH3)->setData(y3, y4);
+        }
+    }
+    else
+    {
+        if (m_daqSet.ch1_en)
+            m_lod[GRAPH_CH1].setData(m_t, y1);
+
+        if (!m_math_2minus1 && m_daqSet.ch2_en)
+            m_lod[GRAPH_CH2].setData(m_t, y2);
+
+        if (m_daqSet.ch3_en)
+            m_lod[GRAPH_CH3].setData(m_t, y3);
+
+        if (!m_math_4minus3 && m_daqSet.ch4_en)
+            m_lod[GRAPH_CH4].setData(m_t, y4);
+
+        if (m_average && m_average_mode == AVG_ENVELOPE && res.envelope)
+        {
+            if (m_daqSet.ch1_en)
+                m_lod[GRAPH_CH1_MIN].setData(m_t, res.ymin[0]);
+
+            if (!m_math_2minus1 && m_daqSet.ch2_en)
+                m_lod[GRAPH_CH2_MIN].setData(m_t, res.ymin[1]);
+
+            if (m_daqSet.ch3_en)
+                m_lod[GRAPH_CH3_MIN].setData(m_t, res.ymin[2]);
+
+            if (!m_math_4minus3 && m_daqSet.ch4_en)
+                m_lod[GRAPH_CH4_MIN].setData(m_t, res.ymin[3]);
+        }
+
+        lodRender();
+    }
+
+    segPlot(res);
+
+    /************* meas *************/
+
+    if (m_meas_en && res.meas_valid)
+    {
+        QString meas_vpp_s;
+        QString meas_rms_s;
+        QString meas_avg_s;
+        QString meas_min_s;
+        QString meas_max_s;
+
+        double vpp = res.meas_vpp;
+        double rms = res.meas_rms;
+        double avg = res.meas_avg;
+        double min = res.meas_min;
+        double max = res.meas_max;
+
+        meas_vpp_s = meas_vpp_s.asprintf(vpp >= 100 || vpp <= -10  ? "%.2f" : (vpp >= 10 || vpp < 0 ? "%.3f" : "%.4f"), vpp);
+        meas_rms_s = meas_rms_s.asprintf(rms >= 100 || rms <= -10  ? "%.2f" : (rms >= 10 || rms < 0 ? "%.3f" : "%.4f"), rms);
+        meas_avg_s = meas_avg_s.asprintf(avg >= 100 || avg <= -10  ? "%.2f" : (avg >= 10 || avg < 0 ? "%.3f" : "%.4f"), avg);
+        meas_min_s = meas_min_s.asprintf(min >= 100 || min <= -10  ? "%.2f" : (min >= 10 || min < 0 ? "%.3f" : "%.4f"), min);
+        meas_max_s = meas_max_s.asprintf(max >= 100 || max <= -10  ? "%.2f" : (max >= 10 || max < 0 ? "%.3f" : "%.4f"), max);
+
+        m_ui->textBrowser_measVpp->setHtml("<p align=\"right\">" + meas_vpp_s + " </p>");
+        m_ui->textBrowser_measRms->setHtml("<p align=\"right\">" + meas_rms_s + " </p>");
+        m_ui->textBrowser_measAvg->setHtml("<p align=\"right\">" + meas_avg_s + " </p>");
+        m_ui->textBrowser_measMin->setHtml("<p align=\"right\">" + meas_min_s + " </p>");
+        m_ui->textBrowser_measMax->setHtml("<p align=\"right\">" + meas_max_s + " </p>");
+    }
+
+    /************* FFT *************/
+
+    if (m_fft && res.fft_err)
+    {
+        msgBox(this, "FFTW alloc memory failed!", CRITICAL);
+        on_pushButton_fft_on_clicked();
+    }
+    else if (m_fft && res.fft_valid && res.fft_db.size() == m_fft_x.size())
+    {
+        m_ui->customPlot->graph(GRAPH_FFT)->setData(m_fft_x, res.fft_db);
+
+        if (m_rescale_fft_needed)
+        {
+            m_axis_fft->axis(QCPAxis::atLeft)->setRange(FFT_DB_MIN, FFT_DB_MAX);
+            //m_axis_fft->axis(QCPAxis::atLeft)->rescale();
+            m_axis_fft->axis(QCPAxis::atBottom)->setRange(0, m_daqSet.fs_real_n / 2);
+            m_rescale_fft_needed = false;
+        }
+    }
+
+    /************* seq num *************/
+
+    m_seq_num++;
+    m_status_seq->setText("Sequence Number: " + QString::number(m_seq_num));
+
+    /************* proc timing *************/
+
+    QString proc;
+    proc = proc.asprintf("Proc: dec %.2f | math %.2f | avg %.2f | meas %.2f | fft %.2f ms | drop %d",
+                         res.stage_ms[STAGE_DECODE], res.stage_ms[STAGE_MATH], res.stage_ms[STAGE_AVG],
+                         res.stage_ms[STAGE_MEAS], res.stage_ms[STAGE_FFT], res.dropped);
+
+    if (res.trig_aligned)
+        proc += QString::asprintf(" | trig %+.2f smpl", res.trig_shift);
+
+    if (m_strig.mode != STRIG_OFF && !m_roll)
+        proc += QString::asprintf(" | rejected %d", m_strig_rejected);
+
+    m_status_proc->setText(proc);
+}
+
+void WindowScope::lodRender()
+{
+    int pixels = m_axis_scope->width();
+
+    for (int i = 0; i <= GRAPH_CH4_MIN; i++)
+    {
+        if (i == GRAPH_FFT || m_lod[i].isEmpty())
+            continue;
+
+        auto graph = m_ui->customPlot->graph(i);
+        bool exact = m_lod[i].render(graph, pixels);
+
+        graph->setSpline(m_spline && exact); // spline over min/max pairs makes no sense
+    }
+}
+
+void WindowScope::setFftWindow(FftWindow window)
+{
+    if (window < FFT_WIN_HANNING || window > FFT_WIN_FLATTOP)
+        window = FFT_WIN_HANNING;
+
+    m_fft_window = window;
+
+    Settings::setValue(CFG_SCOPE_FFT_WIN, (int)window);
+
+    m_ui->actionFFTWinHanning->setChecked(window == FFT_WIN_HANNING);
+    m_ui->actionFFTWinBlackmanHarris->setChecked(window == FFT_WIN_BLACKMAN_HARRIS);
+    m_ui->actionFFTWinFlattop->setChecked(window == FFT_WIN_FLATTOP);
+
+    m_ui->actionFFTwindow->setText("wind:   " + FftEngine::windowName(window));
+}
+
+void WindowScope::setFftWelch(int welch)
+{
+    if (welch != 1 && welch != 4 && welch != 8 && welch != 16)
+        welch = 1;
+
+    m_fft_welch = welch;
+
+    Settings::setValue(CFG_SCOPE_FFT_WELCH, welch);
+
+    m_ui->actionFFTWelch_1->setChecked(welch == 1);
+    m_ui->actionFFTWelch_4->setChecked(welch == 4);
+    m_ui->actionFFTWelch_8->setChecked(welch == 8);
+    m_ui->actionFFTWelch_16->setChecked(welch == 16);
+}
+
+void WindowScope::setAvgMode(AvgMode mode)
+{
+    if (mode < AVG_MEAN || mode > AVG_ENVELOPE)
+        mode = AVG_MEAN;
+
+    m_average_mode = mode;
+
+    Settings::setValue(CFG_SCOPE_AVG_MODE, (int)mode);
+
+    m_ui->actionAvgMean->setChecked(mode == AVG_MEAN);
+    m_ui->actionAvgExp->setChecked(mode == AVG_EXP);
+    m_ui->actionAvgPeak->setChecked(mode == AVG_PEAK);
+    m_ui->actionAvgEnvelope->setChecked(mode == AVG_ENVELOPE);
+
+    m_ui->customPlot->graph(GRAPH_CH1_MIN)->data()->clear();
+    m_ui->customPlot->graph(GRAPH_CH2_MIN)->data()->clear();
+    m_ui->customPlot->graph(GRAPH_CH3_MIN)->data()->clear();
+    m_ui->customPlot->graph(GRAPH_CH4_MIN)->data()->clear();
+
+    if (m_average) // restart running average in new mode
+        on_pushButton_average_off_clicked();
+}
+
+void WindowScope::setSoftTrigMode(SoftTrigMode mode)
+{
+    if (mode < STRIG_OFF || mode > STRIG_SLEW_LT)
+        mode = STRIG_OFF;
+
+    m_strig.mode = mode;
+    m_strig_rejected = 0;
+
+    Settings::setValue(CFG_SCOPE_STRIG, (int)mode);
+
+    m_ui->actionStrigOff->setChecked(mode == STRIG_OFF);
+    m_ui->actionStrigPulseGt->setChecked(mode == STRIG_PULSE_GT);
+    m_ui->actionStrigPulseLt->setChecked(mode == STRIG_PULSE_LT);
+    m_ui->actionStrigRunt->setChecked(mode == STRIG_RUNT);
+    m_ui->actionStrigWindow->setChecked(mode == STRIG_WINDOW);
+    m_ui->actionStrigSlewGt->setChecked(mode == STRIG_SLEW_GT);
+    m_ui->actionStrigSlewLt->setChecked(mode == STRIG_SLEW_LT);
+
+    if (m_average) // history of other frames
+        on_pushButton_average_off_clicked();
+}
+
+void WindowScope::setDecMode(ScopeDec mode)
+{
+    if (mode < DEC_OFF || mode > DEC_MEAN)
+        mode = DEC_PEAK;
+
+    m_dec_mode = mode;
+
+    Settings::setValue(CFG_SCOPE_DEC, (int)mode);
+
+    m_ui->actionDecOff->setChecked(mode == DEC_OFF);
+    m_ui->actionDecSub->setChecked(mode == DEC_SUB);
+    m_ui->actionDecPeak->setChecked(mode == DEC_PEAK);
+    m_ui->actionDecMean->setChecked(mode == DEC_MEAN);
+}
+
+void WindowScope::rollReset()
+{
+    m_roll_pending = false;
+    m_roll_polls = 0;
+    m_roll_seq = 0;
+    m_roll_gaps = 0;
+    m_roll_overruns = 0;
+
+    for (int i = 0; i < 4; i++)
+        m_roll_hist[i].clear();
+}
+
+/* gaps = blocks PC did not get, overruns = blocks device had to drop (subset of gaps, polled less often) */
+void WindowScope::rollStatus()
+{
+    if (!m_roll)
+        return;
+
+    m_status_ets->setText("Roll: gaps " + QString::number(m_roll_gaps) + " | overruns " + QString::number(m_roll_overruns));
+}
+
+void WindowScope::segReset()
+{
+    m_seg_idx = 0;
+    m_seg_data.clear();
+    m_seg_first.clear();
+    m_seg_time.clear();
+
+    m_seg_spin->blockSignals(true);
+    m_seg_spin->setRange(1, 1);
+    m_seg_spin->setSuffix(" / 0");
+    m_seg_spin->blockSignals(false);
+
+    for (int i = 0; i < 4; i++)
+        m_seg_curves[i]->data()->clear();
+}
+
+/* shown segment goes through pipeline as normal frame, rest of them as its overlay */
+void WindowScope::segShow()
+{
+    if (m_seg_data.isEmpty() || m_seg_idx < 0 || m_seg_idx >= m_seg_data.size())
+        return;
+
+    submitFrame(m_seg_data[m_seg_idx], m_seg_first[m_seg_idx], Core::getInstance()->getDevInfo()->daq_reserve, 1, false);
+    segStatus();
+}
+
+/* trigger times relative to first segment, gap = shortest time between two following triggers */
+void WindowScope::segStatus()
+{
+    if (m_seg_time.isEmpty())
+        return;
+
+    quint32 gap = 0;
+    for (int i = 1; i < m_seg_time.size(); i++)
+    {
+        quint32 dt = m_seg_time[i] - m_seg_time[i - 1]; // wraps
+        if (i == 1 || dt < gap)
+            gap = dt;
+    }
+
+    double t = (quint32)(m_seg_time[m_seg_idx] - m_seg_time[0]) / 1000.0;
+
+    m_status_line3->setVisible(true);
+    m_status_ets->setText(QString::asprintf("Segments: +%.3f ms | min gap %.3f ms", t, gap / 1000.0));
+}
+
+/* overlay curves follow channels drawn as raw traces */
+void WindowScope::segPlot(const ScopeResult& res)
+{
+    const bool show[4] = { !m_math_2minus1, !m_math_2minus1, !m_math_4minus3, !m_math_4minus3 }; // math traces have no overlay
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    for (int i = 0; i < 4; i++)
+    {
+        const QVector<QVector<double>>& segs = res.overlay[i];
+
+        if (segs.isEmpty() || !show[i] || m_math_xy_12 || m_math_xy_34)
+        {
+            m_seg_curves[i]->data()->clear();
+            continue;
+        }
+
+        QVector<double> t, y;
+        t.reserve(segs.size() * (m_t.size() + 1));
+        y.reserve(segs.size() * (m_t.size() + 1));
+
+        for (const QVector<double>& seg : segs)
+        {
+            if (seg.size() != m_t.size())
+                continue;
+
+            t.append(m_t);
+            y.append(seg);
+            t.append(nan); // gap to next segment
+            y.append(nan);
+        }
+
+        m_seg_curves[i]->setData(t, y);
+    }
+}
+
+/* SCOP:READ? params, device decimates when more samples are in view than plot has pixels,
+ * full resolution comes back as user zooms in */
+QString WindowScope::readParams()
+{
+    QStringList params;
+
+    m_read_dec = 1;
+    m_read_dec_mode = m_dec_mode;
+
+    if (m_dec_en && m_dec_mode != DEC_OFF && !m_fft && !m_ets && !m_math_xy_12 && !m_math_xy_34 && m_t.size() > 1)
+    {
+        double view = m_axis_scope->axis(QCPAxis::atBottom)->range().size() / m_t[m_t.size()-1];
+        double samples = m_daqSet.mem * qBound(0.0, view, 1.0);
+        int factor = (int)(samples / qMax(m_axis_scope->width(), 1));
+
+        if (factor >= 2)
+        {
+            m_read_dec = factor;
+            params << EMBO_SCOP_DEC << QString::number(factor)
+                   << (m_dec_mode == DEC_SUB ? "SUB" : (m_dec_mode == DEC_PEAK ? "PEAK" : "MEAN"));
+        }
+    }
+
+    if (m_pack)
+        params << EMBO_SCOP_PACK;
+
+    return params.join(",");
+}
+
 void WindowScope::fix2ADCproblem(bool add)
 {
     if (Core::getInstance()->getDevInfo()->adc_num == 2)
@@ -3452,6 +4210,21 @@ void WindowScope::fix2ADCproblem(bool add)
     }
 }
 
+int WindowScope::getMaxMem()
+{
+    auto info = Core::getInstance()->getDevInfo();
+
+    int max_mem = info->mem;
+    if (m_daqSet.bits == B12)
+        max_mem /= 2;
+    max_mem /= (m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en);
+
+    if (m_ui->actionDoubleBuffer->isChecked()) // both halves incl. reserve must fit
+        max_mem = max_mem / 2 - info->daq_reserve;
+
+    return max_mem;
+}
+
 void WindowScope::sendSet()
 {
     auto info = Core::getInstance()->getDevInfo();
@@ -3524,14 +4297,14 @@ void WindowScope::sendSet()
 
     /* fs, mem, trig ch -> trimm */
 
-    int max_mem = info->mem;
-    if (m_daqSet.bits == B12)
-        max_mem /= 2;
-    max_mem /= (m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en);
+    int max_mem = getMaxMem();
 
     m_ui->spinBox_mem->setRange(2,max_mem);
     m_ui->dial_mem->setRange(2,max_mem);
 
+    if (m_daqSet.mem > max_mem)
+        m_daqSet.mem = max_mem;
+
     int max_fs = info->adc_fs_12b; // TODO
 
     if (info->adc_num == 1)
@@ -11,20 +11,29 @@
 #include "qcpcursors.h"
 #include "containers.h"
 #include "recorder.h"
-
-#include "lib/fftw3.h"
+#include "waveavg.h"
+#include "scopeproc.h"
+#include "plotlod.h"
 
 #include <QMainWindow>
 #include <QLabel>
+#include <QSpinBox>
+#include <QThread>
 
 
 #define TIMER_SCOPE_PLOT           33.0    // plot refresh rate = 30 FPS
+#define TIMER_SCOPE_ROLL           20.0    // roll mode drain period, same as device DMA circle
+#define ROLL_STAT_POLLS            25      // SCOP:ROLL? (device overruns) every N drains
 
 #define GRAPH_CH1       0
 #define GRAPH_CH2       1
 #define GRAPH_CH3       2
 #define GRAPH_CH4       3
 #define GRAPH_FFT       4
+#define GRAPH_CH1_MIN   5   // envelope lower traces
+#define GRAPH_CH2_MIN   6
+#define GRAPH_CH3_MIN   7
+#define GRAPH_CH4_MIN   8
 
 #define CURSOR_DEFAULT_H_MIN    400
 #define CURSOR_DEFAULT_H_MAX    600
@@ -66,17 +75,30 @@ private slots:
                     DaqTrigEdge trig_edge, DaqTrigMode trig_mode, int trig_pre,
                     double maxZ, double smpl_time, double fs_real_n, const QString fs_real);
     void on_msg_read(const QByteArray data);
+    void on_msg_rollRead(const QByteArray data);
+    void on_msg_roll(bool active, quint32 seq, quint32 overruns);
+    void on_msg_segRead(const QByteArray data);
+    void on_msg_seg(bool active, int num, int cnt);
 
     /* ok-err msg */
     void on_msg_err(const QString text, MsgBoxType type, bool needClose);
     void on_msg_ok_set(double maxZ, double smpl_time, double fs_real_n, const QString fs_real);
     void on_msg_ok_forceTrig(const QString, const QString);
+    void on_msg_ok_roll(const QString val1, const QString);
+    void on_msg_ok_seg(const QString val1, const QString);
 
      /* async ready msg */
     void on_msg_daqReady(Ready ready, int firstPos);
 
     /* timer slots */
     void on_timer_plot();
+    void on_timer_roll();
+
+    /* post-processing */
+    void on_proc_fftWisdom(const QString wisdom);
+
+    /* segment browser */
+    void on_segSpin_valueChanged(int value);
 
     /* GUI slots - Menu - Help */
     void on_actionAbout_triggered();
@@ -86,6 +108,19 @@ private slots:
     void on_actionViewLines_triggered(bool checked);
     void on_actionInterpLinear_triggered(bool checked);
     void on_actionInterpSinc_triggered(bool checked);
+    void on_actionAvgMean_triggered(bool checked);
+    void on_actionAvgExp_triggered(bool checked);
+    void on_actionAvgPeak_triggered(bool checked);
+    void on_actionAvgEnvelope_triggered(bool checked);
+    void on_actionTrigAlign_triggered(bool checked);
+    void on_actionDoubleBuffer_triggered(bool checked);
+    void on_actionDecOff_triggered(bool checked);
+    void on_actionDecSub_triggered(bool checked);
+    void on_actionDecPeak_triggered(bool checked);
+    void on_actionDecMean_triggered(bool checked);
+    void on_actionRoll_triggered(bool checked);
+    void on_actionSegmented_triggered(bool checked);
+    void on_actionSegOverlay_triggered(bool checked);
 
     /* GUI slots - Menu - Export */
     void on_actionExportSave_triggered();
@@ -122,12 +157,29 @@ private slots:
     void on_actionFFT_131072_triggered(bool checked);
     void on_actionFFT_524288_triggered(bool checked);
     void on_actionFFT_1048576_triggered(bool checked);
+    void on_actionFFTWinHanning_triggered(bool checked);
+    void on_actionFFTWinBlackmanHarris_triggered(bool checked);
+    void on_actionFFTWinFlattop_triggered(bool checked);
+    void on_actionFFTWelch_1_triggered(bool checked);
+    void on_actionFFTWelch_4_triggered(bool checked);
+    void on_actionFFTWelch_8_triggered(bool checked);
+    void on_actionFFTWelch_16_triggered(bool checked);
 
     /* GUI slots - Menu - ETS */
     void on_actionETS_Custom_triggered(bool checked);
     void on_actionETS_PWM_Generator_triggered(bool checked);
     void on_actionETS_Enabled_triggered(bool checked);
 
+    /* GUI slots - Menu - Software Trigger */
+    void on_actionStrigOff_triggered(bool checked);
+    void on_actionStrigPulseGt_triggered(bool checked);
+    void on_actionStrigPulseLt_triggered(bool checked);
+    void on_actionStrigRunt_triggered(bool checked);
+    void on_actionStrigWindow_triggered(bool checked);
+    void on_actionStrigSlewGt_triggered(bool checked);
+    void on_actionStrigSlewLt_triggered(bool checked);
+    void on_actionStrigSettings_triggered();
+
     /* GUI slots - Cursors */
     void on_cursorH_valuesChanged(int min, int max);
     void on_cursorV_valuesChanged(int min, int max);
@@ -139,6 +191,7 @@ private slots:
     /* GUI slots - QCP */
     void on_qcpMouseWheel(QWheelEvent*);
     void on_qcpMousePress(QMouseEvent*);
+    void on_qcpRangeChanged(const QCPRange&);
 
     /* GUI slots - right pannel - main */
     void on_radioButton_zoomH_clicked(bool checked);
@@ -226,14 +279,31 @@ private:
     void enablePanel(bool en);
 
     void fix2ADCproblem(bool add);
+    void applyResult();
+    void submitFrame(const QByteArray& data, int firstPos, int reserve, int dec_factor, bool packed);
+    void rollReset();
+    void rollStatus();
+    void segReset();
+    void segShow();
+    void segStatus();
+    void segPlot(const ScopeResult& res);
+    void lodRender();
+    void setFftWindow(FftWindow window);
+    void setFftWelch(int welch);
+    void setAvgMode(AvgMode mode);
+    void setDecMode(ScopeDec mode);
+    void setSoftTrigMode(SoftTrigMode mode);
+    QString readParams();
 
     void sendSet();
+    int getMaxMem();
 
     /* main window */
     Ui::WindowScope* m_ui;
 
     /* timers */
     QTimer* m_timer_plot;
+    QTimer* m_timer_roll;
     QTimer* m_timer_trigSliders;
 
     /* async ready data */
@@ -257,14 +327,23 @@ private:
     QFrame* m_status_line2;
     QLabel* m_status_ets;
     QFrame* m_status_line3;
+    QLabel* m_status_proc;
+    QSpinBox* m_seg_spin;
+
+    /* post-processing pipeline */
+    QThread* m_procThread;
+    ScopeProc* m_proc;
+    ScopeResult m_procRes;
+
+    /* level of detail, full traces kept here, graphs hold only visible part */
+    PlotLod m_lod[GRAPH_CH4_MIN + 1];
 
     /* FFT */
     int m_fft_size = 131072;
     int m_fft_ch = 1;
-    fftw_plan m_fft_plan = NULL;
+    FftWindow m_fft_window = FFT_WIN_HANNING;
+    int m_fft_welch = 1;
     QVector<double> m_fft_x;
-    double* m_fft_in = NULL;
-    double* m_fft_out = NULL;
     bool m_fft_split = true;
     bool m_rescale_fft_needed = false;
 
@@ -316,6 +395,32 @@ private:
     int m_last_mem = 0;
     int m_err_cntr = 0;
     bool m_refresh = true;
+    bool m_pack = false;            // SCOP:READ? PACK supported
+
+    /* device decimation */
+    bool m_dec_en = false;          // SCOP:READ? DEC supported
+    ScopeDec m_dec_mode = DEC_PEAK;
+    int m_read_dec = 1;             // factor of read in flight
+    ScopeDec m_read_dec_mode = DEC_OFF;
+
+    /* roll mode */
+    bool m_roll = false;            // device streams DMA halves, no trigger
+    bool m_roll_pending = false;    // SCOP:ROLL:READ? in flight
+    int m_roll_polls = 0;
+    quint32 m_roll_seq = 0;         // last block received, 0 = none yet
+    quint32 m_roll_gaps = 0;        // blocks missing in sequence
+    quint32 m_roll_overruns = 0;    // blocks dropped by device
+    QByteArray m_roll_hist[4];      // newest samples of each DAQ buffer, oldest first
+
+    /* segmented memory */
+    int m_seg_want = 0;             // segments asked from device, 0 off
+    int m_seg_num = 0;              // segments which fit device memory, 0 = not active
+    int m_seg_idx = 0;              // segment shown
+    bool m_seg_overlay = true;      // other segments drawn behind shown one
+    QVector<QByteArray> m_seg_data; // last SCOP:SEG:READ? split to frames, same layout as SCOP:READ?
+    QVector<int> m_seg_first;
+    QVector<quint32> m_seg_time;    // device trigger time, microseconds, wraps
+    QCPCurve* m_seg_curves[4];
 
     /* last widget enabled values */
     bool m_last_trigEnabled = true;
@@ -329,12 +434,13 @@ private:
     /* average */
     bool m_average = false;
     int m_average_num = AVERAGE_DEFAULT;
-    int m_average_cnt = 0;
-    int m_average_it = 0;
-    QVector<QVector<double>> m_average_buff_ch1;
-    QVector<QVector<double>> m_average_buff_ch2;
-    QVector<QVector<double>> m_average_buff_ch3;
-    QVector<QVector<double>> m_average_buff_ch4;
+    AvgMode m_average_mode = AVG_MEAN;
+    bool m_trig_align = true;       // sub-sample trigger alignment on PC
+    int m_average_gen = 0;
+
+    /* software trigger */
+    SoftTrigCfg m_strig;
+    int m_strig_rejected = 0;
 
     /* ETS */
     bool m_ets = false;
@@ -371,6 +477,11 @@ private:
     Msg_SCOP_Set* m_msg_set;
     Msg_SCOP_Read* m_msg_read;
     Msg_SCOP_ForceTrig* m_msg_forceTrig;
+    Msg_SCOP_DBuf* m_msg_dbuf;
+    Msg_SCOP_Roll* m_msg_roll;
+    Msg_SCOP_RollRead* m_msg_rollRead;
+    Msg_SCOP_Seg* m_msg_seg;
+    Msg_SCOP_SegRead* m_msg_segRead;
 };
 
 #endif // WINDOW_SCOPE_H
@@ -17,6 +17,7 @@
 #include <QLabel>
 #include <QInputDialog>
 #include <QMessageBox>
+#include <QFileDialog>
 
 #include <algorithm>
 
@@ -42,6 +43,9 @@ WindowVm::WindowVm(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowVm
     m_msg_read3 = new Msg_VM_Read(this);
     m_msg_read4 = new Msg_VM_Read(this);
     m_msg_read5 = new Msg_VM_Read(this);
+    m_msg_readBin = new Msg_VM_Read(this, true);
+    m_msg_log = new Msg_VM_Log(this);
+    m_msg_logRead = new Msg_VM_LogRead(this);
 
     m_msg_read1->setParams("1");
     m_msg_read2->setParams("1");
@@ -64,6 +68,16 @@ WindowVm::WindowVm(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowVm
     connect(m_msg_read5, &Msg_VM_Read::err, this, &WindowVm::on_msg_err, Qt::QueuedConnection);
     connect(m_msg_read5, &Msg_VM_Read::result, this, &WindowVm::on_msg_read, Qt::QueuedConnection);
 
+    connect(m_msg_readBin, &Msg_VM_Read::err, this, &WindowVm::on_msg_err, Qt::QueuedConnection);
+    connect(m_msg_readBin, &Msg_VM_Read::resultBin, this, &WindowVm::on_msg_readBin, Qt::QueuedConnection);
+
+    connect(m_msg_log, &Msg_VM_Log::err, this, &WindowVm::on_msg_err, Qt::QueuedConnection);
+    connect(m_msg_log, &Msg_VM_Log::ok, this, &WindowVm::on_msg_ok_log, Qt::QueuedConnection);
+    connect(m_msg_log, &Msg_VM_Log::result, this, &WindowVm::on_msg_log, Qt::QueuedConnection);
+
+    connect(m_msg_logRead, &Msg_VM_LogRead::err, this, &WindowVm::on_msg_err, Qt::QueuedConnection);
+    connect(m_msg_logRead, &Msg_VM_LogRead::result, this, &WindowVm::on_msg_logRead, Qt::QueuedConnection);
+
     connect(m_timer_plot, &QTimer::timeout, this, &WindowVm::on_timer_plot);
     connect(m_timer_digits, &QTimer::timeout, this, &WindowVm::on_timer_digits);
 
@@ -132,12 +146,14 @@ void WindowVm::statusBarLoad()
 {
     m_status_vcc = new QLabel(" ", this);
     m_status_rec = new QLabel(" ", this);
+    m_status_log = new QLabel(" ", this);
     status_zoom = new QLabel("<span>Zoom with Scroll Wheel, Move with Mouse Drag&nbsp;&nbsp;<span>", this);
     QWidget* widget = new QWidget(this);
 
     QFont font1("Roboto", 11, QFont::Normal);
     m_status_vcc->setFont(font1);
     m_status_rec->setFont(font1);
+    m_status_log->setFont(font1);
     status_zoom->setFont(font1);
 
     QLabel* status_img = new QLabel(this);
@@ -155,8 +171,17 @@ void WindowVm::statusBarLoad()
     m_status_line1->setFixedHeight(18);
     m_status_line1->setVisible(false);
 
+    m_status_line2 = new QFrame(this);
+    m_status_line2->setFrameShape(QFrame::VLine);
+    m_status_line2->setFrameShadow(QFrame::Plain);
+    m_status_line2->setStyleSheet("color:gray;");
+    m_status_line2->setFixedHeight(18);
+    m_status_line2->setVisible(false);
+
     QLabel* status_spacer2 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
     QLabel* status_spacer3 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
+    QLabel* status_spacer4 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
+    QLabel* status_spacer5 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
 
     QSpacerItem* status_spacer0 = new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Preferred);
 
@@ -164,11 +189,15 @@ void WindowVm::statusBarLoad()
     layout->addWidget(status_img,     0,0,1,1,Qt::AlignVCenter);
     layout->addWidget(m_status_vcc,   0,1,1,1,Qt::AlignVCenter);
     layout->addWidget(status_spacer2, 0,2,1,1,Qt::AlignVCenter);
-    layout->addWidget(m_status_line1, 0,3,1,1,Qt::AlignVCenter);
-    layout->addWidget(status_spacer3, 0,4,1,1,Qt::AlignVCenter);
-    layout->addWidget(m_status_rec,   0,5,1,1,Qt::AlignVCenter | Qt::AlignLeft);
-    layout->addItem(status_spacer0,   0,6,1,1,Qt::AlignVCenter);
-    layout->addWidget(status_zoom,    0,7,1,1,Qt::AlignVCenter);
+    layout->addWidget(m_status_line2, 0,3,1,1,Qt::AlignVCenter);
+    layout->addWidget(status_spacer4, 0,4,1,1,Qt::AlignVCenter);
+    layout->addWidget(m_status_log,   0,5,1,1,Qt::AlignVCenter);
+    layout->addWidget(status_spacer5, 0,6,1,1,Qt::AlignVCenter);
+    layout->addWidget(m_status_line1, 0,7,1,1,Qt::AlignVCenter);
+    layout->addWidget(status_spacer3, 0,8,1,1,Qt::AlignVCenter);
+    layout->addWidget(m_status_rec,   0,9,1,1,Qt::AlignVCenter | Qt::AlignLeft);
+    layout->addItem(status_spacer0,   0,10,1,1,Qt::AlignVCenter);
+    layout->addWidget(status_zoom,    0,11,1,1,Qt::AlignVCenter);
     layout->setMargin(0);
     layout->setSpacing(0);
     m_ui->statusbar->addWidget(widget,1);
@@ -236,6 +265,12 @@ void WindowVm::initQcp()
 
 WindowVm::~WindowVm()
 {
+    if (m_recStream != nullptr)
+    {
+        m_recStream->close();
+        delete m_recStream;
+    }
+
     delete m_ui;
 }
 
@@ -257,96 +292,90 @@ void WindowVm::on_msg_err(const QString text, MsgBoxType type, bool needClose)
 }
 
 void WindowVm::on_msg_read(const QString ch1, const QString ch2, const QString ch3, const QString ch4, const QString vcc) // 100 Hz idealy
+{
+    if (m_instrEnabled && !m_activeMsgs.empty())
+        addSample(ch1.toDouble(), ch2.toDouble(), ch3.toDouble(), ch4.toDouble(), vcc.toDouble());
+}
+
+void WindowVm::on_msg_readBin(const QVector<double> ch1, const QVector<double> ch2, const QVector<double> ch3, const QVector<double> ch4,
+                              const QVector<double> vcc, int lost)
 {
     if (m_instrEnabled && !m_activeMsgs.empty())
     {
-        double t_ms = m_timer_elapsed;
-        m_timer_elapsed += 10;
-        double t = t_ms / 1000.0;
+        if (lost > 0) // keep time axis true, samples were overwritten in device
+            m_timer_elapsed += lost * m_smpl_ms;
 
-        double _ch1 = ch1.toDouble() * m_gain1;
-        double _ch2 = ch2.toDouble() * m_gain2;
-        double _ch3 = ch3.toDouble() * m_gain3;
-        double _ch4 = ch4.toDouble() * m_gain4;
+        for (int i = 0; i < ch1.size(); i++)
+            addSample(ch1[i], ch2[i], ch3[i], ch4[i], vcc[i]);
+    }
+}
 
-        double data_ch1 = _ch1;
-        double data_ch2 = _ch2;
-        double data_ch3 = _ch3;
-        double data_ch4 = _ch4;
-        double data_vcc = vcc.toDouble();
+void WindowVm::on_msg_logRead(const QVector<double> ch1, const QVector<double> ch2, const QVector<double> ch3, const QVector<double> ch4,
+                              const QVector<double> vcc, const QVector<quint32> seq)
+{
+    if (!m_log || !m_instrEnabled || m_activeMsgs.empty())
+        return;
 
-        if (m_math_2minus1)
-            data_ch3 = _ch2 - _ch1;
+    for (int i = 0; i < seq.size(); i++)
+    {
+        if (seq[i] != m_log_seq + 1) // records dropped in device, keep time axis true and mark it in file
+        {
+            quint32 gap = seq[i] - m_log_seq - 1;
+            m_log_gaps += gap;
 
-        if (m_math_4minus3)
-            data_ch4 = _ch4 - _ch3;
+            if (m_recording && m_recStream != nullptr)
+                m_recStream->pushGap(m_timer_elapsed, gap);
+            else if (m_recording)
+                m_rec << m_timer_elapsed << QString("GAP") << (int)gap << ENDL;
 
-        if (m_recording)
-        {
-            m_rec << t_ms;
-            if (m_en1)
-                m_rec << data_ch1;
-            if (m_en2)
-                m_rec << data_ch2;
-            if (m_en3)
-                m_rec << data_ch3;
-            if (m_en4)
-                m_rec << data_ch4;
-            if (m_en1 + m_en2 + m_en3 + m_en4 > 0)
-                m_rec << ENDL;
+            m_timer_elapsed += gap * m_smpl_ms;
         }
+        m_log_seq = seq[i];
 
-        bool data_fresh = false;
+        addSample(ch1[i], ch2[i], ch3[i], ch4[i], vcc[i]);
+    }
 
-        if (m_average > 1) // average enabled
-        {
-            m_avg_it++;
-
-            m_avg1_val += data_ch1;
-            m_avg2_val += data_ch2;
-            m_avg3_val += data_ch3;
-            m_avg4_val += data_ch4;
-            m_avgVcc_val += data_vcc;
-
-            if (m_avg_it == m_average) // average is ready
-            {
-                m_data_ch1 = m_avg1_val / m_average;
-                m_data_ch2 = m_avg2_val / m_average;
-                m_data_ch3 = m_avg3_val / m_average;
-                m_data_ch4 = m_avg4_val / m_average;
-                m_data_vcc = m_avgVcc_val / m_average;
-
-                m_avg1_val = 0;
-                m_avg2_val = 0;
-                m_avg3_val = 0;
-                m_avg4_val = 0;
-                m_avgVcc_val = 0;
-
-                m_avg_it = 0;
-
-                data_fresh = true;
-                m_data_fresh = true;
-            }
-        }
-        else // average disabled
-        {
-            data_fresh = true;
-            m_data_fresh = true;
+    if (++m_log_polls % LOG_STAT_POLLS == 0)
+        Core::getInstance()->msgAdd(m_msg_log, true, "");
 
-            m_data_ch1 = data_ch1;
-            m_data_ch2 = data_ch2;
-            m_data_ch3 = data_ch3;
-            m_data_ch4 = data_ch4;
-            m_data_vcc = data_vcc;
-        }
+    logStatus();
+}
 
-        if (data_fresh)
-        {
-            data_fresh = false;
+void WindowVm::on_msg_log(bool active, int, quint32, quint32 overruns)
+{
+    m_log_overruns = overruns;
 
-            m_smplBuff.push_back(VmSample {t, m_data_ch1, m_data_ch2, m_data_ch3, m_data_ch4});
-        }
-    }
+    if (m_log && !active) // device left logging on its own
+        on_msg_ok_log(EMBO_SET_FALSE, "");
+    else
+        logStatus();
+}
+
+void WindowVm::on_msg_ok_log(const QString val1, const QString val2)
+{
+    auto info = Core::getInstance()->getDevInfo();
+
+    m_log = (val1 == EMBO_SET_TRUE);
+    m_log_rate = val2;
+    m_log_seq = 0;
+    m_log_gaps = 0;
+    m_log_overruns = 0;
+    m_log_polls = 0;
+
+    m_ui->actionLog->setChecked(m_log);
+
+    if (m_log && val2.toDouble() > 0)
+        m_smpl_ms = 1000.0 / val2.toDouble();
+    else
+        m_smpl_ms = info->vm_fs > 0 ? 1000.0 / info->vm_fs : 10;
+
+    on_spinBox_display_valueChanged(m_display_pts);
+
+    m_status_log->setVisible(m_log);
+    m_status_line2->setVisible(m_log);
+
+    activeMsgsLoad();
+    logStatus();
 }
 
 /********************************* timer slots *********************************/
@@ -531,6 +560,37 @@ void WindowVm::on_actionInterpSinc_triggered(bool checked) // exclusive with - a
     rescaleYAxis();
 }
 
+void WindowVm::on_actionLog_triggered(bool checked)
+{
+    m_ui->actionLog->setChecked(m_log); // until device confirms
+
+    if (!checked)
+    {
+        m_activeMsgs.clear(); // no VM:LOG:READ? after logger is off
+        Core::getInstance()->msgAdd(m_msg_log, false, EMBO_SET_FALSE);
+        return;
+    }
+
+    bool ok;
+    int rate = QInputDialog::getInt(this, "Logger", "Record rate [Hz]:", Settings::getValue(CFG_VM_LOG_RATE, 100).toInt(),
+                                    1, 1000000, 1, &ok);
+    if (!ok)
+        return;
+
+    int avg = QInputDialog::getInt(this, "Logger", "Samples averaged per record:", Settings::getValue(CFG_VM_LOG_AVG, 10).toInt(),
+                                   1, 10000, 1, &ok);
+    if (!ok)
+        return;
+
+    Settings::setValue(CFG_VM_LOG_RATE, rate);
+    Settings::setValue(CFG_VM_LOG_AVG, avg);
+
+    m_log_avg = avg;
+    m_activeMsgs.clear(); // VM:READ:BIN? data is meaningless once ADC runs at logger rate
+
+    Core::getInstance()->msgAdd(m_msg_log, false, QString::number(rate) + EMBO_DELIM2 + QString::number(avg));
+}
+
 void WindowVm::on_actionShowPlot_triggered(bool checked)
 {
     Settings::setValue(CFG_VM_SHOW_PLOT, checked);
@@ -578,10 +638,44 @@ void WindowVm::on_actionExportStart_triggered()
         {"Common.Firmware", info->fw},
         {"Common.Vcc",      QString::number(info->ref_mv) + " mV"},
         {"Common.Mode",     "VM"},
-        {"VM.SampleRate",   "100 Hz"},
+        {"VM.SampleRate",   (m_log ? m_log_rate : QString::number(1000.0 / m_smpl_ms)) + " Hz"},
         {"VM.Resolution",   "12 bit"},
+        {"VM.Averaging",    m_log ? QString::number(m_log_avg) + " samples per record" : "OFF"},
+        {"VM.Gaps",         "row t(ms),GAP,<records lost>"},
     };
-    bool ret = m_rec.createFile("VM", header);
+    bool ret;
+
+    if (m_rec_bin) // rows queued to writer thread, converted to text offline
+    {
+        QStringList cols = { "t(ms)" };
+        if (m_en1) cols << "CH1(V)";
+        if (m_en2) cols << "CH2(V)";
+        if (m_en3) cols << "CH3(V)";
+        if (m_en4) cols << "CH4(V)";
+
+        m_recStream = new RecStream();
+        ret = m_recStream->open(m_rec.generateFilePath("VM", REC_EXT), header, cols);
+
+        if (!ret)
+        {
+            delete m_recStream;
+            m_recStream = nullptr;
+        }
+    }
+    else
+    {
+        ret = m_rec.createFile("VM", header);
+
+        if (ret)
+        {
+            m_rec << "t(ms)";
+            if (m_en1) m_rec << "CH1(V)";
+            if (m_en2) m_rec << "CH2(V)";
+            if (m_en3) m_rec << "CH3(V)";
+            if (m_en4) m_rec << "CH4(V)";
+            m_rec << ENDL;
+        }
+    }
 
     if (!ret)
     {
@@ -589,12 +683,6 @@ void WindowVm::on_actionExportStart_triggered()
     }
     else
     {
-        m_rec << "t(ms)";
-        if (m_en1) m_rec << "CH1(V)";
-        if (m_en2) m_rec << "CH2(V)";
-        if (m_en3) m_rec << "CH3(V)";
-        if (m_en4) m_rec << "CH4(V)";
-        m_rec << ENDL;
 
         m_recording = true;
 
@@ -624,6 +712,19 @@ void WindowVm::on_actionExportStop_triggered()
     m_status_rec->setVisible(false);
     m_status_line1->setVisible(false);
 
+    if (m_recStream != nullptr)
+    {
+        QString ret = m_recStream->close();
+        quint64 dropped = m_recStream->getDropped();
+
+        delete m_recStream;
+        m_recStream = nullptr;
+
+        msgBox(this, "File saved at: " + ret + (dropped > 0 ? "\n" + QString::number(dropped) + " rows dropped, disk too slow!" : ""),
+               dropped > 0 ? WARNING : INFO);
+        return;
+    }
+
     QString ret = m_rec.closeFile();
 
     msgBox(this, "File saved at: " + ret, INFO);
@@ -677,6 +778,8 @@ void WindowVm::on_actionExportCSV_triggered(bool checked)
         m_ui->actionExportTXT_Tabs->setChecked(false);
         m_ui->actionExportTXT_Semicolon->setChecked(false);
         m_ui->actionExportMAT->setChecked(false);
+        m_ui->actionExportBIN->setChecked(false);
+        m_rec_bin = false;
     }
 }
 
@@ -689,6 +792,8 @@ void WindowVm::on_actionExportTXT_Tabs_triggered(bool checked)
         m_ui->actionExportCSV->setChecked(false);
         m_ui->actionExportTXT_Semicolon->setChecked(false);
         m_ui->actionExportMAT->setChecked(false);
+        m_ui->actionExportBIN->setChecked(false);
+        m_rec_bin = false;
     }
 }
 
@@ -701,6 +806,8 @@ void WindowVm::on_actionExportTXT_Semicolon_triggered(bool checked)
         m_ui->actionExportCSV->setChecked(false);
         m_ui->actionExportTXT_Tabs->setChecked(false);
         m_ui->actionExportMAT->setChecked(false);
+        m_ui->actionExportBIN->setChecked(false);
+        m_rec_bin = false;
     }
 }
 
@@ -713,9 +820,39 @@ void WindowVm::on_actionExportMAT_triggered(bool checked)
         m_ui->actionExportCSV->setChecked(false);
         m_ui->actionExportTXT_Tabs->setChecked(false);
         m_ui->actionExportTXT_Semicolon->setChecked(false);
+        m_ui->actionExportBIN->setChecked(false);
+        m_rec_bin = false;
     }
 }
 
+void WindowVm::on_actionExportBIN_triggered(bool checked)
+{
+    if (checked)
+    {
+        m_rec_bin = true;
+
+        m_ui->actionExportCSV->setChecked(false);
+        m_ui->actionExportTXT_Tabs->setChecked(false);
+        m_ui->actionExportTXT_Semicolon->setChecked(false);
+        m_ui->actionExportMAT->setChecked(false);
+    }
+}
+
+void WindowVm::on_actionExportConvert_triggered()
+{
+    QString path = QFileDialog::getOpenFileName(this, "EMBO - Convert Recording", m_rec.getDir(), "EMBO Recording (*" REC_EXT ")");
+
+    if (path.isEmpty())
+        return;
+
+    QString ret = RecStream::toText(path, m_rec.getDelim(), 4);
+
+    if (ret.isEmpty())
+        msgBox(this, "Convert of: " + path + " failed!", CRITICAL);
+    else
+        msgBox(this, "File saved at: " + ret, INFO);
+}
+
 /********** Meas **********/
 
 void WindowVm::on_actionMeasEnabled_triggered(bool checked)
@@ -1357,7 +1494,7 @@ void WindowVm::on_spinBox_display_valueChanged(int arg1)
     m_ui->dial_display->setValue(arg1);
 
     m_display_pts = arg1;
-    m_display = ((double)arg1 - 1) / (100.0 / m_average);
+    m_display = ((double)arg1 - 1) / ((1000.0 / m_smpl_ms) / m_average);
 
     Settings::setValue(CFG_VM_PLT, arg1);
 }
@@ -1369,6 +1506,109 @@ void WindowVm::on_dial_display_valueChanged(int value)
 
 /********************************* private *********************************/
 
+void WindowVm::addSample(double ch1, double ch2, double ch3, double ch4, double vcc)
+{
+    double t_ms = m_timer_elapsed;
+    m_timer_elapsed += m_smpl_ms;
+    double t = t_ms / 1000.0;
+
+    double _ch1 = ch1 * m_gain1;
+    double _ch2 = ch2 * m_gain2;
+    double _ch3 = ch3 * m_gain3;
+    double _ch4 = ch4 * m_gain4;
+
+    double data_ch1 = _ch1;
+    double data_ch2 = _ch2;
+    double data_ch3 = _ch3;
+    double data_ch4 = _ch4;
+    double data_vcc = vcc;
+
+    if (m_math_2minus1)
+        data_ch3 = _ch2 - _ch1;
+
+    if (m_math_4minus3)
+        data_ch4 = _ch4 - _ch3;
+
+    if (m_recording && m_recStream != nullptr)
+    {
+        float v[4];
+        int n = 0;
+
+        if (m_en1) v[n++] = data_ch1;
+        if (m_en2) v[n++] = data_ch2;
+        if (m_en3) v[n++] = data_ch3;
+        if (m_en4) v[n++] = data_ch4;
+
+        if (n > 0)
+            m_recStream->push(t_ms, v, n);
+    }
+    else if (m_recording)
+    {
+        m_rec << t_ms;
+        if (m_en1)
+            m_rec << data_ch1;
+        if (m_en2)
+            m_rec << data_ch2;
+        if (m_en3)
+            m_rec << data_ch3;
+        if (m_en4)
+            m_rec << data_ch4;
+        if (m_en1 + m_en2 + m_en3 + m_en4 > 0)
+            m_rec << ENDL;
+    }
+
+    bool data_fresh = false;
+
+    if (m_average > 1) // average enabled
+    {
+        m_avg_it++;
+
+        m_avg1_val += data_ch1;
+        m_avg2_val += data_ch2;
+        m_avg3_val += data_ch3;
+        m_avg4_val += data_ch4;
+        m_avgVcc_val += data_vcc;
+
+        if (m_avg_it == m_average) // average is ready
+        {
+            m_data_ch1 = m_avg1_val / m_average;
+            m_data_ch2 = m_avg2_val / m_average;
+            m_data_ch3 = m_avg3_val / m_average;
+            m_data_ch4 = m_avg4_val / m_average;
+            m_data_vcc = m_avgVcc_val / m_average;
+
+            m_avg1_val = 0;
+            m_avg2_val = 0;
+            m_avg3_val = 0;
+            m_avg4_val = 0;
+            m_avgVcc_val = 0;
+
+            m_avg_it = 0;
+
+            data_fresh = true;
+            m_data_fresh = true;
+        }
+    }
+    else // average disabled
+    {
+        data_fresh = true;
+        m_data_fresh = true;
+
+        m_data_ch1 = data_ch1;
+        m_data_ch2 = data_ch2;
+        m_data_ch3 = data_ch3;
+        m_data_ch4 = data_ch4;
+        m_data_vcc = data_vcc;
+    }
+
+    if (data_fresh)
+    {
+        data_fresh = false;
+
+        m_smplBuff.push_back(VmSample {t, m_data_ch1, m_data_ch2, m_data_ch3, m_data_ch4});
+    }
+}
+
 void WindowVm::closeEvent(QCloseEvent*)
 {
     m_activeMsgs.clear();
@@ -1416,11 +1656,11 @@ void WindowVm::showEvent(QShowEvent*)
 
     Core::getInstance()->setMode(VM);
 
-    m_activeMsgs.push_back(m_msg_read1);
-    m_activeMsgs.push_back(m_msg_read2);
-    m_activeMsgs.push_back(m_msg_read3);
-    m_activeMsgs.push_back(m_msg_read4);
-    //m_activeMsgs.push_back(m_msg_read5);
+    bool log = info->features.contains('L');
+    m_ui->actionLog->setEnabled(log);
+    on_msg_ok_log(EMBO_SET_FALSE, "");
+    if (log) // device may still log from last time
+        Core::getInstance()->msgAdd(m_msg_log, false, EMBO_SET_FALSE);
 
     m_smplBuff.clear();
     m_data_fresh = false;
@@ -1467,3 +1707,36 @@ void WindowVm::rescaleXAxis()
     m_ui->customPlot->xAxis->setRange(m_key_last, m_display, Qt::AlignRight);
 }
 
+void WindowVm::activeMsgsLoad()
+{
+    auto info = Core::getInstance()->getDevInfo();
+
+    m_activeMsgs.clear();
+
+    if (m_log) // device block averages, drained in bulk
+    {
+        m_activeMsgs.push_back(m_msg_logRead);
+    }
+    else if (info->features.contains('V')) // all new samples in one binary block
+    {
+        m_activeMsgs.push_back(m_msg_readBin);
+    }
+    else
+    {
+        m_activeMsgs.push_back(m_msg_read1);
+        m_activeMsgs.push_back(m_msg_read2);
+        m_activeMsgs.push_back(m_msg_read3);
+        m_activeMsgs.push_back(m_msg_read4);
+        //m_activeMsgs.push_back(m_msg_read5);
+    }
+}
+
+/* gaps = records PC did not get, overruns = records device had to drop (polled less often) */
+void WindowVm::logStatus()
+{
+    if (!m_log)
+        return;
+
+    m_status_log->setText("Logger: " + m_log_rate + " Hz | gaps " + QString::number(m_log_gaps) +
+                          " | overruns " + QString::number(m_log_overruns));
+}
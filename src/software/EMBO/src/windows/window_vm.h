@@ -11,6 +11,7 @@
 #include "qcpcursors.h"
 #include "movemean.h"
 #include "recorder.h"
+#include "recstream.h"
 
 #include "lib/qcustomplot.h"
 
@@ -23,6 +24,7 @@
 #define TIMER_VM_PLOT           33.0    // graph refresh rate = 16.6 ms = 60 FPS
 #define TIMER_VM_DIGITS         250.0   // values refresh rate = 250 ms = 4 FPS
 //#define MOVEMEAN_VM           1       // values moving average 20 * 10 ms = 200 ms
+#define LOG_STAT_POLLS          100     // VM:LOG? (device overruns) every N drains
 
 #define GRAPH_CH1               0
 #define GRAPH_CH2               1
@@ -72,6 +74,12 @@ private slots:
     /* msg slots */
     void on_msg_err(const QString text, MsgBoxType type, bool needClose);
     void on_msg_read(const QString ch1, const QString ch2, const QString ch3, const QString ch4, const QString vcc);
+    void on_msg_readBin(const QVector<double> ch1, const QVector<double> ch2, const QVector<double> ch3, const QVector<double> ch4,
+                        const QVector<double> vcc, int lost);
+    void on_msg_logRead(const QVector<double> ch1, const QVector<double> ch2, const QVector<double> ch3, const QVector<double> ch4,
+                        const QVector<double> vcc, const QVector<quint32> seq);
+    void on_msg_log(bool active, int avg, quint32 seq, quint32 overruns);
+    void on_msg_ok_log(const QString val1, const QString val2);
 
     /* timer slots */
     void on_timer_plot();
@@ -86,6 +94,7 @@ private slots:
     void on_actionInterpLinear_triggered(bool checked);
     void on_actionInterpSinc_triggered(bool checked);
     void on_actionShowPlot_triggered(bool checked);
+    void on_actionLog_triggered(bool checked);
 
     /* GUI slots - Menu - Export */
     void on_actionExportStart_triggered();
@@ -97,6 +106,8 @@ private slots:
     void on_actionExportTXT_Tabs_triggered(bool checked);
     void on_actionExportTXT_Semicolon_triggered(bool checked);
     void on_actionExportMAT_triggered(bool checked);
+    void on_actionExportBIN_triggered(bool checked);
+    void on_actionExportConvert_triggered();
 
     /* GUI slots - Menu - Measure */
     void on_actionMeasEnabled_triggered(bool checked);
@@ -153,6 +164,9 @@ private slots:
 private:
     void statusBarLoad();
     void initQcp();
+    void addSample(double ch1, double ch2, double ch3, double ch4, double vcc);
+    void activeMsgsLoad();
+    void logStatus();
 
     void closeEvent(QCloseEvent *event) override;
     void showEvent(QShowEvent* event) override;
@@ -166,19 +180,24 @@ private:
 
     /* timers */
     double m_timer_elapsed = 0;
+    double m_smpl_ms = 10;
     QTimer* m_timer_plot;
     QTimer* m_timer_digits;
 
     /* status bar */
     QLabel* m_status_vcc;
     QLabel* m_status_rec;
+    QLabel* m_status_log;
     QFrame* m_status_line1;
+    QFrame* m_status_line2;
 
     /* raw sample buffer */
     std::vector<VmSample> m_smplBuff;
 
-    /* recorder */
+    /* recorder, binary one writes from its own thread */
     Recorder m_rec;
+    RecStream* m_recStream = nullptr;
+    bool m_rec_bin = false;
 
     /* last raw data values */
     double m_data_ch1;
@@ -232,6 +251,7 @@ private:
     bool m_math_2minus1 = false;
     bool m_math_4minus3 = false;
     bool m_plot = true;
+    bool m_log = false;
 
     /* stm32 pins */
     QString m_pin1 = "?";
@@ -254,12 +274,23 @@ private:
     double m_display_pts = DISPLAY_VM_DEFAULT;
     int m_average = 1;
 
+    /* logger - device block averages, seq gaps = records lost */
+    int m_log_avg = 1;
+    QString m_log_rate = "";
+    quint32 m_log_seq = 0;
+    quint32 m_log_gaps = 0;
+    quint32 m_log_overruns = 0;
+    int m_log_polls = 0;
+
     /* messages */
     Msg_VM_Read* m_msg_read1;
     Msg_VM_Read* m_msg_read2;
     Msg_VM_Read* m_msg_read3;
     Msg_VM_Read* m_msg_read4;
     Msg_VM_Read* m_msg_read5;
+    Msg_VM_Read* m_msg_readBin;
+    Msg_VM_Log* m_msg_log;
+    Msg_VM_LogRead* m_msg_logRead;
 };
 
 #endif // WINDOW_VM_H
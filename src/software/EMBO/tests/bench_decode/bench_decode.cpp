@@ -0,0 +1,180 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* scalar vs SSE2 vs AVX2 kernels of decode.cpp on scope sized frames (wrapped circular buffer),
+ * reports Msamples/s per ISA and checks every ISA against scalar output
+ *
+ * usage: bench_decode [samples] */
+
+#include "decode.h"
+
+#include <QElapsedTimer>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+
+#define BENCH_SAMPLES       20000   // F303 4 ch 5k mem
+#define BENCH_MIN_NS        200000000LL
+#define BENCH_SEED          12345
+#define BENCH_RESERVE       6       // buffer a bit longer than frame, so frame wraps around
+
+
+static const char* isa_name[] = { "scalar", "SSE2", "AVX2" };
+
+static volatile double g_sink = 0; // keeps results alive
+
+
+static bool isa_supported(DecodeIsa isa)
+{
+    return isa <= decode_isa();
+}
+
+/* Msamples/s of decode_circ, repeats until BENCH_MIN_NS elapsed */
+static double bench_circ(const std::vector<uint8_t>& buff, int bufflen, int total, DaqBits bits, int ch_num,
+                         std::vector<double>* out, DecodeIsa isa)
+{
+    double* dst[4];
+    double gain[4] = { 1.0, 2.0, 0.5, 1.5 };
+    double offset[4] = { 0.0, -1.0, 0.25, 2.0 };
+    for (int c = 0; c < ch_num; c++)
+        dst[c] = out[c].data();
+
+    int from = bufflen - total / 3; // wrap
+    QElapsedTimer timer;
+    qint64 ns = 0;
+    qint64 iters = 0;
+
+    timer.start();
+    while (ns < BENCH_MIN_NS)
+    {
+        decode_circ(from, total, bufflen, bits, 3.3, buff.data(), ch_num, dst, gain, offset, isa);
+        g_sink = g_sink + out[0][total / ch_num - 1];
+        iters++;
+        ns = timer.nsecsElapsed();
+    }
+    return (double)total * iters / (ns / 1000.0);
+}
+
+static double bench_unpack12(const std::vector<uint8_t>& src, int count, std::vector<uint16_t>& dst, DecodeIsa isa)
+{
+    QElapsedTimer timer;
+    qint64 ns = 0;
+    qint64 iters = 0;
+
+    timer.start();
+    while (ns < BENCH_MIN_NS)
+    {
+        decode_unpack12(src.data(), count, dst.data(), isa);
+        g_sink = g_sink + dst[count - 1];
+        iters++;
+        ns = timer.nsecsElapsed();
+    }
+    return (double)count * iters / (ns / 1000.0);
+}
+
+int main(int argc, char** argv)
+{
+    int samples = argc > 1 ? atoi(argv[1]) : BENCH_SAMPLES;
+    if (samples < 12)
+    {
+        fprintf(stderr, "samples must be at least 12\n");
+        return 1;
+    }
+    samples -= samples % 12; // whole records of 1, 2, 3 and 4 channels
+
+    int bufflen = samples + BENCH_RESERVE * 4;
+    std::vector<uint8_t> raw(bufflen * 2);
+
+    srand(BENCH_SEED);
+    for (int i = 0; i < bufflen; i++) // valid for both B8 and B12
+    {
+        uint16_t v = rand() & 0x0FFF;
+        memcpy(&raw[i * 2], &v, 2);
+    }
+
+    int errors = 0;
+
+    printf("decode_circ, %d samples, buffer %d, best ISA %s\n", samples, bufflen, isa_name[decode_isa()]);
+    printf("%-5s %-3s %12s %12s %12s\n", "bits", "ch", "scalar", "SSE2", "AVX2");
+
+    const DaqBits bits_all[] = { B8, B12 };
+    const int ch_all[] = { 1, 2, 3, 4 };
+
+    for (DaqBits bits : bits_all)
+    {
+        for (int ch_num : ch_all)
+        {
+            std::vector<double> ref[4], out[4];
+            for (int c = 0; c < 4; c++)
+            {
+                ref[c].assign(samples / ch_num, 0);
+                out[c].assign(samples / ch_num, 0);
+            }
+
+            printf("%-5d %-3d", (int)bits, ch_num);
+            bench_circ(raw, bufflen, samples, bits, ch_num, ref, DECODE_SCALAR); // warm up and reference
+
+            for (int isa = DECODE_SCALAR; isa <= DECODE_AVX2; isa++)
+            {
+                if (!isa_supported((DecodeIsa)isa))
+                {
+                    printf(" %12s", "-");
+                    continue;
+                }
+
+                double mss = bench_circ(raw, bufflen, samples, bits, ch_num, out, (DecodeIsa)isa);
+                printf(" %7.1f MS/s", mss);
+
+                for (int c = 0; c < ch_num; c++)
+                {
+                    for (int k = 0; k < samples / ch_num; k++)
+                    {
+                        if (fabs(out[c][k] - ref[c][k]) > 1e-9)
+                        {
+                            if (errors++ < 10)
+                                fprintf(stderr, "\nmismatch %s bits %d ch %d/%d sample %d: %f != %f",
+                                        isa_name[isa], (int)bits, c + 1, ch_num, k, out[c][k], ref[c][k]);
+                        }
+                    }
+                }
+            }
+            printf("\n");
+        }
+    }
+
+    std::vector<uint16_t> ref12(samples), out12(samples);
+    int count12 = samples - 1; // odd count, padded pair
+
+    printf("\ndecode_unpack12, %d samples\n", count12);
+    bench_unpack12(raw, count12, ref12, DECODE_SCALAR);
+
+    for (int isa = DECODE_SCALAR; isa <= DECODE_AVX2; isa++)
+    {
+        if (!isa_supported((DecodeIsa)isa))
+        {
+            printf("%-7s -\n", isa_name[isa]);
+            continue;
+        }
+
+        printf("%-7s %7.1f MS/s\n", isa_name[isa], bench_unpack12(raw, count12, out12, (DecodeIsa)isa));
+
+        if (memcmp(ref12.data(), out12.data(), count12 * sizeof(uint16_t)) != 0)
+        {
+            fprintf(stderr, "mismatch %s unpack12\n", isa_name[isa]);
+            errors++;
+        }
+    }
+
+    if (errors > 0)
+    {
+        fprintf(stderr, "\n%d mismatches\n", errors);
+        return 1;
+    }
+    return 0;
+}
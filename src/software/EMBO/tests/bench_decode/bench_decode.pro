@@ -0,0 +1,15 @@
+QT -= gui
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = bench_decode
+
+INCLUDEPATH += $$PWD/../../src
+
+SOURCES += \
+    bench_decode.cpp \
+    ../../src/decode.cpp
+
+HEADERS += \
+    ../../src/decode.h
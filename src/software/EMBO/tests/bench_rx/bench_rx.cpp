@@ -0,0 +1,213 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* replays device responds through RxParser in random chunk sizes, as USB CDC / serial reads arrive,
+ * reports throughput and heap allocations per frame, garbled block headers checked first
+ *
+ * usage: bench_rx [capture.bin|-] [max_chunk]
+ * capture.bin = raw bytes read from port (e.g. dumped from Core::on_serial_readyRead), synthetic stream if missing or - */
+
+#include "rxparser.h"
+
+#include <QByteArray>
+#include <QVector>
+#include <QElapsedTimer>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define BENCH_PASSES        20
+#define BENCH_SEED          12345
+#define SYNTH_FRAMES        200
+#define SYNTH_BLOCK         44000   // SCOP:READ? of 4 ch, 12 bit, 5k mem + reserve
+
+
+/* glibc only - every malloc/realloc made by parser counted, including QByteArray growth */
+#if defined(__GLIBC__)
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void* __libc_calloc(size_t num, size_t size);
+
+static volatile bool g_count = false;
+static quint64 g_allocs = 0;
+
+extern "C" void* malloc(size_t size)
+{
+    if (g_count) g_allocs++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+    if (g_count) g_allocs++;
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void* calloc(size_t num, size_t size)
+{
+    if (g_count) g_allocs++;
+    return __libc_calloc(num, size);
+}
+#define ALLOC_COUNTING  1
+#else
+static bool g_count = false;
+static quint64 g_allocs = 0;
+#define ALLOC_COUNTING  0
+#endif
+
+
+/* same mix as SCOPE window: SYS:UPT? and SCOP:READ? each batch, async Ready in between */
+static QByteArray synthStream(int frames)
+{
+    QByteArray out;
+    char hdr[32];
+    char len_s[16];
+    int digits = snprintf(len_s, sizeof(len_s), "%d", SYNTH_BLOCK);
+
+    for (int i = 0; i < frames; i++)
+    {
+        out.append("\"ReadyN\",1234\r\n", 15);
+
+        int n = snprintf(hdr, sizeof(hdr), "#%d%s", digits, len_s);
+        out.append(hdr, n);
+        for (int k = 0; k < SYNTH_BLOCK; k++)
+            out.append((char)(k * 7 + i));
+
+        n = snprintf(hdr, sizeof(hdr), ";%d\r\n", 1000 + i);
+        out.append(hdr, n);
+    }
+
+    return out;
+}
+
+static QByteArray readFile(const char* path)
+{
+    QByteArray out;
+    FILE* f = fopen(path, "rb");
+    if (f == NULL)
+        return out;
+
+    char buff[65536];
+    size_t n;
+    while ((n = fread(buff, 1, sizeof(buff), f)) > 0)
+        out.append(buff, (int)n);
+
+    fclose(f);
+    return out;
+}
+
+/* garbled block headers must end in RX_ERR, never in scan outside of buffer */
+static bool checkGarbled()
+{
+    const char* bad[] = { "#2//ab\r\n", "#0\r\n", "#a12\r\n", "#3-10abc\r\n", "#21 x\r\n", "OK;#2/9x\r\n" };
+
+    for (const char* s : bad)
+    {
+        RxParser parser;
+        parser.append(QByteArray(s));
+        RxParser::Result res;
+        while ((res = parser.next()) == RxParser::RX_MSG) {}
+
+        if (res != RxParser::RX_ERR)
+        {
+            fprintf(stderr, "garbled header not rejected: %s\n", s);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (!checkGarbled())
+        return 1;
+
+    QByteArray stream = (argc > 1 && strcmp(argv[1], "-") != 0) ? readFile(argv[1]) : synthStream(SYNTH_FRAMES);
+    int max_chunk = (argc > 2) ? atoi(argv[2]) : 4096;
+
+    if (stream.isEmpty() || max_chunk < 1)
+    {
+        fprintf(stderr, "empty stream or bad chunk size\n");
+        return 1;
+    }
+
+    /* chunks cut once, outside of measurement, like port readAll() results */
+    QVector<QByteArray> chunks;
+    srand(BENCH_SEED);
+    for (int pos = 0; pos < stream.size(); )
+    {
+        int len = qMin(1 + (rand() % max_chunk), stream.size() - pos);
+        chunks.append(stream.mid(pos, len));
+        pos += len;
+    }
+
+    RxParser parser;
+    quint64 msgs = 0, spans = 0, bin_bytes = 0;
+    qint64 ns = 0;
+    bool err = false;
+
+    for (int pass = 0; pass < BENCH_PASSES && !err; pass++)
+    {
+        parser.reset();
+
+        QElapsedTimer timer;
+        timer.start();
+        g_count = true;
+
+        for (const QByteArray& chunk : chunks)
+        {
+            parser.append(chunk);
+
+            RxParser::Result res;
+            while ((res = parser.next()) == RxParser::RX_MSG)
+            {
+                msgs++;
+                for (const RxSpan& span : parser.spans())
+                {
+                    spans++;
+                    if (span.bin)
+                        bin_bytes += span.len;
+                }
+            }
+
+            if (res == RxParser::RX_ERR)
+            {
+                err = true;
+                break;
+            }
+
+            parser.compact();
+        }
+
+        g_count = false;
+        ns += timer.nsecsElapsed();
+
+        if (parser.size() != 0) // stream ends with complete message
+            err = true;
+    }
+
+    if (err)
+    {
+        fprintf(stderr, "parse error\n");
+        return 1;
+    }
+
+    double mb = (double)stream.size() * BENCH_PASSES / 1e6;
+    double s = ns / 1e9;
+
+    printf("stream:     %d B in %d chunks (1..%d B)\n", stream.size(), chunks.size(), max_chunk);
+    printf("messages:   %llu, submessages %llu, binary %llu B\n", (unsigned long long)(msgs / BENCH_PASSES),
+           (unsigned long long)(spans / BENCH_PASSES), (unsigned long long)(bin_bytes / BENCH_PASSES));
+    printf("throughput: %.1f MB/s\n", mb / s);
+
+    if (ALLOC_COUNTING)
+        printf("allocs:     %.2f per frame\n", (double)g_allocs / (double)msgs);
+    else
+        printf("allocs:     not counted on this platform\n");
+
+    return 0;
+}
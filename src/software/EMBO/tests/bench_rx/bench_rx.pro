@@ -0,0 +1,15 @@
+QT -= gui
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TARGET = bench_rx
+
+INCLUDEPATH += $$PWD/../../src
+
+SOURCES += \
+    bench_rx.cpp \
+    ../../src/rxparser.cpp
+
+HEADERS += \
+    ../../src/rxparser.h
@@ -0,0 +1,7 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    bench_rx \
+    bench_decode \
+    tst_ladecoder \
+    tst_softtrig
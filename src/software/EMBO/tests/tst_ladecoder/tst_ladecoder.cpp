@@ -0,0 +1,384 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* UART, SPI and I2C decoders fed by synthetic bit-streams, whole capture and chunked decode must match */
+
+#include "labits.h"
+#include "ladecoder.h"
+
+#include <QString>
+#include <QVector>
+
+#include <stdio.h>
+#include <stdint.h>
+
+
+static int g_fails = 0;
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); g_fails++; } } while (0)
+
+
+/* raw LA capture, one byte per sample, channel c on bit pins[c] (swapped on purpose, like F103 board) */
+class Stream
+{
+public:
+    Stream() { for (int c = 0; c < LA_CH_MAX; c++) m_lvl[c] = 1; }
+
+    void set(int ch, bool lvl) { m_lvl[ch] = lvl; }
+    void hold(int samples)
+    {
+        uint8_t v = 0;
+        for (int c = 0; c < LA_CH_MAX; c++)
+            v |= m_lvl[c] << pins[c];
+        for (int i = 0; i < samples; i++)
+            m_raw.append(v);
+    }
+    int size() const { return m_raw.size(); }
+
+    /* raw stored rotated in ring, as DAQ buffer with first sample at firstPos */
+    void load(LaBits& bits) const
+    {
+        const int n = m_raw.size();
+        const int first = n / 3;
+        QVector<uint8_t> ring(n);
+        for (int i = 0; i < n; i++)
+            ring[(first + i) % n] = m_raw[i];
+        bits.setData(ring.constData(), n, first, n, pins, LA_CH_MAX);
+    }
+
+    static const int pins[LA_CH_MAX];
+
+private:
+    QVector<uint8_t> m_raw;
+    bool m_lvl[LA_CH_MAX];
+};
+
+const int Stream::pins[LA_CH_MAX] = { 2, 3, 0, 1 };
+
+/* decodes whole capture once and in odd sized chunks, both must give same frames */
+static QVector<LaFrame> decode(const LaDecoderCfg& cfg, const Stream& s)
+{
+    LaBits bits;
+    s.load(bits);
+
+    LaDecoder* dec = LaDecoder::create(cfg, bits.chNum());
+    CHECK(dec != NULL);
+    if (dec == NULL)
+        return QVector<LaFrame>();
+
+    QVector<LaFrame> whole;
+    dec->decode(bits, bits.size(), whole);
+
+    dec->reset();
+    QVector<LaFrame> chunked;
+    for (int end = 37; ; end += 37)
+    {
+        if (end > bits.size())
+            end = bits.size();
+        dec->decode(bits, end, chunked);
+        if (end == bits.size())
+            break;
+    }
+    delete dec;
+
+    CHECK(whole.size() == chunked.size());
+    for (int i = 0; i < whole.size() && i < chunked.size(); i++)
+    {
+        CHECK(whole[i].start == chunked[i].start);
+        CHECK(whole[i].text == chunked[i].text);
+        CHECK(whole[i].error == chunked[i].error);
+    }
+    return whole;
+}
+
+static void expect(const QVector<LaFrame>& frames, const char* const* texts, const bool* errors, int num)
+{
+    CHECK(frames.size() == num);
+
+    for (int i = 0; i < frames.size() && i < num; i++)
+    {
+        if (frames[i].text != QString(texts[i]) || frames[i].error != errors[i])
+        {
+            fprintf(stderr, "FAIL frame %d: '%s'%s, expected '%s'%s\n", i, frames[i].text.toLatin1().constData(),
+                    frames[i].error ? " error" : "", texts[i], errors[i] ? " error" : "");
+            g_fails++;
+        }
+        CHECK(frames[i].start <= frames[i].end);
+    }
+}
+
+/********************************* UART *********************************/
+
+static void uart_byte(Stream& s, int ch, int val, double spb, double& t, bool stop = true)
+{
+    auto bit = [&](bool lvl)
+    {
+        s.set(ch, lvl);
+        t += spb;
+        s.hold((int)(t + 0.5) - s.size());
+    };
+
+    bit(0);
+    for (int b = 0; b < 8; b++)
+        bit((val >> b) & 1);
+    bit(stop);
+    s.set(ch, 1);
+}
+
+static void test_uart()
+{
+    const double fs = 1000000;
+    const int baud = 115200;
+    const double spb = fs / baud; // 8.68, not integer on purpose
+
+    Stream s;
+    s.hold(50);
+    double t = s.size();
+
+    uart_byte(s, 2, 'H', spb, t);
+    uart_byte(s, 2, 'i', spb, t);
+    t += 3 * spb; // idle gap
+    s.hold((int)(t + 0.5) - s.size());
+    uart_byte(s, 2, 0x00, spb, t);
+    uart_byte(s, 2, 0xFF, spb, t);
+    uart_byte(s, 2, 0x55, spb, t, false); // framing error
+    t += 20 * spb;
+    s.hold((int)t - s.size());
+
+    LaDecoderCfg cfg;
+    cfg.proto = LA_PROTO_UART;
+    cfg.fs = fs;
+    cfg.uart_rx = 2;
+    cfg.uart_baud = baud;
+
+    const char* texts[] = { "0x48 'H'", "0x69 'i'", "0x00", "0xFF", "0x55 'U'" };
+    const bool errors[] = { false, false, false, false, true };
+
+    QVector<LaFrame> frames = decode(cfg, s);
+    expect(frames, texts, errors, 5);
+
+    for (const LaFrame& f : frames)
+        CHECK(f.ch == 2);
+
+    /* frame cut off by end of capture is not reported */
+    Stream cut;
+    cut.hold(20);
+    t = cut.size();
+    uart_byte(cut, 2, 'A', spb, t);
+    cut.hold(5);
+    t = cut.size();
+    uart_byte(cut, 2, 'B', spb, t);
+    LaBits bits;
+    cut.load(bits);
+    LaDecoder* dec = LaDecoder::create(cfg, bits.chNum());
+    QVector<LaFrame> part;
+    dec->decode(bits, bits.size() - (int)(3 * spb), part);
+    CHECK(part.size() == 1 && part[0].text == "0x41 'A'");
+    delete dec;
+}
+
+/********************************* SPI *********************************/
+
+/* CPOL idle level, CPHA 0 = data valid on first edge */
+static void spi_word(Stream& s, int mode, int mosi, int miso, int bits_num = 8)
+{
+    const bool cpol = mode >> 1;
+    const bool cpha = mode & 1;
+    const int half = 4;
+
+    for (int b = 7; b > 7 - bits_num; b--)
+    {
+        if (!cpha) // data before first edge
+        {
+            s.set(1, (mosi >> b) & 1);
+            s.set(2, (miso >> b) & 1);
+            s.hold(half);
+            s.set(0, !cpol);
+            s.hold(half);
+            s.set(0, cpol);
+        }
+        else // data after first edge, sampled on second
+        {
+            s.set(0, !cpol);
+            s.set(1, (mosi >> b) & 1);
+            s.set(2, (miso >> b) & 1);
+            s.hold(half);
+            s.set(0, cpol);
+            s.hold(half);
+        }
+    }
+}
+
+static void test_spi(int mode)
+{
+    Stream s;
+    s.set(0, mode >> 1); // clk idle
+    s.set(3, 1);         // CS high
+    s.hold(16);
+
+    s.set(3, 0);
+    s.hold(6);
+    spi_word(s, mode, 0xA5, 0x5A);
+    spi_word(s, mode, 0x3C, 0xC3);
+    s.hold(6);
+    s.set(3, 1);
+    s.hold(16);
+
+    s.set(3, 0);
+    s.hold(6);
+    spi_word(s, mode, 0xF0, 0x0F, 5); // deselected after 5 bits
+    s.hold(6);
+    s.set(3, 1);
+    s.hold(16);
+
+    /* clock while not selected is ignored */
+    spi_word(s, mode, 0xFF, 0xFF);
+    s.hold(16);
+
+    LaDecoderCfg cfg;
+    cfg.proto = LA_PROTO_SPI;
+    cfg.spi_clk = 0;
+    cfg.spi_mosi = 1;
+    cfg.spi_miso = 2;
+    cfg.spi_cs = 3;
+    cfg.spi_mode = mode;
+
+    const char* texts[] = { "0xA5 / 0x5A", "0x3C / 0xC3", "0x1E / 0x01" };
+    const bool errors[] = { false, false, true };
+
+    expect(decode(cfg, s), texts, errors, 3);
+
+    /* without MISO and CS */
+    Stream n;
+    n.set(0, mode >> 1);
+    n.set(3, 0);
+    n.hold(16);
+    spi_word(n, mode, 0x81, 0);
+    spi_word(n, mode, 0x7E, 0);
+    n.hold(16);
+
+    cfg.spi_miso = -1;
+    cfg.spi_cs = -1;
+
+    const char* texts_n[] = { "0x81", "0x7E" };
+    const bool errors_n[] = { false, false };
+
+    expect(decode(cfg, n), texts_n, errors_n, 2);
+}
+
+/********************************* I2C *********************************/
+
+static const int SCL = 1;
+static const int SDA = 3;
+
+static void i2c_start(Stream& s)
+{
+    s.set(SDA, 1);
+    s.hold(4);
+    s.set(SCL, 1);
+    s.hold(4);
+    s.set(SDA, 0);
+    s.hold(4);
+    s.set(SCL, 0);
+    s.hold(4);
+}
+
+static void i2c_stop(Stream& s)
+{
+    s.set(SDA, 0);
+    s.hold(4);
+    s.set(SCL, 1);
+    s.hold(4);
+    s.set(SDA, 1);
+    s.hold(8);
+}
+
+static void i2c_byte(Stream& s, int val, bool nak)
+{
+    for (int b = 8; b >= 0; b--)
+    {
+        s.set(SDA, b == 0 ? nak : (val >> (b - 1)) & 1);
+        s.hold(4);
+        s.set(SCL, 1);
+        s.hold(4);
+        s.set(SCL, 0);
+        s.hold(4);
+    }
+}
+
+static void test_i2c()
+{
+    Stream s;
+    s.hold(16);
+
+    i2c_start(s);
+    i2c_byte(s, 0x50 << 1, false);  // write
+    i2c_byte(s, 0x12, false);
+    i2c_start(s);                   // repeated start
+    i2c_byte(s, (0x50 << 1) | 1, false);
+    i2c_byte(s, 0xA7, true);        // master NAK on last read
+    i2c_stop(s);
+
+    i2c_start(s);
+    i2c_byte(s, 0x3C << 1, true);   // nobody there
+    i2c_stop(s);
+
+    LaDecoderCfg cfg;
+    cfg.proto = LA_PROTO_I2C;
+    cfg.i2c_scl = SCL;
+    cfg.i2c_sda = SDA;
+
+    const char* texts[] = { "S", "ADDR 0x50 W ACK", "0x12 ACK", "Sr", "ADDR 0x50 R ACK", "0xA7 NAK", "P",
+                            "S", "ADDR 0x3C W NAK", "P" };
+    const bool errors[10] = {};
+
+    QVector<LaFrame> frames = decode(cfg, s);
+    expect(frames, texts, errors, 10);
+
+    for (const LaFrame& f : frames)
+        CHECK(f.ch == SDA);
+}
+
+/********************************* config *********************************/
+
+static void test_create()
+{
+    LaDecoderCfg cfg;
+    CHECK(LaDecoder::create(cfg, 4) == NULL);
+
+    cfg.proto = LA_PROTO_UART;
+    cfg.fs = 1000000;
+    cfg.uart_rx = 3;
+    CHECK(LaDecoder::create(cfg, 2) == NULL); // channel out of capture
+
+    cfg.proto = LA_PROTO_I2C;
+    cfg.i2c_scl = 0;
+    cfg.i2c_sda = 0;
+    LaDecoder* dec = LaDecoder::create(cfg, 2);
+    CHECK(dec != NULL);
+    delete dec;
+
+    LaDecoderCfg a, b;
+    CHECK(a == b);
+    b.spi_miso = -1;
+    CHECK(a != b);
+}
+
+int main()
+{
+    test_create();
+    test_uart();
+    for (int mode = 0; mode < 4; mode++)
+        test_spi(mode);
+    test_i2c();
+
+    if (g_fails > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", g_fails);
+        return 1;
+    }
+    printf("tst_ladecoder: OK\n");
+    return 0;
+}
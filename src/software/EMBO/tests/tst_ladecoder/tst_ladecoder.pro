@@ -0,0 +1,20 @@
+QT += widgets printsupport
+
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+
+TARGET = tst_ladecoder
+
+INCLUDEPATH += $$PWD/../../src
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += \
+    tst_ladecoder.cpp \
+    ../../src/labits.cpp \
+    ../../src/ladecoder.cpp \
+    ../../lib/qcustomplot.cpp
+
+HEADERS += \
+    ../../src/labits.h \
+    ../../src/ladecoder.h \
+    ../../lib/qcustomplot.h
@@ -0,0 +1,330 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* software trigger modes fed by synthetic waveforms at 1 MS/s, LA pattern on raw captures,
+ * with any argument also prints scan time of 1M samples sine per mode (not checked) */
+
+#include "softtrig.h"
+#include "labits.h"
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+
+#define FS          1000000.0
+#define BENCH_LEN   1000000
+
+static int g_fails = 0;
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); g_fails++; } } while (0)
+
+#define CHECK_AT(got, want) do { int g_ = (got), w_ = (want); if (g_ != w_) { \
+    fprintf(stderr, "FAIL %s:%d: %s = %d, expected %d\n", __FILE__, __LINE__, #got, g_, w_); g_fails++; } } while (0)
+
+
+/* analog frame built from flat levels and linear ramps */
+class Wave
+{
+public:
+    Wave& hold(double v, int n) { for (int i = 0; i < n; i++) m_y.append(v); return *this; }
+    Wave& ramp(double to, int n)
+    {
+        double from = m_y.isEmpty() ? 0 : m_y.last();
+        for (int i = 1; i <= n; i++)
+            m_y.append(from + (to - from) * i / n);
+        return *this;
+    }
+    int size() const { return m_y.size(); }
+    const double* data() const { return m_y.constData(); }
+    double operator[](int i) const { return m_y[i]; }
+
+private:
+    QVector<double> m_y;
+};
+
+static int scan(SoftTrigMode mode, DaqTrigEdge pol, double time, const Wave& w)
+{
+    SoftTrigCfg cfg;
+    cfg.mode = mode;
+    cfg.polarity = pol;
+    cfg.level = 1.65;
+    cfg.lo = 1.0;
+    cfg.hi = 2.3;
+    cfg.time = time;
+
+    SoftTrig strig;
+    return strig.scan(cfg, w.data(), w.size(), FS);
+}
+
+/********************************* pulse *********************************/
+
+static void test_pulse()
+{
+    /* steps cross level half sample before event, so width equals distance of events */
+    Wave w;
+    w.hold(0, 100).hold(3.3, 10).hold(0, 50).hold(3.3, 30).hold(0, 100); // events 100, 110, 160, 190
+
+    CHECK_AT(scan(STRIG_PULSE_GT, RISING, 20e-6, w), 190);
+    CHECK_AT(scan(STRIG_PULSE_LT, RISING, 20e-6, w), 110);
+    CHECK_AT(scan(STRIG_PULSE_GT, FALLING, 20e-6, w), 160);
+    CHECK_AT(scan(STRIG_PULSE_LT, FALLING, 20e-6, w), -1);
+    CHECK_AT(scan(STRIG_PULSE_GT, BOTH, 40e-6, w), 160);
+    CHECK_AT(scan(STRIG_PULSE_GT, BOTH, 60e-6, w), -1);
+    CHECK_AT(scan(STRIG_PULSE_LT, BOTH, 5e-6, w), -1);
+
+    /* pulse running at start or end of frame has unknown width */
+    Wave cut;
+    cut.hold(3.3, 50).hold(0, 20).hold(3.3, 50);
+    CHECK_AT(scan(STRIG_PULSE_GT, RISING, 20e-6, cut), -1);
+    CHECK_AT(scan(STRIG_PULSE_LT, FALLING, 30e-6, cut), 70);
+
+    /* sloped edges, crossings interpolated at 24.5 and 53.5 */
+    Wave slope;
+    slope.hold(0, 20).ramp(3.0, 10).hold(3.0, 20).ramp(0, 10).hold(0, 20);
+    CHECK_AT(scan(STRIG_PULSE_GT, RISING, 28.5e-6, slope), 54);
+    CHECK_AT(scan(STRIG_PULSE_LT, RISING, 29.5e-6, slope), 54);
+    CHECK_AT(scan(STRIG_PULSE_GT, RISING, 29.5e-6, slope), -1);
+}
+
+/********************************* runt *********************************/
+
+static void test_runt()
+{
+    Wave w;
+    w.hold(0, 50).hold(1.65, 10).hold(0, 20)     // positive runt, events 50, 60
+     .hold(3.3, 10).hold(0, 20)                  // full pulse in one step, 80, 90
+     .hold(3.3, 20).hold(1.65, 10).hold(3.3, 20) // negative runt, 110, 130, 140
+     .hold(0, 20);
+
+    CHECK_AT(scan(STRIG_RUNT, RISING, 0, w), 60);
+    CHECK_AT(scan(STRIG_RUNT, FALLING, 0, w), 140);
+    CHECK_AT(scan(STRIG_RUNT, BOTH, 0, w), 60);
+
+    /* full swings through middle band are no runts */
+    Wave full;
+    full.hold(0, 20).ramp(3.3, 10).hold(3.3, 20).ramp(0, 10).hold(0, 20).ramp(3.3, 10).hold(0, 10); // last fall in one step
+    CHECK_AT(scan(STRIG_RUNT, BOTH, 0, full), -1);
+}
+
+/********************************* window *********************************/
+
+static void test_window()
+{
+    Wave w;
+    w.hold(1.65, 200).hold(3.0, 50).hold(1.65, 50).hold(0.5, 50).hold(1.65, 50); // events 200, 250, 300, 350
+
+    CHECK_AT(scan(STRIG_WINDOW, RISING, 0, w), 200);
+    CHECK_AT(scan(STRIG_WINDOW, FALLING, 0, w), 300);
+    CHECK_AT(scan(STRIG_WINDOW, BOTH, 0, w), 200);
+
+    Wave in;
+    in.hold(1.65, 100).ramp(2.2, 50).ramp(1.1, 50).hold(1.0, 10); // lo itself is inside
+    CHECK_AT(scan(STRIG_WINDOW, BOTH, 0, in), -1);
+
+    /* frame starting outside has nothing to leave */
+    Wave out;
+    out.hold(3.0, 100).hold(1.65, 100);
+    CHECK_AT(scan(STRIG_WINDOW, RISING, 0, out), -1);
+}
+
+/********************************* slew *********************************/
+
+/* first sample of [from, to) at or above (below) level */
+static int first_cross(const Wave& w, int from, int to, double level, bool rising)
+{
+    for (int i = from; i < to; i++)
+    {
+        if (rising ? w[i] >= level : w[i] < level)
+            return i;
+    }
+    return -1;
+}
+
+static void test_slew()
+{
+    /* lo 1.0 .. hi 2.3 is 39 % of swing: 10 sample ramp = 3.9 us, 100 sample ramp = 39 us */
+    Wave w;
+    w.hold(0, 50);
+    const int up_fast = w.size();
+    w.ramp(3.3, 10).hold(3.3, 50);
+    const int dn_slow = w.size();
+    w.ramp(0, 100).hold(0, 50);
+    const int up_slow = w.size();
+    w.ramp(3.3, 100).hold(3.3, 50);
+    const int dn_fast = w.size();
+    w.ramp(0, 10).hold(0, 50);
+
+    CHECK_AT(scan(STRIG_SLEW_LT, RISING, 20e-6, w), first_cross(w, up_fast, dn_slow, 2.3, true));
+    CHECK_AT(scan(STRIG_SLEW_GT, RISING, 20e-6, w), first_cross(w, up_slow, dn_fast, 2.3, true));
+    CHECK_AT(scan(STRIG_SLEW_GT, FALLING, 20e-6, w), first_cross(w, dn_slow, up_slow, 1.0, false));
+    CHECK_AT(scan(STRIG_SLEW_LT, FALLING, 20e-6, w), first_cross(w, dn_fast, w.size(), 1.0, false));
+    CHECK_AT(scan(STRIG_SLEW_GT, BOTH, 20e-6, w), first_cross(w, dn_slow, up_slow, 1.0, false));
+    CHECK_AT(scan(STRIG_SLEW_GT, BOTH, 50e-6, w), -1);
+    CHECK_AT(scan(STRIG_SLEW_LT, BOTH, 1e-6, w), -1);
+
+    /* whole transition within one sample */
+    Wave step;
+    step.hold(0, 50).hold(3.3, 50);
+    CHECK_AT(scan(STRIG_SLEW_LT, RISING, 1e-6, step), 50);
+
+    /* leaves bottom, turns back before top */
+    Wave back;
+    back.hold(0, 20).ramp(2.0, 100).ramp(0, 100).hold(0, 20);
+    CHECK_AT(scan(STRIG_SLEW_GT, RISING, 1e-6, back), -1);
+}
+
+static void test_off()
+{
+    Wave w;
+    w.hold(0, 10);
+    CHECK_AT(scan(STRIG_OFF, RISING, 0, w), 0);
+
+    Wave one;
+    one.hold(3.3, 1);
+    CHECK_AT(scan(STRIG_WINDOW, BOTH, 0, one), -1);
+}
+
+/********************************* LA pattern *********************************/
+
+/* raw capture, one byte per sample, channel c on bit c, stored rotated in ring as DAQ buffer */
+static void la_load(LaBits& bits, const QVector<uint8_t>& raw, int ch_num)
+{
+    static const int pins[LA_CH_MAX] = { 0, 1, 2, 3 };
+    const int n = raw.size();
+    const int first = n / 3;
+
+    QVector<uint8_t> ring(n);
+    for (int i = 0; i < n; i++)
+        ring[(first + i) % n] = raw[i];
+    bits.setData(ring.constData(), n, first, n, pins, ch_num);
+}
+
+static void la_fill(QVector<uint8_t>& raw, int from, int to, uint8_t v)
+{
+    for (int i = from; i < to; i++)
+        raw[i] = v;
+}
+
+static void test_pattern()
+{
+    SoftTrigPattern pat;
+    pat.enabled = true;
+    pat.mask = 0x5;     // CH1 = 1, CH2 = X, CH3 = 0
+    pat.value = 0x1;
+    pat.time = 10e-6;   // 10 samples
+
+    QVector<uint8_t> raw(300, 0x4);
+    la_fill(raw, 70, 75, 0x1);      // too short
+    la_fill(raw, 150, 300, 0x1);
+    raw[153] = 0x3;                 // CH2 is don't care
+
+    LaBits bits;
+    la_load(bits, raw, 3);
+    CHECK_AT(SoftTrig::scanPattern(pat, bits, FS), 159);
+
+    /* runs of whole 64 sample words */
+    QVector<uint8_t> all(300, 0x1);
+    la_load(bits, all, 3);
+    pat.time = 64e-6;
+    CHECK_AT(SoftTrig::scanPattern(pat, bits, FS), 63);
+    pat.time = 130e-6;
+    CHECK_AT(SoftTrig::scanPattern(pat, bits, FS), 129);
+
+    la_fill(all, 100, 101, 0x0);
+    la_load(bits, all, 3);
+    CHECK_AT(SoftTrig::scanPattern(pat, bits, FS), 230);
+
+    /* padding of last word does not extend run */
+    QVector<uint8_t> tail(100, 0x4);
+    la_fill(tail, 90, 100, 0x1);
+    la_load(bits, tail, 3);
+    pat.time = 20e-6;
+    CHECK_AT(SoftTrig::scanPattern(pat, bits, FS), -1);
+    pat.time = 10e-6;
+    CHECK_AT(SoftTrig::scanPattern(pat, bits, FS), 99);
+
+    pat.mask = 0x1;     // whole last word matches, CH1 = 0 from 64
+    pat.value = 0x0;
+    la_fill(tail, 0, 64, 0x1);
+    la_fill(tail, 64, 100, 0x0);
+    la_load(bits, tail, 3);
+    pat.time = 40e-6;
+    CHECK_AT(SoftTrig::scanPattern(pat, bits, FS), -1);
+    pat.time = 36e-6;
+    CHECK_AT(SoftTrig::scanPattern(pat, bits, FS), 99);
+
+    /* channel above captured ones is ignored, CH4 level is not in capture */
+    pat.mask = 0x9;
+    pat.value = 0x9;
+    pat.time = 10e-6;
+    la_fill(tail, 0, 90, 0x4);
+    la_fill(tail, 90, 100, 0x1);
+    la_load(bits, tail, 3);
+    CHECK_AT(SoftTrig::scanPattern(pat, bits, FS), 99);
+
+    pat.enabled = false;
+    CHECK_AT(SoftTrig::scanPattern(pat, bits, FS), 0);
+}
+
+/********************************* timing *********************************/
+
+/* 1 kHz sine, condition never found, so whole frame is scanned */
+static void bench()
+{
+    QVector<double> y(BENCH_LEN);
+    for (int i = 0; i < BENCH_LEN; i++)
+        y[i] = 1.65 + 1.5 * sin(2 * M_PI * 1000 * i / FS);
+
+    const SoftTrigMode modes[] = { STRIG_PULSE_GT, STRIG_RUNT, STRIG_WINDOW, STRIG_SLEW_LT };
+    const char* names[] = { "pulse >", "runt", "window", "slew <" };
+
+    SoftTrigCfg cfg;
+    cfg.polarity = BOTH;
+
+    SoftTrig strig;
+    printf("scan of %d samples:", BENCH_LEN);
+
+    for (int m = 0; m < 4; m++)
+    {
+        cfg.mode = modes[m];
+        cfg.lo = modes[m] == STRIG_WINDOW ? 0.1 : 1.0;
+        cfg.hi = modes[m] == STRIG_WINDOW ? 3.2 : 2.3;
+        cfg.time = modes[m] == STRIG_SLEW_LT ? 1e-9 : 1;
+        strig.scan(cfg, y.constData(), BENCH_LEN, FS); // warm up
+
+        QElapsedTimer timer;
+        timer.start();
+        int found = 0;
+        for (int it = 0; it < 10; it++)
+            found += strig.scan(cfg, y.constData(), BENCH_LEN, FS) >= 0;
+        printf(" %s %.2f ms%s", names[m], timer.nsecsElapsed() / 10 / 1e6, found ? " (found)" : "");
+    }
+    printf("\n");
+}
+
+int main(int argc, char**)
+{
+    test_off();
+    test_pulse();
+    test_runt();
+    test_window();
+    test_slew();
+    test_pattern();
+
+    if (argc > 1)
+        bench();
+
+    if (g_fails > 0)
+    {
+        fprintf(stderr, "%d checks failed\n", g_fails);
+        return 1;
+    }
+    printf("tst_softtrig: OK\n");
+    return 0;
+}
@@ -0,0 +1,20 @@
+QT += widgets printsupport
+
+CONFIG += console c++11 testcase
+CONFIG -= app_bundle
+
+TARGET = tst_softtrig
+
+INCLUDEPATH += $$PWD/../../src
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += \
+    tst_softtrig.cpp \
+    ../../src/softtrig.cpp \
+    ../../src/labits.cpp \
+    ../../lib/qcustomplot.cpp
+
+HEADERS += \
+    ../../src/softtrig.h \
+    ../../src/labits.h \
+    ../../lib/qcustomplot.h